@@ -2,8 +2,16 @@
 #include <eosio/asset.hpp>
 #include <eosio/system.hpp>
 #include <eosio/crypto.hpp>
+#include <eosio/binary_extension.hpp>
+#include <eosio/singleton.hpp>
 #include <eosio/transaction.hpp>
 
+#include <optional>
+
+#include <profile.hpp>
+#include "shard.hpp"
+#include <gameplay_core.hpp>
+
 using namespace eosio;
 using std::string;
 
@@ -12,135 +20,217 @@ public:
     using contract::contract;
 
     // Constants
-    static constexpr uint32_t WIN_CHANCE = 35; // 35% chance to win
+    static constexpr uint32_t WIN_CHANCE = dbltz_core::WIN_CHANCE; // 35% chance to win
     static constexpr symbol DBP_SYMBOL = symbol("DBP", 4);
     static constexpr int64_t REWARD_AMOUNT = 10000; // 1.0000 DBP
 
+    // Pure hot-path helpers, public so tests/native/bench can measure them in isolation
+
+    /// Roll in [0, 100): the first four bytes of the random value, big endian, modulo 100
+    static uint32_t roll_of(const checksum256& random_value) { return dbltz_core::checksum_rng::roll_of(random_value); }
+
+    static bool is_successful_play(uint32_t roll) { return roll < WIN_CHANCE; }
+
+    /// Oracle signing value: unique per roll as long as the seed is
+    static uint64_t signing_value_for(const time_point& now, const name& player, uint64_t seed) {
+        return uint64_t(now.time_since_epoch().count()) ^ player.value ^ seed;
+    }
+
+    /// Per-roll seed of a string nonce
+    static uint64_t nonce_seed(const string& nonce) { return std::hash<string>{}(nonce); }
+
+    /// Random value of the k-th play a callback settles: the oracle's value itself, then sha256 of it and k
+    static checksum256 draw_value(const checksum256& random_value, uint32_t k) {
+        if (k == 0) return random_value;
+        char data[36];
+        auto bytes = random_value.extract_as_byte_array();
+        memcpy(data, bytes.data(), 32);
+        memcpy(data + 32, &k, sizeof(k));
+        return sha256(data, sizeof(data));
+    }
+
     /**
      * Play action - Main game entry point
+     * Kept for compatibility; playc is the compact form
      * @param player - Player account
      * @param nonce - Unique nonce for replay protection
      */
     [[eosio::action]]
     void play(const name& player, const string& nonce) {
+        DBLTZ_PROFILE_SCOPE("play");
         require_auth(player);
         
         // Validate nonce
         check(nonce.length() > 0 && nonce.length() <= 64, "invalid nonce length");
         
-        // Check player exists or create new entry
-        players_table players(get_self(), get_self().value);
-        auto player_itr = players.find(player.value);
-        
-        if (player_itr == players.end()) {
-            players.emplace(player, [&](auto& p) {
-                p.player = player;
-                p.total_plays = 0;
-                p.total_wins = 0;
-                p.last_nonce = "";
-            });
-            player_itr = players.find(player.value);
-        }
-        
-        // Check nonce for replay protection
-        check(player_itr->last_nonce != nonce, "nonce already used");
+        DBLTZ_PROFILE_SECTION("config");
+        auto cfg = play_config();
+        check_shard(cfg, player);
         
-        // Update player stats
-        players.modify(player_itr, player, [&](auto& p) {
-            p.total_plays++;
-            p.last_nonce = nonce;
-        });
+        // Check the nonce for replay protection and count the play
+        DBLTZ_PROFILE_SECTION("player");
+        string_game(get_self(), *this, cfg.players_layout()).accept(player, nonce);
         
-        // Get config
-        config_table config(get_self(), get_self().value);
-        auto cfg = config.get_or_default();
-        check(cfg.token_contract != name(), "token contract not set");
-        check(cfg.rng_contract != name(), "rng contract not set");
+        DBLTZ_PROFILE_SECTION("roll");
+        start_roll(player, nonce_seed(nonce), cfg);
+    }
+
+    /**
+     * Compact play action. Dispatched by a fast path in apply that reads the
+     * fixed 17-byte payload straight from the action data.
+     * @param player - Player account
+     * @param nonce - Must exceed the player's previous compact nonce; a batch uses nonce .. nonce + count - 1
+     * @param flags - Move type in the high nibble (0 = BLTZ), batch count in the low nibble (0 = 1)
+     */
+    [[eosio::action]]
+    void playc(const name& player, uint64_t nonce, uint8_t flags) {
+        DBLTZ_PROFILE_SCOPE("playc");
+        require_auth(player);
         
-        // Generate unique signing value for RNG
-        uint64_t signing_value = current_time_point().time_since_epoch().count();
-        signing_value ^= player.value;
-        signing_value ^= std::hash<string>{}(nonce);
+        check((flags >> 4) == MOVE_BLTZ, "unsupported move type");
+        uint32_t rolls = std::max<uint32_t>(flags & 0x0F, 1);
+        check(nonce <= std::numeric_limits<uint64_t>::max() - rolls, "nonce out of range");
         
-        // Store pending RNG request
-        pending_table pending(get_self(), get_self().value);
-        uint64_t request_id = pending.available_primary_key();
+        DBLTZ_PROFILE_SECTION("config");
+        auto cfg = play_config();
+        check_shard(cfg, player);
         
-        pending.emplace(get_self(), [&](auto& p) {
-            p.id = request_id;
-            p.player = player;
-            p.signing_value = signing_value;
-            p.timestamp = current_time_point();
-        });
+        // Compact nonces only move forward, so one integer replaces the nonce string
+        DBLTZ_PROFILE_SECTION("player");
+        compact_game(get_self(), *this, cfg.players_layout()).accept(player, nonce, rolls);
         
-        // Request RNG from oracle
-        action(
-            permission_level{get_self(), "active"_n},
-            cfg.rng_contract,
-            "requestrand"_n,
-            std::make_tuple(request_id, signing_value, get_self())
-        ).send();
+        DBLTZ_PROFILE_SECTION("roll");
+        for (uint32_t i = 0; i < rolls; i++) {
+            start_roll(player, nonce + i, cfg);
+        }
     }
 
     /**
      * Receive random value callback from RNG oracle
+     * Never fails once authorized for the request: duplicate or stale callbacks
+     * are ignored, and plays that cannot be settled are parked in the
+     * dead-letter table, so the oracle has no reason to retry. Only providers
+     * the request has been sent to may settle it
      * @param request_id - Original request ID
      * @param random_value - Random value from oracle
      */
     [[eosio::action]]
     void receiverand(uint64_t request_id, const checksum256& random_value) {
-        // Only RNG oracle can call this
+        DBLTZ_PROFILE_SCOPE("receiverand");
+        
+        // Only a configured RNG provider can call this
+        DBLTZ_PROFILE_SECTION("config");
         config_table config(get_self(), get_self().value);
         auto cfg = config.get_or_default();
-        require_auth(cfg.rng_contract);
+        uint64_t provider = authorize_provider(cfg);
+        
+        // Requests sent before the slot table have no generation
+        if (generation_of(request_id) == 0) {
+            DBLTZ_PROFILE_SECTION("legacy");
+            settle_legacy(provider, request_id, random_value, cfg);
+            return;
+        }
         
-        // Find pending request
+        // Find pending request; the generation guards against callbacks for a reused slot
+        DBLTZ_PROFILE_SECTION("slot.read");
         pending_table pending(get_self(), get_self().value);
-        auto pending_itr = pending.find(request_id);
-        check(pending_itr != pending.end(), "request not found");
+        auto pending_itr = pending.find(slot_of(request_id));
+        if (pending_itr == pending.end() || !pending_itr->in_use ||
+            pending_itr->generation != generation_of(request_id)) {
+            record_callback(provider, false, microseconds());
+            return; // already resolved, e.g. by a hedged request to another provider
+        }
+        
+        // Hedging asks providers in order, so any provider past the last one
+        // asked is answering a request it never received
+        check(provider <= pending_itr->asked_provider(), "rng provider was not asked for this request");
+        
+        // First valid callback wins. Latency is known for the primary, which was
+        // asked at play time, and for the provider asked most recently
+        auto now = current_time_point();
+        microseconds latency(-1);
+        if (provider == pending_itr->asked_provider()) {
+            latency = now - pending_itr->sent_time();
+        } else if (provider == 0) {
+            latency = now - pending_itr->timestamp;
+        }
+        
+        // Oracle latency as the player sees it, from play to settlement
+        microseconds oracle_latency = now - pending_itr->timestamp;
         
         // Extract player from pending request
         name player = pending_itr->player;
         
-        // Remove pending request
-        pending.erase(pending_itr);
+        // Return the slot to the free list, taking the counts plays left there
+        DBLTZ_PROFILE_SECTION("slot.release");
+        auto unreported = release_slot(pending, pending_itr);
         
-        // Calculate win/loss from random value
-        auto byte_array = random_value.extract_as_byte_array();
-        uint32_t random_num = (byte_array[0] << 24) | (byte_array[1] << 16) | 
-                             (byte_array[2] << 8) | byte_array[3];
-        uint32_t result = random_num % 100;
+        // Pool draws are owned by the contract itself
+        if (player == get_self()) {
+            DBLTZ_PROFILE_SECTION("pool");
+            unreported.plays += settle_draw(request_id, random_value, cfg);
+        } else {
+            DBLTZ_PROFILE_SECTION("settle");
+            settle_or_park(player, request_id, random_value, cfg);
+        }
         
-        bool won = result < WIN_CHANCE;
+        // Plays and primary requests since the last callback land with this one
+        DBLTZ_PROFILE_SECTION("metrics");
+        record_callback(provider, true, latency);
+        record_request(0, unreported.requests);
+        update_metrics([&](auto& m) {
+            m.plays += unreported.plays;
+            m.callbacks++;
+            m.latency_ms[latency_bucket(oracle_latency)]++;
+        });
+    }
+
+    /**
+     * Retry settling dead-lettered plays, oldest first
+     * @param max_rows - Maximum dead letters to retry in one transaction
+     */
+    [[eosio::action]]
+    void replaydead(uint32_t max_rows) {
+        require_auth(get_self());
         
-        // Update player stats
-        players_table players(get_self(), get_self().value);
-        auto player_itr = players.find(player.value);
-        check(player_itr != players.end(), "player not found");
+        config_table config(get_self(), get_self().value);
+        auto cfg = config.get_or_default();
         
-        if (won) {
-            players.modify(player_itr, same_payer, [&](auto& p) {
-                p.total_wins++;
-            });
-            
-            // Issue reward token
-            asset reward(REWARD_AMOUNT, DBP_SYMBOL);
-            
-            action(
-                permission_level{cfg.token_contract, "active"_n},
-                cfg.token_contract,
-                "issue"_n,
-                std::make_tuple(player, reward, string("BLTZ win reward"))
-            ).send();
+        dead_letters_table dead_letters(get_self(), get_self().value);
+        auto itr = dead_letters.begin();
+        for (uint32_t count = 0; itr != dead_letters.end() && count < max_rows; count++) {
+            uint8_t status = settle_play(itr->player, itr->random_value, cfg);
+            if (status == dbltz_core::SETTLED) {
+                itr = dead_letters.erase(itr);
+            } else {
+                dead_letters.modify(itr, same_payer, [&](auto& d) {
+                    d.reason = status;
+                    d.attempts++;
+                });
+                ++itr;
+            }
         }
+    }
+
+    /**
+     * Pay out the rewards a player's wins have credited. Settlement only
+     * credits them, so a player account that rejects the token's transfer
+     * notification fails its own claim rather than the oracle callback
+     * @param player - Player claiming their rewards
+     */
+    [[eosio::action]]
+    void claim(const name& player) {
+        require_auth(player);
         
-        // Log result
-        action(
-            permission_level{get_self(), "active"_n},
-            get_self(),
-            "logresult"_n,
-            std::make_tuple(player, won, result)
-        ).send();
+        config_table config(get_self(), get_self().value);
+        auto cfg = config.get_or_default();
+        check_shard(cfg, player);
+        
+        uint64_t owed = player_storage(*this, cfg.players_layout()).take_owed(player);
+        check(owed > 0, "no rewards to claim");
+        auto terms = reward_terms(cfg, owed);
+        check(dbltz_core::checked_issue::check(terms) == dbltz_core::SETTLED, "rewards cannot be issued now, try again later");
+        dbltz_core::direct_issue::pay(player, terms);
     }
 
     /**
@@ -154,6 +244,7 @@ public:
         
         config_table config(get_self(), get_self().value);
         auto cfg = config.get_or_default();
+        cfg.upgrade();
         cfg.token_contract = token_contract;
         config.set(cfg, get_self());
     }
@@ -169,8 +260,106 @@ public:
         
         config_table config(get_self(), get_self().value);
         auto cfg = config.get_or_default();
+        cfg.upgrade();
         cfg.rng_contract = rng_contract;
         config.set(cfg, get_self());
+        
+        // Keep the provider list's primary in step, with fresh counters
+        rng_providers_table providers(get_self(), get_self().value);
+        auto primary = providers.find(0);
+        if (primary != providers.end() && primary->oracle != rng_contract) {
+            providers.modify(primary, same_payer, [&](auto& p) {
+                p = rng_provider{0, rng_contract};
+            });
+        }
+    }
+
+    /**
+     * Set the RNG providers used for hedged requests
+     * @param oracles - Providers in hedging order; the first is the primary
+     * @param hedge_after_ms - Wait before re-requesting from the next provider (0 disables hedging)
+     */
+    [[eosio::action]]
+    void setproviders(const std::vector<name>& oracles, uint32_t hedge_after_ms) {
+        require_auth(get_self());
+        check(!oracles.empty(), "at least one rng provider is required");
+        check(oracles.size() <= MAX_PROVIDERS, "too many rng providers");
+        for (size_t i = 0; i < oracles.size(); i++) {
+            check(is_account(oracles[i]), "rng contract does not exist");
+            for (size_t j = 0; j < i; j++) {
+                check(oracles[i] != oracles[j], "duplicate rng provider");
+            }
+        }
+        
+        rng_providers_table providers(get_self(), get_self().value);
+        for (auto itr = providers.begin(); itr != providers.end();) {
+            itr = providers.erase(itr);
+        }
+        for (size_t i = 0; i < oracles.size(); i++) {
+            providers.emplace(get_self(), [&](auto& p) {
+                p = rng_provider{i, oracles[i]};
+            });
+        }
+        
+        config_table config(get_self(), get_self().value);
+        auto cfg = config.get_or_default();
+        cfg.upgrade();
+        cfg.rng_contract = oracles[0];
+        cfg.hedge_after_ms.value() = hedge_after_ms;
+        config.set(cfg, get_self());
+    }
+
+    /**
+     * Re-request randomness from the next provider for requests that have
+     * waited longer than the hedge delay (maintenance action)
+     * @param max_rows - Maximum slots to examine in one transaction
+     */
+    [[eosio::action]]
+    void hedge(uint32_t max_rows) {
+        require_auth(get_self());
+        
+        config_table config(get_self(), get_self().value);
+        auto cfg = config.get_or_default();
+        check(cfg.hedge_delay_ms() > 0, "hedging is disabled");
+        
+        rng_providers_table providers(get_self(), get_self().value);
+        std::vector<name> oracles;
+        for (const auto& p : providers) {
+            oracles.push_back(p.oracle);
+        }
+        
+        slot_state_table slot_state(get_self(), get_self().value);
+        auto slots = slot_state.get_or_default();
+        if (oracles.size() < 2 || slots.capacity == 0) return;
+        
+        pending_table pending(get_self(), get_self().value);
+        auto now = current_time_point();
+        auto hedge_time = now - milliseconds(cfg.hedge_delay_ms());
+        
+        // Walk the slot ring from where the previous hedge pass stopped
+        uint64_t cursor = slots.hedge_cursor.value_or(0) % slots.capacity;
+        uint64_t visits = std::min<uint64_t>(max_rows, slots.capacity);
+        for (uint64_t i = 0; i < visits; i++) {
+            auto itr = pending.find(cursor);
+            cursor = (cursor + 1) % slots.capacity;
+            
+            if (!itr->in_use || itr->sent_time() > hedge_time) continue;
+            uint8_t next = itr->asked_provider() + 1;
+            if (next >= oracles.size()) continue;
+            
+            pending.modify(itr, same_payer, [&](auto& p) {
+                p.upgrade();
+                p.provider.value() = next;
+                p.sent_at.value() = now;
+            });
+            
+            // Same request id, so whichever provider answers first settles the play
+            send_rng_request(oracles[next], request_id_for(itr->id, itr->generation), itr->signing_value + next);
+            record_request(next);
+        }
+        
+        slots.hedge_cursor.emplace(cursor);
+        slot_state.set(slots, get_self());
     }
 
     /**
@@ -187,31 +376,362 @@ public:
 
     /**
      * Clear expired pending requests (maintenance action)
-     * @param max_rows - Maximum rows to clear in one transaction
+     * @param max_rows - Maximum slots to examine in one transaction
      */
     [[eosio::action]]
     void clearexpired(uint32_t max_rows) {
         require_auth(get_self());
         
+        slot_state_table slot_state(get_self(), get_self().value);
+        auto slots = slot_state.get_or_default();
+        if (slots.capacity == 0) return;
+        
         pending_table pending(get_self(), get_self().value);
-        auto idx = pending.get_index<"bytimestamp"_n>();
         
         // Consider requests older than 5 minutes as expired
         auto expiry_time = current_time_point() - seconds(300);
-        auto itr = idx.begin();
         
-        uint32_t count = 0;
-        while (itr != idx.end() && count < max_rows) {
-            if (itr->timestamp < expiry_time) {
-                itr = idx.erase(itr);
-                count++;
+        // Walk the slot ring from where the previous sweep stopped
+        uint32_t expired = 0;
+        bool draw_expired = false;
+        draw_state_table draw_state(get_self(), get_self().value);
+        auto draws = draw_state.get_or_default();
+        uint64_t visits = std::min<uint64_t>(max_rows, slots.capacity);
+        for (uint64_t i = 0; i < visits; i++) {
+            auto itr = pending.find(slots.sweep_cursor);
+            slots.sweep_cursor = (slots.sweep_cursor + 1) % slots.capacity;
+            
+            if (itr->in_use && itr->timestamp < expiry_time) {
+                draw_expired |= itr->player == get_self() && request_id_for(itr->id, itr->generation) == draws.request_id;
+                
+                pending.modify(itr, same_payer, [&](auto& p) {
+                    p.upgrade();
+                    p.in_use = false;
+                    p.next_free = slots.free_head;
+                });
+                slots.free_head = itr->id;
+                slots.in_use--;
+                expired++;
+            }
+        }
+        slot_state.set(slots, get_self());
+        update_breaker(slots.in_use);
+        
+        // Requests from before the slot table that the oracle never answered
+        legacy_pending_table legacy(get_self(), get_self().value);
+        auto legacy_idx = legacy.get_index<"bytimestamp"_n>();
+        auto legacy_itr = legacy_idx.begin();
+        for (uint32_t i = 0; i < max_rows && legacy_itr != legacy_idx.end() && legacy_itr->timestamp < expiry_time; i++) {
+            legacy_itr = legacy_idx.erase(legacy_itr);
+            expired++;
+        }
+        
+        if (expired > 0) {
+            update_metrics([&](auto& m) {
+                m.expired += expired;
+            });
+        }
+        
+        // Plays an expired draw was for, or left waiting while the breaker was open, get a new one
+        bool draws_changed = draw_expired;
+        if (draw_expired) draws.request_id = 0;
+        if (draws.request_id == 0 && draws.queued > 0 && !breaker_open()) {
+            config_table config(get_self(), get_self().value);
+            draws_changed |= request_draw(draws, config.get_or_default());
+        }
+        if (draws_changed) draw_state.set(draws, get_self());
+        
+        // Counts waiting for a callback are not held back while the oracle is silent
+        flush_unreported();
+    }
+
+    /**
+     * Move idle players out of the players table into the compact archive,
+     * refunding their RAM. A player's totals come back on their next play;
+     * players with rewards to claim stay
+     * @param max_rows - Maximum players rows to examine in one transaction
+     * @param idle_seconds - Evict players whose last play is older than this
+     */
+    [[eosio::action]]
+    void evictidle(uint32_t max_rows, uint32_t idle_seconds) {
+        require_auth(get_self());
+        check(idle_seconds >= MIN_IDLE_SECONDS, "idle threshold must be at least a day");
+        
+        auto cutoff = time_point_sec(current_time_point()) - idle_seconds;
+        players_table players(get_self(), get_self().value);
+        std::vector<archived_player> evicted;
+        uint32_t examined = 0;
+        
+        // Least recently active first, stopping at the first hour that is not wholly idle
+        auto by_last_play = players.get_index<"bylastplay"_n>();
+        uint64_t cutoff_hour = cutoff.sec_since_epoch() / ACTIVITY_GRANULARITY;
+        for (auto itr = by_last_play.begin(); itr != by_last_play.end() && examined < max_rows; examined++) {
+            if (itr->by_last_play() >= cutoff_hour) break;
+            // The archive keeps no rewards, so a row stays until they are claimed
+            if (itr->owed_amount() > 0) {
+                ++itr;
+                continue;
+            }
+            evicted.push_back(archive_entry(*itr));
+            itr = by_last_play.erase(itr);
+        }
+        
+        // Rows nobody has played on since the index was added have no entry in
+        // it. Sweep the table for them, one pass per call at most, until a
+        // full pass finds none still in use
+        evict_state_table evict_state(get_self(), get_self().value);
+        auto state = evict_state.get_or_default();
+        auto itr = players.lower_bound(state.legacy_cursor);
+        while (!state.legacy_done && examined < max_rows) {
+            if (itr == players.end()) {
+                state.legacy_done = !state.legacy_kept;
+                state.legacy_kept = false;
+                break;
+            }
+            examined++;
+            if (itr->is_indexed()) {
+                ++itr;
+            } else if (itr->last_play_at() < cutoff && itr->owed_amount() == 0) {
+                evicted.push_back(archive_entry(*itr));
+                itr = players.erase(itr);
             } else {
-                break; // Remaining entries are not expired
+                state.legacy_kept = true;
+                ++itr;
             }
         }
+        state.legacy_cursor = itr == players.end() ? 0 : itr->primary_key();
+        
+        archive_players(evicted);
+        state.evicted += evicted.size();
+        state.archived += evicted.size();
+        evict_state.set(state, get_self());
+    }
+
+    /**
+     * evictidle for rows in per-player scopes, which no index spans: archive
+     * each listed player whose last play is older than idle_seconds. A bot
+     * finds candidates off chain, e.g. from the players table's scopes
+     * @param players - Players to consider; missing or active ones are skipped
+     * @param idle_seconds - Evict players whose last play is older than this
+     */
+    [[eosio::action]]
+    void evictscoped(const std::vector<name>& players, uint32_t idle_seconds) {
+        require_auth(get_self());
+        check(idle_seconds >= MIN_IDLE_SECONDS, "idle threshold must be at least a day");
+        
+        auto cutoff = time_point_sec(current_time_point()) - idle_seconds;
+        std::vector<archived_player> evicted;
+        for (const auto& player : players) {
+            players_table own(get_self(), player.value);
+            auto itr = own.find(player.value);
+            if (itr == own.end() || itr->last_play_at() >= cutoff || itr->owed_amount() > 0) continue;
+            evicted.push_back(archive_entry(*itr));
+            own.erase(itr);
+        }
+        if (evicted.empty()) return;
+        
+        archive_players(evicted);
+        evict_state_table evict_state(get_self(), get_self().value);
+        auto state = evict_state.get_or_default();
+        state.evicted += evicted.size();
+        state.archived += evicted.size();
+        evict_state.set(state, get_self());
+    }
+
+    /**
+     * Opt in to per-player scopes for the players table, moving up to
+     * max_rows rows from the self scope per call. A play in between moves
+     * its own player's row. Once the self scope is empty the layout is
+     * final; there is no way back. Moved rows are billed to the contract
+     * until their player's next play bills them back
+     * @param max_rows - Maximum rows to move in one transaction
+     */
+    [[eosio::action]]
+    void scopeplayers(uint32_t max_rows) {
+        require_auth(get_self());
+        
+        config_table config(get_self(), get_self().value);
+        auto cfg = config.get_or_default();
+        cfg.upgrade();
+        if (cfg.player_layout.value() == PLAYERS_SCOPED) return;
+        
+        players_table shared(get_self(), get_self().value);
+        auto itr = shared.begin();
+        for (uint32_t moved = 0; itr != shared.end() && moved < max_rows; moved++) {
+            player_stats row = *itr;
+            itr = shared.erase(itr);
+            
+            players_table own(get_self(), row.player.value);
+            own.emplace(get_self(), [&](auto& p) {
+                p = row;
+                p.upgrade();
+                p.indexed.value() = true;
+            });
+        }
+        cfg.player_layout.value() = itr == shared.end() ? PLAYERS_SCOPED : PLAYERS_MIGRATING;
+        config.set(cfg, get_self());
+    }
+
+    /**
+     * Configure the oracle backlog circuit breaker
+     * @param max_outstanding - Outstanding requests that trip the breaker (0 disables it)
+     * @param resume_below - Backlog depth at which plays are admitted again
+     */
+    [[eosio::action]]
+    void setbreaker(uint64_t max_outstanding, uint64_t resume_below) {
+        require_auth(get_self());
+        check(max_outstanding == 0 || resume_below < max_outstanding, "resume level must be below the threshold");
+        
+        breaker_table breaker(get_self(), get_self().value);
+        auto state = breaker.get_or_default();
+        state.max_outstanding = max_outstanding;
+        state.resume_below = resume_below;
+        state.open = false;
+        breaker.set(state, get_self());
+        
+        slot_state_table slot_state(get_self(), get_self().value);
+        update_breaker(slot_state.get_or_default().in_use);
+    }
+
+    /**
+     * Preallocate pending request slots so plays never allocate RAM
+     * @param capacity - Total number of slots wanted; existing slots are kept
+     */
+    [[eosio::action]]
+    void initslots(uint32_t capacity) {
+        require_auth(get_self());
+        check(capacity <= MAX_SLOTS, "slot capacity too large");
+        
+        slot_state_table slot_state(get_self(), get_self().value);
+        auto slots = slot_state.get_or_default();
+        check(capacity > slots.capacity, "slot capacity can only grow");
+        
+        pending_table pending(get_self(), get_self().value);
+        for (uint64_t id = slots.capacity; id < capacity; id++) {
+            pending.emplace(get_self(), [&](auto& p) {
+                p.id = id;
+                p.generation = 0;
+                p.in_use = false;
+                p.next_free = slots.free_head;
+                p.player = name();
+                p.signing_value = 0;
+                p.timestamp = time_point();
+                p.upgrade();
+            });
+            slots.free_head = id;
+        }
+        slots.capacity = capacity;
+        slot_state.set(slots, get_self());
     }
 
+    /**
+     * Start a new metrics window (maintenance action)
+     * @param rotate - Keep the closing window under scope "prev" instead of discarding it
+     */
+    [[eosio::action]]
+    void resetmetrics(bool rotate) {
+        require_auth(get_self());
+        
+        // Plays not yet reported belong to the window being closed
+        flush_unreported();
+        
+        metrics_table metrics(get_self(), get_self().value);
+        if (rotate && metrics.exists()) {
+            metrics_table previous(get_self(), "prev"_n.value);
+            previous.set(metrics.get(), get_self());
+        }
+        
+        metrics.set(metrics_window{current_time_point(), 0, 0, 0, 0, std::vector<uint64_t>(LATENCY_BUCKETS)}, get_self());
+    }
+
+    /**
+     * Configure pooled draws: plays wait in poolplays and one oracle draw,
+     * requested after they were committed, settles up to batch_size of them
+     * @param batch_size - Most plays one draw settles (0 disables the pool; queued plays still drain)
+     */
+    [[eosio::action]]
+    void setpool(uint32_t batch_size) {
+        require_auth(get_self());
+        check(batch_size <= MAX_DRAW_BATCH, "batch size too large");
+        
+        draw_state_table draw_state(get_self(), get_self().value);
+        auto draws = draw_state.get_or_default();
+        draws.batch_size = batch_size;
+        draw_state.set(draws, get_self());
+    }
+
+    /**
+     * Deploy as one of several shard accounts. Each shard owns the players
+     * dbltz_shard::shard_of assigns it and keeps its own players, slots,
+     * pool and oracle, so capacity grows with the shard count. Every shard
+     * is given the same list. Adding a shard moves about 1/N of the players;
+     * their existing rows stay behind on the shard they left
+     * @param shards - Every shard account in order, this one included; empty to stop sharding
+     */
+    [[eosio::action]]
+    void setshards(const std::vector<name>& shards) {
+        require_auth(get_self());
+        check(shards.size() <= MAX_SHARDS, "too many shards");
+        bool listed = shards.empty();
+        for (size_t i = 0; i < shards.size(); i++) {
+            check(is_account(shards[i]), "shard account does not exist");
+            for (size_t j = 0; j < i; j++) {
+                check(shards[i] != shards[j], "duplicate shard account");
+            }
+            listed |= shards[i] == get_self();
+        }
+        check(listed, "shard list must include this account");
+        
+        config_table config(get_self(), get_self().value);
+        auto cfg = config.get_or_default();
+        cfg.upgrade();
+        cfg.shards.value() = shards;
+        config.set(cfg, get_self());
+    }
+
+    /**
+     * The shard account that owns a player, for clients without the shard map
+     * @param player - Player account
+     */
+    [[eosio::action, eosio::read_only]]
+    name route(const name& player) {
+        config_table config(get_self(), get_self().value);
+        return shard_owner(config.get_or_default(), player);
+    }
+
+    // Size of the packed playc payload: player, nonce and the optional flags byte
+    static constexpr uint32_t PLAYC_SIZE = sizeof(uint64_t) + sizeof(uint64_t) + sizeof(uint8_t);
+
 private:
+    static constexpr uint8_t MOVE_BLTZ = 0;
+    static constexpr uint32_t MAX_DRAW_BATCH = 64;
+    static constexpr uint32_t MAX_SLOTS = 65536;
+    static constexpr uint32_t MAX_PROVIDERS = 8;
+    static constexpr uint32_t MAX_SHARDS = 256;
+    static constexpr uint32_t LATENCY_BUCKETS = 20;
+    static constexpr uint32_t ARCHIVE_BUCKETS = 1024;
+    static constexpr uint32_t ACTIVITY_GRANULARITY = 3600; // seconds per bylastplay key
+    // Longer than any request stays in a slot or any transaction stays valid,
+    // so an evicted player has nothing in flight and no nonce left to replay
+    static constexpr uint32_t MIN_IDLE_SECONDS = 24 * 3600;
+    static constexpr uint64_t NO_SLOT = std::numeric_limits<uint64_t>::max();
+
+    // Where players rows live. Shared keeps every row in the self scope; per
+    // player gives each row a scope of its own, player.value, so a play
+    // searches a one-row table however many players there are
+    enum player_layouts : uint8_t {
+        PLAYERS_SHARED    = 0,
+        PLAYERS_MIGRATING = 1, // scopeplayers has started; a row may still be in the self scope
+        PLAYERS_SCOPED    = 2  // every row is in its player's scope
+    };
+
+    // Current schema versions. New columns are appended as binary_extension
+    // fields, so rows written by older code still deserialize and are upgraded
+    // in place the next time they are modified; no bulk migration is needed.
+    static constexpr uint8_t PLAYER_SCHEMA = 4;
+    static constexpr uint8_t SLOT_SCHEMA   = 2;
+    static constexpr uint8_t CONFIG_SCHEMA = 4;
+
     // Tables
     struct [[eosio::table]] player_stats {
         name     player;
@@ -219,34 +739,957 @@ private:
         uint64_t total_wins;
         string   last_nonce;
         
+        // v1
+        binary_extension<uint8_t>        schema_version;
+        binary_extension<time_point_sec> last_play;
+        // v2
+        binary_extension<uint64_t>       last_cnonce;
+        // v3
+        binary_extension<bool>           indexed;     // has a bylastplay entry; rows written before v3 do not
+        // v4
+        binary_extension<uint64_t>       owed;        // rewards won and not claimed yet
+        
         uint64_t primary_key() const { return player.value; }
+        // Whole hours, so plays within the hour leave the index entry alone
+        uint64_t by_last_play() const { return last_play_at().sec_since_epoch() / ACTIVITY_GRANULARITY; }
+        
+        uint8_t version() const { return schema_version.value_or(0); }
+        time_point_sec last_play_at() const { return last_play.value_or(time_point_sec()); }
+        uint64_t last_compact_nonce() const { return last_cnonce.value_or(0); }
+        void set_last_compact_nonce(uint64_t nonce) { last_cnonce.value() = nonce; } // after upgrade()
+        bool is_indexed() const { return indexed.value_or(false); }
+        uint64_t owed_amount() const { return owed.value_or(0); }
+        void credit(int64_t amount) { owed.value() += amount; } // after upgrade()
+        
+        // Extensions serialize positionally, so every earlier one must hold a value
+        void upgrade() {
+            if (version() >= PLAYER_SCHEMA) return;
+            if (!last_play.has_value()) last_play.emplace();
+            if (!last_cnonce.has_value()) last_cnonce.emplace(0);
+            if (!indexed.has_value()) indexed.emplace(false);
+            if (!owed.has_value()) owed.emplace(0);
+            schema_version.emplace(PLAYER_SCHEMA);
+        }
+    };
+
+    // An evicted player's totals, kept sorted by player within its archive bucket
+    struct archived_player {
+        name           player;
+        uint64_t       total_plays;
+        uint64_t       total_wins;
+        uint64_t       last_cnonce;
+        time_point_sec last_play;
+    };
+
+    // Archived players hashed into ARCHIVE_BUCKETS rows, so each costs its
+    // packed size rather than a row's overhead
+    struct [[eosio::table]] archive_bucket {
+        uint64_t                     id;
+        std::vector<archived_player> players;
+        
+        uint64_t primary_key() const { return id; }
+    };
+
+    struct [[eosio::table]] evict_state {
+        uint64_t legacy_cursor = 0;     // next players row of the sweep for rows without an index entry
+        bool     legacy_kept   = false; // the current sweep passed over an unindexed row still in use
+        bool     legacy_done   = false; // a full sweep found no unindexed rows
+        uint64_t evicted       = 0;
+        uint64_t restored      = 0;
+        uint64_t archived      = 0;     // players in the archive now
     };
 
+    // Fixed-size slot, preallocated by initslots and reused in place
     struct [[eosio::table]] pending_rng {
         uint64_t      id;
+        uint32_t      generation;    // bumped on every reuse, part of the request id
+        bool          in_use;
+        uint64_t      next_free;     // free-list link while idle
         name          player;
         uint64_t      signing_value;
         time_point    timestamp;
         
+        // v1
+        binary_extension<uint8_t> schema_version;
+        // v2
+        binary_extension<uint8_t>    provider;  // index of the provider asked most recently
+        binary_extension<time_point> sent_at;   // when that provider was asked
+        
         uint64_t primary_key() const { return id; }
-        uint64_t by_timestamp() const { return timestamp.time_since_epoch().count(); }
+        
+        uint8_t version() const { return schema_version.value_or(0); }
+        uint8_t asked_provider() const { return provider.value_or(0); }
+        time_point sent_time() const { return sent_at.value_or(timestamp); }
+        
+        void upgrade() {
+            if (version() >= SLOT_SCHEMA) return;
+            if (!provider.has_value()) provider.emplace(0);
+            if (!sent_at.has_value()) sent_at.emplace(timestamp);
+            schema_version.emplace(SLOT_SCHEMA);
+        }
+    };
+
+    // Play path counters held back from metrics and the providers table
+    struct unreported_counts {
+        uint64_t plays    = 0;
+        uint64_t requests = 0; // sent to the primary provider
+    };
+
+    struct [[eosio::table]] slot_state {
+        uint64_t capacity     = 0;
+        uint64_t free_head    = NO_SLOT;
+        uint64_t in_use       = 0;
+        uint64_t sweep_cursor = 0;
+        
+        binary_extension<uint64_t> hedge_cursor;
+        // A play already rewrites this row for its slot, so it counts itself
+        // here; callbacks fold the counts into metrics and the provider row
+        binary_extension<uint64_t> unreported_plays;
+        binary_extension<uint64_t> unreported_requests;
+        
+        void count_request(bool play) {
+            if (!hedge_cursor.has_value()) hedge_cursor.emplace(0);
+            unreported_plays.emplace(unreported_plays.value_or(0) + (play ? 1 : 0));
+            unreported_requests.emplace(unreported_requests.value_or(0) + 1);
+        }
+        
+        unreported_counts take_unreported() {
+            unreported_counts counts{unreported_plays.value_or(0), unreported_requests.value_or(0)};
+            if (unreported_requests.has_value()) {
+                unreported_plays.emplace(0);
+                unreported_requests.emplace(0);
+            }
+            return counts;
+        }
     };
 
     struct [[eosio::table]] game_config {
         name token_contract;
         name rng_contract;
+        
+        // v1
+        binary_extension<uint8_t> schema_version;
+        // v2
+        binary_extension<uint32_t> hedge_after_ms;
+        // v3
+        binary_extension<std::vector<name>> shards; // every shard account in order; empty when unsharded
+        // v4
+        binary_extension<uint8_t> player_layout;    // player_layouts
+        
+        uint8_t version() const { return schema_version.value_or(0); }
+        uint32_t hedge_delay_ms() const { return hedge_after_ms.value_or(0); }
+        bool sharded() const { return shards.has_value() && !shards.value().empty(); }
+        uint8_t players_layout() const { return player_layout.value_or(PLAYERS_SHARED); }
+        
+        void upgrade() {
+            if (version() >= CONFIG_SCHEMA) return;
+            if (!hedge_after_ms.has_value()) hedge_after_ms.emplace(0);
+            if (!shards.has_value()) shards.emplace();
+            if (!player_layout.has_value()) player_layout.emplace(PLAYERS_SHARED);
+            schema_version.emplace(CONFIG_SCHEMA);
+        }
+    };
+
+    // Counters for the current metrics window; the previous window is kept under scope "prev"
+    struct [[eosio::table]] metrics_window {
+        time_point            started;
+        uint64_t              plays     = 0; // rolls started by play and playc
+        uint64_t              callbacks = 0; // oracle callbacks that resolved a request
+        uint64_t              expired   = 0; // requests dropped by clearexpired
+        uint64_t              rejected  = 0; // callbacks whose play was dead-lettered
+        // Play-to-callback latency, log2 scale in milliseconds: bucket 0 is
+        // under 2 ms, bucket i covers [2^i, 2^(i+1)) ms, the last is open-ended
+        std::vector<uint64_t> latency_ms;
+    };
+
+    // RNG providers in hedging order, id 0 being the primary
+    struct [[eosio::table]] rng_provider {
+        uint64_t id;
+        name     oracle;
+        uint64_t requests   = 0; // requests sent to this provider
+        uint64_t wins       = 0; // callbacks that settled a request first
+        uint64_t late       = 0; // callbacks discarded because the request was already settled
+        uint64_t latency_us = 0; // summed latency of winning callbacks with a known send time
+        uint64_t timed_wins = 0; // winning callbacks included in latency_us
+        
+        uint64_t primary_key() const { return id; }
+    };
+
+    // Outstanding oracle requests are the in-use slot count in slotstate
+    struct [[eosio::table]] breaker_state {
+        uint64_t max_outstanding = 0; // 0 disables the breaker
+        uint64_t resume_below    = 0;
+        bool     open            = false;
+        uint64_t trips           = 0;
+    };
+
+    struct [[eosio::table]] dead_letter {
+        uint64_t      id;
+        name          player;
+        uint64_t      request_id;
+        checksum256   random_value;
+        uint8_t       reason;        // dbltz_core::settle_status
+        uint32_t      attempts;      // replaydead retries so far
+        time_point    created;
+        
+        uint64_t primary_key() const { return id; }
+    };
+
+    // A pending request as stored before the slot table, under a sequential id the
+    // oracle echoes back; kept until the requests in flight at the upgrade are gone
+    struct legacy_pending_rng {
+        uint64_t      id;
+        name          player;
+        uint64_t      signing_value;
+        time_point    timestamp;
+        
+        uint64_t primary_key() const { return id; }
+        uint64_t by_timestamp() const { return timestamp.time_since_epoch().count(); }
+    };
+
+    // A play waiting for the next pool draw
+    struct [[eosio::table]] pool_play {
+        uint64_t      id;
+        name          player;
+        time_point    queued;
+        
+        uint64_t primary_key() const { return id; }
+    };
+
+    // One draw is in flight at a time, and settles only plays queued before it was requested
+    struct [[eosio::table]] draw_state {
+        uint32_t batch_size  = 0; // most plays one draw settles; 0 disables the pool
+        uint32_t queued      = 0; // plays waiting in poolplays
+        uint64_t request_id  = 0; // of the draw in flight, 0 when there is none
+        uint64_t next_id     = 0; // id of the next queued play
+        uint64_t drawn_below = 0; // plays with a lower id were queued before the draw in flight was requested
+        uint64_t served      = 0; // plays settled by a draw
+        uint64_t draws       = 0; // draws requested
+        uint64_t unreported  = 0; // pooled plays not yet counted in metrics
     };
 
     typedef eosio::multi_index<
         "players"_n, 
-        player_stats
+        player_stats,
+        indexed_by<"bylastplay"_n, const_mem_fun<player_stats, uint64_t, &player_stats::by_last_play>>
     > players_table;
 
+    typedef eosio::multi_index<"archive"_n, archive_bucket> archive_table;
+
+    typedef eosio::singleton<"evictstate"_n, evict_state> evict_state_table;
+
     typedef eosio::multi_index<
-        "pending"_n, 
-        pending_rng,
-        indexed_by<"bytimestamp"_n, const_mem_fun<pending_rng, uint64_t, &pending_rng::by_timestamp>>
+        "rngslots"_n, 
+        pending_rng
     > pending_table;
 
+    typedef eosio::multi_index<
+        "pending"_n,
+        legacy_pending_rng,
+        indexed_by<"bytimestamp"_n, const_mem_fun<legacy_pending_rng, uint64_t, &legacy_pending_rng::by_timestamp>>
+    > legacy_pending_table;
+
+    typedef eosio::singleton<"slotstate"_n, slot_state> slot_state_table;
+
     typedef eosio::singleton<"config"_n, game_config> config_table;
-};
\ No newline at end of file
+
+    typedef eosio::multi_index<"poolplays"_n, pool_play> pool_plays_table;
+
+    typedef eosio::singleton<"drawstate"_n, draw_state> draw_state_table;
+
+    typedef eosio::singleton<"breaker"_n, breaker_state> breaker_table;
+
+    typedef eosio::multi_index<"deadletter"_n, dead_letter> dead_letters_table;
+
+    typedef eosio::multi_index<"providers"_n, rng_provider> rng_providers_table;
+
+    typedef eosio::singleton<"metrics"_n, metrics_window> metrics_table;
+
+    /**
+     * The players table as the game core's storage: a play finds, restores
+     * or creates the player's row and writes it once, with the nonce
+     * policy's check and update in between. Settlement reads the row where
+     * it is and never moves it, since the oracle cannot pay for the move
+     */
+    class player_storage {
+    public:
+        player_storage(gameplay& contract, uint8_t layout) : contract(contract), layout(layout) {}
+        
+        template <typename Check, typename Record>
+        void play(const name& player, uint32_t rolls, Check&& check, Record&& record) {
+            players_table players(contract.get_self(), contract.players_scope(layout, player));
+            auto player_itr = contract.find_or_create_player(players, player, layout);
+            check(*player_itr);
+            players.modify(player_itr, player, [&](auto& p) {
+                p.upgrade();
+                p.total_plays += rolls;
+                record(p);
+                p.last_play.emplace(current_time_point());
+            });
+        }
+        
+        bool has_player(const name& player) {
+            auto& players = table_of(player);
+            return players.find(player.value) != players.end();
+        }
+        
+        template <typename Record>
+        void win(const name& player, Record&& record) {
+            auto& players = table_of(player);
+            auto itr = players.find(player.value);
+            // Upgrading grows the row, which its player did not authorize here
+            name payer = itr->version() < PLAYER_SCHEMA ? contract.get_self() : same_payer;
+            players.modify(itr, payer, [&](auto& p) {
+                p.upgrade();
+                p.total_wins++;
+                record(p);
+            });
+        }
+        
+        /// Zero a player's credited rewards and return them, billing the row back to the player
+        uint64_t take_owed(const name& player) {
+            auto& players = table_of(player);
+            auto itr = players.find(player.value);
+            check(itr != players.end(), "player not found");
+            uint64_t owed = itr->owed_amount();
+            players.modify(itr, player, [](auto& p) {
+                p.upgrade();
+                p.owed.value() = 0;
+            });
+            return owed;
+        }
+        
+    private:
+        gameplay&                    contract;
+        uint8_t                      layout;
+        std::optional<players_table> players;
+        
+        // The table holding the player's row, falling back to the self scope for one not yet moved
+        players_table& table_of(const name& player) {
+            if (players) return *players;
+            players.emplace(contract.get_self(), contract.players_scope(layout, player));
+            if (layout == PLAYERS_MIGRATING && players->find(player.value) == players->end()) {
+                players.emplace(contract.get_self(), contract.get_self().value);
+            }
+            return *players;
+        }
+    };
+    
+    // play and playc differ only in their nonce; both settle through string_game,
+    // which credits wins for the player to claim
+    typedef dbltz_core::game<dbltz_core::distinct_nonce, dbltz_core::checksum_rng,
+                             dbltz_core::credited_issue, player_storage> string_game;
+    typedef dbltz_core::game<dbltz_core::increasing_nonce, dbltz_core::checksum_rng,
+                             dbltz_core::credited_issue, player_storage> compact_game;
+
+public:
+    // One shard's counters, summed across shards by the client's stats aggregator
+    struct shard_stats {
+        name           shard;
+        metrics_window metrics;
+        uint64_t       slots_capacity = 0;
+        uint64_t       slots_in_use   = 0;
+        uint32_t       pool_depth     = 0; // plays waiting for a draw
+        uint64_t       pool_served    = 0;
+        uint64_t       pool_draws     = 0;
+        bool           breaker_open   = false;
+        uint64_t       breaker_trips  = 0;
+    };
+
+    /**
+     * This shard's metrics window, slot, pool and breaker counters in one read
+     */
+    [[eosio::action, eosio::read_only]]
+    shard_stats getstats() {
+        shard_stats s;
+        s.shard = get_self();
+        s.metrics = metrics_table(get_self(), get_self().value).get_or_default();
+        auto slots = slot_state_table(get_self(), get_self().value).get_or_default();
+        s.slots_capacity = slots.capacity;
+        s.slots_in_use = slots.in_use;
+        auto draws = draw_state_table(get_self(), get_self().value).get_or_default();
+        s.pool_depth = draws.queued;
+        s.pool_served = draws.served;
+        s.pool_draws = draws.draws;
+        s.metrics.plays += slots.unreported_plays.value_or(0) + draws.unreported;
+        auto breaker = breaker_table(get_self(), get_self().value).get_or_default();
+        s.breaker_open = breaker.open;
+        s.breaker_trips = breaker.trips;
+        return s;
+    }
+
+private:
+
+    /**
+     * Load the configuration a play needs, failing if it is incomplete
+     */
+    game_config play_config() {
+        config_table config(get_self(), get_self().value);
+        auto cfg = config.get_or_default();
+        check(cfg.token_contract != name(), "token contract not set");
+        check(cfg.rng_contract != name(), "rng contract not set");
+        return cfg;
+    }
+
+    name shard_owner(const game_config& cfg, const name& player) {
+        if (!cfg.sharded()) return get_self();
+        const auto& shards = cfg.shards.value();
+        return shards[dbltz_shard::shard_of(player.value, uint32_t(shards.size()))];
+    }
+
+    /**
+     * Refuse a player another shard owns, naming that shard so the client can go there
+     */
+    void check_shard(const game_config& cfg, const name& player) {
+        if (!cfg.sharded()) return;
+        name owner = shard_owner(cfg, player);
+        if (owner != get_self()) check(false, "player belongs to shard " + owner.to_string());
+    }
+
+    /// Scope of a player's players row under a layout
+    uint64_t players_scope(uint8_t layout, const name& player) const {
+        return layout == PLAYERS_SHARED ? get_self().value : player.value;
+    }
+    
+    /**
+     * Find a player's stats row, restoring it from the archive or creating
+     * it on first play. A row from before the bylastplay index is rewritten
+     * so it gets an entry there; modifying it in place would not add one.
+     * While scopeplayers is migrating, a row still in the self scope is
+     * moved to the player's own
+     * @param players - Players table to search, in the layout's scope for the player
+     * @param player - Player account, pays for a new row
+     * @param layout - Current player_layouts value
+     */
+    players_table::const_iterator find_or_create_player(players_table& players, const name& player, uint8_t layout) {
+        auto player_itr = players.find(player.value);
+        if (player_itr != players.end() && player_itr->is_indexed()) return player_itr;
+        
+        player_stats row;
+        if (player_itr != players.end()) {
+            row = *player_itr;
+            players.erase(player_itr);
+        } else if (!take_unscoped_player(player, layout, row) && !restore_player(player, row)) {
+            row.player = player;
+            row.total_plays = 0;
+            row.total_wins = 0;
+            row.last_nonce = "";
+        }
+        return players.emplace(player, [&](auto& p) {
+            p = row;
+            p.upgrade();
+            p.indexed.value() = true;
+        });
+    }
+
+    /**
+     * Take a player's row out of the self scope while scopeplayers is migrating
+     * @param row - Filled with the row when found
+     * @return false when there is no such row to move
+     */
+    bool take_unscoped_player(const name& player, uint8_t layout, player_stats& row) {
+        if (layout != PLAYERS_MIGRATING) return false;
+        
+        players_table shared(get_self(), get_self().value);
+        auto itr = shared.find(player.value);
+        if (itr == shared.end()) return false;
+        row = *itr;
+        shared.erase(itr);
+        return true;
+    }
+    
+    static uint64_t archive_bucket_of(const name& player) {
+        return (player.value * 0x9e3779b97f4a7c15ULL) >> 54; // top 10 bits: ARCHIVE_BUCKETS
+    }
+
+    static archived_player archive_entry(const player_stats& p) {
+        return {p.player, p.total_plays, p.total_wins, p.last_compact_nonce(), p.last_play_at()};
+    }
+
+    /**
+     * Add evicted players to their archive buckets, writing each bucket once
+     * @param evicted - Players just erased from the players table
+     */
+    void archive_players(std::vector<archived_player>& evicted) {
+        if (evicted.empty()) return;
+        std::sort(evicted.begin(), evicted.end(), [](const auto& a, const auto& b) {
+            uint64_t ba = archive_bucket_of(a.player), bb = archive_bucket_of(b.player);
+            return ba != bb ? ba < bb : a.player < b.player;
+        });
+        
+        archive_table archive(get_self(), get_self().value);
+        for (auto first = evicted.begin(); first != evicted.end();) {
+            uint64_t bucket = archive_bucket_of(first->player);
+            auto last = std::find_if(first, evicted.end(), [&](const auto& e) { return archive_bucket_of(e.player) != bucket; });
+            
+            auto merge = [&](auto& b) {
+                std::vector<archived_player> merged;
+                merged.reserve(b.players.size() + (last - first));
+                std::merge(b.players.begin(), b.players.end(), first, last, std::back_inserter(merged),
+                           [](const auto& x, const auto& y) { return x.player < y.player; });
+                b.players = std::move(merged);
+            };
+            auto itr = archive.find(bucket);
+            if (itr == archive.end()) {
+                archive.emplace(get_self(), [&](auto& b) {
+                    b.id = bucket;
+                    merge(b);
+                });
+            } else {
+                archive.modify(itr, same_payer, merge);
+            }
+            first = last;
+        }
+    }
+
+    /**
+     * Take a returning player's totals out of the archive
+     * @param player - Player account
+     * @param row - Filled with the archived totals when found
+     * @return false when the player was never evicted
+     */
+    bool restore_player(const name& player, player_stats& row) {
+        archive_table archive(get_self(), get_self().value);
+        auto bucket = archive.find(archive_bucket_of(player));
+        if (bucket == archive.end()) return false;
+        
+        const auto& entries = bucket->players;
+        auto entry = std::lower_bound(entries.begin(), entries.end(), player, [](const auto& e, const name& p) { return e.player < p; });
+        if (entry == entries.end() || entry->player != player) return false;
+        
+        row.player = player;
+        row.total_plays = entry->total_plays;
+        row.total_wins = entry->total_wins;
+        row.last_nonce = "";
+        row.upgrade();
+        row.last_play.value() = entry->last_play;
+        row.last_cnonce.value() = entry->last_cnonce;
+        
+        if (entries.size() == 1) {
+            archive.erase(bucket);
+        } else {
+            size_t at = entry - entries.begin();
+            archive.modify(bucket, same_payer, [&](auto& b) {
+                b.players.erase(b.players.begin() + at);
+            });
+        }
+        
+        evict_state_table evict_state(get_self(), get_self().value);
+        auto state = evict_state.get_or_default();
+        state.restored++;
+        state.archived--;
+        evict_state.set(state, get_self());
+        return true;
+    }
+
+    /**
+     * Request randomness for a roll, or queue it for the next pool draw.
+     * Either way the roll settles in a later transaction, from a value
+     * requested after the play was committed
+     * @param player - Player account
+     * @param seed - Per-roll value mixed into the oracle signing value
+     * @param cfg - Current contract configuration
+     */
+    void start_roll(const name& player, uint64_t seed, const game_config& cfg) {
+        DBLTZ_PROFILE_SCOPE("start_roll");
+        DBLTZ_PROFILE_SECTION("pool");
+        draw_state_table draw_state(get_self(), get_self().value);
+        auto draws = draw_state.get_or_default();
+        if (draws.batch_size > 0) {
+            pool_plays_table pool_plays(get_self(), get_self().value);
+            pool_plays.emplace(player, [&](auto& p) {
+                p.id = draws.next_id++;
+                p.player = player;
+                p.queued = current_time_point();
+            });
+            draws.queued++;
+            draws.unreported++;
+            
+            // A draw already in flight was requested before this play, so it waits for the next one
+            if (draws.request_id == 0) {
+                check(!breaker_open(), "oracle backlog is full, try again later");
+                check(request_draw(draws, cfg), "rng request queue is full, try again later");
+            }
+            draw_state.set(draws, get_self());
+            return;
+        }
+        
+        // Generate unique signing value for RNG
+        DBLTZ_PROFILE_SECTION("rng.request");
+        uint64_t signing_value = signing_value_for(current_time_point(), player, seed);
+        
+        // Shed load while the oracle backlog is too deep
+        check(!breaker_open(), "oracle backlog is full, try again later");
+        check(request_random(player, signing_value, cfg) != 0, "rng request queue is full, try again later");
+    }
+
+    // Request ids handed to the oracle pack the slot generation above the slot index
+    static uint64_t request_id_for(uint64_t slot, uint32_t generation) { return (uint64_t(generation) << 32) | slot; }
+    static uint64_t slot_of(uint64_t request_id) { return request_id & 0xFFFFFFFF; }
+    static uint32_t generation_of(uint64_t request_id) { return request_id >> 32; }
+
+    /**
+     * Claim a free slot for a pending request and ask the oracle for randomness
+     * @param player - Player the roll belongs to (self for pool draws)
+     * @param signing_value - Unique signing value for the oracle
+     * @param cfg - Current contract configuration
+     * @return the request id, or 0 when every slot is in use
+     */
+    uint64_t request_random(const name& player, uint64_t signing_value, const game_config& cfg) {
+        slot_state_table slot_state(get_self(), get_self().value);
+        auto slots = slot_state.get_or_default();
+        if (slots.free_head == NO_SLOT) return 0;
+        
+        pending_table pending(get_self(), get_self().value);
+        auto slot = pending.find(slots.free_head);
+        slots.free_head = slot->next_free;
+        slots.in_use++;
+        slots.count_request(player != get_self());
+        update_breaker(slots.in_use);
+        
+        auto now = current_time_point();
+        pending.modify(slot, same_payer, [&](auto& p) {
+            p.upgrade();
+            p.generation++;
+            p.in_use = true;
+            p.next_free = NO_SLOT;
+            p.player = player;
+            p.signing_value = signing_value;
+            p.timestamp = now;
+            p.provider.value() = 0;
+            p.sent_at.value() = now;
+        });
+        slot_state.set(slots, get_self());
+        
+        // Request RNG from the primary oracle
+        uint64_t request_id = request_id_for(slot->id, slot->generation);
+        send_rng_request(cfg.rng_contract, request_id, signing_value);
+        return request_id;
+    }
+
+    void send_rng_request(const name& oracle, uint64_t request_id, uint64_t signing_value) {
+        string_game::rng_policy::request(get_self(), oracle, request_id, signing_value);
+    }
+
+    /**
+     * Identify the provider authorizing a callback. Without a provider list
+     * only the configured rng contract is accepted, as provider 0
+     * @param cfg - Current contract configuration
+     */
+    uint64_t authorize_provider(const game_config& cfg) {
+        rng_providers_table providers(get_self(), get_self().value);
+        if (providers.begin() == providers.end()) {
+            require_auth(cfg.rng_contract);
+            return 0;
+        }
+        
+        for (const auto& p : providers) {
+            if (has_auth(p.oracle)) return p.id;
+        }
+        check(false, "missing authority of an rng provider");
+        return 0;
+    }
+
+    static uint32_t latency_bucket(microseconds latency) {
+        uint64_t ms = latency.count() > 0 ? latency.count() / 1000 : 0;
+        uint32_t bucket = 0;
+        while (ms >= 2 && bucket < LATENCY_BUCKETS - 1) {
+            ms >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    /**
+     * Apply an update to the current metrics window, opening one if needed
+     * @param update - Callable receiving the window to modify
+     */
+    template<typename F>
+    void update_metrics(F&& update) {
+        metrics_table metrics(get_self(), get_self().value);
+        auto m = metrics.get_or_default();
+        if (m.latency_ms.size() != LATENCY_BUCKETS) {
+            m.started = current_time_point();
+            m.latency_ms.resize(LATENCY_BUCKETS);
+        }
+        update(m);
+        metrics.set(m, get_self());
+    }
+
+    void record_request(uint64_t provider, uint64_t count = 1) {
+        if (count == 0) return;
+        rng_providers_table providers(get_self(), get_self().value);
+        auto itr = providers.find(provider);
+        if (itr == providers.end()) return;
+        
+        providers.modify(itr, same_payer, [&](auto& p) {
+            p.requests += count;
+        });
+    }
+
+    /**
+     * Fold the play and request counts held in slotstate and drawstate into
+     * the metrics window and the primary's provider row
+     */
+    void flush_unreported() {
+        slot_state_table slot_state(get_self(), get_self().value);
+        auto slots = slot_state.get_or_default();
+        auto unreported = slots.take_unreported();
+        if (unreported.requests > 0) slot_state.set(slots, get_self());
+        
+        draw_state_table draw_state(get_self(), get_self().value);
+        auto draws = draw_state.get_or_default();
+        if (draws.unreported > 0) {
+            unreported.plays += draws.unreported;
+            draws.unreported = 0;
+            draw_state.set(draws, get_self());
+        }
+        
+        if (unreported.plays > 0) {
+            update_metrics([&](auto& m) {
+                m.plays += unreported.plays;
+            });
+        }
+        record_request(0, unreported.requests);
+    }
+
+    /**
+     * Update a provider's callback counters
+     * @param provider - Provider that sent the callback
+     * @param won - Whether the callback settled its request
+     * @param latency - Time since the provider was asked, negative when unknown
+     */
+    void record_callback(uint64_t provider, bool won, microseconds latency) {
+        rng_providers_table providers(get_self(), get_self().value);
+        auto itr = providers.find(provider);
+        if (itr == providers.end()) return;
+        
+        providers.modify(itr, same_payer, [&](auto& p) {
+            if (!won) {
+                p.late++;
+                return;
+            }
+            p.wins++;
+            if (latency.count() >= 0) {
+                p.latency_us += latency.count();
+                p.timed_wins++;
+            }
+        });
+    }
+
+    /**
+     * Return a resolved slot to the free list
+     * @param pending - Slot table the iterator belongs to
+     * @param slot - Slot to release
+     * @return the play and request counts taken from slotstate, for the caller to report
+     */
+    unreported_counts release_slot(pending_table& pending, pending_table::const_iterator slot) {
+        slot_state_table slot_state(get_self(), get_self().value);
+        auto slots = slot_state.get();
+        
+        pending.modify(slot, same_payer, [&](auto& p) {
+            p.upgrade();
+            p.in_use = false;
+            p.next_free = slots.free_head;
+        });
+        slots.free_head = slot->id;
+        slots.in_use--;
+        auto unreported = slots.take_unreported();
+        slot_state.set(slots, get_self());
+        update_breaker(slots.in_use);
+        return unreported;
+    }
+
+    bool breaker_open() {
+        breaker_table breaker(get_self(), get_self().value);
+        return breaker.get_or_default().open;
+    }
+
+    /**
+     * Trip the breaker when the backlog reaches the threshold, and re-admit plays
+     * (half-open) once it drains to the resume level
+     * @param outstanding - Current number of outstanding oracle requests
+     */
+    void update_breaker(uint64_t outstanding) {
+        breaker_table breaker(get_self(), get_self().value);
+        auto state = breaker.get_or_default();
+        if (state.max_outstanding == 0) return;
+        
+        if (!state.open && outstanding >= state.max_outstanding) {
+            state.open = true;
+            state.trips++;
+        } else if (state.open && outstanding <= state.resume_below) {
+            state.open = false;
+        } else {
+            return;
+        }
+        breaker.set(state, get_self());
+    }
+
+    /**
+     * Request a draw for every play queued so far
+     * @param draws - Draw state, updated in place; the caller persists it
+     * @param cfg - Current contract configuration
+     * @return false when every slot is in use
+     */
+    bool request_draw(draw_state& draws, const game_config& cfg) {
+        uint64_t signing_value = signing_value_for(current_time_point(), get_self(), draws.draws);
+        uint64_t request_id = request_random(get_self(), signing_value, cfg);
+        if (request_id == 0) return false;
+        
+        draws.request_id = request_id;
+        draws.drawn_below = draws.next_id;
+        draws.draws++;
+        return true;
+    }
+
+    /**
+     * Settle a request sent before the slot table from its row in the old
+     * pending table; a callback with no row there is a late duplicate
+     * @param provider - Provider that sent the callback
+     * @param request_id - The old table's request id
+     * @param random_value - The oracle's value
+     * @param cfg - Current contract configuration
+     */
+    void settle_legacy(uint64_t provider, uint64_t request_id, const checksum256& random_value, const game_config& cfg) {
+        legacy_pending_table legacy(get_self(), get_self().value);
+        auto itr = legacy.find(request_id);
+        record_callback(provider, itr != legacy.end(), microseconds(-1));
+        if (itr == legacy.end()) return;
+        
+        name player = itr->player;
+        legacy.erase(itr);
+        update_metrics([&](auto& m) {
+            m.callbacks++;
+        });
+        settle_or_park(player, request_id, random_value, cfg);
+    }
+
+    /**
+     * Settle the plays queued before a draw was requested, oldest first and
+     * each from its own value, then request the next draw for any left
+     * @param request_id - The draw's request id; a stale one settles nothing
+     * @param random_value - The oracle's value
+     * @param cfg - Current contract configuration
+     * @return pooled plays queued since the last draw was settled, for metrics
+     */
+    uint64_t settle_draw(uint64_t request_id, const checksum256& random_value, const game_config& cfg) {
+        draw_state_table draw_state(get_self(), get_self().value);
+        auto draws = draw_state.get_or_default();
+        if (request_id != draws.request_id) return 0; // a draw clearexpired gave up on
+        draws.request_id = 0;
+        uint64_t unreported = draws.unreported;
+        draws.unreported = 0;
+        
+        uint32_t limit = draws.batch_size > 0 ? draws.batch_size : MAX_DRAW_BATCH;
+        pool_plays_table pool_plays(get_self(), get_self().value);
+        auto itr = pool_plays.begin();
+        for (uint32_t k = 0; itr != pool_plays.end() && itr->id < draws.drawn_below && k < limit; k++) {
+            name player = itr->player;
+            itr = pool_plays.erase(itr);
+            draws.queued--;
+            draws.served++;
+            settle_or_park(player, request_id, draw_value(random_value, k), cfg);
+        }
+        
+        if (draws.queued > 0 && !breaker_open()) request_draw(draws, cfg);
+        draw_state.set(draws, get_self());
+        return unreported;
+    }
+
+    /**
+     * Settle a play, or park it in the dead-letter table for replaydead
+     * @param player - Player account
+     * @param request_id - Request the random value answered
+     * @param random_value - Entropy for this roll
+     * @param cfg - Current contract configuration
+     */
+    void settle_or_park(const name& player, uint64_t request_id, const checksum256& random_value, const game_config& cfg) {
+        uint8_t status = settle_play(player, random_value, cfg);
+        if (status == dbltz_core::SETTLED) return;
+        
+        DBLTZ_PROFILE_SCOPE("deadletter");
+        dead_letters_table dead_letters(get_self(), get_self().value);
+        uint64_t id = dead_letters.available_primary_key();
+        dead_letters.emplace(get_self(), [&](auto& d) {
+            d.id = id;
+            d.player = player;
+            d.request_id = request_id;
+            d.random_value = random_value;
+            d.reason = status;
+            d.attempts = 0;
+            d.created = current_time_point();
+        });
+        
+        update_metrics([&](auto& m) {
+            m.rejected++;
+        });
+    }
+
+    /// Terms of issuing `amount` of DBP rewards
+    static dbltz_core::reward_terms reward_terms(const game_config& cfg, int64_t amount) {
+        return {cfg.token_contract, {cfg.token_contract, "active"_n}, asset(amount, DBP_SYMBOL), "BLTZ win reward"};
+    }
+
+    /**
+     * Resolve a play from a random value: update stats, credit a win and log.
+     * Everything is validated before any state changes, so a failed
+     * settlement leaves no trace and can be replayed later
+     * @param player - Player account
+     * @param random_value - Entropy for this roll, never reused
+     * @param cfg - Current contract configuration
+     * @return SETTLED, or the reason the play could not be settled
+     */
+    uint8_t settle_play(const name& player, const checksum256& random_value, const game_config& cfg) {
+        auto settled = string_game(get_self(), *this, cfg.players_layout()).settle(player, random_value, [&] {
+            return reward_terms(cfg, REWARD_AMOUNT);
+        });
+        if (settled.status != dbltz_core::SETTLED) return settled.status;
+        
+        // Log result
+        DBLTZ_PROFILE_SCOPE("logresult.send");
+        action(
+            permission_level{get_self(), "active"_n},
+            get_self(),
+            "logresult"_n,
+            std::make_tuple(player, settled.won, settled.roll)
+        ).send();
+        return dbltz_core::SETTLED;
+    }
+};
+
+extern "C" {
+    /**
+     * Contract entry point. playc is decoded by hand from its fixed layout,
+     * skipping the datastream and std::string work of the generic path;
+     * every other action goes through the regular dispatcher.
+     */
+    [[eosio::wasm_entry]]
+    void apply(uint64_t receiver, uint64_t code, uint64_t action) {
+        if (code != receiver) return;
+        
+        if (action == "playc"_n.value) {
+            // The flags byte is optional; a 16-byte payload means a single BLTZ roll
+            char buffer[gameplay::PLAYC_SIZE] = {};
+            uint32_t size = action_data_size();
+            check(size == gameplay::PLAYC_SIZE || size == gameplay::PLAYC_SIZE - 1, "malformed playc action");
+            read_action_data(buffer, size);
+            
+            uint64_t player;
+            uint64_t nonce;
+            memcpy(&player, buffer, sizeof(player));
+            memcpy(&nonce, buffer + sizeof(player), sizeof(nonce));
+            uint8_t flags = static_cast<uint8_t>(buffer[2 * sizeof(uint64_t)]);
+            
+            gameplay(name(receiver), name(code), datastream<const char*>(nullptr, 0)).playc(name(player), nonce, flags);
+            return;
+        }
+        
+        switch (action) {
+            EOSIO_DISPATCH_HELPER(gameplay, (play)(receiverand)(settoken)(setrng)(logresult)(clearexpired)(evictidle)
+                                            (setbreaker)(initslots)(setpool)(replaydead)
+                                            (setproviders)(hedge)(resetmetrics)(setshards)(route)(getstats)
+                                            (evictscoped)(scopeplayers)(claim))
+        }
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Player-to-shard assignment when gameplay is deployed as several shard
+ * accounts, shared by the contract and by clients that route plays
+ * themselves (tests/native/client/shards.hpp):
+ *
+ *     shards[dbltz_shard::shard_of(player.value, shards.size())]
+ *
+ * A jump consistent hash of the mixed name value: adding a shard moves
+ * about 1/N of the players, all of them to the new shard, and leaves
+ * everyone else where they are. The floating-point steps are exact IEEE
+ * operations, so wasm and native agree.
+ */
+namespace dbltz_shard {
+
+    inline uint32_t shard_of(uint64_t player, uint32_t shard_count) {
+        // Names share their low bits and common prefixes; mix before hashing
+        uint64_t key = player + 0x9e3779b97f4a7c15ULL;
+        key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+
+        int64_t b = -1, j = 0;
+        while (j < int64_t(shard_count)) {
+            b = j;
+            key = key * 2862933555777941757ULL + 1;
+            j = int64_t(double(b + 1) * (double(int64_t(1) << 31) / double((key >> 33) + 1)));
+        }
+        return uint32_t(b < 0 ? 0 : b);
+    }
+
+} // namespace dbltz_shard
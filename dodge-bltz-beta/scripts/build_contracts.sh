@@ -32,6 +32,8 @@ fi
 SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
 PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
 CONTRACTS_DIR="$PROJECT_ROOT/contracts"
+# The gameplay core shared with dodge-bltz
+CORE_DIR="$(dirname "$PROJECT_ROOT")/shared/core"
 
 echo "Project root: $PROJECT_ROOT"
 echo "Contracts directory: $CONTRACTS_DIR"
@@ -58,7 +60,7 @@ echo -e "\n${YELLOW}Building Gameplay Contract...${NC}"
 cd "$CONTRACTS_DIR/gameplay"
 
 if [ -f "gameplay.cpp" ]; then
-    eosio-cpp -abigen -I include -o gameplay.wasm gameplay.cpp
+    eosio-cpp -abigen -I include -I "$CORE_DIR" -o gameplay.wasm gameplay.cpp
     if [ $? -eq 0 ]; then
         echo -e "${GREEN}✓ Gameplay contract built successfully${NC}"
     else
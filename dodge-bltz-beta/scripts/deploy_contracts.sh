@@ -152,6 +152,11 @@ cleos -u $WAX_TESTNET_URL push action $GAMEPLAY_ACCOUNT setrng \
     "[\"orng.wax\"]" \
     -p $GAMEPLAY_ACCOUNT@active
 
+# Preallocate pending RNG request slots
+cleos -u $WAX_TESTNET_URL push action $GAMEPLAY_ACCOUNT initslots \
+    "[256]" \
+    -p $GAMEPLAY_ACCOUNT@active
+
 echo -e "\n${GREEN}Deployment complete!${NC}"
 echo -e "${BLUE}Next steps:${NC}"
 echo "1. Test the contracts with test transactions"
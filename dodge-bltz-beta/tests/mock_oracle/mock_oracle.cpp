@@ -0,0 +1,76 @@
+#include <eosio/eosio.hpp>
+#include <eosio/crypto.hpp>
+
+using namespace eosio;
+
+/**
+ * Stand-in for the WAX RNG oracle used by the gameplay tests.
+ * Requests are queued until a test fulfills them, so tests decide which
+ * callbacks arrive, in what order, and which are dropped.
+ */
+class [[eosio::contract("mock_oracle")]] mock_oracle : public contract {
+public:
+    using contract::contract;
+
+    /**
+     * Queue a randomness request, same signature as orng.wax
+     * @param assoc_id - Caller's request id, echoed back in the callback
+     * @param signing_value - Caller's signing value
+     * @param caller - Contract that receives the callback
+     */
+    [[eosio::action]]
+    void requestrand(uint64_t assoc_id, uint64_t signing_value, const name& caller) {
+        require_auth(caller);
+        
+        requests_table requests(get_self(), get_self().value);
+        uint64_t id = requests.available_primary_key();
+        requests.emplace(get_self(), [&](auto& r) {
+            r.id = id;
+            r.assoc_id = assoc_id;
+            r.signing_value = signing_value;
+            r.caller = caller;
+        });
+    }
+
+    /**
+     * Deliver the callback for a queued request
+     * @param id - Queued request id
+     * @param random_value - Random value to hand to the caller
+     */
+    [[eosio::action]]
+    void fulfill(uint64_t id, const checksum256& random_value) {
+        requests_table requests(get_self(), get_self().value);
+        const auto& r = requests.get(id, "request not found");
+        
+        action(
+            permission_level{get_self(), "active"_n},
+            r.caller,
+            "receiverand"_n,
+            std::make_tuple(r.assoc_id, random_value)
+        ).send();
+        
+        requests.erase(r);
+    }
+
+    /**
+     * Drop a queued request without a callback
+     * @param id - Queued request id
+     */
+    [[eosio::action]]
+    void drop(uint64_t id) {
+        requests_table requests(get_self(), get_self().value);
+        requests.erase(requests.get(id, "request not found"));
+    }
+
+private:
+    struct [[eosio::table]] rng_request {
+        uint64_t id;
+        uint64_t assoc_id;
+        uint64_t signing_value;
+        name     caller;
+        
+        uint64_t primary_key() const { return id; }
+    };
+
+    typedef eosio::multi_index<"requests"_n, rng_request> requests_table;
+};
@@ -0,0 +1,260 @@
+#include "audit.hpp"
+#include "sha256x4.hpp"
+
+#include <records.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <span>
+#include <thread>
+
+namespace audit {
+
+    namespace {
+
+        constexpr uint32_t win_chance = 35;
+
+        /// One chunk's counts; merged in chunk order
+        struct partial {
+            report   r;
+            bool     any = false;
+            bool     first_won = false;
+            bool     last_won = false;
+            std::exception_ptr error;
+
+            void outcome(uint32_t roll, bool won) {
+                r.outcomes++;
+                r.rolls[roll]++;
+                r.wins += won;
+                if (!any || won != last_won) r.runs++;
+                if (!any) first_won = won;
+                any = true;
+                last_won = won;
+            }
+
+            void find(size_t max, const finding& f) {
+                r.mismatches++;
+                if (r.findings.size() < max) r.findings.push_back(f);
+            }
+        };
+
+        /// Blocks [from, to) of one chunk
+        struct block_range {
+            uint32_t from;
+            uint32_t to;
+        };
+
+        template <typename Record>
+        std::span<const Record> in_blocks(std::span<const Record> records, block_range range) {
+            auto lo = std::partition_point(records.begin(), records.end(), [&](const Record& r) { return r.block_num < range.from; });
+            auto hi = std::partition_point(lo, records.end(), [&](const Record& r) { return r.block_num < range.to; });
+            return {lo, hi};
+        }
+
+        /// The roll of the k-th play a beta callback settles, from gameplay::draw_value
+        uint32_t beta_roll(const ingest::callback_record& c, uint32_t k) {
+            const uint8_t* value = c.random_value;
+            std::array<uint8_t, 32> derived;
+            if (k > 0) {
+                char data[36];
+                std::memcpy(data, c.random_value, 32);
+                std::memcpy(data + 32, &k, sizeof(k));
+                derived = eosio::sha256(data, sizeof(data)).extract_as_byte_array();
+                value = derived.data();
+            }
+            uint32_t random_num = (uint32_t(value[0]) << 24) | (uint32_t(value[1]) << 16) |
+                                  (uint32_t(value[2]) << 8) | uint32_t(value[3]);
+            return random_num % 100;
+        }
+
+        struct sources {
+            std::span<const ingest::callback_record> callbacks;
+            std::span<const ingest::result_record>   results;
+            std::span<const ingest::issue_record>    issues;
+        };
+
+        /**
+         * A beta logresult is sent inline by the receiverand before it. A
+         * pool draw settles several plays, the k-th from gameplay::draw_value
+         * of the draw and k. A play the draw parks in the dead-letter table
+         * shifts the positions after it and shows up as a roll finding.
+         * Wins are credited and paid when the player claims them, so no
+         * issue follows a result.
+         */
+        void audit_beta(const sources& in, const options& opts, partial& p) {
+            const ingest::callback_record* callback = nullptr;
+            uint32_t answered = 0; // results the current callback has settled
+            size_t c = 0;
+
+            for (const auto& result : in.results) {
+                while (c < in.callbacks.size() && in.callbacks[c].global_sequence < result.global_sequence) {
+                    if (callback && !answered) p.r.unanswered++;
+                    callback = &in.callbacks[c++];
+                    answered = 0;
+                }
+
+                if (callback && callback->block_num == result.block_num) {
+                    p.r.pool_settled += answered > 0;
+                    p.r.verified++;
+                    uint32_t roll = beta_roll(*callback, answered++);
+                    if (result.roll != roll) {
+                        p.find(opts.max_findings, {result.global_sequence, result.block_num, finding_kind::roll, roll, result.roll});
+                    }
+                } else {
+                    p.find(opts.max_findings, {result.global_sequence, result.block_num, finding_kind::orphan, 0, 0});
+                }
+
+                bool won = result.roll < win_chance;
+                if ((result.won != 0) != won) {
+                    p.find(opts.max_findings, {result.global_sequence, result.block_num, finding_kind::outcome, won, result.won});
+                }
+
+                p.outcome(std::min<uint32_t>(result.roll, 99), result.won != 0);
+            }
+            p.r.unanswered += (callback && !answered) + (in.callbacks.size() - c);
+        }
+
+        /**
+         * dodge-bltz settles in receiverand itself: the roll is the u64
+         * random_value % 100 and a win's issue is the very next action.
+         */
+        void audit_dodge(const sources& in, const options& opts, partial& p) {
+            static const uint8_t zero_hash[32] = {};
+            size_t is = 0;
+
+            for (size_t base = 0; base < in.callbacks.size(); base += 4) {
+                size_t   lanes = std::min<size_t>(4, in.callbacks.size() - base);
+                uint64_t values[4] = {};
+                uint8_t  hashes[4][32];
+                for (size_t l = 0; l < lanes; l++) values[l] = in.callbacks[base + l].request_id;
+                signing_value_hash_x4(values, hashes);
+
+                for (size_t l = 0; l < lanes; l++) {
+                    const auto& callback = in.callbacks[base + l];
+                    if (std::memcmp(callback.random_value, zero_hash, 32) == 0) {
+                        p.r.hashes_missing++;
+                    } else {
+                        p.r.hashes_checked++;
+                        if (std::memcmp(callback.random_value, hashes[l], 32) != 0) {
+                            p.find(opts.max_findings, {callback.global_sequence, callback.block_num, finding_kind::hash, 1, 0});
+                        }
+                    }
+
+                    uint32_t roll = uint32_t(callback.random_word % 100);
+                    bool     won = roll < win_chance;
+                    while (is < in.issues.size() && in.issues[is].global_sequence <= callback.global_sequence) is++;
+                    bool paid = is < in.issues.size() && in.issues[is].global_sequence == callback.global_sequence + 1;
+                    if (paid != won) {
+                        p.find(opts.max_findings, {callback.global_sequence, callback.block_num, finding_kind::reward, won, paid});
+                    }
+                    p.r.verified++;
+                    p.outcome(roll, won);
+                }
+            }
+        }
+
+        /// Chunks of about chunk_outcomes outcomes each, split only between blocks
+        template <typename Record>
+        std::vector<block_range> chunk_blocks(std::span<const Record> outcomes, size_t chunk_outcomes) {
+            std::vector<block_range> ranges;
+            uint32_t from = 0;
+            for (size_t i = chunk_outcomes; i < outcomes.size(); i += chunk_outcomes) {
+                uint32_t to = outcomes[i].block_num;
+                if (to <= from) continue;
+                ranges.push_back({from, to});
+                from = to;
+            }
+            ranges.push_back({from, UINT32_MAX});
+            return ranges;
+        }
+
+    } // namespace
+
+    const char* to_string(finding_kind kind) {
+        switch (kind) {
+            case finding_kind::roll: return "roll";
+            case finding_kind::outcome: return "outcome";
+            case finding_kind::reward: return "reward";
+            case finding_kind::hash: return "hash";
+            case finding_kind::orphan: return "orphan";
+        }
+        return "?";
+    }
+
+    bool report::passed(double alpha) const {
+        return mismatches == 0 && win_rate.p_value >= alpha && chi_square.p_value >= alpha && runs_test.p_value >= alpha;
+    }
+
+    report run(const std::string& records_dir, const options& opts) {
+        auto start = std::chrono::steady_clock::now();
+        bool beta = opts.variant == ingest::layout::beta;
+
+        ingest::mapped_records<ingest::callback_record> callbacks(records_dir + "/callbacks.bin", ingest::record_kind::callback);
+        ingest::mapped_records<ingest::result_record>   results(records_dir + "/results.bin", ingest::record_kind::result);
+        ingest::mapped_records<ingest::issue_record>    issues(records_dir + "/issues.bin", ingest::record_kind::issue);
+        sources all{callbacks.all(), results.all(), issues.all()};
+
+        size_t chunk = std::max<size_t>(opts.chunk_outcomes, 1);
+        auto ranges = beta ? chunk_blocks(all.results, chunk) : chunk_blocks(all.callbacks, chunk);
+        std::vector<partial> partials(ranges.size());
+
+        unsigned threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<unsigned>(threads, unsigned(ranges.size()));
+        std::atomic<size_t> next{0};
+        auto worker = [&] {
+            for (size_t i; (i = next++) < ranges.size();) {
+                sources in{in_blocks(all.callbacks, ranges[i]), in_blocks(all.results, ranges[i]),
+                           in_blocks(all.issues, ranges[i])};
+                try {
+                    if (beta) {
+                        audit_beta(in, opts, partials[i]);
+                    } else {
+                        audit_dodge(in, opts, partials[i]);
+                    }
+                } catch (...) {
+                    partials[i].error = std::current_exception();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker);
+        for (auto& t : pool) t.join();
+
+        report r;
+        r.callbacks = all.callbacks.size();
+        const partial* previous = nullptr;
+        for (const auto& p : partials) {
+            if (p.error) std::rethrow_exception(p.error);
+            r.outcomes += p.r.outcomes;
+            r.verified += p.r.verified;
+            r.pool_settled += p.r.pool_settled;
+            r.unanswered += p.r.unanswered;
+            r.hashes_checked += p.r.hashes_checked;
+            r.hashes_missing += p.r.hashes_missing;
+            r.mismatches += p.r.mismatches;
+            r.wins += p.r.wins;
+            for (size_t i = 0; i < r.rolls.size(); i++) r.rolls[i] += p.r.rolls[i];
+            for (const auto& f : p.r.findings) {
+                if (r.findings.size() < opts.max_findings) r.findings.push_back(f);
+            }
+
+            // A run carries on across the chunk boundary when the outcome either side agrees
+            if (!p.any) continue;
+            r.runs += p.r.runs - (previous && previous->last_won == p.first_won ? 1 : 0);
+            previous = &p;
+        }
+
+        auto probabilities = roll_probabilities(beta ? 32 : 64);
+        double win_probability = 0;
+        for (uint32_t i = 0; i < win_chance; i++) win_probability += probabilities[i];
+        r.win_rate = win_rate_test(r.wins, r.outcomes, win_probability);
+        r.chi_square = chi_square_test(r.rolls, probabilities);
+        r.runs_test = runs_test(r.runs, r.wins, r.outcomes - r.wins);
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return r;
+    }
+
+} // namespace audit
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "stats.hpp"
+
+#include <decoder.hpp>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Provable-fairness audit of an ingest record directory. Every outcome is
+ * recomputed from the oracle's random value with the contract's own
+ * extraction, and each roll is checked against what the contract logged
+ * and paid:
+ *
+ * - beta: each logresult is paired with the receiverand that settled it.
+ *   The roll is the random value's first four bytes, big endian, % 100;
+ *   the k-th play of a pool draw rolls sha256 of the value and k instead.
+ *   Wins are credited for the player to claim, so no issue is checked.
+ * - dodge-bltz: each receiverand is an outcome, the roll is its u64
+ *   random_value % 100, and a win is the issue sent inline right after it.
+ *   The callback's caller_signing_value_hash must be the sha256 of the
+ *   packed signing value.
+ *
+ * The rolls then go through the distribution tests in stats.hpp. Record
+ * files are mapped and walked in block-aligned chunks on a thread pool, so
+ * memory stays bounded whatever their size.
+ */
+namespace audit {
+
+    enum class finding_kind : uint8_t {
+        roll,    // the logged roll is not the one the random value gives
+        outcome, // the logged win flag does not follow from the roll
+        reward,  // a dodge-bltz win without its issue, or an issue for a loss
+        hash,    // the callback's signing value hash is wrong
+        orphan,  // a result with no callback to settle it
+    };
+
+    const char* to_string(finding_kind kind);
+
+    struct finding {
+        uint64_t     global_sequence; // of the result, or of the dodge-bltz callback
+        uint32_t     block_num;
+        finding_kind kind;
+        uint32_t     expected;        // roll or flag recomputed from the chain
+        uint32_t     recorded;        // what the contract logged or did
+    };
+
+    struct options {
+        ingest::layout variant = ingest::layout::beta;
+        unsigned       threads = 0;       // 0: one per core
+        size_t         max_findings = 100;
+        double         alpha = 0.001;     // significance level of the distribution tests
+        size_t         chunk_outcomes = size_t(1) << 20; // per unit of work, rounded to whole blocks
+    };
+
+    struct report {
+        uint64_t callbacks = 0;
+        uint64_t outcomes = 0;       // rolls tested: beta logresults, dodge-bltz callbacks
+        uint64_t verified = 0;       // outcomes recomputed from their callback's random value
+        uint64_t pool_settled = 0;   // beta results settled by a pool draw after its first
+        uint64_t unanswered = 0;     // beta callbacks settling no result: late duplicates, parked plays
+        uint64_t hashes_checked = 0;
+        uint64_t hashes_missing = 0; // all-zero hashes, from records ingested before hashes were kept
+        uint64_t mismatches = 0;
+        std::vector<finding> findings; // the first max_findings, in chain order
+
+        uint64_t                  wins = 0;
+        uint64_t                  runs = 0; // of wins and losses, in chain order
+        std::array<uint64_t, 100> rolls{};
+
+        test_result win_rate;
+        test_result chi_square;
+        test_result runs_test;
+        double      seconds = 0;
+
+        /// No mismatches, and no distribution test rejects fairness at `alpha`
+        bool passed(double alpha) const;
+    };
+
+    /// @throws std::runtime_error if a record file is missing or not a record file
+    report run(const std::string& records_dir, const options& opts);
+
+} // namespace audit
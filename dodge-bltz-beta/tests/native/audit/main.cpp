@@ -0,0 +1,87 @@
+#include "audit.hpp"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    const char* const usage =
+        "usage: audit [options] RECORDS_DIR   check every outcome in an ingest record directory\n"
+        "options: --layout beta|dodge --threads N --alpha P --findings N\n";
+
+    struct arguments {
+        audit::options opts;
+        std::string    dir;
+    };
+
+    arguments parse(int argc, char** argv) {
+        arguments args;
+        for (int i = 0; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                if (!args.dir.empty()) throw std::invalid_argument("one records directory only");
+                args.dir = arg;
+                continue;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            std::string value = argv[++i];
+            if (arg == "--layout") {
+                if (value != "beta" && value != "dodge") throw std::invalid_argument("unknown layout " + value);
+                args.opts.variant = value == "beta" ? ingest::layout::beta : ingest::layout::dodge;
+            } else if (arg == "--threads") args.opts.threads = unsigned(std::stoul(value));
+            else if (arg == "--alpha") args.opts.alpha = std::stod(value);
+            else if (arg == "--findings") args.opts.max_findings = std::stoul(value);
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+        if (args.dir.empty()) throw std::invalid_argument("need a records directory");
+        return args;
+    }
+
+    void print_test(const char* name, const char* statistic, const audit::test_result& t, double alpha) {
+        std::printf("%-14s%s = %9.3f   p = %.4f%s\n", name, statistic, t.statistic, t.p_value, t.p_value < alpha ? "   REJECTED" : "");
+    }
+
+    int run(const arguments& args) {
+        auto r = audit::run(args.dir, args.opts);
+        bool beta = args.opts.variant == ingest::layout::beta;
+
+        std::printf("outcomes      %llu, %llu verified against their callback", (unsigned long long)r.outcomes,
+                    (unsigned long long)r.verified);
+        if (beta) std::printf(", %llu settled by a pool draw", (unsigned long long)r.pool_settled);
+        std::printf("\ncallbacks     %llu", (unsigned long long)r.callbacks);
+        if (beta) std::printf(", %llu settling no result", (unsigned long long)r.unanswered);
+        std::printf("\n");
+        if (!beta) {
+            std::printf("hashes        %llu checked, %llu not recorded\n", (unsigned long long)r.hashes_checked,
+                        (unsigned long long)r.hashes_missing);
+        }
+        std::printf("win rate      %.4f%% (%llu wins)\n", r.outcomes ? 100.0 * double(r.wins) / double(r.outcomes) : 0.0,
+                    (unsigned long long)r.wins);
+        print_test("win rate", "z  ", r.win_rate, args.opts.alpha);
+        print_test("rolls", "chi2", r.chi_square, args.opts.alpha);
+        print_test("runs", "z  ", r.runs_test, args.opts.alpha);
+        std::printf("mismatches    %llu\n", (unsigned long long)r.mismatches);
+        for (const auto& f : r.findings) {
+            std::printf("  %-8s seq %llu block %u: expected %u, recorded %u\n", audit::to_string(f.kind),
+                        (unsigned long long)f.global_sequence, f.block_num, f.expected, f.recorded);
+        }
+        std::printf("time          %.2f s, %.2fM outcomes/s\n", r.seconds, r.seconds > 0 ? double(r.outcomes) / r.seconds / 1e6 : 0.0);
+
+        bool passed = r.passed(args.opts.alpha);
+        std::printf("%s\n", passed ? "PASS" : "FAIL");
+        return passed ? 0 : 1;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        if (argc > 1) return run(parse(argc - 1, argv + 1));
+        std::cerr << usage;
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "audit: " << e.what() << "\n";
+        return 2;
+    }
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <eosio/crypto.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * SHA-256 of packed 64-bit signing values, four at a time. An eight-byte
+ * message is one padded block, so the four lanes run the same 64 rounds in
+ * step, one value per 32-bit lane of an SSE2 register. Other targets hash
+ * each value in turn.
+ */
+namespace audit {
+
+    /// The oracle's hash of a signing value: sha256 of its eight packed bytes
+    inline void signing_value_hash(uint64_t value, uint8_t out[32]) {
+        auto hash = eosio::sha256(reinterpret_cast<const char*>(&value), sizeof(value)).extract_as_byte_array();
+        std::memcpy(out, hash.data(), 32);
+    }
+
+#if defined(__SSE2__)
+    namespace detail {
+
+        inline __m128i rotr(__m128i x, int n) { return _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - n)); }
+
+        inline __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+
+        inline uint32_t load_be32(const uint8_t* p) {
+            return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+        }
+
+    } // namespace detail
+
+    /// signing_value_hash of four values at once
+    inline void signing_value_hash_x4(const uint64_t values[4], uint8_t out[4][32]) {
+        using namespace detail;
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+        // The padded block: the value's bytes, 0x80, zeros, then the 64-bit length
+        uint32_t words[2][4];
+        for (int lane = 0; lane < 4; lane++) {
+            uint8_t bytes[8];
+            std::memcpy(bytes, &values[lane], 8);
+            words[0][lane] = load_be32(bytes);
+            words[1][lane] = load_be32(bytes + 4);
+        }
+        __m128i w[64];
+        w[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words[0]));
+        w[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words[1]));
+        w[2] = _mm_set1_epi32(int(0x80000000));
+        for (int i = 3; i < 15; i++) w[i] = _mm_setzero_si128();
+        w[15] = _mm_set1_epi32(64);
+        for (int i = 16; i < 64; i++) {
+            __m128i s0 = _mm_xor_si128(_mm_xor_si128(rotr(w[i - 15], 7), rotr(w[i - 15], 18)), _mm_srli_epi32(w[i - 15], 3));
+            __m128i s1 = _mm_xor_si128(_mm_xor_si128(rotr(w[i - 2], 17), rotr(w[i - 2], 19)), _mm_srli_epi32(w[i - 2], 10));
+            w[i] = add(add(w[i - 16], s0), add(w[i - 7], s1));
+        }
+
+        __m128i s[8];
+        for (int i = 0; i < 8; i++) s[i] = _mm_set1_epi32(int(initial[i]));
+        __m128i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int i = 0; i < 64; i++) {
+            __m128i s1 = _mm_xor_si128(_mm_xor_si128(rotr(e, 6), rotr(e, 11)), rotr(e, 25));
+            __m128i ch = _mm_xor_si128(_mm_and_si128(e, f), _mm_andnot_si128(e, g));
+            __m128i t1 = add(add(add(h, s1), add(ch, _mm_set1_epi32(int(k[i])))), w[i]);
+            __m128i s0 = _mm_xor_si128(_mm_xor_si128(rotr(a, 2), rotr(a, 13)), rotr(a, 22));
+            __m128i maj = _mm_xor_si128(_mm_xor_si128(_mm_and_si128(a, b), _mm_and_si128(a, c)), _mm_and_si128(b, c));
+            h = g;
+            g = f;
+            f = e;
+            e = add(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = add(t1, add(s0, maj));
+        }
+        __m128i state[8] = {add(s[0], a), add(s[1], b), add(s[2], c), add(s[3], d),
+                            add(s[4], e), add(s[5], f), add(s[6], g), add(s[7], h)};
+
+        for (int i = 0; i < 8; i++) {
+            uint32_t lanes[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), state[i]);
+            for (int lane = 0; lane < 4; lane++) {
+                out[lane][i * 4] = uint8_t(lanes[lane] >> 24);
+                out[lane][i * 4 + 1] = uint8_t(lanes[lane] >> 16);
+                out[lane][i * 4 + 2] = uint8_t(lanes[lane] >> 8);
+                out[lane][i * 4 + 3] = uint8_t(lanes[lane]);
+            }
+        }
+    }
+#else
+    inline void signing_value_hash_x4(const uint64_t values[4], uint8_t out[4][32]) {
+        for (int lane = 0; lane < 4; lane++) signing_value_hash(values[lane], out[lane]);
+    }
+#endif
+
+} // namespace audit
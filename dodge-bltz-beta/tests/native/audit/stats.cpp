@@ -0,0 +1,85 @@
+#include "stats.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace audit {
+
+    namespace {
+
+        /// Regularized upper incomplete gamma Q(a, x): the series below a + 1, the continued fraction above
+        double gamma_q(double a, double x) {
+            if (x <= 0) return 1;
+            double log_prefix = a * std::log(x) - x - std::lgamma(a);
+            if (x < a + 1) {
+                double term = 1 / a, sum = term;
+                for (int n = 1; n < 10000 && std::fabs(term) > std::fabs(sum) * 1e-15; n++) {
+                    term *= x / (a + n);
+                    sum += term;
+                }
+                return 1 - sum * std::exp(log_prefix);
+            }
+            // Lentz's method
+            const double tiny = std::numeric_limits<double>::min() / std::numeric_limits<double>::epsilon();
+            double b = x + 1 - a, c = 1 / tiny, d = 1 / b, h = d;
+            for (int n = 1; n < 10000; n++) {
+                double an = -n * (n - a);
+                b += 2;
+                d = an * d + b;
+                if (std::fabs(d) < tiny) d = tiny;
+                c = b + an / c;
+                if (std::fabs(c) < tiny) c = tiny;
+                d = 1 / d;
+                double delta = d * c;
+                h *= delta;
+                if (std::fabs(delta - 1) < 1e-15) break;
+            }
+            return std::exp(log_prefix) * h;
+        }
+
+    } // namespace
+
+    std::array<double, 100> roll_probabilities(unsigned bits) {
+        // 2^bits = 100 q + r: rolls below r have q + 1 words each, the rest q
+        long double total = std::ldexp(1.0L, int(bits));
+        unsigned    r = bits == 32 ? unsigned((uint64_t(1) << 32) % 100) : unsigned(uint64_t(-1) % 100 + 1) % 100;
+        long double q = std::floor(total / 100);
+        std::array<double, 100> p{};
+        for (unsigned i = 0; i < 100; i++) p[i] = double((q + (i < r ? 1 : 0)) / total);
+        return p;
+    }
+
+    test_result win_rate_test(uint64_t wins, uint64_t plays, double win_probability) {
+        if (plays == 0) return {};
+        double expected = double(plays) * win_probability;
+        double z = (double(wins) - expected) / std::sqrt(expected * (1 - win_probability));
+        return {z, normal_two_sided(z)};
+    }
+
+    test_result chi_square_test(const std::array<uint64_t, 100>& counts, const std::array<double, 100>& probabilities) {
+        uint64_t n = 0;
+        for (auto c : counts) n += c;
+        if (n == 0) return {};
+        double x = 0;
+        for (size_t i = 0; i < counts.size(); i++) {
+            double expected = double(n) * probabilities[i];
+            double diff = double(counts[i]) - expected;
+            x += diff * diff / expected;
+        }
+        return {x, chi_square_sf(x, double(counts.size() - 1))};
+    }
+
+    test_result runs_test(uint64_t runs, uint64_t wins, uint64_t losses) {
+        if (wins == 0 || losses == 0) return {};
+        double n1 = double(wins), n2 = double(losses), n = n1 + n2;
+        double mean = 2 * n1 * n2 / n + 1;
+        double variance = 2 * n1 * n2 * (2 * n1 * n2 - n) / (n * n * (n - 1));
+        double z = (double(runs) - mean) / std::sqrt(variance);
+        return {z, normal_two_sided(z)};
+    }
+
+    double chi_square_sf(double x, double dof) { return gamma_q(dof / 2, x / 2); }
+
+    double normal_two_sided(double z) { return std::erfc(std::fabs(z) / std::sqrt(2.0)); }
+
+} // namespace audit
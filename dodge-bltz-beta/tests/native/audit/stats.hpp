@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ * The distribution tests the audit runs over the rolls it has checked.
+ * p-values are two-sided for the z tests and upper-tail for chi-square.
+ */
+namespace audit {
+
+    /**
+     * Exact probability of each roll for a uniformly random word of `bits`
+     * bits taken modulo 100. 2^32 and 2^64 are not multiples of 100, so the
+     * low rolls are very slightly likelier; the tests expect exactly that.
+     */
+    std::array<double, 100> roll_probabilities(unsigned bits);
+
+    struct test_result {
+        double statistic = 0; // z, or chi-square
+        double p_value = 1;
+    };
+
+    /// Wins against the expected win probability, by the normal approximation to the binomial
+    test_result win_rate_test(uint64_t wins, uint64_t plays, double win_probability);
+
+    /// Observed roll counts against `probabilities`; 99 degrees of freedom
+    test_result chi_square_test(const std::array<uint64_t, 100>& counts, const std::array<double, 100>& probabilities);
+
+    /// Wald-Wolfowitz runs test of a win/loss sequence with `runs` runs
+    test_result runs_test(uint64_t runs, uint64_t wins, uint64_t losses);
+
+    /// Upper tail of the chi-square distribution
+    double chi_square_sf(double x, double dof);
+
+    /// Two-sided tail of the standard normal distribution
+    double normal_two_sided(double z);
+
+} // namespace audit
@@ -0,0 +1,174 @@
+#include <gameplay_core.hpp>
+
+#include <contracts.hpp>
+#include <native/chain.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <type_traits>
+
+/**
+ * Every workable combination of the gameplay core's policies, each built as
+ * a contract of its own and timed head to head on the native tester. An
+ * iteration is one play and the settlement of its roll; every other roll
+ * wins and is paid in DBP by the real token contract, or credited to the
+ * player's row under credited_issue.
+ *
+ * dodge-bltz as deployed is core/nonce_set/u64/direct/no_state. The beta
+ * contract's players table keeps more columns and an archive, so
+ * core/distinct/checksum/credited/player_rows approximates its play.
+ */
+
+namespace {
+
+    using namespace eosio;
+    using namespace dbltz_core;
+
+    const symbol DBP = symbol("DBP", 4);
+
+    struct nonce_row {
+        uint64_t nonce;
+        name     player;
+        uint32_t timestamp;
+
+        uint64_t primary_key() const { return nonce; }
+        uint64_t by_player() const { return player.value; }
+        uint64_t by_timestamp() const { return timestamp; }
+    };
+
+    typedef eosio::multi_index<"usednonces"_n, nonce_row,
+        indexed_by<"byplayer"_n, const_mem_fun<nonce_row, uint64_t, &nonce_row::by_player>>,
+        indexed_by<"bytimestamp"_n, const_mem_fun<nonce_row, uint64_t, &nonce_row::by_timestamp>>
+    > nonces_table;
+
+    struct player_row {
+        name        player;
+        uint64_t    total_plays = 0;
+        uint64_t    total_wins = 0;
+        std::string last_nonce;
+        uint64_t    last_cnonce = 0;
+        uint64_t    owed = 0;
+
+        uint64_t primary_key() const { return player.value; }
+        uint64_t last_compact_nonce() const { return last_cnonce; }
+        void set_last_compact_nonce(uint64_t nonce) { last_cnonce = nonce; }
+        void credit(int64_t amount) { owed += amount; }
+    };
+
+    typedef eosio::multi_index<"players"_n, player_row> players_table;
+
+    /// A contract that is one game and nothing else: play accepts, settle rolls and pays
+    template <typename Game, typename Nonce>
+    class core_contract : public contract {
+    public:
+        using contract::contract;
+
+        void play(const name& player, const Nonce& nonce) {
+            require_auth(player);
+            make_game().accept(player, nonce);
+        }
+
+        void settle(const name& player, const typename Game::random_type& random_value) {
+            require_auth(get_self());
+            auto settled = make_game().settle(player, random_value, [] {
+                return reward_terms{"dbptoken"_n, {"dbptoken"_n, "active"_n}, asset(10000, DBP), "BLTZ reward"};
+            });
+            check(settled.status == SETTLED, "roll not settled");
+        }
+
+    private:
+        Game make_game() {
+            if constexpr (std::is_same_v<typename Game::storage_policy, no_player_state>) {
+                return Game(get_self());
+            } else {
+                return Game(get_self(), get_self());
+            }
+        }
+    };
+
+    template <typename Contract>
+    void apply(uint64_t receiver, uint64_t code, uint64_t action) {
+        if (code != receiver) return;
+        switch (action) {
+            EOSIO_DISPATCH_HELPER(Contract, (play)(settle))
+            default:
+                check(false, "unknown action");
+        }
+    }
+
+    /// A random value that rolls `roll`
+    template <typename Random>
+    Random rolling(uint32_t roll) {
+        if constexpr (std::is_same_v<Random, uint64_t>) {
+            return roll;
+        } else {
+            Random random_value;
+            random_value.data()[3] = uint8_t(roll);
+            return random_value;
+        }
+    }
+
+    template <typename NoncePolicy, typename RngPolicy, typename RewardPolicy, typename StoragePolicy>
+    void play_and_settle(benchmark::State& state) {
+        using game_type = game<NoncePolicy, RngPolicy, RewardPolicy, StoragePolicy>;
+        using nonce_type = std::conditional_t<std::is_same_v<NoncePolicy, distinct_nonce>, std::string, uint64_t>;
+        using random_type = typename game_type::random_type;
+
+        native::tester t;
+        t.create_accounts({"dbptoken"_n, "game"_n, "alice"_n});
+        t.set_code("dbptoken"_n, contracts::dbp_token_apply);
+        t.set_code("game"_n, apply<core_contract<game_type, nonce_type>>);
+        t.grant_code("dbptoken"_n, "game"_n);
+        t.push_action("dbptoken"_n, "create"_n, "dbptoken"_n, "dbptoken"_n, asset(4000000000000000000, DBP));
+
+        const random_type win = rolling<random_type>(0), loss = rolling<random_type>(50);
+        uint64_t nonce = 0;
+        for (auto _ : state) {
+            nonce++;
+            if constexpr (std::is_same_v<nonce_type, std::string>) {
+                t.push_action("game"_n, "play"_n, "alice"_n, "alice"_n, std::to_string(nonce));
+            } else {
+                t.push_action("game"_n, "play"_n, "alice"_n, "alice"_n, nonce);
+            }
+            t.push_action("game"_n, "settle"_n, "game"_n, "alice"_n, nonce % 2 ? win : loss);
+        }
+        state.counters["plays/s"] = benchmark::Counter(double(state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    template <typename NoncePolicy, typename RngPolicy, typename RewardPolicy, typename StoragePolicy>
+    void add(const std::string& name) {
+        benchmark::RegisterBenchmark(("core/" + name).c_str(), play_and_settle<NoncePolicy, RngPolicy, RewardPolicy, StoragePolicy>)
+            ->Unit(benchmark::kMicrosecond);
+    }
+
+    /// Every RNG and reward policy under one nonce and storage policy
+    template <typename NoncePolicy, typename StoragePolicy>
+    void add_all(const std::string& nonce, const std::string& storage) {
+        add<NoncePolicy, u64_rng, direct_issue, StoragePolicy>(nonce + "/u64/direct/" + storage);
+        add<NoncePolicy, u64_rng, checked_issue, StoragePolicy>(nonce + "/u64/checked/" + storage);
+        add<NoncePolicy, checksum_rng, direct_issue, StoragePolicy>(nonce + "/checksum/direct/" + storage);
+        add<NoncePolicy, checksum_rng, checked_issue, StoragePolicy>(nonce + "/checksum/checked/" + storage);
+        // Credits need a stored row to land in
+        if constexpr (!std::is_same_v<StoragePolicy, no_player_state>) {
+            add<NoncePolicy, u64_rng, credited_issue, StoragePolicy>(nonce + "/u64/credited/" + storage);
+            add<NoncePolicy, checksum_rng, credited_issue, StoragePolicy>(nonce + "/checksum/credited/" + storage);
+        }
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    // Per-player nonces live in the player's row, so they only pair with player_rows
+    add_all<nonce_set<nonces_table>, no_player_state>("nonce_set", "no_state");
+    add_all<nonce_set<nonces_table>, player_rows<players_table>>("nonce_set", "player_rows");
+    add_all<distinct_nonce, player_rows<players_table>>("distinct", "player_rows");
+    add_all<increasing_nonce, player_rows<players_table>>("increasing", "player_rows");
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
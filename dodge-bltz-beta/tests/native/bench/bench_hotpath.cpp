@@ -0,0 +1,309 @@
+#include <gameplay/gameplay.cpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/**
+ * Microbenchmarks of the contract's pure hot-path logic, each next to the
+ * alternatives worth considering, so a micro-optimization is measured
+ * natively before it reaches the wasm build. Every benchmark reports
+ * allocs/op beside its time. The `gameplay::` helpers are the contract's
+ * own; the rest are candidates, checked against them before anything runs.
+ *
+ * Native timings rank the candidates; they are not wasm instruction counts.
+ */
+
+namespace {
+
+    uint64_t allocations = 0;
+
+} // namespace
+
+// Count every heap allocation in the process; the benchmarks run on one thread
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+    constexpr size_t input_count = 1024; // a power of two, cycled through by every benchmark
+
+    uint64_t splitmix64(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    struct inputs {
+        std::array<checksum256, input_count> checksums;
+        std::array<uint64_t, input_count> words;
+        std::array<name, input_count> names;
+        std::array<string, input_count> name_strings;
+
+        inputs() {
+            uint64_t state = 42;
+            for (size_t i = 0; i < input_count; i++) {
+                for (size_t b = 0; b < 32; b++) checksums[i].data()[b] = uint8_t(splitmix64(state));
+                words[i] = splitmix64(state);
+                // Player-like names of 5 to 12 characters
+                names[i] = name(splitmix64(state) & ~((uint64_t(1) << (5 * (7 - i % 8) + 4)) - 1));
+                name_strings[i] = names[i].to_string();
+            }
+        }
+    };
+
+    const inputs& in() {
+        static const inputs data;
+        return data;
+    }
+
+    /// Run `op` on each input in turn, reporting allocations per call
+    template <typename Op>
+    void measure(benchmark::State& state, Op&& op) {
+        size_t i = 0;
+        uint64_t before = allocations;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(op(i++ & (input_count - 1)));
+        }
+        state.counters["allocs/op"] = benchmark::Counter(double(allocations - before), benchmark::Counter::kAvgIterations);
+    }
+
+    // Roll extraction ----------------------------------------------------
+
+    uint32_t first_word_bswap(const checksum256& c) {
+        uint32_t word;
+        std::memcpy(&word, c.data(), sizeof(word));
+        if constexpr (std::endian::native == std::endian::little) word = __builtin_bswap32(word);
+        return word;
+    }
+
+    uint32_t roll_bswap(const checksum256& c) { return first_word_bswap(c) % 100; }
+
+    // 2^32 is not a multiple of 100, so plain modulo favours rolls 0-95 by one
+    // part in 43 million; rejection takes the next word instead
+    constexpr uint32_t rejection_limit = uint32_t((uint64_t(1) << 32) / 100 * 100);
+
+    uint32_t roll_rejection(const checksum256& c) {
+        for (size_t offset = 0; offset + 4 <= 32; offset += 4) {
+            uint32_t word;
+            std::memcpy(&word, c.data() + offset, sizeof(word));
+            word = __builtin_bswap32(word);
+            if (word < rejection_limit) return word % 100;
+        }
+        return first_word_bswap(c) % 100; // all eight words rejected: 1 in 10^60
+    }
+
+    void roll_shifts(benchmark::State& state) {
+        measure(state, [](size_t i) { return gameplay::roll_of(in().checksums[i]); });
+    }
+    BENCHMARK(roll_shifts);
+
+    void roll_memcpy_bswap(benchmark::State& state) {
+        measure(state, [](size_t i) { return roll_bswap(in().checksums[i]); });
+    }
+    BENCHMARK(roll_memcpy_bswap);
+
+    // Multiply-shift range reduction: no division, but a different roll for the same bytes
+    void roll_multiply_shift(benchmark::State& state) {
+        measure(state, [](size_t i) { return uint32_t((uint64_t(first_word_bswap(in().checksums[i])) * 100) >> 32); });
+    }
+    BENCHMARK(roll_multiply_shift);
+
+    // is_successful_play -------------------------------------------------
+
+    void win_modulo(benchmark::State& state) {
+        measure(state, [](size_t i) { return gameplay::is_successful_play(gameplay::roll_of(in().checksums[i])); });
+    }
+    BENCHMARK(win_modulo);
+
+    void win_rejection(benchmark::State& state) {
+        measure(state, [](size_t i) { return gameplay::is_successful_play(roll_rejection(in().checksums[i])); });
+    }
+    BENCHMARK(win_rejection);
+
+    // dodge-bltz takes the oracle's value as a u64: a 64-bit modulo
+    void win_modulo_u64(benchmark::State& state) {
+        measure(state, [](size_t i) { return in().words[i] % 100 < gameplay::WIN_CHANCE; });
+    }
+    BENCHMARK(win_modulo_u64);
+
+    // Signing value ------------------------------------------------------
+
+    void signing_xor(benchmark::State& state) {
+        time_point now = current_time_point();
+        measure(state, [now](size_t i) { return gameplay::signing_value_for(now, in().names[i], in().words[i]); });
+    }
+    BENCHMARK(signing_xor);
+
+    // dodge-bltz signs with the slot and its generation
+    void signing_slot_generation(benchmark::State& state) {
+        measure(state, [](size_t i) { return (uint64_t(uint32_t(in().words[i] >> 40)) << 32) | (i & 0xFFFF); });
+    }
+    BENCHMARK(signing_slot_generation);
+
+    void signing_sha256(benchmark::State& state) {
+        time_point now = current_time_point();
+        measure(state, [now](size_t i) {
+            uint64_t parts[] = {uint64_t(now.time_since_epoch().count()), in().names[i].value, in().words[i]};
+            return first_word_bswap(sha256(reinterpret_cast<const char*>(parts), sizeof(parts)));
+        });
+    }
+    BENCHMARK(signing_sha256);
+
+    // Asset arithmetic ---------------------------------------------------
+
+    asset balance_of(size_t i) { return asset(int64_t(in().words[i] >> 8), gameplay::DBP_SYMBOL); }
+
+    void asset_add_checked(benchmark::State& state) {
+        asset reward(gameplay::REWARD_AMOUNT, gameplay::DBP_SYMBOL);
+        measure(state, [&](size_t i) { return (balance_of(i) + reward).amount; });
+    }
+    BENCHMARK(asset_add_checked);
+
+    void asset_sub_checked(benchmark::State& state) {
+        asset reward(gameplay::REWARD_AMOUNT, gameplay::DBP_SYMBOL);
+        measure(state, [&](size_t i) { return (balance_of(i) - reward).amount; });
+    }
+    BENCHMARK(asset_sub_checked);
+
+    // Both range bounds in one unsigned compare; amounts in range cannot overflow an int64 sum
+    void asset_add_range(benchmark::State& state) {
+        asset reward(gameplay::REWARD_AMOUNT, gameplay::DBP_SYMBOL);
+        measure(state, [&](size_t i) {
+            asset sum = balance_of(i);
+            check(sum.symbol == reward.symbol, "attempt to add asset with different symbol");
+            sum.amount += reward.amount;
+            check(uint64_t(sum.amount + asset::max_amount) <= uint64_t(2 * asset::max_amount), "addition overflow");
+            return sum.amount;
+        });
+    }
+    BENCHMARK(asset_add_range);
+
+    // Nonce hashing, at the nonce lengths play accepts -------------------
+
+    string nonce_of(size_t i, size_t length) {
+        string nonce = std::to_string(in().words[i]);
+        nonce.resize(length, '0');
+        return nonce;
+    }
+
+    template <typename Hash>
+    void measure_nonce(benchmark::State& state, Hash&& hash) {
+        std::vector<string> nonces;
+        for (size_t i = 0; i < input_count; i++) nonces.push_back(nonce_of(i, size_t(state.range(0))));
+        measure(state, [&](size_t i) { return hash(nonces[i]); });
+    }
+
+    void nonce_std_hash(benchmark::State& state) {
+        measure_nonce(state, [](const string& nonce) { return gameplay::nonce_seed(nonce); });
+    }
+    BENCHMARK(nonce_std_hash)->Arg(8)->Arg(20)->Arg(64);
+
+    void nonce_fnv1a(benchmark::State& state) {
+        measure_nonce(state, [](const string& nonce) {
+            uint64_t h = 0xcbf29ce484222325ULL;
+            for (unsigned char c : nonce) {
+                h ^= c;
+                h *= 0x100000001b3ULL;
+            }
+            return h;
+        });
+    }
+    BENCHMARK(nonce_fnv1a)->Arg(8)->Arg(20)->Arg(64);
+
+    void nonce_sha256(benchmark::State& state) {
+        measure_nonce(state, [](const string& nonce) { return first_word_bswap(sha256(nonce.data(), uint32_t(nonce.size()))); });
+    }
+    BENCHMARK(nonce_sha256)->Arg(8)->Arg(20)->Arg(64);
+
+    // The nonce as play receives it: unpacked from the action data, heap-allocated past 15 bytes
+    void nonce_unpack(benchmark::State& state) {
+        std::vector<std::vector<char>> packed;
+        for (size_t i = 0; i < input_count; i++) packed.push_back(pack(nonce_of(i, size_t(state.range(0)))));
+        measure(state, [&](size_t i) { return unpack<string>(packed[i]).size(); });
+    }
+    BENCHMARK(nonce_unpack)->Arg(8)->Arg(20)->Arg(64);
+
+    // Name encoding ------------------------------------------------------
+
+    void name_parse(benchmark::State& state) {
+        measure(state, [](size_t i) { return name(in().name_strings[i]).value; });
+    }
+    BENCHMARK(name_parse);
+
+    constexpr std::array<uint8_t, 256> name_values = [] {
+        std::array<uint8_t, 256> values{};
+        values.fill(0xFF);
+        values['.'] = 0;
+        for (char c = '1'; c <= '5'; c++) values[uint8_t(c)] = uint8_t(c - '1' + 1);
+        for (char c = 'a'; c <= 'z'; c++) values[uint8_t(c)] = uint8_t(c - 'a' + 6);
+        return values;
+    }();
+
+    // A lookup table in place of char_to_value's range tests; names up to 12 characters
+    uint64_t parse_table(std::string_view str) {
+        check(str.size() <= 12, "string is too long to be a valid name");
+        uint64_t value = 0;
+        uint8_t invalid = 0;
+        for (char c : str) {
+            uint8_t v = name_values[uint8_t(c)];
+            invalid |= v & 0xE0;
+            value = (value << 5) | (v & 0x1F);
+        }
+        check(!invalid, "character is not in allowed character set for names");
+        return value << (4 + 5 * (12 - str.size()));
+    }
+
+    void name_parse_table(benchmark::State& state) {
+        measure(state, [](size_t i) { return parse_table(in().name_strings[i]); });
+    }
+    BENCHMARK(name_parse_table);
+
+    void name_to_string(benchmark::State& state) {
+        measure(state, [](size_t i) { return in().names[i].to_string().size(); });
+    }
+    BENCHMARK(name_to_string);
+
+    /// Candidates must agree with the contract wherever they claim to compute the same thing
+    bool candidates_agree() {
+        bool ok = true;
+        auto expect = [&](bool same, const char* what, size_t i) {
+            if (!same) std::fprintf(stderr, "%s disagrees with the contract on input %zu\n", what, i);
+            ok &= same;
+        };
+        for (size_t i = 0; i < input_count; i++) {
+            const auto& c = in().checksums[i];
+            expect(roll_bswap(c) == gameplay::roll_of(c), "roll_memcpy_bswap", i);
+            expect(roll_rejection(c) < 100, "roll_rejection", i);
+            expect(parse_table(in().name_strings[i]) == in().names[i].value, "name_parse_table", i);
+
+            asset sum = balance_of(i);
+            sum.amount += gameplay::REWARD_AMOUNT;
+            expect(sum == balance_of(i) + asset(gameplay::REWARD_AMOUNT, gameplay::DBP_SYMBOL), "asset_add_range", i);
+        }
+        return ok;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!candidates_agree()) return 1;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include <scaling.hpp>
+
+#include <target.hpp>
+
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/time.hpp>
+
+using namespace eosio;
+using std::string;
+
+namespace {
+
+    const symbol DBP = symbol("DBP", 4);
+
+    const name GAMEPLAY = "gameplay"_n;
+    const name TOKEN = "dbptoken"_n;
+    const name ALICE = "alice"_n;
+    const name BOB = "bob"_n;
+
+    // The contract's slot limit
+    constexpr int64_t max_slots = 65536;
+
+    // Full layouts of the rows filled directly, current schema
+
+    struct player_row {
+        name           player;
+        uint64_t       total_plays;
+        uint64_t       total_wins;
+        string         last_nonce;
+        uint8_t        schema_version;
+        time_point_sec last_play;
+        uint64_t       last_cnonce;
+    };
+
+    struct dead_letter_row {
+        uint64_t    id;
+        name        player;
+        uint64_t    request_id;
+        checksum256 random_value;
+        uint8_t     reason;
+        uint32_t    attempts;
+        time_point  created;
+    };
+
+    struct account_row {
+        asset balance;
+    };
+
+    std::unique_ptr<replay::target> deployment = replay::make_target();
+
+    native::tester& deployed(native::tester& chain) {
+        deployment->setup(chain, {ALICE, BOB});
+        return chain;
+    }
+
+    void push(native::tester& chain, const action& act) { chain.push_transaction({act}); }
+
+    /// Answer alice's outstanding play, untimed, so slots never run out
+    void settle(benchmark::State& state, native::tester& chain, uint64_t random_value) {
+        state.PauseTiming();
+        for (auto request : deployment->take_requests(chain)) push(chain, deployment->callback(request, random_value));
+        state.ResumeTiming();
+    }
+
+    // A returning player's play: one players lookup and modify
+    void play_players(benchmark::State& state, int64_t rows) {
+        auto& chain = scaling::chain_for("play/players", rows, [&](native::tester& c) {
+            deployed(c);
+            for (int64_t i = 0; i < rows; i++) {
+                name player(scaling::spread(i));
+                scaling::put_row(GAMEPLAY, GAMEPLAY.value, "players"_n, player.value,
+                                 player_row{player, 1, 0, "1", 2, time_point_sec(), 0}, player);
+            }
+        });
+
+        static uint64_t nonce = 0;
+        for (auto _ : state) {
+            push(chain, deployment->play(ALICE, ++nonce));
+            settle(state, chain, 0xff00000000000000ULL);
+        }
+    }
+
+    // The same play after scopeplayers: every player's row in a scope of its own
+    void play_players_scoped(benchmark::State& state, int64_t rows) {
+        auto& chain = scaling::chain_for("play/players_scoped", rows, [&](native::tester& c) {
+            deployed(c).push_action(GAMEPLAY, "scopeplayers"_n, GAMEPLAY, uint32_t(0));
+            for (int64_t i = 0; i < rows; i++) {
+                name player(scaling::spread(i));
+                scaling::put_row(GAMEPLAY, player.value, "players"_n, player.value,
+                                 player_row{player, 1, 0, "1", 2, time_point_sec(), 0}, player);
+            }
+        });
+
+        static uint64_t nonce = 0;
+        for (auto _ : state) {
+            push(chain, deployment->play(ALICE, ++nonce));
+            settle(state, chain, 0xff00000000000000ULL);
+        }
+    }
+
+    // A callback: one slot lookup and the settlement
+    void receiverand_rngslots(benchmark::State& state, int64_t rows) {
+        auto& chain = scaling::chain_for("receiverand/rngslots", rows, [&](native::tester& c) {
+            deployed(c).push_action(GAMEPLAY, "initslots"_n, GAMEPLAY, uint32_t(rows));
+        });
+
+        static uint64_t nonce = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            push(chain, deployment->play(ALICE, ++nonce));
+            auto requests = deployment->take_requests(chain);
+            state.ResumeTiming();
+            push(chain, deployment->callback(requests.front(), 0xff00000000000000ULL));
+        }
+    }
+
+    // One sweep of 50 slots from the cursor
+    void clearexpired_rngslots(benchmark::State& state, int64_t rows) {
+        auto& chain = scaling::chain_for("clearexpired/rngslots", rows, [&](native::tester& c) {
+            deployed(c).push_action(GAMEPLAY, "initslots"_n, GAMEPLAY, uint32_t(rows));
+        });
+
+        for (auto _ : state) {
+            push(chain, deployment->maintain());
+        }
+    }
+
+    // A callback whose player row is gone: dead-lettered under available_primary_key
+    void receiverand_deadletter(benchmark::State& state, int64_t rows) {
+        auto& chain = scaling::chain_for("receiverand/deadletter", rows, [&](native::tester& c) {
+            deployed(c);
+            for (int64_t i = 0; i < rows; i++) {
+                scaling::put_row(GAMEPLAY, GAMEPLAY.value, "deadletter"_n, uint64_t(i),
+                                 dead_letter_row{uint64_t(i), name(scaling::spread(i)), 0, checksum256(), 1, 0, time_point()}, GAMEPLAY);
+            }
+        });
+
+        static uint64_t nonce = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            push(chain, deployment->play(ALICE, ++nonce));
+            auto requests = deployment->take_requests(chain);
+            native::state().db.remove({GAMEPLAY.value, GAMEPLAY.value, "players"_n.value}, ALICE.value);
+            state.ResumeTiming();
+            push(chain, deployment->callback(requests.front(), 0xff00000000000000ULL));
+        }
+    }
+
+    // A transfer between existing holders among `rows` token accounts
+    void transfer_accounts(benchmark::State& state, int64_t rows) {
+        auto& chain = scaling::chain_for("transfer/accounts", rows, [&](native::tester& c) {
+            deployed(c);
+            for (int64_t i = 0; i < rows; i++) {
+                name owner(scaling::spread(i));
+                scaling::put_row(TOKEN, owner.value, "accounts"_n, DBP.code().raw(), account_row{asset(1, DBP)}, owner);
+            }
+        });
+
+        bool forward = true;
+        for (auto _ : state) {
+            push(chain, forward ? deployment->transfer(ALICE, BOB, 1) : deployment->transfer(BOB, ALICE, 1));
+            forward = !forward;
+        }
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    return scaling::run(argc, argv, {
+        {"play/players", INT64_MAX, play_players},
+        {"play/players_scoped", INT64_MAX, play_players_scoped},
+        {"receiverand/rngslots", max_slots, receiverand_rngslots},
+        {"clearexpired/rngslots", max_slots, clearexpired_rngslots},
+        {"receiverand/deadletter", INT64_MAX, receiverand_deadletter},
+        {"transfer/accounts", INT64_MAX, transfer_accounts},
+    });
+}
@@ -0,0 +1,166 @@
+#include <client/tx.hpp>
+#include <contracts.hpp>
+#include <native/chain.hpp>
+
+#ifdef DBLTZ_HAVE_K1
+#include <client/k1_signer.hpp>
+#endif
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <new>
+
+/**
+ * Throughput of the transaction builder as a bot drives it: patch a
+ * template's header and nonce, digest it, sign it, and push it at the
+ * native tester. Every benchmark reports allocs/op beside its time; the
+ * builder's own paths should report zero.
+ */
+
+namespace {
+
+    uint64_t allocations = 0;
+
+} // namespace
+
+// Count every heap allocation in the process; the benchmarks run on one thread
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+    using namespace eosio;
+
+    const symbol             DBP = symbol("DBP", 4);
+    const eosio::checksum256 chain_id = eosio::sha256("chain", 5);
+
+    void report(benchmark::State& state, uint64_t before) {
+        state.counters["allocs/op"] = benchmark::Counter(double(allocations - before), benchmark::Counter::kAvgIterations);
+        state.counters["tx/s"] = benchmark::Counter(double(state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    client::transaction_template<> playc_template(std::array<size_t, 3>& fields) {
+        client::transaction_template<> trx;
+        fields = trx.add<client::gameplay::playc>("gameplay"_n, {"alice"_n}, "alice"_n, uint64_t(0), uint8_t(0));
+        trx.finish();
+        return trx;
+    }
+
+    /// The per-transaction work of a bot reusing one template
+    void patch_and_digest(benchmark::State& state) {
+        std::array<size_t, 3> fields;
+        auto trx = playc_template(fields);
+        uint64_t nonce = 0, before = allocations;
+        for (auto _ : state) {
+            trx.set_header(1700000060 + uint32_t(nonce >> 10), uint16_t(nonce), 0xdeadbeef);
+            trx.patch(fields[1], ++nonce);
+            benchmark::DoNotOptimize(trx.digest(chain_id));
+        }
+        report(state, before);
+    }
+    BENCHMARK(patch_and_digest);
+
+    /// The string-nonce play, patched in decimal
+    void patch_decimal_and_digest(benchmark::State& state) {
+        client::transaction_template<> trx;
+        auto fields = trx.add<client::gameplay::play>("gameplay"_n, {"alice"_n}, "alice"_n, std::string_view("00000000000000000000"));
+        trx.finish();
+        uint64_t nonce = 0, before = allocations;
+        for (auto _ : state) {
+            trx.set_header(1700000060, uint16_t(nonce), 0xdeadbeef);
+            trx.patch_decimal(fields[1], ++nonce);
+            benchmark::DoNotOptimize(trx.digest(chain_id));
+        }
+        report(state, before);
+    }
+    BENCHMARK(patch_decimal_and_digest);
+
+    /// A transfer packed afresh every time, for comparison with patching
+    void build_and_digest(benchmark::State& state) {
+        uint64_t amount = 0, before = allocations;
+        for (auto _ : state) {
+            client::transaction_template<> trx;
+            trx.add<client::dbp_token::transfer>("dbptoken"_n, {"alice"_n}, "alice"_n, "bob"_n, asset(int64_t(++amount), DBP),
+                                                 std::string_view("load test"));
+            trx.finish();
+            trx.set_header(1700000060, 1, 2);
+            benchmark::DoNotOptimize(trx.digest(chain_id));
+        }
+        report(state, before);
+    }
+    BENCHMARK(build_and_digest);
+
+    /// The same transfer through eosio::transaction and eosio::pack, as the bots did before
+    void eosio_pack_and_digest(benchmark::State& state) {
+        uint64_t amount = 0, before = allocations;
+        for (auto _ : state) {
+            transaction trx(time_point_sec(1700000060));
+            trx.ref_block_num = 1;
+            trx.ref_block_prefix = 2;
+            trx.actions.emplace_back(permission_level{"alice"_n, "active"_n}, "dbptoken"_n, "transfer"_n,
+                                     std::make_tuple("alice"_n, "bob"_n, asset(int64_t(++amount), DBP), std::string("load test")));
+            auto bytes = pack(trx);
+            auto id = chain_id.extract_as_byte_array();
+            bytes.insert(bytes.begin(), id.begin(), id.end());
+            bytes.resize(bytes.size() + 32);
+            benchmark::DoNotOptimize(sha256(bytes.data(), uint32_t(bytes.size())));
+        }
+        report(state, before);
+    }
+    BENCHMARK(eosio_pack_and_digest);
+
+#ifdef DBLTZ_HAVE_K1
+    void patch_digest_and_sign(benchmark::State& state) {
+        std::array<size_t, 3> fields;
+        auto trx = playc_template(fields);
+        std::array<uint8_t, 32> key{};
+        key.fill(7);
+        client::k1_signer signer(key);
+        client::signature signature;
+        uint64_t nonce = 0, before = allocations;
+        for (auto _ : state) {
+            trx.set_header(1700000060, uint16_t(nonce), 0xdeadbeef);
+            trx.patch(fields[1], ++nonce);
+            signer.sign(trx.digest(chain_id), signature);
+            benchmark::DoNotOptimize(signature);
+        }
+        report(state, before);
+    }
+    BENCHMARK(patch_digest_and_sign);
+#endif
+
+    /// Templated transfers pushed at the native tester; the contract's own work dominates
+    void push_native(benchmark::State& state) {
+        native::tester t;
+        t.create_accounts({"dbptoken"_n, "alice"_n, "bob"_n});
+        t.set_code("dbptoken"_n, contracts::dbp_token_apply);
+        t.push_action("dbptoken"_n, "create"_n, "dbptoken"_n, "dbptoken"_n, asset(4000000000000000000, DBP));
+        t.push_action("dbptoken"_n, "issue"_n, "dbptoken"_n, "alice"_n, asset(4000000000000000000, DBP), std::string());
+
+        client::transaction_template<> trx;
+        trx.add<client::dbp_token::transfer>("dbptoken"_n, {"alice"_n}, "alice"_n, "bob"_n, asset(1, DBP), std::string_view());
+        trx.finish();
+        trx.set_header(t.now().sec_since_epoch() + 3600, 1, 2);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(t.push_packed(trx.packed().data(), trx.packed().size()));
+        }
+        state.counters["tx/s"] = benchmark::Counter(double(state.iterations()), benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(push_native);
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
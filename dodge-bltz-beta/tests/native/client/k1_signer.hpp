@@ -0,0 +1,155 @@
+#pragma once
+
+#include "tx.hpp"
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * secp256k1 signing with a local private key through OpenSSL's libcrypto.
+ * Link OpenSSL::Crypto to use it.
+ *
+ * Signatures come out as the chain requires them: low s, canonical r and s,
+ * and the recovery byte derived from the nonce point, so no key recovery
+ * is needed to produce it. EVP signing hides that point, hence the point
+ * and bignum API.
+ */
+namespace client {
+
+    class k1_signer {
+    public:
+        explicit k1_signer(const std::array<uint8_t, 32>& private_key)
+            : group(EC_GROUP_new_by_curve_name(NID_secp256k1)), ctx(BN_CTX_new()), d(BN_bin2bn(private_key.data(), 32, nullptr)),
+              order(BN_new()), half_order(BN_new()) {
+            if (!group || !ctx || !d || !order || !half_order) throw std::runtime_error("libcrypto allocation failed");
+            EC_GROUP_get_order(group.get(), order.get(), ctx.get());
+            BN_rshift1(half_order.get(), order.get());
+            if (BN_is_zero(d.get()) || BN_cmp(d.get(), order.get()) >= 0) throw std::invalid_argument("invalid secp256k1 private key");
+
+            public_point.reset(EC_POINT_new(group.get()));
+            nonce_point.reset(EC_POINT_new(group.get()));
+            EC_POINT_mul(group.get(), public_point.get(), d.get(), nullptr, nullptr, ctx.get());
+            EC_POINT_point2oct(group.get(), public_point.get(), POINT_CONVERSION_COMPRESSED, public_key_bytes.data(), 33, ctx.get());
+        }
+
+        /// The compressed public key
+        const std::array<uint8_t, 33>& public_key() const { return public_key_bytes; }
+
+        void sign(const eosio::checksum256& digest, signature& out) {
+            auto hash = digest.extract_as_byte_array();
+            BN_CTX_start(ctx.get());
+            BIGNUM* e = BN_CTX_get(ctx.get());
+            BIGNUM* k = BN_CTX_get(ctx.get());
+            BIGNUM* x = BN_CTX_get(ctx.get());
+            BIGNUM* y = BN_CTX_get(ctx.get());
+            BIGNUM* r = BN_CTX_get(ctx.get());
+            BIGNUM* s = BN_CTX_get(ctx.get());
+            BIGNUM* t = BN_CTX_get(ctx.get());
+            BN_bin2bn(hash.data(), 32, e);
+
+            // A fresh nonce until the signature is canonical, about one in four tries
+            for (;;) {
+                BN_priv_rand_range(k, order.get());
+                if (BN_is_zero(k)) continue;
+                EC_POINT_mul(group.get(), nonce_point.get(), k, nullptr, nullptr, ctx.get());
+                EC_POINT_get_affine_coordinates(group.get(), nonce_point.get(), x, y, ctx.get());
+                uint8_t recovery = uint8_t(BN_is_odd(y)) | uint8_t(BN_cmp(x, order.get()) >= 0 ? 2 : 0);
+                BN_nnmod(r, x, order.get(), ctx.get());
+                if (BN_is_zero(r)) continue;
+
+                // s = k^-1 (e + r d) mod n
+                BN_mod_mul(t, r, d.get(), order.get(), ctx.get());
+                BN_mod_add(t, t, e, order.get(), ctx.get());
+                BN_mod_inverse(s, k, order.get(), ctx.get());
+                BN_mod_mul(s, s, t, order.get(), ctx.get());
+                if (BN_is_zero(s)) continue;
+                if (BN_cmp(s, half_order.get()) > 0) {
+                    BN_sub(s, order.get(), s);
+                    recovery ^= 1;
+                }
+
+                out.data[0] = uint8_t(27 + 4 + recovery); // compressed key
+                BN_bn2binpad(r, out.data.data() + 1, 32);
+                BN_bn2binpad(s, out.data.data() + 33, 32);
+                if (is_canonical(out)) break;
+            }
+            BN_CTX_end(ctx.get());
+        }
+
+        /// The chain's canonical signature rule: neither r nor s has a leading byte to spare
+        static bool is_canonical(const signature& sig) {
+            const auto& c = sig.data;
+            return !(c[1] & 0x80) && !(c[1] == 0 && !(c[2] & 0x80)) && !(c[33] & 0x80) && !(c[33] == 0 && !(c[34] & 0x80));
+        }
+
+        /// The compressed public key a signature over `digest` was made with; for checking signatures offline
+        std::array<uint8_t, 33> recover(const eosio::checksum256& digest, const signature& sig) const {
+            auto   hash = digest.extract_as_byte_array();
+            bn_ctx local(BN_CTX_new());
+            BN_CTX_start(local.get());
+            BIGNUM* e = BN_CTX_get(local.get());
+            BIGNUM* r = BN_CTX_get(local.get());
+            BIGNUM* s = BN_CTX_get(local.get());
+            BIGNUM* x = BN_CTX_get(local.get());
+            BIGNUM* u1 = BN_CTX_get(local.get());
+            BIGNUM* u2 = BN_CTX_get(local.get());
+            BIGNUM* rinv = BN_CTX_get(local.get());
+            BN_bin2bn(hash.data(), 32, e);
+            BN_bin2bn(sig.data.data() + 1, 32, r);
+            BN_bin2bn(sig.data.data() + 33, 32, s);
+            int recovery = (sig.data[0] - 27) & 3;
+
+            // Q = r^-1 (s R - e G)
+            BN_copy(x, r);
+            if (recovery & 2) BN_add(x, x, order.get());
+            point candidate(EC_POINT_new(group.get())), q(EC_POINT_new(group.get()));
+            std::array<uint8_t, 33> key{};
+            if (EC_POINT_set_compressed_coordinates(group.get(), candidate.get(), x, recovery & 1, local.get()) == 1) {
+                BN_mod_inverse(rinv, r, order.get(), local.get());
+                BN_mod_mul(u1, e, rinv, order.get(), local.get());
+                BN_sub(u1, order.get(), u1);
+                BN_mod_mul(u2, s, rinv, order.get(), local.get());
+                EC_POINT_mul(group.get(), q.get(), u1, candidate.get(), u2, local.get());
+                EC_POINT_point2oct(group.get(), q.get(), POINT_CONVERSION_COMPRESSED, key.data(), 33, local.get());
+            }
+            BN_CTX_end(local.get());
+            return key;
+        }
+
+    private:
+        struct group_free {
+            void operator()(EC_GROUP* g) const { EC_GROUP_free(g); }
+        };
+        struct ctx_free {
+            void operator()(BN_CTX* c) const { BN_CTX_free(c); }
+        };
+        struct bn_free {
+            void operator()(BIGNUM* b) const { BN_clear_free(b); }
+        };
+        struct point_free {
+            void operator()(EC_POINT* p) const { EC_POINT_free(p); }
+        };
+
+        using bn_ctx = std::unique_ptr<BN_CTX, ctx_free>;
+        using bignum = std::unique_ptr<BIGNUM, bn_free>;
+        using point = std::unique_ptr<EC_POINT, point_free>;
+
+        std::unique_ptr<EC_GROUP, group_free> group;
+        bn_ctx                                ctx;
+        bignum                                d;
+        bignum                                order;
+        bignum                                half_order;
+        point                                 public_point;
+        point                                 nonce_point; // scratch for sign
+        std::array<uint8_t, 33>               public_key_bytes{};
+    };
+
+    static_assert(signer<k1_signer>);
+
+} // namespace client
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <gameplay/shard.hpp>
+
+#include <eosio/name.hpp>
+#include <eosio/time.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * Clients of a sharded gameplay deployment (see gameplay::setshards): the
+ * shard map that routes each player's plays to the account owning them,
+ * and the aggregator that sums the shards' getstats results into one view.
+ * The map must list the shards exactly as setshards was given them.
+ */
+namespace client {
+
+    class shard_map {
+    public:
+        explicit shard_map(std::vector<eosio::name> shards) : shards(std::move(shards)) {
+            if (this->shards.empty()) throw std::invalid_argument("a shard map needs at least one shard");
+        }
+
+        /// The shard account to send `player`'s plays to
+        eosio::name shard_for(eosio::name player) const {
+            return shards[dbltz_shard::shard_of(player.value, uint32_t(shards.size()))];
+        }
+
+        const std::vector<eosio::name>& accounts() const { return shards; }
+
+    private:
+        std::vector<eosio::name> shards;
+    };
+
+    /// gameplay's metrics window, as getstats returns it
+    struct metrics_window {
+        eosio::time_point     started;
+        uint64_t              plays = 0;
+        uint64_t              callbacks = 0;
+        uint64_t              expired = 0;
+        uint64_t              rejected = 0;
+        std::vector<uint64_t> latency_ms; // log2 buckets in milliseconds
+    };
+
+    /// gameplay::getstats' return value
+    struct shard_stats {
+        eosio::name    shard;
+        metrics_window metrics;
+        uint64_t       slots_capacity = 0;
+        uint64_t       slots_in_use = 0;
+        uint32_t       pool_depth = 0; // plays waiting for a draw
+        uint64_t       pool_served = 0;
+        uint64_t       pool_draws = 0;
+        bool           breaker_open = false;
+        uint64_t       breaker_trips = 0;
+    };
+
+    /// Every shard's counters summed
+    struct cluster_stats {
+        uint32_t       shards = 0;
+        uint32_t       breakers_open = 0; // shards currently shedding plays
+        metrics_window metrics;           // started: the earliest shard window
+        uint64_t       slots_capacity = 0;
+        uint64_t       slots_in_use = 0;
+        uint64_t       pool_depth = 0;
+        uint64_t       pool_served = 0;
+        uint64_t       pool_draws = 0;
+        uint64_t       breaker_trips = 0;
+        eosio::name    busiest;           // the shard with the most requests in flight
+
+        /// Fraction of all slots in use; how close the deployment is to needing another shard
+        double utilization() const { return slots_capacity ? double(slots_in_use) / double(slots_capacity) : 0; }
+    };
+
+    inline cluster_stats merge_stats(std::span<const shard_stats> shards) {
+        cluster_stats c;
+        uint64_t busiest_in_use = 0;
+        for (const auto& s : shards) {
+            if (c.shards++ == 0 || s.metrics.started < c.metrics.started) c.metrics.started = s.metrics.started;
+            c.metrics.plays += s.metrics.plays;
+            c.metrics.callbacks += s.metrics.callbacks;
+            c.metrics.expired += s.metrics.expired;
+            c.metrics.rejected += s.metrics.rejected;
+            if (c.metrics.latency_ms.size() < s.metrics.latency_ms.size()) c.metrics.latency_ms.resize(s.metrics.latency_ms.size());
+            for (size_t i = 0; i < s.metrics.latency_ms.size(); i++) c.metrics.latency_ms[i] += s.metrics.latency_ms[i];
+
+            c.slots_capacity += s.slots_capacity;
+            c.slots_in_use += s.slots_in_use;
+            c.pool_depth += s.pool_depth;
+            c.pool_served += s.pool_served;
+            c.pool_draws += s.pool_draws;
+            c.breakers_open += s.breaker_open;
+            c.breaker_trips += s.breaker_trips;
+            if (c.busiest == eosio::name() || s.slots_in_use > busiest_in_use) {
+                c.busiest = s.shard;
+                busiest_in_use = s.slots_in_use;
+            }
+        }
+        return c;
+    }
+
+} // namespace client
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/name.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Transactions for bots and load tests, packed straight into fixed buffers.
+ * A transaction_template is packed once; each transaction after that is the
+ * same bytes with the expiration, TaPoS and whichever action fields vary
+ * (usually a nonce) patched in place, then hashed and signed. Nothing here
+ * allocates.
+ *
+ *     client::transaction_template<> trx;
+ *     auto fields = trx.add<client::gameplay::playc>("gameplay"_n, {player}, player, uint64_t(1), uint8_t(0));
+ *     trx.finish();
+ *     for (uint64_t nonce = 1;; nonce++) {
+ *         trx.set_header(expiration, ref_block_num, ref_block_prefix);
+ *         trx.patch(fields[1], nonce);
+ *         signer.sign(trx.digest(chain_id), signature);
+ *     }
+ *
+ * The action types mirror the contracts' action signatures; the native
+ * contract builds static_assert that they still match.
+ */
+namespace client {
+
+    /// Bounds-checked writes into caller-owned memory
+    class writer {
+    public:
+        writer(char* begin, size_t capacity) : start(begin), pos(begin), end(begin + capacity) {}
+
+        void write(const void* data, size_t n) {
+            if (size_t(end - pos) < n) throw std::length_error("transaction buffer too small");
+            std::memcpy(pos, data, n);
+            pos += n;
+        }
+
+        template <typename T>
+        void put(T v) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            write(&v, sizeof(v));
+        }
+
+        void varuint32(uint32_t v) {
+            do {
+                uint8_t b = uint8_t(v & 0x7f);
+                v >>= 7;
+                put<uint8_t>(b | (v ? 0x80 : 0));
+            } while (v);
+        }
+
+        size_t size() const { return size_t(pos - start); }
+
+    private:
+        char* start;
+        char* pos;
+        char* end;
+    };
+
+    // Action argument packing, as eosio::pack does it
+    inline void pack(writer& w, bool v) { w.put<uint8_t>(v); }
+    inline void pack(writer& w, uint8_t v) { w.put(v); }
+    inline void pack(writer& w, uint16_t v) { w.put(v); }
+    inline void pack(writer& w, uint32_t v) { w.put(v); }
+    inline void pack(writer& w, uint64_t v) { w.put(v); }
+    inline void pack(writer& w, int64_t v) { w.put(v); }
+    inline void pack(writer& w, eosio::name v) { w.put(v.value); }
+
+    inline void pack(writer& w, const eosio::asset& v) {
+        w.put(v.amount);
+        w.put(v.symbol.raw());
+    }
+
+    inline void pack(writer& w, std::string_view v) {
+        w.varuint32(uint32_t(v.size()));
+        w.write(v.data(), v.size());
+    }
+
+    /// An action's name and argument types; strings are taken as string_view
+    template <uint64_t Name, typename... Args>
+    struct action_type {
+        static constexpr uint64_t name = Name;
+        static constexpr size_t   arity = sizeof...(Args);
+
+        static void pack_data(writer& w, const Args&... args) { (pack(w, args), ...); }
+    };
+
+    namespace gameplay {
+        using play = action_type<"play"_n.value, eosio::name, std::string_view>;
+        using playc = action_type<"playc"_n.value, eosio::name, uint64_t, uint8_t>;
+    } // namespace gameplay
+
+    namespace dbp_token {
+        using transfer = action_type<"transfer"_n.value, eosio::name, eosio::name, eosio::asset, std::string_view>;
+        using issue = action_type<"issue"_n.value, eosio::name, eosio::asset, std::string_view>;
+    } // namespace dbp_token
+
+    namespace detail {
+
+        template <typename T>
+        struct wire {
+            using type = std::remove_cvref_t<T>;
+        };
+
+        template <>
+        struct wire<const std::string&> {
+            using type = std::string_view;
+        };
+
+        template <>
+        struct wire<std::string> {
+            using type = std::string_view;
+        };
+
+        template <typename Method, typename Action>
+        struct matches : std::false_type {};
+
+        template <typename Contract, typename... Params, uint64_t Name, typename... Args>
+        struct matches<void (Contract::*)(Params...), action_type<Name, Args...>>
+            : std::bool_constant<(std::is_same_v<typename wire<Params>::type, Args> && ...)> {};
+
+    } // namespace detail
+
+    /// Whether `Action` packs the arguments of contract action `Method`
+    template <auto Method, typename Action>
+    inline constexpr bool signature_matches = detail::matches<decltype(Method), Action>::value;
+
+    struct permission {
+        eosio::name actor;
+        eosio::name level = "active"_n;
+    };
+
+    /// A transaction's packed bytes; the header is patched, the actions' fields patched by offset
+    template <size_t Capacity = 512>
+    class transaction_template {
+    public:
+        static constexpr size_t expiration_offset = 0;
+        static constexpr size_t ref_block_num_offset = 4;
+        static constexpr size_t ref_block_prefix_offset = 6;
+
+        transaction_template() {
+            writer w(bytes.data(), Capacity);
+            w.put<uint32_t>(0);    // expiration
+            w.put<uint16_t>(0);    // ref_block_num
+            w.put<uint32_t>(0);    // ref_block_prefix
+            w.varuint32(0);        // max_net_usage_words
+            w.put<uint8_t>(0);     // max_cpu_usage_ms
+            w.varuint32(0);        // delay_sec
+            w.varuint32(0);        // context_free_actions
+            actions_count_offset = w.size();
+            w.put<uint8_t>(0);     // actions, patched by add up to 127
+            length = w.size();
+        }
+
+        /**
+         * Append an action authorized by `auth`
+         * @return the offset of each argument, for patch()
+         */
+        template <typename Action, typename... Args>
+        std::array<size_t, Action::arity> add(eosio::name contract, permission auth, const Args&... args) {
+            if (finished) throw std::logic_error("transaction already finished");
+            if (actions == 127) throw std::length_error("too many actions for one transaction");
+
+            writer w(bytes.data() + length, Capacity - length);
+            w.put(contract.value);
+            w.put(Action::name);
+            w.varuint32(1);
+            w.put(auth.actor.value);
+            w.put(auth.level.value);
+
+            // The data's size prefix is written once the data is packed
+            char   data[Capacity];
+            writer d(data, sizeof(data));
+            std::array<size_t, Action::arity> offsets{};
+            size_t i = 0;
+            auto   one = [&](const auto& arg) {
+                offsets[i++] = d.size();
+                pack(d, arg);
+            };
+            (one(args), ...);
+
+            w.varuint32(uint32_t(d.size()));
+            size_t data_offset = length + w.size();
+            w.write(data, d.size());
+            for (auto& o : offsets) o += data_offset;
+
+            length += w.size();
+            bytes[actions_count_offset] = char(++actions);
+            return offsets;
+        }
+
+        /// Append the empty transaction_extensions; no more actions after this
+        void finish() {
+            if (finished) return;
+            writer w(bytes.data() + length, Capacity - length);
+            w.varuint32(0);
+            length += w.size();
+            finished = true;
+        }
+
+        void set_header(uint32_t expiration_sec, uint16_t ref_block_num, uint32_t ref_block_prefix) {
+            std::memcpy(bytes.data() + expiration_offset, &expiration_sec, 4);
+            std::memcpy(bytes.data() + ref_block_num_offset, &ref_block_num, 2);
+            std::memcpy(bytes.data() + ref_block_prefix_offset, &ref_block_prefix, 4);
+        }
+
+        /// Overwrite a fixed-size argument in place
+        template <typename T>
+        void patch(size_t offset, T value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            std::memcpy(bytes.data() + offset, &value, sizeof(value));
+        }
+
+        /**
+         * Overwrite a string argument with `value` in decimal, zero padded to
+         * the string's packed length, which stays the same; a string nonce
+         * packed as e.g. 20 zeros can take any 64-bit value
+         */
+        void patch_decimal(size_t offset, uint64_t value) {
+            if (offset >= length) throw std::out_of_range("no string field at offset");
+            size_t width = uint8_t(bytes[offset]); // strings under 128 bytes have a one-byte size
+            if (width >= 0x80 || offset + 1 + width > length) throw std::out_of_range("no string field at offset");
+            char*  digits = bytes.data() + offset + 1;
+            for (size_t i = width; i-- > 0; value /= 10) digits[i] = char('0' + value % 10);
+            if (value) throw std::length_error("nonce wider than its template");
+        }
+
+        /// The signing digest: sha256 of the chain id, the transaction, then the empty context-free data's 32 zeros
+        eosio::checksum256 digest(const eosio::checksum256& chain_id) const {
+            if (!finished) throw std::logic_error("transaction not finished");
+            char buffer[32 + Capacity + 32];
+            auto id = chain_id.extract_as_byte_array();
+            std::memcpy(buffer, id.data(), 32);
+            std::memcpy(buffer + 32, bytes.data(), length);
+            std::memset(buffer + 32 + length, 0, 32);
+            return eosio::sha256(buffer, uint32_t(64 + length));
+        }
+
+        std::string_view packed() const { return {bytes.data(), length}; }
+
+    private:
+        std::array<char, Capacity> bytes{};
+        size_t                     length = 0;
+        size_t                     actions_count_offset = 0;
+        uint8_t                    actions = 0;
+        bool                       finished = false;
+    };
+
+    /// A K1 signature as the chain packs it: the key type, then recovery byte, r and s
+    struct signature {
+        std::array<uint8_t, 65> data{};
+    };
+
+    /// Anything that signs a digest
+    template <typename S>
+    concept signer = requires(S& s, const eosio::checksum256& digest, signature& out) { s.sign(digest, out); };
+
+    template <signer S>
+    void sign_batch(S& s, std::span<const eosio::checksum256> digests, std::span<signature> out) {
+        if (out.size() < digests.size()) throw std::length_error("fewer signatures than digests");
+        for (size_t i = 0; i < digests.size(); i++) s.sign(digests[i], out[i]);
+    }
+
+    /**
+     * A packed_transaction, as push_transaction takes it: the signatures, no
+     * compression, no context-free data, then the transaction
+     * @return bytes written
+     */
+    template <size_t Capacity>
+    size_t pack_signed(char* out, size_t capacity, const transaction_template<Capacity>& trx,
+                       std::span<const signature> signatures) {
+        writer w(out, capacity);
+        w.varuint32(uint32_t(signatures.size()));
+        for (const auto& s : signatures) {
+            w.put<uint8_t>(0); // K1
+            w.write(s.data.data(), s.data.size());
+        }
+        w.put<uint8_t>(0); // compression: none
+        w.varuint32(0);    // packed_context_free_data
+        auto trx_bytes = trx.packed();
+        w.varuint32(uint32_t(trx_bytes.size()));
+        w.write(trx_bytes.data(), trx_bytes.size());
+        return w.size();
+    }
+
+} // namespace client
@@ -0,0 +1,14 @@
+#include <dbp_token/dbp_token.cpp>
+
+#include <client/tx.hpp>
+#include <contracts.hpp>
+#include <native/chain.hpp>
+
+static_assert(client::signature_matches<&dbp_token::transfer, client::dbp_token::transfer>);
+static_assert(client::signature_matches<&dbp_token::issue, client::dbp_token::issue>);
+
+namespace contracts {
+
+    NATIVE_APPLY(dbp_token_apply, dbp_token, (create)(issue)(transfer)(burn))
+
+} // namespace contracts
@@ -0,0 +1,17 @@
+#include <gameplay/gameplay.cpp>
+
+#include <client/tx.hpp>
+#include <contracts.hpp>
+
+// The client's packers must follow the actions they build
+static_assert(client::signature_matches<&gameplay::play, client::gameplay::play>);
+static_assert(client::signature_matches<&gameplay::playc, client::gameplay::playc>);
+
+namespace contracts {
+
+    // gameplay writes its own apply for the playc fast path
+    void gameplay_apply(uint64_t receiver, uint64_t code, uint64_t action) {
+        apply(receiver, code, action);
+    }
+
+} // namespace contracts
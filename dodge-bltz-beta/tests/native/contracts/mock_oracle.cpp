@@ -0,0 +1,10 @@
+#include "../../mock_oracle/mock_oracle.cpp"
+
+#include <contracts.hpp>
+#include <native/chain.hpp>
+
+namespace contracts {
+
+    NATIVE_APPLY(mock_oracle_apply, mock_oracle, (requestrand)(fulfill)(drop))
+
+} // namespace contracts
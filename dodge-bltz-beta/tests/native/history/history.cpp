@@ -0,0 +1,196 @@
+#include "history.hpp"
+#include "scan.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace history {
+
+    namespace {
+
+        namespace fs = std::filesystem;
+
+        /// The directory's segment files, by first block
+        std::vector<std::string> segment_paths(const std::string& dir) {
+            std::vector<std::string> paths;
+            for (const auto& entry : fs::directory_iterator(dir)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".seg") paths.push_back(entry.path().string());
+            }
+            std::sort(paths.begin(), paths.end());
+            return paths;
+        }
+
+        /// The posting positions of the entry's rows within [lo, hi)
+        std::pair<const uint32_t*, const uint32_t*> postings_between(const segment& s, const player_entry& e, uint32_t lo,
+                                                                     uint32_t hi) {
+            const uint32_t* begin = s.postings() + e.first;
+            const uint32_t* end = begin + e.count;
+            auto first = std::lower_bound(begin, end, lo);
+            return {first, std::lower_bound(first, end, hi)};
+        }
+
+    } // namespace
+
+    writer::writer(const std::string& dir, uint32_t partition_blocks) : dir(dir), partition(partition_blocks) {
+        if (partition == 0) throw std::invalid_argument("partition_blocks must be positive");
+        fs::create_directories(dir);
+
+        auto paths = segment_paths(dir);
+        if (paths.empty()) return;
+        segment latest(paths.back());
+        partition = latest.header().partition_blocks;
+        open_first = latest.header().first_block;
+        last = latest.header().last_sequence;
+        open.reserve(latest.rows());
+        for (uint32_t i = 0; i < latest.rows(); i++) open.push_back(latest.row(i));
+    }
+
+    writer::~writer() {
+        try {
+            flush();
+        } catch (...) {
+            // Unflushed outcomes are appended again on the next run
+        }
+    }
+
+    bool writer::append(uint64_t global_sequence, const outcome& o) {
+        if (global_sequence <= last) return false;
+        if (!open.empty() && o.block_num < open.back().block_num) {
+            throw std::runtime_error("outcome in block " + std::to_string(o.block_num) + " appended after block " +
+                                     std::to_string(open.back().block_num));
+        }
+
+        uint32_t first = o.block_num - o.block_num % partition;
+        if (first != open_first) {
+            if (first < open_first) {
+                throw std::runtime_error("outcome in block " + std::to_string(o.block_num) + " precedes the open partition");
+            }
+            flush();
+            open.clear();
+            open_first = first;
+        }
+        open.push_back(o);
+        last = global_sequence;
+        dirty = true;
+        return true;
+    }
+
+    void writer::flush() {
+        if (!dirty) return;
+        write_segment((fs::path(dir) / segment_name(open_first)).string(), open_first, partition, open, last);
+        dirty = false;
+    }
+
+    store::store(const std::string& dir) {
+        if (!fs::is_directory(dir)) throw std::runtime_error("no history in " + dir);
+        for (const auto& path : segment_paths(dir)) parts.emplace_back(path);
+    }
+
+    uint64_t store::rows() const {
+        uint64_t total = 0;
+        for (const auto& s : parts) total += s.rows();
+        return total;
+    }
+
+    std::vector<outcome> store::player_history(uint64_t player, window w, size_t limit) const {
+        std::vector<outcome> out;
+        for (auto s = parts.rbegin(); s != parts.rend() && out.size() < limit; ++s) {
+            if (s->rows() == 0 || s->min_block() >= w.to_block || s->max_block() < w.from_block) continue;
+            const player_entry* e = s->find(player);
+            if (!e) continue;
+
+            auto [lo, hi] = s->rows_between(w.from_block, w.to_block);
+            auto [first, last] = postings_between(*s, *e, lo, hi);
+            for (auto p = last; p != first && out.size() < limit;) out.push_back(s->row(*--p));
+        }
+        return out;
+    }
+
+    tally store::player_tally(uint64_t player, window w) const {
+        tally t;
+        for (const auto& s : parts) {
+            if (s.rows() == 0 || s.min_block() >= w.to_block || s.max_block() < w.from_block) continue;
+            const player_entry* e = s.find(player);
+            if (!e) continue;
+
+            if (w.covers(s.min_block(), s.max_block())) {
+                t.plays += e->count;
+                t.wins += e->wins;
+                t.reward += e->reward;
+                continue;
+            }
+            auto [lo, hi] = s.rows_between(w.from_block, w.to_block);
+            auto [first, last] = postings_between(s, *e, lo, hi);
+            t.plays += uint64_t(last - first);
+            for (auto p = first; p != last; ++p) {
+                t.wins += s.won()[*p];
+                t.reward += s.rewards()[*p];
+            }
+        }
+        return t;
+    }
+
+    tally store::overall(window w) const {
+        tally t;
+        for (const auto& s : parts) {
+            if (s.rows() == 0 || s.min_block() >= w.to_block || s.max_block() < w.from_block) continue;
+
+            if (w.covers(s.min_block(), s.max_block())) {
+                t.plays += s.rows();
+                t.wins += s.header().wins;
+                t.reward += s.header().reward;
+                continue;
+            }
+            auto [lo, hi] = s.rows_between(w.from_block, w.to_block);
+            t.plays += hi - lo;
+            t.wins += scan::count_set(s.won() + lo, hi - lo);
+            t.reward += scan::sum(s.rewards() + lo, hi - lo);
+        }
+        return t;
+    }
+
+    std::vector<leader> store::top(size_t n, window w, rank by) const {
+        // Only wins earn reward, so losing rows never matter here
+        std::unordered_map<uint64_t, leader> totals;
+        for (const auto& s : parts) {
+            if (s.rows() == 0 || s.min_block() >= w.to_block || s.max_block() < w.from_block) continue;
+
+            if (w.covers(s.min_block(), s.max_block())) {
+                for (const auto& e : s.index()) {
+                    if (e.wins == 0) continue;
+                    auto& l = totals[e.player];
+                    l.wins += e.wins;
+                    l.reward += e.reward;
+                }
+                continue;
+            }
+            auto [lo, hi] = s.rows_between(w.from_block, w.to_block);
+            const uint64_t* players = s.players();
+            const int64_t*  rewards = s.rewards();
+            scan::for_each_set(s.won(), lo, hi, [&](size_t row) {
+                auto& l = totals[players[row]];
+                l.wins++;
+                l.reward += rewards[row];
+            });
+        }
+
+        std::vector<leader> leaders;
+        leaders.reserve(totals.size());
+        for (auto& [player, l] : totals) {
+            l.player = player;
+            leaders.push_back(l);
+        }
+        auto better = [by](const leader& a, const leader& b) {
+            auto ka = by == rank::reward ? std::pair{a.reward, int64_t(a.wins)} : std::pair{int64_t(a.wins), a.reward};
+            auto kb = by == rank::reward ? std::pair{b.reward, int64_t(b.wins)} : std::pair{int64_t(b.wins), b.reward};
+            return ka != kb ? ka > kb : a.player < b.player;
+        };
+        n = std::min(n, leaders.size());
+        std::partial_sort(leaders.begin(), leaders.begin() + std::ptrdiff_t(n), leaders.end(), better);
+        leaders.resize(n);
+        return leaders;
+    }
+
+} // namespace history
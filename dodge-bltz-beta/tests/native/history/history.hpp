@@ -0,0 +1,105 @@
+#pragma once
+
+#include "segment.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * Play history by player and by time: the settled outcomes of the gameplay
+ * contract in one directory of time-partitioned columnar segments. Blocks
+ * are the clock; at two blocks a second, a day is 172800 blocks.
+ */
+namespace history {
+
+    inline constexpr uint32_t default_partition_blocks = 172800;
+
+    /// Blocks [from_block, to_block)
+    struct window {
+        uint32_t from_block = 0;
+        uint32_t to_block = std::numeric_limits<uint32_t>::max();
+
+        bool covers(uint32_t first, uint32_t last) const { return from_block <= first && last < to_block; }
+    };
+
+    struct tally {
+        uint64_t plays = 0;
+        uint64_t wins = 0;
+        int64_t  reward = 0;
+
+        double win_rate() const { return plays ? double(wins) / double(plays) : 0.0; }
+    };
+
+    struct leader {
+        uint64_t player = 0;
+        uint64_t wins = 0;
+        int64_t  reward = 0;
+    };
+
+    enum class rank { reward, wins };
+
+    /**
+     * Appends outcomes in settlement order. The partition being filled is
+     * kept in memory and written out whole when the next one starts or on
+     * flush(); reopening a directory picks that partition up again.
+     * Outcomes at or below the last stored global sequence are skipped.
+     */
+    class writer {
+    public:
+        /// `partition_blocks` applies to a new directory; an existing one keeps its own
+        explicit writer(const std::string& dir, uint32_t partition_blocks = default_partition_blocks);
+        ~writer();
+
+        writer(const writer&) = delete;
+        writer& operator=(const writer&) = delete;
+
+        /// @return false if the outcome was already stored
+        /// @throws std::runtime_error if it was settled before the last outcome appended
+        bool append(uint64_t global_sequence, const outcome& o);
+
+        void flush();
+
+        uint64_t last_sequence() const { return last; }
+
+        uint32_t partition_blocks() const { return partition; }
+
+    private:
+        std::string          dir;
+        uint32_t             partition;
+        uint32_t             open_first = 0; // the partition in `open`
+        std::vector<outcome> open;
+        uint64_t             last = 0;
+        bool                 dirty = false;
+    };
+
+    /**
+     * The queries, over every segment of a directory as it was when opened.
+     * Whole segments inside a window are answered from their player index;
+     * only the segments at its edges are scanned.
+     */
+    class store {
+    public:
+        explicit store(const std::string& dir);
+
+        /// The player's outcomes in the window, newest first
+        std::vector<outcome> player_history(uint64_t player, window w = {}, size_t limit = 100) const;
+
+        tally player_tally(uint64_t player, window w = {}) const;
+
+        /// Every player's outcomes in the window together
+        tally overall(window w = {}) const;
+
+        /// The `n` players with the most reward, or wins, in the window; ties go to the lower account
+        std::vector<leader> top(size_t n, window w = {}, rank by = rank::reward) const;
+
+        size_t segments() const { return parts.size(); }
+
+        uint64_t rows() const;
+
+    private:
+        std::vector<segment> parts; // by first block
+    };
+
+} // namespace history
@@ -0,0 +1,42 @@
+#include "import.hpp"
+
+#include <records.hpp>
+
+#include <algorithm>
+
+namespace history {
+
+    import_summary import_records(const std::string& records_dir, writer& out) {
+        auto results = ingest::read_records<ingest::result_record>(records_dir + "/results.bin", ingest::record_kind::result);
+        auto issues = ingest::read_records<ingest::issue_record>(records_dir + "/issues.bin", ingest::record_kind::issue);
+
+        import_summary s;
+        uint64_t last = out.last_sequence();
+        auto from = std::upper_bound(results.begin(), results.end(), last,
+                                     [](uint64_t seq, const ingest::result_record& r) { return seq < r.global_sequence; });
+        s.results = uint64_t(results.end() - from);
+
+        // Both files are in chain order, so the issues of each block are found walking alongside
+        std::vector<bool> claimed(issues.size());
+        size_t block_start = 0;
+        for (auto r = from; r != results.end(); ++r) {
+            while (block_start < issues.size() && issues[block_start].block_num < r->block_num) block_start++;
+
+            outcome o{r->player, r->block_num, uint8_t(std::min<uint32_t>(r->roll, 255)), r->won != 0, 0};
+            if (o.won) {
+                for (size_t i = block_start; i < issues.size() && issues[i].block_num == r->block_num; i++) {
+                    if (!claimed[i] && issues[i].to == r->player) {
+                        claimed[i] = true;
+                        o.reward = issues[i].amount;
+                        s.rewards++;
+                        break;
+                    }
+                }
+            }
+            s.appended += out.append(r->global_sequence, o);
+        }
+        out.flush();
+        return s;
+    }
+
+} // namespace history
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "history.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace history {
+
+    struct import_summary {
+        uint64_t results = 0;  // logresult records read
+        uint64_t appended = 0; // outcomes new to the history
+        uint64_t rewards = 0;  // wins matched to their issue
+    };
+
+    /**
+     * Append the outcomes in an ingest record directory to the history. Each
+     * beta logresult is one outcome; a win's reward is the issue to the same
+     * player in the same block, sent from the same settlement. Wins since
+     * the contract credits them for claim are paid later and import with a
+     * reward of 0. dodge-bltz logs no results, so its records hold no
+     * outcomes to import.
+     */
+    import_summary import_records(const std::string& records_dir, writer& out);
+
+} // namespace history
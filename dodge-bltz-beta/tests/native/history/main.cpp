@@ -0,0 +1,123 @@
+#include "history.hpp"
+#include "import.hpp"
+
+#include <eosio/name.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    const char* const usage =
+        "usage: history import RECORDS_DIR HISTORY_DIR [--partition-blocks N]\n"
+        "       history player HISTORY_DIR ACCOUNT [--limit N]\n"
+        "       history winrate HISTORY_DIR [ACCOUNT]\n"
+        "       history top HISTORY_DIR [--n N] [--by reward|wins]\n"
+        "queries take --from BLOCK --to BLOCK to restrict them to blocks [from, to)\n";
+
+    struct arguments {
+        std::vector<std::string> paths;
+        history::window          w;
+        uint32_t                 partition_blocks = history::default_partition_blocks;
+        size_t                   limit = 20;
+        size_t                   n = 10;
+        history::rank            by = history::rank::reward;
+    };
+
+    arguments parse(int argc, char** argv) {
+        arguments args;
+        for (int i = 0; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                args.paths.push_back(arg);
+                continue;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            std::string value = argv[++i];
+            if (arg == "--from") args.w.from_block = uint32_t(std::stoul(value));
+            else if (arg == "--to") args.w.to_block = uint32_t(std::stoul(value));
+            else if (arg == "--partition-blocks") args.partition_blocks = uint32_t(std::stoul(value));
+            else if (arg == "--limit") args.limit = std::stoul(value);
+            else if (arg == "--n") args.n = std::stoul(value);
+            else if (arg == "--by") {
+                if (value != "reward" && value != "wins") throw std::invalid_argument("unknown ranking " + value);
+                args.by = value == "reward" ? history::rank::reward : history::rank::wins;
+            } else throw std::invalid_argument("unknown option " + arg);
+        }
+        return args;
+    }
+
+    /// Run a query, printing how long it took
+    template <typename F>
+    auto timed(F&& query) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = query();
+        auto us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        std::printf("query         %.1f us\n", us);
+        return result;
+    }
+
+    void print(const history::tally& t) {
+        std::printf("plays         %llu\n", (unsigned long long)t.plays);
+        std::printf("wins          %llu (%.2f%%)\n", (unsigned long long)t.wins, 100 * t.win_rate());
+        std::printf("reward        %lld\n", (long long)t.reward);
+    }
+
+    int import(const arguments& args) {
+        if (args.paths.size() != 2) throw std::invalid_argument("import takes a record directory and a history directory");
+        history::writer out(args.paths[1], args.partition_blocks);
+        auto s = history::import_records(args.paths[0], out);
+        std::printf("results       %llu read, %llu new, %llu rewards matched\n", (unsigned long long)s.results,
+                    (unsigned long long)s.appended, (unsigned long long)s.rewards);
+        return 0;
+    }
+
+    int query(const std::string& command, const arguments& args) {
+        if (args.paths.empty()) throw std::invalid_argument(command + " needs a history directory");
+        history::store store(args.paths[0]);
+        std::printf("history       %llu outcomes in %zu segments\n", (unsigned long long)store.rows(), store.segments());
+
+        if (command == "player") {
+            if (args.paths.size() != 2) throw std::invalid_argument("player takes one account");
+            uint64_t player = eosio::name(args.paths[1]).value;
+            auto rows = timed([&] { return store.player_history(player, args.w, args.limit); });
+            for (const auto& o : rows) {
+                std::printf("%10u  roll %2u  %s  %lld\n", o.block_num, unsigned(o.roll), o.won ? "won " : "lost",
+                            (long long)o.reward);
+            }
+            print(timed([&] { return store.player_tally(player, args.w); }));
+        } else if (command == "winrate") {
+            if (args.paths.size() > 2) throw std::invalid_argument("winrate takes at most one account");
+            if (args.paths.size() == 2) {
+                uint64_t player = eosio::name(args.paths[1]).value;
+                print(timed([&] { return store.player_tally(player, args.w); }));
+            } else {
+                print(timed([&] { return store.overall(args.w); }));
+            }
+        } else {
+            if (args.paths.size() != 1) throw std::invalid_argument("top takes no account");
+            auto leaders = timed([&] { return store.top(args.n, args.w, args.by); });
+            for (const auto& l : leaders) {
+                std::printf("%-13s %8llu wins  %lld\n", eosio::name(l.player).to_string().c_str(), (unsigned long long)l.wins,
+                            (long long)l.reward);
+            }
+        }
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        std::string command = argc > 1 ? argv[1] : "";
+        if (command == "import") return import(parse(argc - 2, argv + 2));
+        if (command == "player" || command == "winrate" || command == "top") return query(command, parse(argc - 2, argv + 2));
+        std::cerr << usage;
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "history: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Column scans for the history queries. SSE2 is part of x86-64, so those
+ * builds always take the vector paths; other targets get the scalar loops.
+ */
+namespace history::scan {
+
+    /// Number of nonzero bytes in `bytes[0, n)`; the won column holds only 0 and 1
+    inline uint64_t count_set(const uint8_t* bytes, size_t n) {
+        uint64_t total = 0;
+        size_t   i = 0;
+#if defined(__SSE2__)
+        // 255 chunks of 16 ones at most per lane before the byte sums could wrap
+        const __m128i zero = _mm_setzero_si128();
+        while (n - i >= 16) {
+            size_t  end = i + 16 * std::min<size_t>((n - i) / 16, 255);
+            __m128i acc = zero;
+            for (; i < end; i += 16) acc = _mm_add_epi8(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)));
+            __m128i sums = _mm_sad_epu8(acc, zero);
+            total += uint64_t(_mm_cvtsi128_si64(sums)) + uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+        }
+#endif
+        for (; i < n; i++) total += bytes[i] != 0;
+        return total;
+    }
+
+    /// Sum of `values[0, n)`
+    inline int64_t sum(const int64_t* values, size_t n) {
+        int64_t total = 0;
+        size_t  i = 0;
+#if defined(__SSE2__)
+        __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+        for (; n - i >= 4; i += 4) {
+            acc0 = _mm_add_epi64(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+            acc1 = _mm_add_epi64(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 2)));
+        }
+        __m128i acc = _mm_add_epi64(acc0, acc1);
+        total = _mm_cvtsi128_si64(acc) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(acc, acc));
+#endif
+        for (; i < n; i++) total += values[i];
+        return total;
+    }
+
+    /// Call `f(row)` for each row in [lo, hi) whose byte is nonzero, sixteen rows to a test
+    template <typename F>
+    inline void for_each_set(const uint8_t* bytes, size_t lo, size_t hi, F&& f) {
+        size_t i = lo;
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        for (; hi - i >= 16; i += 16) {
+            __m128i  chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+            unsigned mask = ~unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero))) & 0xffff;
+            while (mask) {
+                f(i + unsigned(__builtin_ctz(mask)));
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; i < hi; i++) {
+            if (bytes[i]) f(i);
+        }
+    }
+
+} // namespace history::scan
@@ -0,0 +1,176 @@
+#include "segment.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace history {
+
+    namespace {
+
+        constexpr char     magic[4] = {'D', 'B', 'H', 'S'};
+        constexpr uint16_t format_version = 1;
+        constexpr uint64_t alignment = 64;
+
+        uint64_t align(uint64_t offset) { return (offset + alignment - 1) & ~(alignment - 1); }
+
+        /// Section offsets for a segment of this many rows and players; the last is the file size
+        std::vector<uint64_t> layout(uint64_t rows, uint64_t players) {
+            const uint64_t sizes[7] = {8 * rows, 4 * rows, rows, rows, 8 * rows, sizeof(player_entry) * players, 4 * rows};
+            std::vector<uint64_t> offsets;
+            uint64_t at = sizeof(segment_header);
+            for (uint64_t size : sizes) {
+                at = align(at);
+                offsets.push_back(at);
+                at += size;
+            }
+            offsets.push_back(at);
+            return offsets;
+        }
+
+        template <typename T>
+        void put(std::ofstream& out, uint64_t offset, const std::vector<T>& values) {
+            out.seekp(std::streamoff(offset));
+            out.write(reinterpret_cast<const char*>(values.data()), std::streamsize(values.size() * sizeof(T)));
+        }
+
+    } // namespace
+
+    segment::segment(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot read " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        length = size_t(st.st_size);
+        if (length < sizeof(segment_header)) {
+            ::close(fd);
+            throw std::runtime_error(path + ": truncated segment");
+        }
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+        data = static_cast<const char*>(mapped);
+
+        const auto& h = header();
+        auto fail = [&](const char* what) {
+            ::munmap(const_cast<char*>(data), length);
+            data = nullptr;
+            throw std::runtime_error(path + ": " + what);
+        };
+        if (std::memcmp(h.magic, magic, sizeof(magic)) != 0) fail("not a history segment");
+        if (h.version != format_version) fail("unsupported history segment version");
+        auto offsets = layout(h.rows, h.players);
+        if (!std::equal(h.offsets, h.offsets + 7, offsets.begin()) || offsets.back() != length) fail("truncated segment");
+    }
+
+    segment::~segment() {
+        if (data) ::munmap(const_cast<char*>(data), length);
+    }
+
+    segment::segment(segment&& other) noexcept : data(std::exchange(other.data, nullptr)), length(other.length) {}
+
+    segment& segment::operator=(segment&& other) noexcept {
+        if (this != &other) {
+            if (data) ::munmap(const_cast<char*>(data), length);
+            data = std::exchange(other.data, nullptr);
+            length = other.length;
+        }
+        return *this;
+    }
+
+    const player_entry* segment::find(uint64_t player) const {
+        auto entries = index();
+        auto it = std::lower_bound(entries.begin(), entries.end(), player,
+                                   [](const player_entry& e, uint64_t p) { return e.player < p; });
+        return it != entries.end() && it->player == player ? &*it : nullptr;
+    }
+
+    std::pair<uint32_t, uint32_t> segment::rows_between(uint32_t from_block, uint32_t to_block) const {
+        const uint32_t* begin = blocks();
+        const uint32_t* end = begin + rows();
+        auto lo = std::lower_bound(begin, end, from_block);
+        auto hi = std::lower_bound(lo, end, to_block);
+        return {uint32_t(lo - begin), uint32_t(hi - begin)};
+    }
+
+    void write_segment(const std::string& path, uint32_t first_block, uint32_t partition_blocks,
+                       const std::vector<outcome>& rows, uint64_t last_sequence) {
+        uint32_t n = uint32_t(rows.size());
+
+        // Group row numbers by player, keeping each player's rows in order
+        std::vector<uint32_t> postings(n);
+        for (uint32_t i = 0; i < n; i++) postings[i] = i;
+        std::stable_sort(postings.begin(), postings.end(),
+                         [&](uint32_t a, uint32_t b) { return rows[a].player < rows[b].player; });
+
+        std::vector<player_entry> entries;
+        for (uint32_t i = 0; i < n; i++) {
+            const auto& r = rows[postings[i]];
+            if (entries.empty() || entries.back().player != r.player) entries.push_back({r.player, i, 0, 0, 0, 0});
+            entries.back().count++;
+            entries.back().wins += r.won;
+            entries.back().reward += r.reward;
+        }
+
+        std::vector<uint64_t> players(n);
+        std::vector<uint32_t> blocks(n);
+        std::vector<uint8_t>  rolls(n), won(n);
+        std::vector<int64_t>  rewards(n);
+        segment_header h{};
+        for (uint32_t i = 0; i < n; i++) {
+            players[i] = rows[i].player;
+            blocks[i] = rows[i].block_num;
+            rolls[i] = rows[i].roll;
+            won[i] = rows[i].won;
+            rewards[i] = rows[i].reward;
+            h.wins += rows[i].won;
+            h.reward += rows[i].reward;
+        }
+
+        std::memcpy(h.magic, magic, sizeof(magic));
+        h.version = format_version;
+        h.rows = n;
+        h.players = uint32_t(entries.size());
+        h.first_block = first_block;
+        h.partition_blocks = partition_blocks;
+        h.last_sequence = last_sequence;
+        auto offsets = layout(h.rows, h.players);
+        std::copy(offsets.begin(), offsets.begin() + 7, h.offsets);
+
+        // Readers may have the old version mapped; they keep it until they reopen
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("cannot write " + temp);
+            out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+            put(out, h.offsets[0], players);
+            put(out, h.offsets[1], blocks);
+            put(out, h.offsets[2], rolls);
+            put(out, h.offsets[3], won);
+            put(out, h.offsets[4], rewards);
+            put(out, h.offsets[5], entries);
+            put(out, h.offsets[6], postings);
+            if (!out) throw std::runtime_error("cannot write " + temp);
+        }
+        std::filesystem::resize_file(temp, offsets.back());
+        std::filesystem::rename(temp, path);
+    }
+
+    std::string segment_name(uint32_t first_block) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%010u.seg", first_block);
+        return name;
+    }
+
+} // namespace history
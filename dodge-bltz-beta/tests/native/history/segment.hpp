@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * One time partition of the play history: every outcome settled in a fixed
+ * span of blocks, stored column by column in a single file that readers
+ * map. Rows are in settlement order, so the block column is sorted.
+ *
+ *     header                  128 bytes, below
+ *     uint64 player[rows]
+ *     uint32 block[rows]
+ *     uint8  roll[rows]
+ *     uint8  won[rows]
+ *     int64  reward[rows]
+ *     player_entry[players]   sorted by player
+ *     uint32 postings[rows]   row numbers grouped by player, ascending
+ *
+ * Every section starts on a 64-byte boundary.
+ */
+namespace history {
+
+    /// One settled play
+    struct outcome {
+        uint64_t player = 0;
+        uint32_t block_num = 0;
+        uint8_t  roll = 0;
+        bool     won = false;
+        int64_t  reward = 0; // token units issued for the win, 0 for a loss
+    };
+
+    /// A player's rows in one segment, with their totals
+    struct player_entry {
+        uint64_t player;
+        uint32_t first;    // into the postings
+        uint32_t count;
+        uint32_t wins;
+        uint32_t reserved;
+        int64_t  reward;
+    };
+    static_assert(sizeof(player_entry) == 32);
+
+    struct segment_header {
+        char     magic[4]; // "DBHS"
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t rows;
+        uint32_t players;
+        uint32_t first_block;      // the partition's first block
+        uint32_t partition_blocks; // blocks per partition
+        uint64_t last_sequence;    // global sequence of the last outcome stored
+        uint64_t wins;
+        int64_t  reward;
+        uint64_t offsets[7];       // player, block, roll, won, reward, index, postings
+        uint8_t  padding[24];
+    };
+    static_assert(sizeof(segment_header) == 128);
+
+    /// A segment file mapped read-only
+    class segment {
+    public:
+        explicit segment(const std::string& path);
+        ~segment();
+
+        segment(segment&& other) noexcept;
+        segment& operator=(segment&& other) noexcept;
+        segment(const segment&) = delete;
+        segment& operator=(const segment&) = delete;
+
+        const segment_header& header() const { return *reinterpret_cast<const segment_header*>(data); }
+
+        uint32_t rows() const { return header().rows; }
+
+        const uint64_t* players() const { return column<uint64_t>(0); }
+        const uint32_t* blocks() const { return column<uint32_t>(1); }
+        const uint8_t*  rolls() const { return column<uint8_t>(2); }
+        const uint8_t*  won() const { return column<uint8_t>(3); }
+        const int64_t*  rewards() const { return column<int64_t>(4); }
+        const uint32_t* postings() const { return column<uint32_t>(6); }
+
+        std::span<const player_entry> index() const { return {column<player_entry>(5), header().players}; }
+
+        /// The player's entry, or nullptr if they did not play in this partition
+        const player_entry* find(uint64_t player) const;
+
+        /// Rows [first, second) settled in blocks [from_block, to_block)
+        std::pair<uint32_t, uint32_t> rows_between(uint32_t from_block, uint32_t to_block) const;
+
+        /// Block of the first and last row; the segment's rows all lie within
+        uint32_t min_block() const { return rows() ? blocks()[0] : header().first_block; }
+        uint32_t max_block() const { return rows() ? blocks()[rows() - 1] : header().first_block; }
+
+        outcome row(uint32_t i) const { return {players()[i], blocks()[i], rolls()[i], won()[i] != 0, rewards()[i]}; }
+
+    private:
+        template <typename T>
+        const T* column(int i) const { return reinterpret_cast<const T*>(data + header().offsets[i]); }
+
+        const char* data = nullptr;
+        size_t      length = 0;
+    };
+
+    /// Write a partition's rows as a segment, replacing any earlier version of it atomically
+    void write_segment(const std::string& path, uint32_t first_block, uint32_t partition_blocks,
+                       const std::vector<outcome>& rows, uint64_t last_sequence);
+
+    /// The file name of the partition starting at `first_block`, ordered by block when sorted by name
+    std::string segment_name(uint32_t first_block);
+
+} // namespace history
@@ -0,0 +1,278 @@
+#include "decoder.hpp"
+
+#include <eosio/name.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace ingest {
+
+    namespace {
+
+        constexpr uint8_t executed = 0; // transaction_status
+
+        // K1 and R1 signatures: type then 65 bytes; WebAuthn adds its auth data and client JSON
+        constexpr uint32_t webauthn_signature = 2;
+        constexpr size_t   signature_bytes = 65;
+
+        /// A cursor over packed bytes that reads in place and only checks bounds
+        struct cursor {
+            const char* pos;
+            const char* end;
+
+            void need(size_t n) const {
+                if (size_t(end - pos) < n) throw std::runtime_error("truncated transaction trace");
+            }
+
+            void skip(size_t n) {
+                need(n);
+                pos += n;
+            }
+
+            uint8_t u8() {
+                need(1);
+                return uint8_t(*pos++);
+            }
+
+            uint64_t u64() {
+                need(8);
+                uint64_t v;
+                std::memcpy(&v, pos, 8);
+                pos += 8;
+                return v;
+            }
+
+            uint32_t varuint32() {
+                uint32_t v = 0;
+                for (int shift = 0; shift < 35; shift += 7) {
+                    uint8_t b = u8();
+                    v |= uint32_t(b & 0x7f) << shift;
+                    if (!(b & 0x80)) return v;
+                }
+                throw std::runtime_error("overlong varuint32 in transaction trace");
+            }
+
+            std::string_view bytes() {
+                uint32_t size = varuint32();
+                need(size);
+                std::string_view view(pos, size);
+                pos += size;
+                return view;
+            }
+
+            bool present() { return u8() != 0; }
+
+            void skip_bytes() { skip(varuint32()); }
+
+            void skip_vector(size_t element_size) {
+                uint32_t n = varuint32();
+                if (element_size && n > size_t(end - pos) / element_size) throw std::runtime_error("truncated transaction trace");
+                skip(n * element_size);
+            }
+        };
+
+        uint64_t load_u64(const char* p) {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            return v;
+        }
+
+        uint64_t fnv1a(std::string_view s) {
+            uint64_t h = 0xcbf29ce484222325ULL;
+            for (unsigned char c : s) {
+                h ^= c;
+                h *= 0x100000001b3ULL;
+            }
+            return h;
+        }
+
+        /// One action's data, read through the layout its contract declares
+        class action_decoder {
+        public:
+            action_decoder(const contracts& ours, batch& out, decode_stats& stats, uint32_t block_num)
+                : ours(ours), out(out), stats(stats), block_num(block_num) {}
+
+            void decode(uint64_t global_sequence, uint64_t account, uint64_t name, std::string_view data) {
+                bool fits = true;
+                if (account == ours.gameplay) {
+                    fits = gameplay(global_sequence, name, data);
+                } else if (account == ours.token) {
+                    fits = token(global_sequence, name, data);
+                }
+                if (!fits) stats.malformed++;
+            }
+
+        private:
+            bool gameplay(uint64_t seq, uint64_t name, std::string_view data) {
+                const char* p = data.data();
+                bool beta = ours.variant == layout::beta;
+
+                if (name == "play"_n.value) {
+                    play_record r{seq, ours.gameplay, 0, 0, block_num, 0, 0, 0};
+                    if (beta) {
+                        if (data.size() < 9) return false;
+                        cursor c{p + 8, p + data.size()};
+                        try {
+                            r.nonce = fnv1a(c.bytes());
+                        } catch (const std::runtime_error&) {
+                            return false;
+                        }
+                    } else {
+                        if (data.size() != 16) return false;
+                        r.nonce = load_u64(p + 8);
+                    }
+                    r.player = load_u64(p);
+                    out.plays.push_back(r);
+                } else if (beta && name == "playc"_n.value) {
+                    if (data.size() != 16 && data.size() != 17) return false;
+                    uint8_t flags = data.size() == 17 ? uint8_t(p[16]) : 0;
+                    out.plays.push_back({seq, ours.gameplay, load_u64(p), load_u64(p + 8), block_num, 1, flags, 0});
+                } else if (name == "receiverand"_n.value) {
+                    callback_record r{seq, ours.gameplay, 0, 0, block_num, 0, {}};
+                    if (data.size() != (beta ? 40u : 48u)) return false;
+                    r.request_id = load_u64(p);
+                    if (beta) {
+                        std::memcpy(r.random_value, p + 8, 32);
+                        for (int i = 0; i < 8; i++) r.random_word = (r.random_word << 8) | uint8_t(p[8 + i]);
+                    } else {
+                        std::memcpy(r.random_value, p + 8, 32);
+                        r.random_word = load_u64(p + 40);
+                    }
+                    out.callbacks.push_back(r);
+                } else if (beta && name == "logresult"_n.value) {
+                    if (data.size() != 13) return false;
+                    uint32_t roll;
+                    std::memcpy(&roll, p + 9, 4);
+                    out.results.push_back({seq, ours.gameplay, load_u64(p), block_num, roll, uint8_t(p[8] != 0), {}});
+                } else {
+                    return true;
+                }
+                stats.matched++;
+                return true;
+            }
+
+            bool token(uint64_t seq, uint64_t name, std::string_view data) {
+                const char* p = data.data();
+                if (name == "issue"_n.value) {
+                    if (data.size() < 25) return false; // to, asset, memo
+                    out.issues.push_back({seq, ours.token, load_u64(p), int64_t(load_u64(p + 8)), load_u64(p + 16), block_num, 0});
+                } else if (name == "transfer"_n.value) {
+                    if (data.size() < 33) return false; // from, to, asset, memo
+                    out.transfers.push_back({seq, ours.token, load_u64(p), load_u64(p + 8), int64_t(load_u64(p + 16)),
+                                             load_u64(p + 24), block_num, 0});
+                } else {
+                    return true;
+                }
+                stats.matched++;
+                return true;
+            }
+
+            const contracts& ours;
+            batch&           out;
+            decode_stats&    stats;
+            uint32_t         block_num;
+        };
+
+        void skip_transaction_trace(cursor& c);
+
+        /// action_trace_v0, or v1 with its return value
+        void action_trace(cursor& c, bool emit, action_decoder& actions, decode_stats& stats) {
+            uint32_t version = c.varuint32();
+            if (version > 1) throw std::runtime_error("unknown action_trace version " + std::to_string(version));
+
+            c.varuint32(); // action_ordinal
+            c.varuint32(); // creator_action_ordinal
+
+            uint64_t global_sequence = 0;
+            bool has_receipt = c.present();
+            if (has_receipt) {
+                if (c.varuint32() != 0) throw std::runtime_error("unknown action_receipt version");
+                c.skip(8 + 32);         // receiver, act_digest
+                global_sequence = c.u64();
+                c.skip(8);              // recv_sequence
+                c.skip_vector(16);      // auth_sequence
+                c.varuint32();          // code_sequence
+                c.varuint32();          // abi_sequence
+            }
+
+            uint64_t receiver = c.u64();
+            uint64_t account = c.u64();
+            uint64_t name = c.u64();
+            c.skip_vector(16);          // authorization
+            std::string_view data = c.bytes();
+
+            c.skip(1 + 8);              // context_free, elapsed
+            c.skip_bytes();             // console
+            c.skip_vector(16);          // account_ram_deltas
+            if (c.present()) c.skip_bytes(); // except
+            if (c.present()) c.skip(8);      // error_code
+            if (version == 1) c.skip_bytes(); // return_value
+
+            stats.actions++;
+            if (emit && has_receipt && receiver == account) actions.decode(global_sequence, account, name, data);
+        }
+
+        void skip_partial_transaction(cursor& c) {
+            if (c.varuint32() != 0) throw std::runtime_error("unknown partial_transaction version");
+            c.skip(4 + 2 + 4);          // expiration, ref_block_num, ref_block_prefix
+            c.varuint32();              // max_net_usage_words
+            c.skip(1);                  // max_cpu_usage_ms
+            c.varuint32();              // delay_sec
+
+            for (uint32_t n = c.varuint32(); n > 0; n--) { // transaction_extensions
+                c.skip(2);
+                c.skip_bytes();
+            }
+            for (uint32_t n = c.varuint32(); n > 0; n--) { // signatures
+                uint32_t type = c.varuint32();
+                c.skip(signature_bytes);
+                if (type == webauthn_signature) {
+                    c.skip_bytes();     // auth_data
+                    c.skip_bytes();     // client_json
+                }
+            }
+            for (uint32_t n = c.varuint32(); n > 0; n--) c.skip_bytes(); // context_free_data
+        }
+
+        /// transaction_trace_v0; its actions produce records only when it executed
+        void transaction_trace(cursor& c, bool top_level, action_decoder& actions, decode_stats& stats) {
+            if (c.varuint32() != 0) throw std::runtime_error("unknown transaction_trace version");
+
+            c.skip(32);                 // id
+            uint8_t status = c.u8();
+            c.skip(4);                  // cpu_usage_us
+            c.varuint32();              // net_usage_words
+            c.skip(8 + 8 + 1);          // elapsed, net_usage, scheduled
+
+            bool emit = top_level && status == executed;
+            if (emit) stats.transactions++;
+            for (uint32_t n = c.varuint32(); n > 0; n--) action_trace(c, emit, actions, stats);
+
+            if (c.present()) c.skip(16);     // account_ram_delta
+            if (c.present()) c.skip_bytes(); // except
+            if (c.present()) c.skip(8);      // error_code
+            if (c.present()) skip_transaction_trace(c); // failed_dtrx_trace
+            if (c.present()) skip_partial_transaction(c);
+        }
+
+        void skip_transaction_trace(cursor& c) {
+            decode_stats ignored;
+            batch none;
+            contracts nobody;
+            action_decoder actions(nobody, none, ignored, 0);
+            transaction_trace(c, false, actions, ignored);
+        }
+
+    } // namespace
+
+    void decode_block(std::string_view traces, uint32_t block_num, const contracts& ours, batch& out, decode_stats& stats) {
+        cursor c{traces.data(), traces.data() + traces.size()};
+        action_decoder actions(ours, out, stats, block_num);
+        stats.blocks++;
+        if (traces.empty()) return;
+
+        for (uint32_t n = c.varuint32(); n > 0; n--) transaction_trace(c, true, actions, stats);
+        if (c.pos != c.end) throw std::runtime_error("trailing bytes after block " + std::to_string(block_num) + "'s traces");
+    }
+
+} // namespace ingest
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "records.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Decoding of a block's packed vector<transaction_trace>, in the
+ * state-history ABI, down to the actions of our contracts. Everything else
+ * is skipped field by field, without building any trace objects; the action
+ * data of interest is read in place through each action's fixed layout.
+ */
+namespace ingest {
+
+    /// The action layouts differ between the two gameplay contracts
+    enum class layout : uint8_t {
+        beta,  // play(name, string), playc, receiverand(u64, checksum256), logresult
+        dodge, // play(name, u64), receiverand(u64, checksum256, u64); no logresult
+    };
+
+    struct contracts {
+        uint64_t gameplay = 0;
+        uint64_t token = 0;
+        layout   variant = layout::beta;
+    };
+
+    struct decode_stats {
+        uint64_t blocks = 0;
+        uint64_t transactions = 0; // executed ones; failed and expired transactions are skipped whole
+        uint64_t actions = 0;      // every action trace looked at, notifications included
+        uint64_t matched = 0;      // records produced
+        uint64_t malformed = 0;    // our actions whose data did not fit the layout, e.g. from an older contract
+    };
+
+    /**
+     * Append the records for one block's traces to `out`. Only each action's
+     * own receiver is considered, so the notifications a transfer fans out to
+     * are not counted again.
+     * @throws std::runtime_error on malformed traces
+     */
+    void decode_block(std::string_view traces, uint32_t block_num, const contracts& ours, batch& out, decode_stats& stats);
+
+} // namespace ingest
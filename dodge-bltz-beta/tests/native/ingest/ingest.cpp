@@ -0,0 +1,138 @@
+#include "ingest.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace ingest {
+
+    namespace {
+
+        struct decoded_segment {
+            batch              records;
+            decode_stats       stats;
+            uint64_t           bytes = 0;
+            std::exception_ptr error;
+        };
+
+        decoded_segment decode_segment(const std::string& path, const contracts& ours) {
+            decoded_segment d;
+            try {
+                log_reader reader(path);
+                d.bytes = reader.size();
+                log_entry entry;
+                while (reader.next(entry)) {
+                    try {
+                        decode_block(entry.traces, entry.block_num, ours, d.records, d.stats);
+                    } catch (const std::runtime_error& err) {
+                        throw std::runtime_error(path + ": block " + std::to_string(entry.block_num) + ": " + err.what());
+                    }
+                }
+            } catch (...) {
+                d.error = std::current_exception();
+            }
+            return d;
+        }
+
+        void add(decode_stats& total, const decode_stats& s) {
+            total.blocks += s.blocks;
+            total.transactions += s.transactions;
+            total.actions += s.actions;
+            total.matched += s.matched;
+            total.malformed += s.malformed;
+        }
+
+    } // namespace
+
+    summary run(const std::vector<std::string>& segments, const std::string& out_dir, const options& opts) {
+        auto start = std::chrono::steady_clock::now();
+
+        // Block order, whatever the order on the command line
+        std::vector<std::pair<uint32_t, std::string>> ordered;
+        for (const auto& path : segments) ordered.emplace_back(log_reader(path).first_block(), path);
+        std::stable_sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        unsigned threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<unsigned>(threads, unsigned(std::max<size_t>(ordered.size(), 1)));
+        size_t window = 2 * threads; // decoded segments allowed ahead of the writer
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::optional<decoded_segment>> done(ordered.size());
+        size_t next = 0;    // next segment to hand out
+        size_t written = 0; // segments stored so far
+        bool stopping = false;
+
+        auto worker = [&] {
+            for (;;) {
+                size_t i;
+                {
+                    std::unique_lock lock(mutex);
+                    changed.wait(lock, [&] { return stopping || next == ordered.size() || next < written + window; });
+                    if (stopping || next == ordered.size()) return;
+                    i = next++;
+                }
+                auto d = decode_segment(ordered[i].second, opts.ours);
+                {
+                    std::lock_guard lock(mutex);
+                    done[i] = std::move(d);
+                }
+                changed.notify_all();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker);
+
+        summary s;
+        std::exception_ptr failure;
+        try {
+            record_store store(out_dir);
+            uint64_t before = store.plays.records() + store.callbacks.records() + store.results.records() +
+                              store.issues.records() + store.transfers.records();
+
+            for (size_t i = 0; i < ordered.size(); i++) {
+                decoded_segment d;
+                {
+                    std::unique_lock lock(mutex);
+                    changed.wait(lock, [&] { return done[i].has_value(); });
+                    d = std::move(*done[i]);
+                    done[i].reset();
+                }
+                if (d.error) std::rethrow_exception(d.error);
+
+                store.append(d.records);
+                add(s.stats, d.stats);
+                s.log_bytes += d.bytes;
+                s.segments++;
+                {
+                    std::lock_guard lock(mutex);
+                    written = i + 1;
+                }
+                changed.notify_all();
+            }
+
+            s.appended = store.plays.records() + store.callbacks.records() + store.results.records() +
+                         store.issues.records() + store.transfers.records() - before;
+        } catch (...) {
+            failure = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        for (auto& t : pool) t.join();
+        if (failure) std::rethrow_exception(failure);
+
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return s;
+    }
+
+} // namespace ingest
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "decoder.hpp"
+
+#include <string>
+#include <vector>
+
+namespace ingest {
+
+    struct options {
+        contracts ours;
+        unsigned  threads = 0; // 0: one per core
+    };
+
+    struct summary {
+        decode_stats stats;
+        uint64_t     segments = 0;
+        uint64_t     log_bytes = 0;
+        uint64_t     appended = 0; // records new to the store
+        double       seconds = 0;
+    };
+
+    /**
+     * Decode trace log segments and append our actions to the record store in
+     * `out_dir`. Segments are decoded in parallel, one per thread, and stored
+     * in block order whatever order they were named in; a few segments at
+     * most wait decoded in memory for an earlier one to finish.
+     */
+    summary run(const std::vector<std::string>& segments, const std::string& out_dir, const options& opts);
+
+} // namespace ingest
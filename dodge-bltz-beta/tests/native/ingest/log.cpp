@@ -0,0 +1,160 @@
+#include "log.hpp"
+
+#include <eosio/name.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ingest {
+
+    namespace {
+
+        constexpr uint64_t ship_name = eosio::name("ship").value;
+
+        uint64_t load_u64(const char* p) {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        uint32_t load_u32(const char* p) {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        uint32_t block_num_of(const char* block_id) {
+            auto b = reinterpret_cast<const unsigned char*>(block_id);
+            return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | b[3];
+        }
+
+        /// Inflate a whole zlib stream into `out`, growing it as needed; never shrinks it
+        /// @return the number of bytes produced
+        size_t inflate_into(std::vector<char>& out, const char* in, size_t in_size, const std::string& path) {
+            if (out.size() < in_size * 4) out.resize(std::max<size_t>(in_size * 4, 4096));
+
+            z_stream z{};
+            if (inflateInit(&z) != Z_OK) throw std::runtime_error("zlib inflateInit failed");
+            z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+            z.avail_in = uInt(in_size);
+
+            size_t produced = 0;
+            int status;
+            do {
+                if (produced == out.size()) out.resize(out.size() * 2);
+                z.next_out = reinterpret_cast<Bytef*>(out.data() + produced);
+                z.avail_out = uInt(out.size() - produced);
+                status = inflate(&z, Z_NO_FLUSH);
+                produced = out.size() - z.avail_out;
+            } while (status == Z_OK);
+            inflateEnd(&z);
+
+            if (status != Z_STREAM_END) throw std::runtime_error(path + ": corrupt compressed traces");
+            return produced;
+        }
+
+        void put_u64(std::string& out, uint64_t v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+    } // namespace
+
+    uint64_t ship_magic(uint16_t version, uint16_t features) { return ship_name | version | uint64_t(features) << 16; }
+
+    log_reader::log_reader(const std::string& path) : path(path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot read " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        length = size_t(st.st_size);
+        if (length > 0) {
+            void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("cannot map " + path);
+            }
+            ::madvise(mapped, length, MADV_SEQUENTIAL);
+            data = static_cast<const char*>(mapped);
+        }
+        ::close(fd);
+    }
+
+    log_reader::~log_reader() {
+        if (data) ::munmap(const_cast<char*>(data), length);
+    }
+
+    uint32_t log_reader::first_block() const {
+        return length >= entry_header_size ? block_num_of(data + 8) : 0;
+    }
+
+    bool log_reader::next(log_entry& entry) {
+        if (pos == length) return false;
+        if (length - pos < entry_header_size) throw std::runtime_error(path + ": truncated entry header");
+
+        const char* header = data + pos;
+        uint64_t magic = load_u64(header);
+        if ((magic & ~uint64_t(0xffffffff)) != ship_name) throw std::runtime_error(path + ": not a state-history log");
+        uint16_t version = uint16_t(magic);
+        if (version > 1) throw std::runtime_error(path + ": unsupported state-history version " + std::to_string(version));
+
+        uint64_t payload_size = load_u64(header + 40);
+        if (length - pos - entry_header_size < payload_size + 8) throw std::runtime_error(path + ": truncated entry");
+        const char* payload = header + entry_header_size;
+        if (load_u64(payload + payload_size) != pos) throw std::runtime_error(path + ": entry position mismatch");
+
+        entry.block_num = block_num_of(header + 8);
+        if (version == 0) {
+            if (payload_size < 4) throw std::runtime_error(path + ": truncated entry");
+            uint32_t compressed = load_u32(payload);
+            if (compressed > payload_size - 4) throw std::runtime_error(path + ": truncated entry");
+            size_t produced = compressed ? inflate_into(inflated, payload + 4, compressed, path) : 0;
+            entry.traces = std::string_view(inflated.data(), produced);
+        } else {
+            size_t produced = inflate_into(inflated, payload, payload_size, path);
+            entry.traces = std::string_view(inflated.data(), produced);
+        }
+
+        pos += entry_header_size + payload_size + 8;
+        return true;
+    }
+
+    log_writer::log_writer(const std::string& path) : path(path), out(path, std::ios::binary | std::ios::trunc) {
+        if (!out) throw std::runtime_error("cannot write " + path);
+    }
+
+    void log_writer::append(uint32_t block_num, std::string_view packed_traces) {
+        std::vector<char> compressed(compressBound(uLong(packed_traces.size())));
+        uLongf compressed_size = uLongf(compressed.size());
+        if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size,
+                      reinterpret_cast<const Bytef*>(packed_traces.data()), uLong(packed_traces.size()), Z_BEST_SPEED) != Z_OK) {
+            throw std::runtime_error("zlib compress failed");
+        }
+
+        std::string entry;
+        put_u64(entry, ship_magic(1));
+        char block_id[32] = {};
+        block_id[0] = char(block_num >> 24);
+        block_id[1] = char(block_num >> 16);
+        block_id[2] = char(block_num >> 8);
+        block_id[3] = char(block_num);
+        entry.append(block_id, sizeof(block_id));
+        put_u64(entry, compressed_size);
+        entry.append(compressed.data(), compressed_size);
+        put_u64(entry, position);
+
+        out.write(entry.data(), std::streamsize(entry.size()));
+        if (!out) throw std::runtime_error("cannot write " + path);
+        position += entry.size();
+    }
+
+} // namespace ingest
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * State-history trace logs as nodeos's state_history_plugin writes them
+ * (trace_history.log and its retained trace_history-N-M.log segments). Each
+ * block is one entry: a header, a zlib-compressed payload holding the
+ * block's packed vector<transaction_trace>, then the entry's own file
+ * position so the log can be walked backwards.
+ *
+ *     uint64 magic          "ship"_n | version | features << 16
+ *     char   block_id[32]   block number in the first four bytes, big endian
+ *     uint64 payload_size
+ *     payload               version 0: uint32 size, then that many zlib bytes
+ *                           version 1: a zlib stream
+ *     uint64 position       where this entry's header starts
+ */
+namespace ingest {
+
+    inline constexpr size_t entry_header_size = 8 + 32 + 8;
+
+    uint64_t ship_magic(uint16_t version, uint16_t features = 0);
+
+    /// One block's traces, decompressed; valid until the reader moves on
+    struct log_entry {
+        uint32_t         block_num = 0;
+        std::string_view traces;
+    };
+
+    /**
+     * Walks a trace log segment front to back. The file is mapped, not read,
+     * and every payload inflates into one buffer reused for the whole segment.
+     */
+    class log_reader {
+    public:
+        explicit log_reader(const std::string& path);
+        ~log_reader();
+
+        log_reader(const log_reader&) = delete;
+        log_reader& operator=(const log_reader&) = delete;
+
+        /// @return false at the end of the segment
+        bool next(log_entry& entry);
+
+        /// Block number of the first entry, or 0 for an empty segment
+        uint32_t first_block() const;
+
+        size_t size() const { return length; }
+
+    private:
+        std::string       path;
+        const char*       data = nullptr;
+        size_t            length = 0;
+        size_t            pos = 0;
+        std::vector<char> inflated;
+    };
+
+    /**
+     * Writes trace log entries in the version 1 layout; for tests and the
+     * throughput check, since only nodeos writes real logs
+     */
+    class log_writer {
+    public:
+        explicit log_writer(const std::string& path);
+
+        void append(uint32_t block_num, std::string_view packed_traces);
+
+    private:
+        std::string   path;
+        std::ofstream out;
+        uint64_t      position = 0;
+    };
+
+} // namespace ingest
@@ -0,0 +1,101 @@
+#include "ingest.hpp"
+#include "synth.hpp"
+
+#include <eosio/name.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    const char* const usage =
+        "usage: ingest [options] OUT_DIR SEGMENT...   append our actions from trace log segments to OUT_DIR\n"
+        "       ingest synth [options] DIR            write synthetic trace log segments to DIR\n"
+        "         --segments N --blocks N --plays-per-block N   (synth only)\n"
+        "options: --layout beta|dodge --gameplay ACCOUNT --token ACCOUNT --threads N\n";
+
+    struct arguments {
+        ingest::options          opts;
+        ingest::synthetic_shape  shape;
+        uint32_t                 segments = 8;
+        std::vector<std::string> paths;
+    };
+
+    arguments parse(int argc, char** argv) {
+        arguments args;
+        std::string gameplay, token;
+        for (int i = 0; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                args.paths.push_back(arg);
+                continue;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            std::string value = argv[++i];
+            if (arg == "--layout") {
+                if (value != "beta" && value != "dodge") throw std::invalid_argument("unknown layout " + value);
+                args.opts.ours.variant = value == "beta" ? ingest::layout::beta : ingest::layout::dodge;
+            } else if (arg == "--gameplay") gameplay = value;
+            else if (arg == "--token") token = value;
+            else if (arg == "--threads") args.opts.threads = unsigned(std::stoul(value));
+            else if (arg == "--segments") args.segments = uint32_t(std::stoul(value));
+            else if (arg == "--blocks") args.shape.blocks = uint32_t(std::stoul(value));
+            else if (arg == "--plays-per-block") args.shape.plays_per_block = uint32_t(std::stoul(value));
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+
+        // Each variant's usual account names
+        bool beta = args.opts.ours.variant == ingest::layout::beta;
+        args.opts.ours.gameplay = eosio::name(gameplay.empty() ? (beta ? "gameplay" : "gameplay.acc") : gameplay).value;
+        args.opts.ours.token = eosio::name(token.empty() ? "dbptoken" : token).value;
+        return args;
+    }
+
+    int synth(const arguments& args) {
+        if (args.paths.size() != 1) throw std::invalid_argument("synth takes one directory");
+        std::filesystem::create_directories(args.paths[0]);
+
+        uint64_t global_sequence = 0, expected = 0;
+        auto shape = args.shape;
+        for (uint32_t s = 0; s < args.segments; s++) {
+            auto path = args.paths[0] + "/trace_history-" + std::to_string(shape.first_block) + "-" +
+                        std::to_string(shape.first_block + shape.blocks) + ".log";
+            expected += ingest::write_synthetic_log(path, args.opts.ours, shape, global_sequence);
+            shape.first_block += shape.blocks;
+            shape.seed++;
+        }
+        std::cout << args.segments << " segments, " << global_sequence << " actions, " << expected
+                  << " of them ours, written to " << args.paths[0] << "\n";
+        return 0;
+    }
+
+    int run(const arguments& args) {
+        if (args.paths.size() < 2) throw std::invalid_argument("need an output directory and at least one segment");
+        std::vector<std::string> segments(args.paths.begin() + 1, args.paths.end());
+
+        auto s = ingest::run(segments, args.paths[0], args.opts);
+        std::printf("segments      %llu (%.1f MB)\n", (unsigned long long)s.segments, double(s.log_bytes) / 1e6);
+        std::printf("blocks        %llu\n", (unsigned long long)s.stats.blocks);
+        std::printf("transactions  %llu executed\n", (unsigned long long)s.stats.transactions);
+        std::printf("actions       %llu\n", (unsigned long long)s.stats.actions);
+        std::printf("records       %llu decoded, %llu new\n", (unsigned long long)s.stats.matched, (unsigned long long)s.appended);
+        if (s.stats.malformed) std::printf("malformed     %llu\n", (unsigned long long)s.stats.malformed);
+        std::printf("time          %.2f s, %.2fM actions/s\n", s.seconds, s.seconds > 0 ? double(s.stats.actions) / s.seconds / 1e6 : 0.0);
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        if (argc > 1 && std::string(argv[1]) == "synth") return synth(parse(argc - 2, argv + 2));
+        if (argc > 2) return run(parse(argc - 1, argv + 1));
+        std::cerr << usage;
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "ingest: " << e.what() << "\n";
+        return 1;
+    }
+}
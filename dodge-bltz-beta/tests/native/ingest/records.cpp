@@ -0,0 +1,154 @@
+#include "records.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ingest {
+
+    namespace {
+
+        constexpr char     magic[4] = {'D', 'B', 'I', 'X'};
+        constexpr uint16_t format_version = 1;
+        constexpr size_t   header_size = 16;
+
+        struct file_header {
+            char     magic[4];
+            uint16_t version;
+            uint16_t kind;
+            uint32_t record_size;
+            uint32_t reserved;
+        };
+        static_assert(sizeof(file_header) == header_size);
+
+        void check_header(const file_header& h, const std::string& path, record_kind kind, uint32_t record_size) {
+            if (std::memcmp(h.magic, magic, sizeof(magic)) != 0) throw std::runtime_error(path + ": not a record file");
+            if (h.version != format_version) throw std::runtime_error(path + ": unsupported record file version");
+            if (h.kind != uint16_t(kind) || h.record_size != record_size) {
+                throw std::runtime_error(path + ": holds a different record kind");
+            }
+        }
+
+    } // namespace
+
+    record_file::record_file(const std::string& path, record_kind kind, uint32_t record_size)
+        : path(path), record_size(record_size) {
+        file = std::fopen(path.c_str(), "a+b");
+        if (!file) throw std::runtime_error("cannot open " + path);
+
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        if (size == 0) {
+            file_header h{{magic[0], magic[1], magic[2], magic[3]}, format_version, uint16_t(kind), record_size, 0};
+            std::fwrite(&h, sizeof(h), 1, file);
+            return;
+        }
+
+        file_header h{};
+        std::fseek(file, 0, SEEK_SET);
+        if (size < long(header_size) || std::fread(&h, sizeof(h), 1, file) != 1) throw std::runtime_error(path + ": truncated header");
+        check_header(h, path, kind, record_size);
+
+        // A torn last record from an interrupted run is dropped
+        uint64_t whole = uint64_t(size - long(header_size)) / record_size;
+        if (uint64_t(size) != header_size + whole * record_size) {
+            std::fclose(file);
+            std::filesystem::resize_file(path, header_size + whole * record_size);
+            file = std::fopen(path.c_str(), "a+b");
+            if (!file) throw std::runtime_error("cannot open " + path);
+        }
+        count = whole;
+        if (whole > 0) {
+            std::fseek(file, long(header_size + (whole - 1) * record_size), SEEK_SET);
+            if (std::fread(&last, sizeof(last), 1, file) != 1) throw std::runtime_error(path + ": cannot read last record");
+        }
+    }
+
+    record_file::~record_file() {
+        if (file) std::fclose(file);
+    }
+
+    void record_file::append(const void* records, size_t n) {
+        const char* p = static_cast<const char*>(records);
+
+        // Skip what an earlier run already stored
+        size_t skip = 0;
+        while (skip < n) {
+            uint64_t sequence;
+            std::memcpy(&sequence, p + skip * record_size, sizeof(sequence));
+            if (sequence > last) break;
+            skip++;
+        }
+        if (skip == n) return;
+
+        size_t fresh = n - skip;
+        if (std::fwrite(p + skip * record_size, record_size, fresh, file) != fresh) throw std::runtime_error("cannot write " + path);
+        std::memcpy(&last, p + (n - 1) * record_size, sizeof(last));
+        count += fresh;
+    }
+
+    record_store::record_store(const std::string& dir)
+        : plays((std::filesystem::create_directories(dir), dir + "/plays.bin"), record_kind::play, sizeof(play_record)),
+          callbacks(dir + "/callbacks.bin", record_kind::callback, sizeof(callback_record)),
+          results(dir + "/results.bin", record_kind::result, sizeof(result_record)),
+          issues(dir + "/issues.bin", record_kind::issue, sizeof(issue_record)),
+          transfers(dir + "/transfers.bin", record_kind::transfer, sizeof(transfer_record)) {}
+
+    void record_store::append(const batch& b) {
+        plays.append(b.plays.data(), b.plays.size());
+        callbacks.append(b.callbacks.data(), b.callbacks.size());
+        results.append(b.results.data(), b.results.size());
+        issues.append(b.issues.data(), b.issues.size());
+        transfers.append(b.transfers.data(), b.transfers.size());
+    }
+
+    std::vector<char> read_record_bytes(const std::string& path, record_kind kind, uint32_t record_size) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("cannot read " + path);
+
+        file_header h{};
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h))) throw std::runtime_error(path + ": truncated header");
+        check_header(h, path, kind, record_size);
+
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        bytes.resize(bytes.size() / record_size * record_size);
+        return bytes;
+    }
+
+    record_map::record_map(const std::string& path, record_kind kind, uint32_t record_size) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot read " + path);
+        struct stat st{};
+        ::fstat(fd, &st);
+        length = size_t(st.st_size);
+        if (length < header_size) {
+            ::close(fd);
+            throw std::runtime_error(path + ": truncated header");
+        }
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+        data = static_cast<char*>(mapped);
+
+        file_header h{};
+        std::memcpy(&h, data, sizeof(h));
+        try {
+            check_header(h, path, kind, record_size);
+        } catch (...) {
+            ::munmap(data, length);
+            throw;
+        }
+        records_count = (length - header_size) / record_size;
+        ::madvise(data, length, MADV_SEQUENTIAL);
+    }
+
+    record_map::~record_map() {
+        if (data) ::munmap(data, length);
+    }
+
+} // namespace ingest
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * The ingested actions: one fixed-size little-endian record per action,
+ * one append-only file per kind. A file is a 16-byte header, then records in
+ * global sequence order, so a reader can map it and index it directly.
+ *
+ *     char   magic[4]       "DBIX"
+ *     uint16 version
+ *     uint16 kind
+ *     uint32 record_size
+ *     uint32 reserved
+ */
+namespace ingest {
+
+    enum class record_kind : uint16_t {
+        play      = 1,
+        callback  = 2,
+        result    = 3,
+        issue     = 4,
+        transfer  = 5,
+    };
+
+    /// play, or the beta contract's compact playc
+    struct play_record {
+        uint64_t global_sequence;
+        uint64_t contract;
+        uint64_t player;
+        uint64_t nonce;     // numeric nonces as sent; string nonces as their FNV-1a hash
+        uint32_t block_num;
+        uint8_t  compact;   // 1 for playc
+        uint8_t  flags;     // playc's move and batch count
+        uint16_t reserved;
+    };
+
+    /// receiverand
+    struct callback_record {
+        uint64_t global_sequence;
+        uint64_t contract;
+        uint64_t request_id;  // the beta request id, or dodge-bltz's signing value
+        uint64_t random_word; // the first eight bytes big endian, or dodge-bltz's u64
+        uint32_t block_num;
+        uint32_t reserved;
+        uint8_t  random_value[32]; // the beta checksum256, or dodge-bltz's caller_signing_value_hash
+    };
+
+    /// logresult
+    struct result_record {
+        uint64_t global_sequence;
+        uint64_t contract;
+        uint64_t player;
+        uint32_t block_num;
+        uint32_t roll;
+        uint8_t  won;
+        uint8_t  reserved[7];
+    };
+
+    /// issue
+    struct issue_record {
+        uint64_t global_sequence;
+        uint64_t contract;
+        uint64_t to;
+        int64_t  amount;
+        uint64_t symbol;
+        uint32_t block_num;
+        uint32_t reserved;
+    };
+
+    /// transfer
+    struct transfer_record {
+        uint64_t global_sequence;
+        uint64_t contract;
+        uint64_t from;
+        uint64_t to;
+        int64_t  amount;
+        uint64_t symbol;
+        uint32_t block_num;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(play_record) == 40);
+    static_assert(sizeof(callback_record) == 72);
+    static_assert(sizeof(result_record) == 40);
+    static_assert(sizeof(issue_record) == 48);
+    static_assert(sizeof(transfer_record) == 56);
+
+    /// Every record decoded from some span of blocks, in chain order
+    struct batch {
+        std::vector<play_record>     plays;
+        std::vector<callback_record> callbacks;
+        std::vector<result_record>   results;
+        std::vector<issue_record>    issues;
+        std::vector<transfer_record> transfers;
+
+        size_t size() const { return plays.size() + callbacks.size() + results.size() + issues.size() + transfers.size(); }
+
+        void clear() {
+            plays.clear();
+            callbacks.clear();
+            results.clear();
+            issues.clear();
+            transfers.clear();
+        }
+    };
+
+    /**
+     * One kind's file, opened for appending. Records at or below the last
+     * global sequence already in the file are skipped, so ingesting a
+     * segment twice, or resuming after a crash, adds nothing twice.
+     */
+    class record_file {
+    public:
+        record_file(const std::string& path, record_kind kind, uint32_t record_size);
+        ~record_file();
+
+        record_file(const record_file&) = delete;
+        record_file& operator=(const record_file&) = delete;
+
+        /// Append `count` records of the file's size, each starting with its global sequence
+        void append(const void* records, size_t count);
+
+        uint64_t last_sequence() const { return last; }
+
+        uint64_t records() const { return count; }
+
+    private:
+        std::string path;
+        uint32_t    record_size;
+        FILE*       file = nullptr;
+        uint64_t    last = 0;
+        uint64_t    count = 0;
+    };
+
+    /// The record files of one output directory: plays.bin, callbacks.bin, results.bin, issues.bin, transfers.bin
+    class record_store {
+    public:
+        explicit record_store(const std::string& dir);
+
+        void append(const batch& b);
+
+        record_file plays;
+        record_file callbacks;
+        record_file results;
+        record_file issues;
+        record_file transfers;
+    };
+
+    /// The records of a whole file, after checking its header matches `kind` and `record_size`
+    std::vector<char> read_record_bytes(const std::string& path, record_kind kind, uint32_t record_size);
+
+    /**
+     * A record file mapped read-only, for passes over more records than
+     * should be read into memory. The header is checked as read_records
+     * checks it; a torn last record is left out.
+     */
+    class record_map {
+    public:
+        record_map(const std::string& path, record_kind kind, uint32_t record_size);
+        ~record_map();
+
+        record_map(const record_map&) = delete;
+        record_map& operator=(const record_map&) = delete;
+
+        const char* records() const { return data ? data + 16 : nullptr; }
+
+        size_t count() const { return records_count; }
+
+    private:
+        char*  data = nullptr;
+        size_t length = 0;
+        size_t records_count = 0;
+    };
+
+    /// The records of a mapped file as a span
+    template <typename Record>
+    class mapped_records {
+    public:
+        mapped_records(const std::string& path, record_kind kind) : map(path, kind, sizeof(Record)) {}
+
+        std::span<const Record> all() const { return {reinterpret_cast<const Record*>(map.records()), map.count()}; }
+
+    private:
+        record_map map;
+    };
+
+    /// Read a whole record file; for tests and small tools
+    template <typename Record>
+    std::vector<Record> read_records(const std::string& path, record_kind kind) {
+        auto bytes = read_record_bytes(path, kind, sizeof(Record));
+        std::vector<Record> records(bytes.size() / sizeof(Record));
+        std::memcpy(records.data(), bytes.data(), bytes.size());
+        return records;
+    }
+
+} // namespace ingest
@@ -0,0 +1,262 @@
+#include "synth.hpp"
+#include "log.hpp"
+
+#include <eosio/crypto.hpp>
+#include <eosio/name.hpp>
+
+#include <cstring>
+
+namespace ingest {
+
+    namespace {
+
+        const uint64_t oracle = "orng.wax"_n.value;
+        const uint64_t dbp_symbol = (uint64_t('D') << 8) | (uint64_t('B') << 16) | (uint64_t('P') << 24) | 4;
+
+        void put_u8(std::string& out, uint8_t v) { out.push_back(char(v)); }
+
+        void put_u32(std::string& out, uint32_t v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+        void put_u64(std::string& out, uint64_t v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+        void put_varuint32(std::string& out, uint32_t v) {
+            while (v >= 0x80) {
+                out.push_back(char(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back(char(v));
+        }
+
+        void put_bytes(std::string& out, std::string_view bytes) {
+            put_varuint32(out, uint32_t(bytes.size()));
+            out.append(bytes);
+        }
+
+        /// action_trace_v1 when the action returned a value, as nodeos 2.1+ writes it, else v0
+        void pack_action(std::string& out, const synthetic_action& a, uint32_t ordinal, bool with_return_value) {
+            put_varuint32(out, with_return_value ? 1 : 0);
+            put_varuint32(out, ordinal);
+            put_varuint32(out, ordinal > 1 ? 1 : 0);
+
+            put_u8(out, 1);             // receipt
+            put_varuint32(out, 0);
+            put_u64(out, a.receiver);
+            out.append(32, '\x5a');     // act_digest
+            put_u64(out, a.global_sequence);
+            put_u64(out, a.global_sequence / 3); // recv_sequence
+            put_varuint32(out, 1);      // auth_sequence
+            put_u64(out, a.account);
+            put_u64(out, a.global_sequence);
+            put_varuint32(out, 1);      // code_sequence
+            put_varuint32(out, 1);      // abi_sequence
+
+            put_u64(out, a.receiver);
+            put_u64(out, a.account);
+            put_u64(out, a.name);
+            put_varuint32(out, 1);      // authorization
+            put_u64(out, a.account);
+            put_u64(out, "active"_n.value);
+            put_bytes(out, a.data);
+
+            put_u8(out, 0);             // context_free
+            put_u64(out, 42);           // elapsed
+            put_bytes(out, "");         // console
+            put_varuint32(out, 1);      // account_ram_deltas
+            put_u64(out, a.receiver);
+            put_u64(out, 0);
+            put_u8(out, 0);             // except
+            put_u8(out, 0);             // error_code
+            if (with_return_value) put_bytes(out, "ok");
+        }
+
+        void pack_transaction(std::string& out, const synthetic_transaction& t, bool failed_dtrx) {
+            put_varuint32(out, 0);
+            out.append(32, '\x11');     // id
+            put_u8(out, t.status);
+            put_u32(out, 250);          // cpu_usage_us
+            put_varuint32(out, 16);     // net_usage_words
+            put_u64(out, 300);          // elapsed
+            put_u64(out, 128);          // net_usage
+            put_u8(out, 0);             // scheduled
+
+            put_varuint32(out, uint32_t(t.actions.size()));
+            for (size_t i = 0; i < t.actions.size(); i++) pack_action(out, t.actions[i], uint32_t(i + 1), i % 2 == 1);
+
+            put_u8(out, 0);             // account_ram_delta
+            if (t.status == 0) {
+                put_u8(out, 0);         // except
+                put_u8(out, 0);         // error_code
+            } else {
+                put_u8(out, 1);
+                put_bytes(out, "assertion failure");
+                put_u8(out, 1);
+                put_u64(out, 3050003);
+            }
+
+            // A failed deferred transaction carries its own trace; its actions never count
+            if (failed_dtrx) {
+                put_u8(out, 1);
+                synthetic_transaction inner{2, t.actions};
+                pack_transaction(out, inner, false);
+            } else {
+                put_u8(out, 0);
+            }
+
+            put_u8(out, 1);             // partial
+            put_varuint32(out, 0);
+            put_u32(out, 1700000000);   // expiration
+            out.append(2 + 4, '\0');    // ref_block_num, ref_block_prefix
+            put_varuint32(out, 0);      // max_net_usage_words
+            put_u8(out, 0);             // max_cpu_usage_ms
+            put_varuint32(out, 0);      // delay_sec
+            put_varuint32(out, 0);      // transaction_extensions
+            put_varuint32(out, 2);      // signatures: one K1, one WebAuthn
+            put_varuint32(out, 0);
+            out.append(65, '\x01');
+            put_varuint32(out, 2);
+            out.append(65, '\x02');
+            put_bytes(out, "authenticator data");
+            put_bytes(out, "{\"type\":\"webauthn.get\"}");
+            put_varuint32(out, 0);      // context_free_data
+        }
+
+        uint64_t splitmix64(uint64_t& state) {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+    } // namespace
+
+    std::string pack_traces(const std::vector<synthetic_transaction>& transactions) {
+        std::string out;
+        put_varuint32(out, uint32_t(transactions.size()));
+        for (size_t i = 0; i < transactions.size(); i++) pack_transaction(out, transactions[i], i % 7 == 3);
+        return out;
+    }
+
+    std::string play_data(const contracts& ours, uint64_t player, uint64_t nonce) {
+        std::string out;
+        put_u64(out, player);
+        if (ours.variant == layout::beta) {
+            put_bytes(out, std::to_string(nonce));
+        } else {
+            put_u64(out, nonce);
+        }
+        return out;
+    }
+
+    std::string receiverand_data(const contracts& ours, uint64_t request_id, uint64_t random_word) {
+        std::string out;
+        put_u64(out, request_id);
+        if (ours.variant == layout::beta) {
+            for (int i = 7; i >= 0; i--) put_u8(out, uint8_t(random_word >> (8 * i)));
+            out.append(24, '\0');
+        } else {
+            // caller_signing_value_hash: the oracle's sha256 of the packed signing value
+            auto hash = eosio::sha256(reinterpret_cast<const char*>(&request_id), sizeof(request_id)).extract_as_byte_array();
+            out.append(reinterpret_cast<const char*>(hash.data()), hash.size());
+            put_u64(out, random_word);
+        }
+        return out;
+    }
+
+    std::string logresult_data(uint64_t player, bool won, uint32_t roll) {
+        std::string out;
+        put_u64(out, player);
+        put_u8(out, won);
+        put_u32(out, roll);
+        return out;
+    }
+
+    std::string issue_data(uint64_t to, int64_t amount, uint64_t symbol) {
+        std::string out;
+        put_u64(out, to);
+        put_u64(out, uint64_t(amount));
+        put_u64(out, symbol);
+        put_bytes(out, "BLTZ win reward");
+        return out;
+    }
+
+    std::string transfer_data(uint64_t from, uint64_t to, int64_t amount, uint64_t symbol) {
+        std::string out;
+        put_u64(out, from);
+        put_u64(out, to);
+        put_u64(out, uint64_t(amount));
+        put_u64(out, symbol);
+        put_bytes(out, "gg");
+        return out;
+    }
+
+    uint64_t write_synthetic_log(const std::string& path, const contracts& ours, const synthetic_shape& shape,
+                                 uint64_t& global_sequence) {
+        log_writer log(path);
+        uint64_t rng = shape.seed;
+        uint64_t expected = 0;
+        bool beta = ours.variant == layout::beta;
+
+        std::vector<std::pair<uint64_t, uint64_t>> waiting; // (request id, player) answered next block
+        for (uint32_t b = 0; b < shape.blocks; b++) {
+            std::vector<synthetic_transaction> block;
+
+            for (auto [request_id, player] : waiting) {
+                uint64_t random_word = splitmix64(rng);
+                // Each contract's own roll: the first four bytes, or the whole word
+                uint32_t roll = beta ? uint32_t(random_word >> 32) % 100 : uint32_t(random_word % 100);
+                bool won = roll < 35;
+
+                synthetic_transaction t;
+                t.actions.push_back({ours.gameplay, ours.gameplay, "receiverand"_n.value,
+                                     receiverand_data(ours, request_id, random_word), ++global_sequence});
+                expected++;
+                // Inline actions in the order settlement sends them: the reward, then the log
+                if (won) {
+                    t.actions.push_back({ours.token, ours.token, "issue"_n.value, issue_data(player, 10000, dbp_symbol),
+                                         ++global_sequence});
+                    expected++;
+                }
+                if (beta) {
+                    t.actions.push_back({ours.gameplay, ours.gameplay, "logresult"_n.value, logresult_data(player, won, roll),
+                                         ++global_sequence});
+                    expected++;
+                }
+                block.push_back(std::move(t));
+            }
+            waiting.clear();
+
+            for (uint32_t i = 0; i < shape.plays_per_block; i++) {
+                uint64_t player = splitmix64(rng) & ~uint64_t(0xf);
+                uint64_t nonce = splitmix64(rng) >> 16;
+
+                synthetic_transaction t;
+                t.actions.push_back({ours.gameplay, ours.gameplay, "play"_n.value, play_data(ours, player, nonce), ++global_sequence});
+                t.actions.push_back({oracle, oracle, "requestrand"_n.value, std::string(24, '\0'), ++global_sequence});
+
+                // Every tenth play fails: nothing in it may be ingested, and no callback follows
+                if (i % 10 == 9) {
+                    t.status = 2;
+                } else {
+                    expected++;
+                    waiting.push_back({(uint64_t(b) << 32) | i, player});
+                }
+                block.push_back(std::move(t));
+
+                if (i % 5 == 4) {
+                    uint64_t to = splitmix64(rng) & ~uint64_t(0xf);
+                    synthetic_transaction transfer;
+                    auto data = transfer_data(player, to, 5000, dbp_symbol);
+                    transfer.actions.push_back({ours.token, ours.token, "transfer"_n.value, data, ++global_sequence});
+                    transfer.actions.push_back({player, ours.token, "transfer"_n.value, data, ++global_sequence});
+                    transfer.actions.push_back({to, ours.token, "transfer"_n.value, data, ++global_sequence});
+                    expected++;
+                    block.push_back(std::move(transfer));
+                }
+            }
+
+            log.append(shape.first_block + b, pack_traces(block));
+        }
+        return expected;
+    }
+
+} // namespace ingest
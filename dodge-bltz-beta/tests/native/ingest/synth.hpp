@@ -0,0 +1,55 @@
+#pragma once
+
+#include "decoder.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Synthetic state-history traces, packed exactly as nodeos packs them, for
+ * the tests and for measuring ingest throughput without a node
+ */
+namespace ingest {
+
+    struct synthetic_action {
+        uint64_t    receiver;
+        uint64_t    account;
+        uint64_t    name;
+        std::string data;
+        uint64_t    global_sequence;
+    };
+
+    struct synthetic_transaction {
+        uint8_t                       status = 0; // transaction_status; 0 executed
+        std::vector<synthetic_action> actions;
+    };
+
+    /// A block's packed vector<transaction_trace>
+    std::string pack_traces(const std::vector<synthetic_transaction>& transactions);
+
+    // Action data in each contract's layout
+    std::string play_data(const contracts& ours, uint64_t player, uint64_t nonce);
+    std::string receiverand_data(const contracts& ours, uint64_t request_id, uint64_t random_word);
+    std::string logresult_data(uint64_t player, bool won, uint32_t roll);
+    std::string issue_data(uint64_t to, int64_t amount, uint64_t symbol);
+    std::string transfer_data(uint64_t from, uint64_t to, int64_t amount, uint64_t symbol);
+
+    struct synthetic_shape {
+        uint32_t first_block = 1;
+        uint32_t blocks = 1000;
+        uint32_t plays_per_block = 20; // each answered in the next block; one transfer per five plays
+        uint64_t seed = 1;
+    };
+
+    /**
+     * Write a trace log segment of play, callback and transfer traffic for
+     * `ours`, mixed with failed transactions and notifications that must
+     * not be ingested
+     * @param global_sequence - Last global sequence used; advanced past the segment's actions
+     * @return the number of records ingest should produce
+     */
+    uint64_t write_synthetic_log(const std::string& path, const contracts& ours, const synthetic_shape& shape,
+                                 uint64_t& global_sequence);
+
+} // namespace ingest
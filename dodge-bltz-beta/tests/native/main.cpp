@@ -0,0 +1,2 @@
+#define BOOST_TEST_MODULE dodge_bltz_native_tests
+#include <boost/test/unit_test.hpp>
@@ -0,0 +1,390 @@
+#include "abi.hpp"
+
+#include <eosio/name.hpp>
+#include <eosio/symbol.hpp>
+
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+namespace snapshot {
+
+    namespace {
+
+        constexpr int max_typedef_depth = 32;
+
+        // Key and signature types: K1, R1, then WebAuthn with its extra fields
+        constexpr uint8_t webauthn = 2;
+
+        bool ends_with(const std::string& s, std::string_view suffix) {
+            return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+        }
+
+        void hex(std::string_view bytes, std::string& out) {
+            static const char digits[] = "0123456789abcdef";
+            for (unsigned char c : bytes) {
+                out.push_back(digits[c >> 4]);
+                out.push_back(digits[c & 0xf]);
+            }
+        }
+
+        void json_string(std::string_view s, std::string& out) {
+            out.push_back('"');
+            for (unsigned char c : s) {
+                switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    } else {
+                        out.push_back(char(c));
+                    }
+                }
+            }
+            out.push_back('"');
+        }
+
+        /// ISO 8601 in UTC, with milliseconds when asked for
+        std::string iso_time(int64_t ms, bool with_ms) {
+            std::time_t seconds = std::time_t(ms / 1000);
+            std::tm t{};
+            gmtime_r(&seconds, &t);
+            char text[40];
+            size_t n = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &t);
+            if (with_ms) std::snprintf(text + n, sizeof(text) - n, ".%03d", int(ms % 1000));
+            return text;
+        }
+
+        std::string uint128_string(unsigned __int128 v) {
+            std::string digits;
+            do {
+                digits.insert(digits.begin(), char('0' + int(v % 10)));
+                v /= 10;
+            } while (v);
+            return digits;
+        }
+
+        std::string asset_string(int64_t amount, uint64_t symbol) {
+            eosio::symbol sym(symbol);
+            uint8_t  precision = sym.precision();
+            uint64_t magnitude = amount < 0 ? uint64_t(0) - uint64_t(amount) : uint64_t(amount);
+            uint64_t p10 = 1;
+            for (uint8_t i = 0; i < precision && i < 19; i++) p10 *= 10;
+
+            std::string text = amount < 0 ? "-" : "";
+            text += std::to_string(magnitude / p10);
+            if (precision) {
+                std::string fraction = std::to_string(magnitude % p10);
+                text += "." + std::string(precision - fraction.size(), '0') + fraction;
+            }
+            return text + " " + sym.code().to_string();
+        }
+
+        std::vector<std::string> string_vector(stream& in) {
+            std::vector<std::string> v(in.varuint32());
+            for (auto& s : v) s = in.string();
+            return v;
+        }
+
+        void pack_strings(std::string& out, const std::vector<std::string>& v) {
+            put_varuint32(out, uint32_t(v.size()));
+            for (const auto& s : v) put_bytes(out, s);
+        }
+
+    } // namespace
+
+    abi abi::parse(std::string_view packed) {
+        stream in(packed);
+        abi a;
+        a.version = in.string();
+        if (a.version.rfind("eosio::abi/1.", 0) != 0) throw std::runtime_error("unsupported abi version " + a.version);
+
+        for (uint32_t n = in.varuint32(); n > 0; n--) {
+            auto name = in.string();
+            a.types[name] = in.string();
+        }
+        for (uint32_t n = in.varuint32(); n > 0; n--) {
+            auto  name = in.string();
+            auto& s = a.structs[name];
+            s.base = in.string();
+            for (uint32_t f = in.varuint32(); f > 0; f--) {
+                auto field = in.string();
+                s.fields.push_back({field, in.string()});
+            }
+        }
+        for (uint32_t n = in.varuint32(); n > 0; n--) { // actions
+            in.u64();
+            in.bytes();
+            in.bytes();
+        }
+        for (uint32_t n = in.varuint32(); n > 0; n--) {
+            uint64_t table = in.u64();
+            in.bytes(); // index_type
+            string_vector(in);
+            string_vector(in);
+            a.tables[table] = in.string();
+        }
+        for (uint32_t n = in.varuint32(); n > 0; n--) { // ricardian_clauses
+            in.bytes();
+            in.bytes();
+        }
+        for (uint32_t n = in.varuint32(); n > 0; n--) { // error_messages
+            in.u64();
+            in.bytes();
+        }
+        for (uint32_t n = in.varuint32(); n > 0; n--) { // abi_extensions
+            in.read<uint16_t>();
+            in.bytes();
+        }
+        if (in.remaining()) {
+            for (uint32_t n = in.varuint32(); n > 0; n--) {
+                auto name = in.string();
+                a.variants[name] = string_vector(in);
+            }
+        }
+        return a;
+    }
+
+    std::string abi::pack() const {
+        std::string out;
+        put_bytes(out, version);
+        put_varuint32(out, uint32_t(types.size()));
+        for (const auto& [name, type] : types) {
+            put_bytes(out, name);
+            put_bytes(out, type);
+        }
+        put_varuint32(out, uint32_t(structs.size()));
+        for (const auto& [name, s] : structs) {
+            put_bytes(out, name);
+            put_bytes(out, s.base);
+            put_varuint32(out, uint32_t(s.fields.size()));
+            for (const auto& f : s.fields) {
+                put_bytes(out, f.name);
+                put_bytes(out, f.type);
+            }
+        }
+        put_varuint32(out, 0);
+        put_varuint32(out, uint32_t(tables.size()));
+        for (const auto& [table, type] : tables) {
+            put_u64(out, table);
+            put_bytes(out, "i64");
+            put_varuint32(out, 0);
+            put_varuint32(out, 0);
+            put_bytes(out, type);
+        }
+        put_varuint32(out, 0);
+        put_varuint32(out, 0);
+        put_varuint32(out, 0);
+        put_varuint32(out, uint32_t(variants.size()));
+        for (const auto& [name, types] : variants) {
+            put_bytes(out, name);
+            pack_strings(out, types);
+        }
+        return out;
+    }
+
+    const std::string& abi::resolve(const std::string& type) const {
+        const std::string* t = &type;
+        for (int depth = 0; depth < max_typedef_depth; depth++) {
+            auto it = types.find(*t);
+            if (it == types.end()) return *t;
+            t = &it->second;
+        }
+        throw std::runtime_error("typedef loop at " + type);
+    }
+
+    std::vector<std::string> abi::columns(const std::string& type) const {
+        auto it = structs.find(resolve(type));
+        if (it == structs.end()) throw std::runtime_error("abi has no struct " + type);
+        auto names = it->second.base.empty() ? std::vector<std::string>{} : columns(it->second.base);
+        for (const auto& f : it->second.fields) names.push_back(f.name);
+        return names;
+    }
+
+    bool abi::builtin(const std::string& type, stream& in, std::string& out, bool quote_strings) const {
+        auto quoted = [&](std::string_view s) {
+            if (quote_strings) {
+                json_string(s, out);
+            } else {
+                out += s;
+            }
+        };
+        auto hex_quoted = [&](std::string_view bytes) {
+            std::string h;
+            hex(bytes, h);
+            quoted(h);
+        };
+
+        if (type == "bool") out += in.u8() ? "true" : "false";
+        else if (type == "int8") out += std::to_string(in.read<int8_t>());
+        else if (type == "uint8") out += std::to_string(in.u8());
+        else if (type == "int16") out += std::to_string(in.read<int16_t>());
+        else if (type == "uint16") out += std::to_string(in.read<uint16_t>());
+        else if (type == "int32") out += std::to_string(in.read<int32_t>());
+        else if (type == "uint32") out += std::to_string(in.u32());
+        else if (type == "int64") out += std::to_string(in.read<int64_t>());
+        else if (type == "uint64") out += std::to_string(in.u64());
+        else if (type == "varint32") out += std::to_string(in.varint32());
+        else if (type == "varuint32") out += std::to_string(in.varuint32());
+        else if (type == "uint128") quoted(uint128_string(in.read<unsigned __int128>()));
+        else if (type == "int128") {
+            auto v = in.read<__int128>();
+            quoted(v < 0 ? "-" + uint128_string((unsigned __int128)0 - (unsigned __int128)v) : uint128_string((unsigned __int128)v));
+        } else if (type == "float32" || type == "float64") {
+            char text[32];
+            if (type == "float32") {
+                std::snprintf(text, sizeof(text), "%.9g", double(in.read<float>()));
+            } else {
+                std::snprintf(text, sizeof(text), "%.17g", in.read<double>());
+            }
+            out += text;
+        } else if (type == "float128") hex_quoted(in.bytes(16));
+        else if (type == "time_point") quoted(iso_time(in.read<int64_t>() / 1000, true));
+        else if (type == "time_point_sec") quoted(iso_time(int64_t(in.u32()) * 1000, false));
+        else if (type == "block_timestamp_type") quoted(iso_time(int64_t(in.u32()) * 500 + 946684800000LL, true));
+        else if (type == "name") quoted(eosio::name(in.u64()).to_string());
+        else if (type == "string") quoted(in.bytes());
+        else if (type == "bytes") hex_quoted(in.bytes());
+        else if (type == "checksum160") hex_quoted(in.bytes(20));
+        else if (type == "checksum256") hex_quoted(in.bytes(32));
+        else if (type == "checksum512") hex_quoted(in.bytes(64));
+        else if (type == "public_key" || type == "signature") {
+            const char* start = in.pos;
+            uint8_t kind = in.u8();
+            in.skip(type == "public_key" ? 33 : 65);
+            if (kind == webauthn) {
+                if (type == "public_key") {
+                    in.u8();
+                    in.bytes();
+                } else {
+                    in.bytes();
+                    in.bytes();
+                }
+            }
+            hex_quoted(std::string_view(start, size_t(in.pos - start)));
+        } else if (type == "symbol_code") quoted(eosio::symbol_code(in.u64()).to_string());
+        else if (type == "symbol") quoted(eosio::symbol(in.u64()).to_string());
+        else if (type == "asset") {
+            int64_t amount = in.read<int64_t>();
+            quoted(asset_string(amount, in.u64()));
+        } else if (type == "extended_asset") {
+            int64_t amount = in.read<int64_t>();
+            auto    quantity = asset_string(amount, in.u64());
+            auto    contract = eosio::name(in.u64()).to_string();
+            out += "{\"quantity\":";
+            json_string(quantity, out);
+            out += ",\"contract\":";
+            json_string(contract, out);
+            out += "}";
+        } else return false;
+        return true;
+    }
+
+    void abi::json(const std::string& type, stream& in, std::string& out) const {
+        if (ends_with(type, "$")) {
+            if (in.remaining() == 0) {
+                out += "null";
+            } else {
+                json(type.substr(0, type.size() - 1), in, out);
+            }
+            return;
+        }
+        if (ends_with(type, "[]")) {
+            auto element = type.substr(0, type.size() - 2);
+            uint32_t n = in.varuint32();
+            out.push_back('[');
+            for (uint32_t i = 0; i < n; i++) {
+                if (i) out.push_back(',');
+                json(element, in, out);
+            }
+            out.push_back(']');
+            return;
+        }
+        if (ends_with(type, "?")) {
+            if (in.u8()) {
+                json(type.substr(0, type.size() - 1), in, out);
+            } else {
+                out += "null";
+            }
+            return;
+        }
+
+        const auto& t = resolve(type);
+        if (t != type) return json(t, in, out);
+        if (builtin(t, in, out, true)) return;
+        if (auto v = variants.find(t); v != variants.end()) {
+            uint32_t index = in.varuint32();
+            if (index >= v->second.size()) throw std::runtime_error("variant index out of range for " + t);
+            out.push_back('[');
+            json_string(v->second[index], out);
+            out.push_back(',');
+            json(v->second[index], in, out);
+            out.push_back(']');
+            return;
+        }
+        if (auto s = structs.find(t); s != structs.end()) {
+            out.push_back('{');
+            struct_json(s->second, in, out);
+            out.push_back('}');
+            return;
+        }
+        throw std::runtime_error("abi has no type " + t);
+    }
+
+    void abi::struct_json(const abi_struct& s, stream& in, std::string& out) const {
+        if (!s.base.empty()) {
+            auto base = structs.find(resolve(s.base));
+            if (base == structs.end()) throw std::runtime_error("abi has no struct " + s.base);
+            struct_json(base->second, in, out);
+        }
+        for (const auto& f : s.fields) {
+            if (ends_with(f.type, "$") && in.remaining() == 0) break;
+            if (out.back() != '{') out.push_back(',');
+            json_string(f.name, out);
+            out.push_back(':');
+            json(f.type, in, out);
+        }
+    }
+
+    void abi::csv_cells(const std::string& type, stream& in, std::string& out) const {
+        auto it = structs.find(resolve(type));
+        if (it == structs.end()) throw std::runtime_error("abi has no struct " + type);
+        const auto& s = it->second;
+        if (!s.base.empty()) csv_cells(s.base, in, out);
+
+        std::string cell;
+        for (const auto& f : s.fields) {
+            out.push_back(',');
+            if (ends_with(f.type, "$") && in.remaining() == 0) continue;
+
+            cell.clear();
+            auto field_type = ends_with(f.type, "$") ? f.type.substr(0, f.type.size() - 1) : f.type;
+            if (ends_with(field_type, "?")) {
+                if (!in.u8()) continue;
+                field_type.pop_back();
+            }
+            if (!builtin(resolve(field_type), in, cell, false)) json(field_type, in, cell);
+            csv_escape(cell, out);
+        }
+    }
+
+    void csv_escape(std::string_view cell, std::string& out) {
+        if (cell.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out += cell;
+            return;
+        }
+        out.push_back('"');
+        for (char c : cell) {
+            if (c == '"') out.push_back('"');
+            out.push_back(c);
+        }
+        out.push_back('"');
+    }
+
+} // namespace snapshot
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "stream.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Contract ABIs as the chain stores them, packed abi_def, and the decoding
+ * of table rows through them. Values are rendered the way nodeos renders
+ * them in get_table_rows, except that 64-bit integers are not quoted and
+ * keys and signatures are shown as hex.
+ */
+namespace snapshot {
+
+    struct abi_field {
+        std::string name;
+        std::string type;
+    };
+
+    struct abi_struct {
+        std::string            base;
+        std::vector<abi_field> fields;
+    };
+
+    struct abi {
+        std::string                                     version = "eosio::abi/1.2";
+        std::map<std::string, std::string>              types;    // typedefs
+        std::map<std::string, abi_struct>               structs;
+        std::map<std::string, std::vector<std::string>> variants;
+        std::map<uint64_t, std::string>                 tables;   // table name to row type
+
+        /// @throws std::runtime_error if `packed` is not an abi_def
+        static abi parse(std::string_view packed);
+
+        /// The abi_def bytes; only the parts above are kept, so actions and clauses are dropped
+        std::string pack() const;
+
+        /// The names of a struct's fields, its bases' first
+        std::vector<std::string> columns(const std::string& type) const;
+
+        /// Append one CSV cell per field of a row of struct `type`. Strings are
+        /// written bare, nested values as JSON; an absent optional or binary
+        /// extension is an empty cell.
+        void csv_cells(const std::string& type, stream& in, std::string& out) const;
+
+        /// Append a value of `type` as JSON
+        void json(const std::string& type, stream& in, std::string& out) const;
+
+    private:
+        const std::string& resolve(const std::string& type) const;
+        void               struct_json(const abi_struct& s, stream& in, std::string& out) const;
+        bool               builtin(const std::string& type, stream& in, std::string& out, bool quote_strings) const;
+    };
+
+    /// Append `cell` to a CSV line, quoted if it needs to be
+    void csv_escape(std::string_view cell, std::string& out);
+
+} // namespace snapshot
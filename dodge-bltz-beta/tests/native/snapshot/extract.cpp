@@ -0,0 +1,271 @@
+#include "extract.hpp"
+#include "abi.hpp"
+#include "snapshot.hpp"
+
+#include <eosio/name.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace snapshot {
+
+    namespace {
+
+        constexpr char     dump_magic[4] = {'D', 'B', 'S', 'X'};
+        constexpr uint16_t dump_version = 1;
+        constexpr size_t   chunk_bytes = 1 << 20; // snapshot bytes formatted per task
+
+        /// One output file: a table of one contract, across all its scopes
+        struct output {
+            uint64_t           code;
+            uint64_t           table;
+            const abi*         contract = nullptr; // null for binary dumps
+            const std::string* row_type = nullptr; // null when the ABI does not describe the table
+            std::string        path;
+            FILE*              file = nullptr;
+        };
+
+        struct chunk {
+            size_t first; // into the spans
+            size_t last;
+        };
+
+        /// A chunk's formatted rows, one buffer per output
+        struct formatted {
+            std::vector<std::string> text;
+            uint64_t                 rows = 0;
+            std::exception_ptr       error;
+        };
+
+        std::string name_string(uint64_t v) { return eosio::name(v).to_string(); }
+
+        void format_span(const snapshot_file& snap, const table_span& t, const output& o, std::string& out) {
+            stream in(snap.bytes(t.offset, t.size));
+            for (uint32_t r = 0; r < t.rows; r++) {
+                uint64_t primary_key = in.u64();
+                uint64_t payer = in.u64();
+                auto     value = in.bytes();
+
+                if (!o.contract) {
+                    put_u64(out, t.scope);
+                    put_u64(out, primary_key);
+                    put_u64(out, payer);
+                    put_u32(out, uint32_t(value.size()));
+                    out += value;
+                    continue;
+                }
+
+                out += name_string(t.scope);
+                out.push_back(',');
+                out += std::to_string(primary_key);
+                out.push_back(',');
+                out += name_string(payer);
+                if (!o.row_type) {
+                    out.push_back(',');
+                    static const char digits[] = "0123456789abcdef";
+                    for (unsigned char c : value) {
+                        out.push_back(digits[c >> 4]);
+                        out.push_back(digits[c & 0xf]);
+                    }
+                } else {
+                    try {
+                        stream row(value);
+                        o.contract->csv_cells(*o.row_type, row, out);
+                        if (row.remaining()) throw std::runtime_error("row longer than its type");
+                    } catch (const std::runtime_error& e) {
+                        throw std::runtime_error(name_string(t.code) + "." + name_string(t.table) + " scope " +
+                                                 name_string(t.scope) + " row " + std::to_string(primary_key) + ": " +
+                                                 e.what());
+                    }
+                }
+                out.push_back('\n');
+            }
+        }
+
+    } // namespace
+
+    summary extract(const std::string& snapshot_path, const std::string& out_dir, const options& opts) {
+        auto start = std::chrono::steady_clock::now();
+        snapshot_file snap(snapshot_path);
+
+        summary s;
+        s.version = snap.version();
+
+        auto codes = opts.codes;
+        auto tables = opts.tables;
+        std::sort(codes.begin(), codes.end());
+        std::sort(tables.begin(), tables.end());
+        auto wanted_code = [&](uint64_t code) { return std::binary_search(codes.begin(), codes.end(), code); };
+        auto wanted = [&](uint64_t code, uint64_t table) {
+            return wanted_code(code) && (tables.empty() || std::binary_search(tables.begin(), tables.end(), table));
+        };
+
+        std::map<uint64_t, abi> abis;
+        if (opts.output == format::csv) {
+            for (const auto& [account, packed] : snap.abis(wanted_code)) {
+                if (packed.empty()) {
+                    throw std::runtime_error(name_string(account) + " has no ABI in the snapshot; extract it with the binary format");
+                }
+                abis.emplace(account, abi::parse(packed));
+            }
+        }
+
+        auto spans = snap.tables(wanted, &s.tables_seen);
+        s.scopes = spans.size();
+
+        // An output per table, in order of first appearance
+        std::filesystem::create_directories(out_dir);
+        std::vector<output>                            outputs;
+        std::map<std::pair<uint64_t, uint64_t>, size_t> output_of;
+        std::vector<size_t>                            span_output(spans.size());
+        for (size_t i = 0; i < spans.size(); i++) {
+            auto key = std::pair{spans[i].code, spans[i].table};
+            auto it = output_of.find(key);
+            if (it == output_of.end()) {
+                output o{.code = key.first,
+                         .table = key.second,
+                         .path = out_dir + "/" + name_string(key.first) + "." + name_string(key.second) +
+                                 (opts.output == format::csv ? ".csv" : ".bin")};
+                if (opts.output == format::csv) {
+                    auto a = abis.find(o.code);
+                    if (a == abis.end()) throw std::runtime_error(name_string(o.code) + " has no account in the snapshot");
+                    o.contract = &a->second;
+                    auto type = a->second.tables.find(o.table);
+                    if (type != a->second.tables.end()) o.row_type = &type->second;
+                }
+                it = output_of.emplace(key, outputs.size()).first;
+                outputs.push_back(std::move(o));
+            }
+            span_output[i] = it->second;
+        }
+
+        std::exception_ptr failure;
+        try {
+            for (auto& o : outputs) {
+                o.file = std::fopen(o.path.c_str(), "wb");
+                if (!o.file) throw std::runtime_error("cannot write " + o.path);
+                s.files.push_back(o.path);
+
+                std::string header;
+                if (opts.output == format::csv) {
+                    header = "scope,primary_key,payer";
+                    auto columns = o.row_type ? o.contract->columns(*o.row_type) : std::vector<std::string>{"data"};
+                    for (const auto& c : columns) {
+                        header.push_back(',');
+                        csv_escape(c, header);
+                    }
+                    header.push_back('\n');
+                } else {
+                    header.append(dump_magic, sizeof(dump_magic));
+                    header.append(reinterpret_cast<const char*>(&dump_version), 2);
+                    header.append(2, '\0');
+                    put_u32(header, snap.version());
+                    put_u32(header, 0);
+                }
+                std::fwrite(header.data(), 1, header.size(), o.file);
+                s.bytes_written += header.size();
+            }
+
+            std::vector<chunk> chunks;
+            for (size_t i = 0; i < spans.size();) {
+                chunk c{i, i};
+                size_t bytes = 0;
+                while (c.last < spans.size() && (c.last == c.first || bytes < chunk_bytes)) bytes += spans[c.last++].size;
+                chunks.push_back(c);
+                i = c.last;
+            }
+
+            unsigned threads = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+            threads = std::min<unsigned>(threads, unsigned(std::max<size_t>(chunks.size(), 1)));
+            size_t window = 4 * threads; // formatted chunks allowed ahead of the writer
+
+            std::mutex                            mutex;
+            std::condition_variable               changed;
+            std::vector<std::optional<formatted>> done(chunks.size());
+            size_t                                next = 0, written = 0;
+            bool                                  stopping = false;
+
+            auto worker = [&] {
+                for (;;) {
+                    size_t i;
+                    {
+                        std::unique_lock lock(mutex);
+                        changed.wait(lock, [&] { return stopping || next == chunks.size() || next < written + window; });
+                        if (stopping || next == chunks.size()) return;
+                        i = next++;
+                    }
+                    formatted f;
+                    f.text.resize(outputs.size());
+                    try {
+                        for (size_t t = chunks[i].first; t < chunks[i].last; t++) {
+                            format_span(snap, spans[t], outputs[span_output[t]], f.text[span_output[t]]);
+                            f.rows += spans[t].rows;
+                        }
+                    } catch (...) {
+                        f.error = std::current_exception();
+                    }
+                    {
+                        std::lock_guard lock(mutex);
+                        done[i] = std::move(f);
+                    }
+                    changed.notify_all();
+                }
+            };
+
+            std::vector<std::thread> pool;
+            for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker);
+            try {
+                for (size_t i = 0; i < chunks.size(); i++) {
+                    formatted f;
+                    {
+                        std::unique_lock lock(mutex);
+                        changed.wait(lock, [&] { return done[i].has_value(); });
+                        f = std::move(*done[i]);
+                        done[i].reset();
+                    }
+                    if (f.error) std::rethrow_exception(f.error);
+                    for (size_t o = 0; o < outputs.size(); o++) {
+                        if (f.text[o].empty()) continue;
+                        if (std::fwrite(f.text[o].data(), 1, f.text[o].size(), outputs[o].file) != f.text[o].size()) {
+                            throw std::runtime_error("cannot write " + outputs[o].path);
+                        }
+                        s.bytes_written += f.text[o].size();
+                    }
+                    s.rows += f.rows;
+                    {
+                        std::lock_guard lock(mutex);
+                        written = i + 1;
+                    }
+                    changed.notify_all();
+                }
+            } catch (...) {
+                failure = std::current_exception();
+            }
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            changed.notify_all();
+            for (auto& t : pool) t.join();
+        } catch (...) {
+            failure = std::current_exception();
+        }
+
+        for (auto& o : outputs) {
+            if (o.file && std::fclose(o.file) != 0 && !failure) failure = std::make_exception_ptr(std::runtime_error("cannot write " + o.path));
+        }
+        if (failure) std::rethrow_exception(failure);
+
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return s;
+    }
+
+} // namespace snapshot
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace snapshot {
+
+    enum class format { csv, binary };
+
+    struct options {
+        std::vector<uint64_t> codes;  // contracts whose tables to extract
+        std::vector<uint64_t> tables; // empty for all of their tables
+        format                output = format::csv;
+        unsigned              threads = 0; // 0: one per core
+    };
+
+    struct summary {
+        uint32_t                 version = 0;
+        uint64_t                 tables_seen = 0; // every table of every scope in the snapshot
+        uint64_t                 scopes = 0;      // tables of ours, counted once per scope
+        uint64_t                 rows = 0;
+        uint64_t                 bytes_written = 0;
+        std::vector<std::string> files;
+        double                   seconds = 0;
+    };
+
+    /**
+     * Write each of our tables, every scope of it, to `out_dir`: one
+     * `<code>.<table>.csv` or `.bin` per table, in snapshot order. CSV rows
+     * are the scope, primary key and payer, then the row's fields decoded
+     * through the contract's ABI as stored in the snapshot. The binary dump
+     * keeps rows packed:
+     *
+     *     char   magic[4]  "DBSX"
+     *     uint16 version
+     *     uint16 reserved
+     *     uint32 snapshot version
+     *     uint32 reserved
+     *     rows, each: uint64 scope, uint64 primary_key, uint64 payer, uint32 size, bytes
+     *
+     * The tables are located in one pass over the snapshot, then decoded
+     * and formatted in parallel in snapshot-ordered chunks.
+     */
+    summary extract(const std::string& snapshot_path, const std::string& out_dir, const options& opts);
+
+} // namespace snapshot
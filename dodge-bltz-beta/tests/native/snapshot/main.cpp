@@ -0,0 +1,81 @@
+#include "extract.hpp"
+#include "synthetic.hpp"
+
+#include <eosio/name.hpp>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    const char* const usage =
+        "usage: snapshot [options] SNAPSHOT OUT_DIR   extract our contracts' tables from a portable snapshot\n"
+        "       snapshot synth [--players N] [--holders N] SNAPSHOT\n"
+        "                                             write a synthetic snapshot\n"
+        "options: --code ACCOUNT (repeatable; default gameplay and dbptoken)\n"
+        "         --table NAME (repeatable; default all of their tables)\n"
+        "         --format csv|bin --threads N\n";
+
+    struct arguments {
+        snapshot::options         opts;
+        snapshot::synthetic_shape shape;
+        std::vector<std::string>  paths;
+    };
+
+    arguments parse(int argc, char** argv) {
+        arguments args;
+        for (int i = 0; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                args.paths.push_back(arg);
+                continue;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            std::string value = argv[++i];
+            if (arg == "--code") args.opts.codes.push_back(eosio::name(value).value);
+            else if (arg == "--table") args.opts.tables.push_back(eosio::name(value).value);
+            else if (arg == "--threads") args.opts.threads = unsigned(std::stoul(value));
+            else if (arg == "--players") args.shape.players = uint32_t(std::stoul(value));
+            else if (arg == "--holders") args.shape.holders = uint32_t(std::stoul(value));
+            else if (arg == "--format") {
+                if (value != "csv" && value != "bin") throw std::invalid_argument("unknown format " + value);
+                args.opts.output = value == "csv" ? snapshot::format::csv : snapshot::format::binary;
+            } else throw std::invalid_argument("unknown option " + arg);
+        }
+        if (args.opts.codes.empty()) args.opts.codes = {"gameplay"_n.value, "dbptoken"_n.value};
+        return args;
+    }
+
+    int synth(const arguments& args) {
+        if (args.paths.size() != 1) throw std::invalid_argument("synth takes one snapshot path");
+        auto counts = snapshot::write_synthetic_snapshot(args.paths[0], args.shape);
+        std::cout << counts.tables << " tables, " << counts.gameplay_rows + counts.token_rows << " rows of ours, written to "
+                  << args.paths[0] << "\n";
+        return 0;
+    }
+
+    int extract(const arguments& args) {
+        if (args.paths.size() != 2) throw std::invalid_argument("need a snapshot and an output directory");
+        auto s = snapshot::extract(args.paths[0], args.paths[1], args.opts);
+        std::printf("snapshot      version %u, %llu tables\n", s.version, (unsigned long long)s.tables_seen);
+        std::printf("extracted     %llu scopes, %llu rows, %.1f MB\n", (unsigned long long)s.scopes, (unsigned long long)s.rows,
+                    double(s.bytes_written) / 1e6);
+        for (const auto& f : s.files) std::printf("              %s\n", f.c_str());
+        std::printf("time          %.2f s\n", s.seconds);
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        if (argc > 1 && std::string(argv[1]) == "synth") return synth(parse(argc - 2, argv + 2));
+        if (argc > 2) return extract(parse(argc - 1, argv + 1));
+        std::cerr << usage;
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "snapshot: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,160 @@
+#include "snapshot.hpp"
+#include "stream.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace snapshot {
+
+    namespace {
+
+        constexpr uint64_t end_marker = ~uint64_t(0);
+
+        // Secondary key sizes: index64, index128, index256, index_double, index_long_double
+        constexpr size_t secondary_key_size[5] = {8, 16, 32, 8, 16};
+
+    } // namespace
+
+    snapshot_file::snapshot_file(const std::string& path) : path(path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot read " + path);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat " + path);
+        }
+        length = size_t(st.st_size);
+        if (length < 16) {
+            ::close(fd);
+            throw std::runtime_error(path + ": not a snapshot");
+        }
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+        data = static_cast<const char*>(mapped);
+
+        try {
+            stream in(data, data + length);
+            if (in.u32() != magic) throw std::runtime_error(path + ": not a portable snapshot");
+            format_version = in.u32();
+            if (format_version < min_version || format_version > max_version) {
+                throw std::runtime_error(path + ": unsupported snapshot version " + std::to_string(format_version));
+            }
+
+            for (;;) {
+                uint64_t size = in.u64();
+                if (size == end_marker) break;
+                if (size < 8 || size > in.remaining()) throw std::runtime_error(path + ": truncated section");
+                const char* end = in.pos + size;
+
+                section s;
+                s.rows = in.u64();
+                stream header(in.pos, end);
+                s.name = header.cstring();
+                s.offset = size_t(header.pos - data);
+                s.size = size_t(end - header.pos);
+                all.push_back(std::move(s));
+                in.pos = end;
+            }
+        } catch (...) {
+            ::munmap(const_cast<char*>(data), length);
+            throw;
+        }
+    }
+
+    snapshot_file::~snapshot_file() { ::munmap(const_cast<char*>(data), length); }
+
+    const section& snapshot_file::find(std::string_view name) const {
+        for (const auto& s : all) {
+            if (s.name == name) return s;
+        }
+        throw std::runtime_error(path + ": no " + std::string(name) + " section");
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> snapshot_file::abis(const std::function<bool(uint64_t)>& wanted) const {
+        std::vector<std::pair<uint64_t, std::string>> out;
+        const auto& s = find("eosio::chain::account_object");
+        stream in(rows(s));
+        for (uint64_t i = 0; i < s.rows; i++) {
+            uint64_t account = in.u64();
+            in.u32(); // creation_date
+            auto abi = in.bytes();
+            if (wanted(account)) out.emplace_back(account, std::string(abi));
+        }
+        return out;
+    }
+
+    std::vector<table_span> snapshot_file::tables(const std::function<bool(uint64_t, uint64_t)>& wanted,
+                                                  uint64_t* tables_seen) const {
+        std::vector<table_span> out;
+        const auto& s = find("contract_tables");
+        stream in(rows(s));
+        uint64_t seen = 0;
+        try {
+            while (in.remaining()) {
+                table_span t{};
+                t.code = in.u64();
+                t.scope = in.u64();
+                t.table = in.u64();
+                in.u64(); // payer
+                in.u32(); // count
+                seen++;
+
+                // key_value rows: primary_key, payer, value
+                t.rows = in.varuint32();
+                t.offset = size_t(in.pos - data);
+                for (uint32_t r = 0; r < t.rows; r++) {
+                    in.skip(16);
+                    in.skip(in.varuint32());
+                }
+                t.size = size_t(in.pos - data) - t.offset;
+                if (wanted(t.code, t.table)) out.push_back(t);
+
+                // Secondary rows: primary_key, payer, secondary_key
+                for (size_t key_size : secondary_key_size) {
+                    uint32_t n = in.varuint32();
+                    if (n > in.remaining() / (16 + key_size)) throw std::runtime_error("truncated secondary index");
+                    in.skip(n * (16 + key_size));
+                }
+            }
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ": contract_tables: " + e.what());
+        }
+        if (tables_seen) *tables_seen = seen;
+        return out;
+    }
+
+    snapshot_writer::snapshot_writer(const std::string& path, uint32_t version) : path(path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) throw std::runtime_error("cannot write " + path);
+        std::fwrite(&magic, 4, 1, file);
+        std::fwrite(&version, 4, 1, file);
+    }
+
+    snapshot_writer::~snapshot_writer() {
+        if (file) std::fclose(file);
+    }
+
+    void snapshot_writer::add_section(std::string_view name, uint64_t rows, std::string_view packed_rows) {
+        uint64_t size = 8 + name.size() + 1 + packed_rows.size();
+        std::fwrite(&size, 8, 1, file);
+        std::fwrite(&rows, 8, 1, file);
+        std::fwrite(name.data(), 1, name.size(), file);
+        std::fputc(0, file);
+        std::fwrite(packed_rows.data(), 1, packed_rows.size(), file);
+    }
+
+    void snapshot_writer::finish() {
+        std::fwrite(&end_marker, 8, 1, file);
+        bool ok = std::ferror(file) == 0;
+        std::fclose(file);
+        file = nullptr;
+        if (!ok) throw std::runtime_error("cannot write " + path);
+    }
+
+} // namespace snapshot
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * nodeos portable snapshots, the binary form written by
+ * `producer_api/create_snapshot`:
+ *
+ *     uint32 magic            0x30510550
+ *     uint32 version
+ *     sections, each:
+ *         uint64 size         bytes after this field to the section's end
+ *         uint64 row_count
+ *         char   name[]       null terminated
+ *         rows
+ *     uint64 end marker       all ones
+ *
+ * Contract tables are the "contract_tables" section. For each table there
+ * is its table_id row (code, scope, table, payer, uint32 count), then the
+ * table's primary rows and each of its five secondary indexes in turn, every
+ * one a varuint32 row count followed by the rows.
+ */
+namespace snapshot {
+
+    inline constexpr uint32_t magic = 0x30510550;
+
+    // account_object has been (name, creation_date, abi) since version 2
+    inline constexpr uint32_t min_version = 2;
+    inline constexpr uint32_t max_version = 8;
+
+    struct section {
+        std::string name;
+        uint64_t    rows = 0;
+        size_t      offset = 0; // first row
+        size_t      size = 0;   // bytes of rows
+    };
+
+    /// One table of one scope, located but not decoded
+    struct table_span {
+        uint64_t code;
+        uint64_t scope;
+        uint64_t table;
+        uint32_t rows;
+        size_t   offset; // first primary row
+        size_t   size;   // bytes of primary rows
+    };
+
+    /// A snapshot file mapped read-only, with its sections located
+    class snapshot_file {
+    public:
+        explicit snapshot_file(const std::string& path);
+        ~snapshot_file();
+
+        snapshot_file(const snapshot_file&) = delete;
+        snapshot_file& operator=(const snapshot_file&) = delete;
+
+        uint32_t version() const { return format_version; }
+
+        const std::vector<section>& sections() const { return all; }
+
+        /// @throws std::runtime_error if the snapshot has no such section
+        const section& find(std::string_view name) const;
+
+        std::string_view bytes(size_t offset, size_t size) const { return {data + offset, size}; }
+
+        std::string_view rows(const section& s) const { return bytes(s.offset, s.size); }
+
+        /// Every account's packed ABI, for the accounts `wanted` accepts
+        std::vector<std::pair<uint64_t, std::string>> abis(const std::function<bool(uint64_t)>& wanted) const;
+
+        /**
+         * Walk the contract tables, returning the primary rows of those whose
+         * code and table `wanted` accepts, in snapshot order. Secondary index
+         * rows are derived from the primary ones and are skipped.
+         */
+        std::vector<table_span> tables(const std::function<bool(uint64_t code, uint64_t table)>& wanted,
+                                       uint64_t* tables_seen = nullptr) const;
+
+    private:
+        std::string          path;
+        const char*          data = nullptr;
+        size_t               length = 0;
+        uint32_t             format_version = 0;
+        std::vector<section> all;
+    };
+
+    /// Packs sections into a snapshot file; for tests and synthetic snapshots
+    class snapshot_writer {
+    public:
+        snapshot_writer(const std::string& path, uint32_t version);
+        ~snapshot_writer();
+
+        snapshot_writer(const snapshot_writer&) = delete;
+        snapshot_writer& operator=(const snapshot_writer&) = delete;
+
+        void add_section(std::string_view name, uint64_t rows, std::string_view packed_rows);
+
+        /// Writes the end marker
+        void finish();
+
+    private:
+        std::string path;
+        FILE*       file;
+    };
+
+} // namespace snapshot
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace snapshot {
+
+    /// A cursor over packed bytes that reads in place and only checks bounds
+    struct stream {
+        const char* pos;
+        const char* end;
+
+        stream(const char* begin, const char* end) : pos(begin), end(end) {}
+        explicit stream(std::string_view bytes) : pos(bytes.data()), end(bytes.data() + bytes.size()) {}
+
+        size_t remaining() const { return size_t(end - pos); }
+
+        void need(size_t n) const {
+            if (remaining() < n) throw std::runtime_error("unexpected end of packed data");
+        }
+
+        void skip(size_t n) {
+            need(n);
+            pos += n;
+        }
+
+        template <typename T>
+        T read() {
+            need(sizeof(T));
+            T v;
+            std::memcpy(&v, pos, sizeof(T));
+            pos += sizeof(T);
+            return v;
+        }
+
+        uint8_t  u8() { return read<uint8_t>(); }
+        uint32_t u32() { return read<uint32_t>(); }
+        uint64_t u64() { return read<uint64_t>(); }
+
+        uint32_t varuint32() {
+            uint32_t v = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                uint8_t b = u8();
+                v |= uint32_t(b & 0x7f) << shift;
+                if (!(b & 0x80)) return v;
+            }
+            throw std::runtime_error("overlong varuint32");
+        }
+
+        int32_t varint32() {
+            uint32_t v = varuint32();
+            return int32_t(v >> 1) ^ -int32_t(v & 1);
+        }
+
+        std::string_view bytes(size_t n) {
+            need(n);
+            std::string_view view(pos, n);
+            pos += n;
+            return view;
+        }
+
+        std::string_view bytes() { return bytes(varuint32()); }
+
+        std::string string() { return std::string(bytes()); }
+
+        /// A null-terminated string, as section names are stored
+        std::string_view cstring() {
+            const void* nul = std::memchr(pos, 0, remaining());
+            if (!nul) throw std::runtime_error("unterminated string");
+            std::string_view view(pos, size_t(static_cast<const char*>(nul) - pos));
+            pos += view.size() + 1;
+            return view;
+        }
+    };
+
+    // Little-endian packing, for the writers
+    inline void put_u8(std::string& out, uint8_t v) { out.push_back(char(v)); }
+    inline void put_u32(std::string& out, uint32_t v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+    inline void put_u64(std::string& out, uint64_t v) { out.append(reinterpret_cast<const char*>(&v), sizeof(v)); }
+
+    inline void put_varuint32(std::string& out, uint32_t v) {
+        while (v >= 0x80) {
+            out.push_back(char(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(char(v));
+    }
+
+    inline void put_bytes(std::string& out, std::string_view bytes) {
+        put_varuint32(out, uint32_t(bytes.size()));
+        out.append(bytes);
+    }
+
+} // namespace snapshot
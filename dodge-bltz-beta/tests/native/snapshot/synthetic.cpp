@@ -0,0 +1,206 @@
+#include "synthetic.hpp"
+#include "snapshot.hpp"
+
+#include <eosio/name.hpp>
+#include <eosio/symbol.hpp>
+
+namespace snapshot {
+
+    namespace {
+
+        constexpr uint32_t synthetic_version = 6;
+
+        uint64_t splitmix64(uint64_t& state) {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        /// A valid account name from a number, so the dumps read like real ones
+        uint64_t account(uint64_t n) {
+            std::string s;
+            for (int i = 0; i < 12; i++) {
+                s.push_back("abcdefghijklmnopqrstuvwxyz12345"[n % 31]);
+                n /= 31;
+            }
+            return eosio::name(s).value;
+        }
+
+        /// Packs the contract_tables section
+        struct table_packer {
+            std::string rows;
+            uint64_t    tables = 0;
+
+            void begin(uint64_t code, uint64_t scope, uint64_t table, uint32_t count) {
+                put_u64(rows, code);
+                put_u64(rows, scope);
+                put_u64(rows, table);
+                put_u64(rows, code);
+                put_u32(rows, count);
+                put_varuint32(rows, count);
+                tables++;
+            }
+
+            void row(uint64_t primary_key, uint64_t payer, std::string_view value) {
+                put_u64(rows, primary_key);
+                put_u64(rows, payer);
+                put_bytes(rows, value);
+            }
+
+            /// Each secondary index's rows; `per_index` of every kind
+            void secondaries(uint32_t per_index) {
+                const size_t key_sizes[5] = {8, 16, 32, 8, 16};
+                for (size_t size : key_sizes) {
+                    put_varuint32(rows, per_index);
+                    for (uint32_t i = 0; i < per_index; i++) {
+                        put_u64(rows, i);
+                        put_u64(rows, 0);
+                        rows.append(size, char(0x40 + i));
+                    }
+                }
+            }
+        };
+
+    } // namespace
+
+    abi gameplay_abi() {
+        abi a;
+        a.structs["player_stats"] = {"",
+                                     {{"player", "name"},
+                                      {"total_plays", "uint64"},
+                                      {"total_wins", "uint64"},
+                                      {"last_nonce", "string"},
+                                      {"schema_version", "uint8$"},
+                                      {"last_play", "time_point_sec$"},
+                                      {"last_cnonce", "uint64$"}}};
+        a.structs["pending_rng"] = {"",
+                                    {{"id", "uint64"},
+                                     {"generation", "uint32"},
+                                     {"in_use", "bool"},
+                                     {"next_free", "uint64"},
+                                     {"player", "name"},
+                                     {"signing_value", "uint64"},
+                                     {"timestamp", "time_point"},
+                                     {"schema_version", "uint8$"},
+                                     {"provider", "uint8$"},
+                                     {"sent_at", "time_point$"}}};
+        a.tables["players"_n.value] = "player_stats";
+        a.tables["rngslots"_n.value] = "pending_rng";
+        return a;
+    }
+
+    abi token_abi() {
+        abi a;
+        a.structs["account"] = {"", {{"balance", "asset"}}};
+        a.structs["currency_stats"] = {"", {{"supply", "asset"}, {"max_supply", "asset"}, {"issuer", "name"}}};
+        a.tables["accounts"_n.value] = "account";
+        a.tables["stat"_n.value] = "currency_stats";
+        return a;
+    }
+
+    synthetic_counts write_synthetic_snapshot(const std::string& path, const synthetic_shape& shape) {
+        const uint64_t gameplay = "gameplay"_n.value, token = "dbptoken"_n.value, other = "othergame"_n.value;
+        const uint64_t dbp = eosio::symbol("DBP", 4).raw();
+        uint64_t       rng = shape.seed;
+        synthetic_counts counts;
+
+        snapshot_writer out(path, synthetic_version);
+        std::string header;
+        put_u32(header, synthetic_version);
+        out.add_section("eosio::chain::chain_snapshot_header", 1, header);
+        out.add_section("eosio::chain::block_state", 1, std::string(300, '\x07'));
+
+        // account_object: name, creation_date, abi
+        abi other_abi;
+        other_abi.structs["thing"] = {"", {{"id", "uint64"}, {"blob", "bytes"}}};
+        other_abi.tables["things"_n.value] = "thing";
+        std::string accounts;
+        for (auto [name, a] : {std::pair{"eosio"_n.value, std::string()}, std::pair{gameplay, gameplay_abi().pack()},
+                               std::pair{token, token_abi().pack()}, std::pair{other, other_abi.pack()}}) {
+            put_u64(accounts, name);
+            put_u32(accounts, 0);
+            put_bytes(accounts, a);
+        }
+        out.add_section("eosio::chain::account_object", 4, accounts);
+
+        table_packer tables;
+
+        // An unrelated contract first, so ours sit between tables to be skipped
+        for (uint32_t t = 0; t < shape.other_tables / 2; t++) {
+            tables.begin(other, account(t), "things"_n.value, 3);
+            for (uint32_t r = 0; r < 3; r++) tables.row(r, other, std::string(40 + r, 'x'));
+            tables.secondaries(2);
+        }
+
+        tables.begin(gameplay, gameplay, "players"_n.value, shape.players);
+        for (uint32_t p = 0; p < shape.players; p++) {
+            uint64_t    player = account(splitmix64(rng));
+            uint64_t    plays = splitmix64(rng) % 500;
+            std::string row;
+            put_u64(row, player);
+            put_u64(row, plays);
+            put_u64(row, plays * 35 / 100);
+            put_bytes(row, "nonce-" + std::to_string(p));
+            // Rows from each schema version: v0 stops at last_nonce
+            if (p % 3 > 0) {
+                put_u8(row, uint8_t(p % 3));
+                put_u32(row, 1700000000 + p);
+            }
+            if (p % 3 > 1) put_u64(row, p);
+            tables.row(player, gameplay, row);
+        }
+        tables.secondaries(0);
+
+        tables.begin(gameplay, gameplay, "rngslots"_n.value, 4);
+        for (uint32_t s = 0; s < 4; s++) {
+            std::string row;
+            put_u64(row, s);
+            put_u32(row, s + 1);
+            put_u8(row, s % 2);
+            put_u64(row, s + 1);
+            put_u64(row, account(s));
+            put_u64(row, (uint64_t(s + 1) << 32) | s);
+            put_u64(row, 1700000000000000ULL + s);
+            tables.row(s, gameplay, row);
+        }
+        tables.secondaries(0);
+        counts.gameplay_rows = shape.players + 4;
+
+        tables.begin(token, dbp >> 8, "stat"_n.value, 1);
+        {
+            std::string row;
+            put_u64(row, 123456789);
+            put_u64(row, dbp);
+            put_u64(row, 10000000000000ULL);
+            put_u64(row, dbp);
+            put_u64(row, gameplay);
+            tables.row(dbp >> 8, token, row);
+        }
+        tables.secondaries(0);
+
+        for (uint32_t h = 0; h < shape.holders; h++) {
+            uint64_t holder = account(splitmix64(rng));
+            tables.begin(token, holder, "accounts"_n.value, 1);
+            std::string row;
+            put_u64(row, splitmix64(rng) % 100000000);
+            put_u64(row, dbp);
+            tables.row(dbp >> 8, holder, row);
+            tables.secondaries(0);
+        }
+        counts.token_rows = 1 + shape.holders;
+
+        for (uint32_t t = shape.other_tables / 2; t < shape.other_tables; t++) {
+            tables.begin(other, account(t), "things"_n.value, 1);
+            tables.row(0, other, "y");
+            tables.secondaries(1);
+        }
+        counts.tables = tables.tables;
+
+        out.add_section("contract_tables", tables.tables, tables.rows);
+        out.add_section("eosio::chain::permission_object", 0, "");
+        out.finish();
+        return counts;
+    }
+
+} // namespace snapshot
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "abi.hpp"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Synthetic snapshots holding the beta contracts' tables among unrelated
+ * ones, for the tests and for measuring extraction without a node
+ */
+namespace snapshot {
+
+    /// The gameplay contract's players and rngslots tables, as its ABI declares them
+    abi gameplay_abi();
+
+    /// The token's accounts and stat tables
+    abi token_abi();
+
+    struct synthetic_shape {
+        uint32_t players = 1000;  // rows of gameplay's players table
+        uint32_t holders = 1000;  // accounts scopes of dbptoken, one balance each
+        uint32_t other_tables = 200; // tables of an unrelated contract, with secondary indexes
+        uint64_t seed = 1;
+    };
+
+    struct synthetic_counts {
+        uint64_t tables = 0;        // table_id rows written
+        uint64_t gameplay_rows = 0; // players and rngslots
+        uint64_t token_rows = 0;    // accounts and stat
+    };
+
+    /// Write a snapshot with `gameplay` and `dbptoken` deployed among other accounts
+    synthetic_counts write_synthetic_snapshot(const std::string& path, const synthetic_shape& shape);
+
+} // namespace snapshot
@@ -0,0 +1,232 @@
+#include <boost/test/unit_test.hpp>
+
+#include <audit.hpp>
+#include <ingest.hpp>
+#include <records.hpp>
+#include <sha256x4.hpp>
+#include <synth.hpp>
+
+#include <eosio/name.hpp>
+
+#include <filesystem>
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    struct scratch_dir {
+        fs::path path;
+
+        explicit scratch_dir(const std::string& name) : path(fs::temp_directory_path() / ("dbltz_audit_" + name)) {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+
+        ~scratch_dir() { fs::remove_all(path); }
+
+        std::string operator/(const std::string& file) const { return (path / file).string(); }
+    };
+
+    const uint64_t gameplay = "gameplay"_n.value;
+    const uint64_t token = "dbptoken"_n.value;
+
+    /// Synthetic traffic for `variant`, ingested into `dir/records`
+    std::string ingest_synthetic(const scratch_dir& dir, ingest::layout variant) {
+        ingest::contracts ours{gameplay, token, variant};
+        ingest::synthetic_shape shape;
+        shape.blocks = 400;
+        uint64_t global_sequence = 0;
+        ingest::write_synthetic_log(dir / "segment.log", ours, shape, global_sequence);
+        ingest::run({dir / "segment.log"}, dir / "records", {ours, 1});
+        return dir / "records";
+    }
+
+    ingest::callback_record beta_callback(uint64_t seq, uint32_t block, uint32_t first_word) {
+        ingest::callback_record c{seq, gameplay, seq, 0, block, 0, {}};
+        for (int i = 0; i < 4; i++) c.random_value[i] = uint8_t(first_word >> (24 - 8 * i));
+        return c;
+    }
+
+    ingest::result_record result(uint64_t seq, uint32_t block, uint64_t player, uint32_t roll, bool won) {
+        return {seq, gameplay, player, block, roll, uint8_t(won), {}};
+    }
+
+    ingest::issue_record issue(uint64_t seq, uint32_t block, uint64_t to) { return {seq, token, to, 10000, 0, block, 0}; }
+
+    bool has_finding(const audit::report& r, audit::finding_kind kind, uint64_t seq) {
+        for (const auto& f : r.findings) {
+            if (f.kind == kind && f.global_sequence == seq) return true;
+        }
+        return false;
+    }
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(audit_tests)
+
+BOOST_AUTO_TEST_CASE(hash_lanes_test) {
+    uint64_t values[4] = {0, 1, 0x0000000700000003ULL, ~uint64_t(0)};
+    uint8_t  lanes[4][32];
+    audit::signing_value_hash_x4(values, lanes);
+    for (int l = 0; l < 4; l++) {
+        auto expected = eosio::sha256(reinterpret_cast<const char*>(&values[l]), 8).extract_as_byte_array();
+        BOOST_CHECK(std::equal(expected.begin(), expected.end(), lanes[l]));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(distribution_tests_test) {
+    for (unsigned bits : {32u, 64u}) {
+        auto p = audit::roll_probabilities(bits);
+        double total = 0;
+        for (double x : p) total += x;
+        BOOST_CHECK_CLOSE(total, 1.0, 1e-9);
+        BOOST_CHECK_GE(p[0], p[99]);
+    }
+
+    // Tabulated chi-square tails for 99 degrees of freedom
+    BOOST_CHECK_CLOSE(audit::chi_square_sf(123.225, 99), 0.05, 0.5);
+    BOOST_CHECK_CLOSE(audit::chi_square_sf(69.230, 99), 0.99, 0.1);
+    BOOST_CHECK_CLOSE(audit::normal_two_sided(1.959964), 0.05, 0.01);
+
+    // Perfectly alternating wins and losses have far too many runs
+    BOOST_CHECK_LT(audit::runs_test(1000, 500, 500).p_value, 1e-6);
+    BOOST_CHECK_GT(audit::runs_test(501, 500, 500).p_value, 0.9);
+    BOOST_CHECK_LT(audit::win_rate_test(5000, 10000, 0.35).p_value, 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(synthetic_history_passes_test) {
+    for (auto variant : {ingest::layout::beta, ingest::layout::dodge}) {
+        scratch_dir dir(variant == ingest::layout::beta ? "beta" : "dodge");
+        auto records = ingest_synthetic(dir, variant);
+
+        audit::options opts;
+        opts.variant = variant;
+        opts.threads = 1;
+        auto whole = audit::run(records, opts);
+        BOOST_REQUIRE_EQUAL(whole.outcomes, 399u * 18);
+        BOOST_CHECK_EQUAL(whole.verified, whole.outcomes);
+        BOOST_CHECK_EQUAL(whole.mismatches, 0u);
+        BOOST_CHECK_EQUAL(whole.unanswered, 0u);
+        BOOST_CHECK(whole.passed(opts.alpha));
+        if (variant == ingest::layout::dodge) BOOST_CHECK_EQUAL(whole.hashes_checked, whole.callbacks);
+
+        // Small chunks on several threads agree exactly, runs across chunk edges included
+        opts.threads = 3;
+        opts.chunk_outcomes = 100;
+        auto chunked = audit::run(records, opts);
+        BOOST_CHECK_EQUAL(chunked.outcomes, whole.outcomes);
+        BOOST_CHECK_EQUAL(chunked.wins, whole.wins);
+        BOOST_CHECK_EQUAL(chunked.runs, whole.runs);
+        BOOST_CHECK(chunked.rolls == whole.rolls);
+        BOOST_CHECK_EQUAL(chunked.chi_square.statistic, whole.chi_square.statistic);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(beta_findings_test) {
+    scratch_dir dir("beta_findings");
+    const uint64_t alice = "alice"_n.value, bob = "bob"_n.value;
+    {
+        ingest::record_store store(dir.path.string());
+        ingest::batch b;
+        // Block 10: a fair win
+        b.callbacks.push_back(beta_callback(100, 10, 7));
+        b.results.push_back(result(103, 10, alice, 7, true));
+        // Block 11: the logged roll is not the random value's
+        b.callbacks.push_back(beta_callback(110, 11, 1000));
+        b.results.push_back(result(111, 11, bob, 1, true));
+        // Block 12: a win flag the roll does not give
+        b.callbacks.push_back(beta_callback(120, 12, 50));
+        b.results.push_back(result(121, 12, bob, 50, true));
+        // Block 13: a pool draw settling two plays, the second from sha256 of its value and 1
+        auto draw = beta_callback(130, 13, 80);
+        b.callbacks.push_back(draw);
+        b.results.push_back(result(131, 13, alice, 80, false));
+        char     data[36];
+        uint32_t k = 1;
+        std::memcpy(data, draw.random_value, 32);
+        std::memcpy(data + 32, &k, sizeof(k));
+        auto     derived = eosio::sha256(data, sizeof(data)).extract_as_byte_array();
+        uint32_t second = ((uint32_t(derived[0]) << 24) | (uint32_t(derived[1]) << 16) | (uint32_t(derived[2]) << 8) |
+                           uint32_t(derived[3])) % 100;
+        b.results.push_back(result(133, 13, bob, second, second < 35));
+        // Block 14: a result out of nowhere
+        b.results.push_back(result(140, 14, bob, 90, false));
+        // Block 15: a late duplicate settling nothing
+        b.callbacks.push_back(beta_callback(150, 15, 3));
+        store.append(b);
+    }
+
+    audit::options opts;
+    opts.threads = 2;
+    auto r = audit::run(dir.path.string(), opts);
+    BOOST_CHECK_EQUAL(r.outcomes, 6u);
+    BOOST_CHECK_EQUAL(r.verified, 5u);
+    BOOST_CHECK_EQUAL(r.pool_settled, 1u);
+    BOOST_CHECK_EQUAL(r.unanswered, 1u);
+    BOOST_CHECK(has_finding(r, audit::finding_kind::roll, 111));
+    BOOST_CHECK(has_finding(r, audit::finding_kind::outcome, 121));
+    BOOST_CHECK(has_finding(r, audit::finding_kind::orphan, 140));
+    BOOST_CHECK_EQUAL(r.mismatches, 3u);
+    BOOST_CHECK(!r.passed(opts.alpha));
+
+    opts.max_findings = 2;
+    auto capped = audit::run(dir.path.string(), opts);
+    BOOST_CHECK_EQUAL(capped.mismatches, 3u);
+    BOOST_REQUIRE_EQUAL(capped.findings.size(), 2u);
+    BOOST_CHECK_EQUAL(capped.findings[0].global_sequence, 111u);
+}
+
+BOOST_AUTO_TEST_CASE(dodge_findings_test) {
+    scratch_dir dir("dodge_findings");
+    {
+        ingest::record_store store(dir.path.string());
+        ingest::batch b;
+        for (uint64_t i = 0; i < 9; i++) {
+            uint64_t seq = 100 + 10 * i;
+            ingest::callback_record c{seq, gameplay, (i << 32) | 5, 1000 + i * 7, uint32_t(10 + i), 0, {}};
+            audit::signing_value_hash(c.request_id, c.random_value);
+            if (i == 2) c.random_value[31] ^= 1;                      // a hash that does not match
+            if (i == 3) std::memset(c.random_value, 0, 32);           // a hash not recorded
+            b.callbacks.push_back(c);
+            bool won = c.random_word % 100 < 35;
+            if (won != (i == 4)) b.issues.push_back(issue(seq + 1, c.block_num, "alice"_n.value)); // i == 4 goes unpaid
+        }
+        store.append(b);
+    }
+
+    audit::options opts;
+    opts.variant = ingest::layout::dodge;
+    auto r = audit::run(dir.path.string(), opts);
+    BOOST_CHECK_EQUAL(r.outcomes, 9u);
+    BOOST_CHECK_EQUAL(r.hashes_checked, 8u);
+    BOOST_CHECK_EQUAL(r.hashes_missing, 1u);
+    BOOST_CHECK(has_finding(r, audit::finding_kind::hash, 120));
+    BOOST_CHECK(has_finding(r, audit::finding_kind::reward, 140));
+    BOOST_CHECK_EQUAL(r.mismatches, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(biased_rolls_rejected_test) {
+    scratch_dir dir("biased");
+    {
+        ingest::record_store store(dir.path.string());
+        ingest::batch b;
+        // Honest settlement of a skewed oracle: rolls cluster in [0, 50)
+        uint64_t state = 3;
+        for (uint32_t i = 0; i < 20000; i++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            uint32_t word = uint32_t(state >> 32) % 50;
+            uint32_t roll = word % 100;
+            b.callbacks.push_back(beta_callback(10 * i + 1, i + 1, word));
+            if (roll < 35) b.issues.push_back(issue(10 * i + 2, i + 1, 1));
+            b.results.push_back(result(10 * i + 3, i + 1, 1, roll, roll < 35));
+        }
+        store.append(b);
+    }
+    auto r = audit::run(dir.path.string(), {});
+    BOOST_CHECK_EQUAL(r.mismatches, 0u);
+    BOOST_CHECK_LT(r.chi_square.p_value, 1e-6);
+    BOOST_CHECK_LT(r.win_rate.p_value, 1e-6);
+    BOOST_CHECK(!r.passed(0.001));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
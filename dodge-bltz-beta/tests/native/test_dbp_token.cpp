@@ -0,0 +1,106 @@
+#include <boost/test/unit_test.hpp>
+
+#include <contracts.hpp>
+#include <native/chain.hpp>
+
+#include <eosio/asset.hpp>
+
+using namespace eosio;
+using std::string;
+
+namespace {
+
+    const symbol DBP = symbol("DBP", 4);
+
+    asset dbp(int64_t amount) { return asset(amount, DBP); }
+
+    // Leading fields of the token's rows
+    struct account_row {
+        asset balance;
+    };
+
+    struct stats_row {
+        asset supply;
+        asset max_supply;
+        name  issuer;
+    };
+
+} // namespace
+
+class dbp_token_tester : public native::tester {
+public:
+    dbp_token_tester() {
+        create_accounts({"dbptoken"_n, "alice"_n, "bob"_n, "carol"_n});
+        set_code("dbptoken"_n, contracts::dbp_token_apply);
+    }
+
+    void create_token(name issuer, asset max_supply) {
+        push_action("dbptoken"_n, "create"_n, "dbptoken"_n, issuer, max_supply);
+    }
+
+    void issue_tokens(name to, asset quantity, string memo) {
+        push_action("dbptoken"_n, "issue"_n, "dbptoken"_n, to, quantity, memo);
+    }
+
+    void transfer_tokens(name from, name to, asset quantity, string memo) {
+        push_action("dbptoken"_n, "transfer"_n, from, from, to, quantity, memo);
+    }
+
+    asset get_balance(name account) {
+        auto row = get_row<account_row>("dbptoken"_n, account.value, "accounts"_n, DBP.code().raw());
+        return row ? row->balance : dbp(0);
+    }
+
+    std::optional<stats_row> get_stats() {
+        return get_row<stats_row>("dbptoken"_n, DBP.code().raw(), "stat"_n, DBP.code().raw());
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(dbp_token_native_tests)
+
+BOOST_FIXTURE_TEST_CASE(issue_and_transfer_test, dbp_token_tester) {
+    create_token("dbptoken"_n, dbp(10000000000));
+    issue_tokens("alice"_n, dbp(1000000), "initial");
+
+    // Issuing to another account goes through an inline transfer from the issuer
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(1000000));
+    BOOST_REQUIRE_EQUAL(get_balance("dbptoken"_n), dbp(0));
+    BOOST_REQUIRE_EQUAL(get_stats()->supply, dbp(1000000));
+
+    transfer_tokens("alice"_n, "bob"_n, dbp(250000), "hi");
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(750000));
+    BOOST_REQUIRE_EQUAL(get_balance("bob"_n), dbp(250000));
+
+    // The sender pays for the recipient's new balance row
+    BOOST_REQUIRE_GT(ram_usage("alice"_n), 0);
+    BOOST_REQUIRE_EQUAL(ram_usage("bob"_n), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(failed_transfer_rolls_back_test, dbp_token_tester) {
+    create_token("dbptoken"_n, dbp(10000000000));
+    issue_tokens("alice"_n, dbp(1000), "");
+
+    BOOST_CHECK_EXCEPTION(transfer_tokens("alice"_n, "bob"_n, dbp(1001), ""),
+                          native::assert_error, native::message_contains{"overdrawn balance"});
+    BOOST_CHECK_EXCEPTION(transfer_tokens("alice"_n, "nobody"_n, dbp(1), ""),
+                          native::assert_error, native::message_contains{"to account does not exist"});
+    BOOST_CHECK_EXCEPTION(push_action("dbptoken"_n, "transfer"_n, "bob"_n, "alice"_n, "bob"_n, dbp(1), string()),
+                          native::auth_error, native::message_contains{"missing authority of alice"});
+
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(1000));
+    BOOST_REQUIRE_EQUAL(row_count("dbptoken"_n, "bob"_n.value, "accounts"_n), 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(burn_tokens_test, dbp_token_tester) {
+    create_token("dbptoken"_n, dbp(10000000000));
+    issue_tokens("alice"_n, dbp(5000), "");
+
+    push_action("dbptoken"_n, "burn"_n, "alice"_n, "alice"_n, dbp(2000));
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(3000));
+    BOOST_REQUIRE_EQUAL(get_stats()->supply, dbp(3000));
+
+    BOOST_CHECK_EXCEPTION(issue_tokens("alice"_n, dbp(10000000000), ""),
+                          native::assert_error, native::message_contains{"quantity exceeds available supply"});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
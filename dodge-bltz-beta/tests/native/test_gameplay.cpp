@@ -0,0 +1,826 @@
+#include <boost/test/unit_test.hpp>
+
+#include <client/shards.hpp>
+#include <contracts.hpp>
+#include <native/chain.hpp>
+#include <native/profile.hpp>
+
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <map>
+
+using namespace eosio;
+using std::string;
+
+namespace {
+
+    const symbol DBP = symbol("DBP", 4);
+
+    asset dbp(int64_t amount) { return asset(amount, DBP); }
+
+    // The first four bytes, big endian, mod 100 are the roll; below 35 wins
+    checksum256 roll_value(uint8_t first_byte) {
+        std::array<uint8_t, 32> bytes = {};
+        bytes[0] = first_byte;
+        return checksum256(bytes);
+    }
+
+    const checksum256 WIN = roll_value(0x00);
+    const checksum256 LOSE = roll_value(0xff); // 0xff000000 % 100 = 80
+
+    // Leading fields of the gameplay and token rows
+
+    struct player_row {
+        name     player;
+        uint64_t total_plays;
+        uint64_t total_wins;
+        string   last_nonce;
+    };
+
+    // A players row as written before the bylastplay index, with no entry in it
+    struct v2_player_row {
+        name           player;
+        uint64_t       total_plays;
+        uint64_t       total_wins;
+        string         last_nonce;
+        uint8_t        schema_version;
+        time_point_sec last_play;
+        uint64_t       last_cnonce;
+    };
+
+    struct archived_player_row {
+        name           player;
+        uint64_t       total_plays;
+        uint64_t       total_wins;
+        uint64_t       last_cnonce;
+        time_point_sec last_play;
+    };
+
+    struct archive_row {
+        uint64_t                         id;
+        std::vector<archived_player_row> players;
+    };
+
+    struct evict_state_row {
+        uint64_t legacy_cursor;
+        bool     legacy_kept;
+        bool     legacy_done;
+        uint64_t evicted;
+        uint64_t restored;
+        uint64_t archived;
+    };
+
+    struct slot_state_row {
+        uint64_t capacity;
+        uint64_t free_head;
+        uint64_t in_use;
+        uint64_t sweep_cursor;
+    };
+
+    struct metrics_row {
+        time_point            started;
+        uint64_t              plays;
+        uint64_t              callbacks;
+        uint64_t              expired;
+        uint64_t              rejected;
+        std::vector<uint64_t> latency_ms;
+    };
+
+    struct breaker_row {
+        uint64_t max_outstanding;
+        uint64_t resume_below;
+        bool     open;
+        uint64_t trips;
+    };
+
+    struct draw_state_row {
+        uint32_t batch_size;
+        uint32_t queued;
+        uint64_t request_id;
+        uint64_t next_id;
+        uint64_t drawn_below;
+        uint64_t served;
+        uint64_t draws;
+    };
+
+    // A pending row as stored before the slot table
+    struct legacy_pending_row {
+        uint64_t   id;
+        name       player;
+        uint64_t   signing_value;
+        time_point timestamp;
+    };
+
+    struct oracle_request_row {
+        uint64_t id;
+        uint64_t assoc_id;
+        uint64_t signing_value;
+        name     caller;
+    };
+
+    struct provider_row {
+        uint64_t id;
+        name     oracle;
+        uint64_t requests;
+        uint64_t wins;
+        uint64_t late;
+        uint64_t latency_us;
+        uint64_t timed_wins;
+    };
+
+    struct dead_letter_row {
+        uint64_t    id;
+        name        player;
+        uint64_t    request_id;
+        checksum256 random_value;
+        uint8_t     reason;
+        uint32_t    attempts;
+        time_point  created;
+    };
+
+    struct account_row {
+        asset balance;
+    };
+
+    /// A player contract that refuses every DBP transfer notification
+    void refuse_transfers(uint64_t, uint64_t code, uint64_t action) {
+        if (code == "dbptoken"_n.value && action == "transfer"_n.value) check(false, "transfers refused");
+    }
+
+} // namespace
+
+class gameplay_tester : public native::tester {
+public:
+    gameplay_tester() {
+        create_accounts({"gameplay"_n, "dbptoken"_n, "oracle"_n, "alice"_n, "bob"_n});
+        set_code("gameplay"_n, contracts::gameplay_apply);
+        set_code("dbptoken"_n, contracts::dbp_token_apply);
+        set_code("oracle"_n, contracts::mock_oracle_apply);
+
+        // Rewards are issued inline under dbptoken@active
+        grant_code("dbptoken"_n, "gameplay"_n);
+
+        push_action("dbptoken"_n, "create"_n, "dbptoken"_n, "dbptoken"_n, dbp(10000000000));
+        push_action("gameplay"_n, "settoken"_n, "gameplay"_n, "dbptoken"_n);
+        push_action("gameplay"_n, "setrng"_n, "gameplay"_n, "oracle"_n);
+        push_action("gameplay"_n, "initslots"_n, "gameplay"_n, uint32_t(8));
+    }
+
+    void play(name player, string nonce) {
+        push_action("gameplay"_n, "play"_n, player, player, nonce);
+    }
+
+    /// Deliver an oracle's callback for its oldest queued request
+    void fulfill_next(const checksum256& random_value, name oracle = "oracle"_n) {
+        auto queued = get_table<oracle_request_row>(oracle, oracle.value, "requests"_n);
+        BOOST_REQUIRE(!queued.empty());
+        push_action(oracle, "fulfill"_n, oracle, queued.front().id, random_value);
+    }
+
+    /// Push playc in its wire form: player, nonce, then flags unless omitted
+    void playc_raw(name player, uint64_t nonce, std::optional<uint8_t> flags, size_t padding = 0) {
+        native::bytes data(2 * sizeof(uint64_t) + (flags ? 1 : 0) + padding);
+        uint64_t raw_player = player.value;
+        memcpy(data.data(), &raw_player, sizeof(raw_player));
+        memcpy(data.data() + sizeof(raw_player), &nonce, sizeof(nonce));
+        if (flags) data[2 * sizeof(uint64_t)] = char(*flags);
+        push_raw("gameplay"_n, "playc"_n, player, std::move(data));
+    }
+
+    uint64_t last_cnonce(name player) {
+        auto row = get_row<v2_player_row>("gameplay"_n, "gameplay"_n.value, "players"_n, player.value);
+        BOOST_REQUIRE(row.has_value());
+        return row->last_cnonce;
+    }
+
+    void claim(name player) {
+        push_action("gameplay"_n, "claim"_n, player, player);
+    }
+
+    player_row get_player(name player) {
+        auto row = get_row<player_row>("gameplay"_n, "gameplay"_n.value, "players"_n, player.value);
+        BOOST_REQUIRE(row.has_value());
+        return *row;
+    }
+
+    provider_row get_provider(uint64_t id) {
+        auto row = get_row<provider_row>("gameplay"_n, "gameplay"_n.value, "providers"_n, id);
+        BOOST_REQUIRE(row.has_value());
+        return *row;
+    }
+
+    slot_state_row get_slots() { return *get_singleton<slot_state_row>("gameplay"_n, "gameplay"_n.value, "slotstate"_n); }
+
+    metrics_row get_metrics() { return *get_singleton<metrics_row>("gameplay"_n, "gameplay"_n.value, "metrics"_n); }
+
+    client::shard_stats get_stats() { return call<client::shard_stats>("gameplay"_n, "getstats"_n); }
+
+    breaker_row get_breaker() { return *get_singleton<breaker_row>("gameplay"_n, "gameplay"_n.value, "breaker"_n); }
+
+    draw_state_row get_draws() { return *get_singleton<draw_state_row>("gameplay"_n, "gameplay"_n.value, "drawstate"_n); }
+
+    evict_state_row get_evict_state() { return *get_singleton<evict_state_row>("gameplay"_n, "gameplay"_n.value, "evictstate"_n); }
+
+    void evict_idle(uint32_t max_rows, uint32_t idle_seconds) {
+        push_action("gameplay"_n, "evictidle"_n, "gameplay"_n, max_rows, idle_seconds);
+    }
+
+    /// A player's row in their own scope, where scopeplayers puts it
+    std::optional<player_row> get_scoped_player(name player) {
+        return get_row<player_row>("gameplay"_n, player.value, "players"_n, player.value);
+    }
+
+    asset get_balance(name account) {
+        auto row = get_row<account_row>("dbptoken"_n, account.value, "accounts"_n, DBP.code().raw());
+        return row ? row->balance : dbp(0);
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(gameplay_native_tests)
+
+BOOST_FIXTURE_TEST_CASE(play_and_settle_test, gameplay_tester) {
+    play("alice"_n, "n1");
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 1u);
+    BOOST_REQUIRE_EQUAL(row_count("oracle"_n, "oracle"_n.value, "requests"_n), 1u);
+
+    // The play is counted with its slot; the metrics window waits for the callback
+    BOOST_REQUIRE(!get_singleton<metrics_row>("gameplay"_n, "gameplay"_n.value, "metrics"_n).has_value());
+    BOOST_REQUIRE_EQUAL(get_stats().metrics.plays, 1u);
+
+    // A winning roll credits the reward and frees the slot; the player claims it
+    advance_time(milliseconds(1500));
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 1u);
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(0));
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 0u);
+    claim("alice"_n);
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(10000));
+    BOOST_CHECK_EXCEPTION(claim("alice"_n), native::assert_error, native::message_contains{"no rewards to claim"});
+
+    // 1.5 s from play to callback lands in the [1024, 2048) ms bucket
+    auto m = get_metrics();
+    BOOST_REQUIRE_EQUAL(m.plays, 1u);
+    BOOST_REQUIRE_EQUAL(m.callbacks, 1u);
+    BOOST_REQUIRE_EQUAL(m.latency_ms[10], 1u);
+
+    play("alice"_n, "n2");
+    fulfill_next(LOSE);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 2u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 1u);
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(10000));
+}
+
+BOOST_FIXTURE_TEST_CASE(refused_reward_test, gameplay_tester) {
+    create_account("mallory"_n);
+    set_code("mallory"_n, refuse_transfers);
+
+    // The callback only credits the win, so the refusal cannot revert it
+    play("mallory"_n, "n1");
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_player("mallory"_n).total_wins, 1u);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 0u);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "deadletter"_n), 0u);
+
+    // Only mallory's own claim fails, and the reward stays owed
+    BOOST_CHECK_EXCEPTION(claim("mallory"_n), native::assert_error, native::message_contains{"transfers refused"});
+    BOOST_CHECK_EXCEPTION(claim("mallory"_n), native::assert_error, native::message_contains{"transfers refused"});
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "claim"_n, "alice"_n, "mallory"_n), native::auth_error,
+                          native::message_contains{"missing authority of mallory"});
+}
+
+BOOST_FIXTURE_TEST_CASE(issuer_mismatch_test, gameplay_tester) {
+    // A DBP token whose issuer is not the account gameplay issues under
+    create_account("faketoken"_n);
+    set_code("faketoken"_n, contracts::dbp_token_apply);
+    grant_code("faketoken"_n, "gameplay"_n);
+    push_action("faketoken"_n, "create"_n, "faketoken"_n, "bob"_n, dbp(10000000000));
+    push_action("gameplay"_n, "settoken"_n, "gameplay"_n, "faketoken"_n);
+
+    play("alice"_n, "n1");
+    fulfill_next(WIN);
+    auto dead = get_table<dead_letter_row>("gameplay"_n, "gameplay"_n.value, "deadletter"_n);
+    BOOST_REQUIRE_EQUAL(dead.size(), 1u);
+    BOOST_REQUIRE_EQUAL(dead[0].reason, 5u); // ISSUER_MISMATCH
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(dead_letter_replay_test, gameplay_tester) {
+    // A token account with no DBP stat row cannot issue the reward
+    create_account("notoken"_n);
+    push_action("gameplay"_n, "settoken"_n, "gameplay"_n, "notoken"_n);
+
+    // The callback still succeeds and frees the slot; the play waits in the dead letters
+    play("alice"_n, "n1");
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 0u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 0u);
+    BOOST_REQUIRE_EQUAL(get_metrics().rejected, 1u);
+    auto dead = get_table<dead_letter_row>("gameplay"_n, "gameplay"_n.value, "deadletter"_n);
+    BOOST_REQUIRE_EQUAL(dead.size(), 1u);
+    BOOST_REQUIRE_EQUAL(dead[0].player, "alice"_n);
+    BOOST_REQUIRE_EQUAL(dead[0].reason, 3u); // TOKEN_UNAVAILABLE
+    BOOST_REQUIRE_EQUAL(dead[0].attempts, 0u);
+
+    // Replaying before the cause is fixed keeps the row and counts the attempt
+    push_action("gameplay"_n, "replaydead"_n, "gameplay"_n, uint32_t(10));
+    dead = get_table<dead_letter_row>("gameplay"_n, "gameplay"_n.value, "deadletter"_n);
+    BOOST_REQUIRE_EQUAL(dead.size(), 1u);
+    BOOST_REQUIRE_EQUAL(dead[0].attempts, 1u);
+
+    // Once the token is back the replay settles it from the stored value
+    push_action("gameplay"_n, "settoken"_n, "gameplay"_n, "dbptoken"_n);
+    push_action("gameplay"_n, "replaydead"_n, "gameplay"_n, uint32_t(10));
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "deadletter"_n), 0u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 1u);
+    claim("alice"_n);
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(10000));
+
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "replaydead"_n, "alice"_n, uint32_t(10)), native::auth_error,
+                          native::message_contains{"missing authority of gameplay"});
+}
+
+BOOST_FIXTURE_TEST_CASE(breaker_test, gameplay_tester) {
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "setbreaker"_n, "gameplay"_n, uint64_t(2), uint64_t(2)),
+                          native::assert_error, native::message_contains{"resume level must be below the threshold"});
+    push_action("gameplay"_n, "setbreaker"_n, "gameplay"_n, uint64_t(2), uint64_t(0));
+
+    // The second outstanding request trips the breaker, and plays are shed
+    play("alice"_n, "n1");
+    BOOST_REQUIRE(!get_breaker().open);
+    play("bob"_n, "n1");
+    BOOST_REQUIRE(get_breaker().open);
+    BOOST_REQUIRE_EQUAL(get_breaker().trips, 1u);
+    BOOST_CHECK_EXCEPTION(play("alice"_n, "n2"), native::assert_error,
+                          native::message_contains{"oracle backlog is full, try again later"});
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 2u);
+
+    // It stays open until the backlog drains to the resume level
+    fulfill_next(LOSE);
+    BOOST_REQUIRE(get_breaker().open);
+    fulfill_next(LOSE);
+    BOOST_REQUIRE(!get_breaker().open);
+
+    play("alice"_n, "n2");
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 2u);
+    BOOST_REQUIRE_EQUAL(get_breaker().trips, 1u);
+}
+
+BOOST_FIXTURE_TEST_CASE(failed_play_rolls_back_test, gameplay_tester) {
+    play("alice"_n, "n1");
+
+    BOOST_CHECK_EXCEPTION(play("alice"_n, "n1"), native::assert_error, native::message_contains{"nonce already used"});
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "play"_n, "bob"_n, "alice"_n, string("n2")),
+                          native::auth_error, native::message_contains{"missing authority of alice"});
+
+    // Neither failed transaction left a slot, an oracle request or a counter behind
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 1u);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 1u);
+    BOOST_REQUIRE_EQUAL(row_count("oracle"_n, "oracle"_n.value, "requests"_n), 1u);
+    BOOST_REQUIRE_EQUAL(get_stats().metrics.plays, 1u);
+}
+
+BOOST_FIXTURE_TEST_CASE(playc_batch_test, gameplay_tester) {
+    // Low nibble 3: one 17-byte action rolls nonces 10, 11 and 12
+    playc_raw("alice"_n, 10, uint8_t(0x03));
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 3u);
+    BOOST_REQUIRE_EQUAL(last_cnonce("alice"_n), 12u);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 3u);
+    BOOST_REQUIRE_EQUAL(row_count("oracle"_n, "oracle"_n.value, "requests"_n), 3u);
+
+    // Every nonce of the batch is used; 16 bytes without flags is a single roll
+    BOOST_CHECK_EXCEPTION(playc_raw("alice"_n, 12, uint8_t(0x01)), native::assert_error,
+                          native::message_contains{"nonce already used"});
+    playc_raw("alice"_n, 13, std::nullopt);
+    BOOST_REQUIRE_EQUAL(last_cnonce("alice"_n), 13u);
+
+    // A zero count is one roll, as with the flags left off
+    playc_raw("alice"_n, 14, uint8_t(0x00));
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 5u);
+    BOOST_REQUIRE_EQUAL(last_cnonce("alice"_n), 14u);
+
+    // A trailing byte past the flags is not a playc payload
+    BOOST_CHECK_EXCEPTION(playc_raw("alice"_n, 15, uint8_t(0x01), 1), native::assert_error,
+                          native::message_contains{"malformed playc action"});
+}
+
+BOOST_FIXTURE_TEST_CASE(playc_rejected_flags_test, gameplay_tester) {
+    playc_raw("alice"_n, 1, uint8_t(0x01));
+
+    // Only BLTZ (0) is a known move type
+    BOOST_CHECK_EXCEPTION(playc_raw("alice"_n, 2, uint8_t(0x11)), native::assert_error,
+                          native::message_contains{"unsupported move type"});
+    BOOST_CHECK_EXCEPTION(playc_raw("alice"_n, 2, uint8_t(0xF0)), native::assert_error,
+                          native::message_contains{"unsupported move type"});
+
+    // A batch larger than the free slots fails whole; so does one running past the last nonce
+    BOOST_CHECK_EXCEPTION(playc_raw("alice"_n, 2, uint8_t(0x08)), native::assert_error,
+                          native::message_contains{"rng request queue is full"});
+    BOOST_CHECK_EXCEPTION(playc_raw("alice"_n, std::numeric_limits<uint64_t>::max() - 1, uint8_t(0x02)),
+                          native::assert_error, native::message_contains{"nonce out of range"});
+
+    // None of them recorded a roll or used a nonce
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 1u);
+    BOOST_REQUIRE_EQUAL(last_cnonce("alice"_n), 1u);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 1u);
+    BOOST_REQUIRE_EQUAL(row_count("oracle"_n, "oracle"_n.value, "requests"_n), 1u);
+    playc_raw("alice"_n, 2, uint8_t(0x07));
+    BOOST_REQUIRE_EQUAL(last_cnonce("alice"_n), 8u);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 8u);
+}
+
+BOOST_FIXTURE_TEST_CASE(resetmetrics_test, gameplay_tester) {
+    play("alice"_n, "n1");
+    advance_time(milliseconds(1500));
+    fulfill_next(WIN);
+    play("alice"_n, "n2");
+
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "resetmetrics"_n, "alice"_n, true), native::auth_error,
+                          native::message_contains{"missing authority of gameplay"});
+    BOOST_REQUIRE_EQUAL(get_stats().metrics.plays, 2u);
+
+    // The closed window, with the play still in flight, moves to prev
+    push_action("gameplay"_n, "resetmetrics"_n, "gameplay"_n, true);
+    auto prev = *get_singleton<metrics_row>("gameplay"_n, "prev"_n.value, "metrics"_n);
+    BOOST_REQUIRE_EQUAL(prev.plays, 2u);
+    BOOST_REQUIRE_EQUAL(prev.callbacks, 1u);
+    BOOST_REQUIRE_EQUAL(prev.latency_ms[10], 1u);
+
+    auto stats = get_stats();
+    BOOST_REQUIRE_EQUAL(stats.metrics.plays, 0u);
+    BOOST_REQUIRE_EQUAL(stats.metrics.callbacks, 0u);
+    BOOST_REQUIRE_EQUAL(stats.metrics.expired, 0u);
+    BOOST_REQUIRE_EQUAL(stats.metrics.rejected, 0u);
+    for (auto count : stats.metrics.latency_ms) BOOST_REQUIRE_EQUAL(count, 0u);
+    BOOST_REQUIRE_EQUAL(stats.slots_in_use, 1u);
+
+    // The new window counts only what lands after the reset
+    fulfill_next(LOSE);
+    BOOST_REQUIRE_EQUAL(get_stats().metrics.plays, 0u);
+    BOOST_REQUIRE_EQUAL(get_stats().metrics.callbacks, 1u);
+}
+
+BOOST_FIXTURE_TEST_CASE(expired_request_test, gameplay_tester) {
+    play("alice"_n, "n1");
+    push_action("oracle"_n, "drop"_n, "oracle"_n, uint64_t(0));
+
+    // Not expired until five minutes have passed
+    advance_time(seconds(299));
+    push_action("gameplay"_n, "clearexpired"_n, "gameplay"_n, uint32_t(8));
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 1u);
+
+    advance_time(seconds(2));
+    push_action("gameplay"_n, "clearexpired"_n, "gameplay"_n, uint32_t(8));
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 0u);
+    BOOST_REQUIRE_EQUAL(get_metrics().expired, 1u);
+    BOOST_REQUIRE_EQUAL(get_metrics().plays, 1u);
+}
+
+BOOST_FIXTURE_TEST_CASE(legacy_pending_test, gameplay_tester) {
+    play("alice"_n, "n1");
+    fulfill_next(LOSE);
+
+    // Two requests still in flight when the slot table replaced pending
+    for (uint64_t id : {0, 1}) {
+        native::state().db.store({"gameplay"_n.value, "gameplay"_n.value, "pending"_n.value}, id,
+                                 {pack(legacy_pending_row{id, "alice"_n, 1000 + id, now()}), "gameplay"_n.value,
+                                  {uint64_t(now().time_since_epoch().count())}});
+    }
+
+    // Their ids have no generation, so the callback settles from the old table
+    push_action("gameplay"_n, "receiverand"_n, "oracle"_n, uint64_t(0), WIN);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 1u);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "pending"_n), 1u);
+
+    // A duplicate is ignored, and the one never answered expires
+    push_action("gameplay"_n, "receiverand"_n, "oracle"_n, uint64_t(0), WIN);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 1u);
+    advance_time(seconds(301));
+    push_action("gameplay"_n, "clearexpired"_n, "gameplay"_n, uint32_t(8));
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "pending"_n), 0u);
+    BOOST_REQUIRE_EQUAL(get_metrics().expired, 1u);
+}
+
+BOOST_FIXTURE_TEST_CASE(evict_and_restore_test, gameplay_tester) {
+    constexpr uint32_t day = 24 * 3600;
+    play("alice"_n, "n1");
+    fulfill_next(WIN);
+    play("alice"_n, "n2");
+    fulfill_next(LOSE);
+    play("bob"_n, "n1");
+    fulfill_next(LOSE);
+
+    BOOST_CHECK_EXCEPTION(evict_idle(100, 3600), native::assert_error, native::message_contains{"at least a day"});
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "evictidle"_n, "alice"_n, uint32_t(100), day),
+                          native::auth_error, native::message_contains{"missing authority of gameplay"});
+
+    // Only alice has been idle for two days, and her row stays until she claims her win
+    advance_time(seconds(2 * day));
+    play("bob"_n, "n2");
+    fulfill_next(LOSE);
+    evict_idle(100, day);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 2u);
+    claim("alice"_n);
+
+    // Then her row's RAM goes back to her
+    int64_t alice_ram = ram_usage("alice"_n);
+    evict_idle(100, day);
+    BOOST_REQUIRE(!get_row<player_row>("gameplay"_n, "gameplay"_n.value, "players"_n, "alice"_n.value).has_value());
+    BOOST_REQUIRE_EQUAL(get_player("bob"_n).total_plays, 2u);
+    BOOST_REQUIRE_LT(ram_usage("alice"_n), alice_ram);
+
+    auto archive = get_table<archive_row>("gameplay"_n, "gameplay"_n.value, "archive"_n);
+    BOOST_REQUIRE_EQUAL(archive.size(), 1u);
+    BOOST_REQUIRE_EQUAL(archive[0].players.size(), 1u);
+    BOOST_REQUIRE_EQUAL(archive[0].players[0].player, "alice"_n);
+    BOOST_REQUIRE_EQUAL(archive[0].players[0].total_plays, 2u);
+    BOOST_REQUIRE_EQUAL(archive[0].players[0].total_wins, 1u);
+    BOOST_REQUIRE_EQUAL(get_evict_state().evicted, 1u);
+    BOOST_REQUIRE_EQUAL(get_evict_state().archived, 1u);
+
+    // Her next play picks her totals back up and empties the archive
+    play("alice"_n, "n3");
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 3u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 2u);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "archive"_n), 0u);
+    BOOST_REQUIRE_EQUAL(get_evict_state().restored, 1u);
+    BOOST_REQUIRE_EQUAL(get_evict_state().archived, 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(evict_budget_test, gameplay_tester) {
+    constexpr uint32_t day = 24 * 3600;
+    const std::vector<name> players = {"p1"_n, "p2"_n, "p3"_n, "p4"_n, "p5"_n};
+    for (auto p : players) create_account(p);
+    for (size_t i = 0; i < players.size(); i++) {
+        push_action("gameplay"_n, "playc"_n, players[i], players[i], uint64_t(1), uint8_t(0));
+        fulfill_next(LOSE);
+    }
+
+    // Two rows per call; a compact nonce already used stays used after a round trip
+    advance_time(seconds(day + 7200));
+    evict_idle(2, day);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "players"_n), 3u);
+    evict_idle(2, day);
+    evict_idle(2, day);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "players"_n), 0u);
+    BOOST_REQUIRE_EQUAL(get_evict_state().archived, players.size());
+
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "playc"_n, "p3"_n, "p3"_n, uint64_t(1), uint8_t(0)),
+                          native::assert_error, native::message_contains{"nonce already used"});
+    push_action("gameplay"_n, "playc"_n, "p3"_n, "p3"_n, uint64_t(2), uint8_t(0));
+    BOOST_REQUIRE_EQUAL(get_player("p3"_n).total_plays, 2u);
+}
+
+BOOST_FIXTURE_TEST_CASE(evict_unindexed_rows_test, gameplay_tester) {
+    constexpr uint32_t day = 24 * 3600;
+    auto put_v2 = [&](name player, time_point_sec last_play) {
+        native::state().db.store({"gameplay"_n.value, "gameplay"_n.value, "players"_n.value}, player.value,
+                                 {pack(v2_player_row{player, 4, 1, "x", 2, last_play, 0}), player.value, {}});
+    };
+    create_account("carol"_n);
+    put_v2("alice"_n, time_point_sec(now()) - 3 * day);
+    put_v2("bob"_n, time_point_sec(now()));
+    put_v2("carol"_n, time_point_sec(now()));
+
+    // The index does not see these rows; the sweep evicts the idle one and keeps the others
+    evict_idle(100, day);
+    BOOST_REQUIRE(!get_row<player_row>("gameplay"_n, "gameplay"_n.value, "players"_n, "alice"_n.value).has_value());
+    BOOST_REQUIRE_EQUAL(get_evict_state().evicted, 1u);
+    BOOST_REQUIRE(!get_evict_state().legacy_done);
+
+    // Playing rewrites bob's row with an index entry; carol is left to the sweep
+    play("bob"_n, "n1");
+    fulfill_next(LOSE);
+    BOOST_REQUIRE_EQUAL(get_player("bob"_n).total_plays, 5u);
+    advance_time(seconds(2 * day));
+    evict_idle(100, day);
+    evict_idle(100, day);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "players"_n), 0u);
+    BOOST_REQUIRE(get_evict_state().legacy_done);
+    BOOST_REQUIRE_EQUAL(get_evict_state().archived, 3u);
+}
+
+BOOST_FIXTURE_TEST_CASE(scoped_players_test, gameplay_tester) {
+    constexpr uint32_t day = 24 * 3600;
+    play("alice"_n, "n1");
+    fulfill_next(LOSE);
+    play("bob"_n, "n1");
+    fulfill_next(LOSE);
+    play("bob"_n, "n2");
+
+    // alice moves first, billed to the contract; bob's row stays until the next call or his next play
+    int64_t alice_ram = ram_usage("alice"_n);
+    push_action("gameplay"_n, "scopeplayers"_n, "gameplay"_n, uint32_t(1));
+    BOOST_REQUIRE_EQUAL(get_scoped_player("alice"_n)->total_plays, 1u);
+    BOOST_REQUIRE(!get_row<player_row>("gameplay"_n, "gameplay"_n.value, "players"_n, "alice"_n.value).has_value());
+    BOOST_REQUIRE_EQUAL(get_player("bob"_n).total_plays, 2u);
+    BOOST_REQUIRE_LT(ram_usage("alice"_n), alice_ram);
+
+    // A roll settles against a row that has not moved yet, and bob's next play moves it
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_player("bob"_n).total_wins, 1u);
+    play("bob"_n, "n3");
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_scoped_player("bob"_n)->total_plays, 3u);
+    BOOST_REQUIRE_EQUAL(get_scoped_player("bob"_n)->total_wins, 2u);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "players"_n), 0u);
+
+    // The next call finds the self scope empty and makes the layout final; alice's play bills her row back to her
+    push_action("gameplay"_n, "scopeplayers"_n, "gameplay"_n, uint32_t(1));
+    play("alice"_n, "n2");
+    fulfill_next(LOSE);
+    BOOST_REQUIRE_EQUAL(get_scoped_player("alice"_n)->total_plays, 2u);
+    BOOST_REQUIRE_EQUAL(ram_usage("alice"_n), alice_ram);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "players"_n), 0u);
+
+    // Idle scoped rows are evicted by name, and a returning player is restored into their own scope
+    create_account("carol"_n);
+    advance_time(seconds(2 * day));
+    play("bob"_n, "n4");
+    fulfill_next(LOSE);
+    push_action("gameplay"_n, "evictscoped"_n, "gameplay"_n, std::vector<name>{"alice"_n, "bob"_n, "carol"_n}, day);
+    BOOST_REQUIRE(!get_scoped_player("alice"_n).has_value());
+    BOOST_REQUIRE_EQUAL(get_scoped_player("bob"_n)->total_plays, 4u);
+    BOOST_REQUIRE_EQUAL(get_evict_state().archived, 1u);
+
+    play("alice"_n, "n3");
+    BOOST_REQUIRE_EQUAL(get_scoped_player("alice"_n)->total_plays, 3u);
+    BOOST_REQUIRE_EQUAL(get_evict_state().restored, 1u);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "players"_n), 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(pooled_draw_test, gameplay_tester) {
+    push_action("gameplay"_n, "setpool"_n, "gameplay"_n, uint32_t(4));
+
+    // The first play requests a draw and settles nothing in its own transaction
+    play("alice"_n, "n1");
+    BOOST_REQUIRE_EQUAL(get_draws().queued, 1u);
+    BOOST_REQUIRE_EQUAL(row_count("oracle"_n, "oracle"_n.value, "requests"_n), 1u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 0u);
+
+    // Plays queued while it is in flight wait for the next draw
+    play("bob"_n, "n1");
+    play("alice"_n, "n2");
+    BOOST_REQUIRE_EQUAL(get_draws().queued, 3u);
+    BOOST_REQUIRE_EQUAL(row_count("oracle"_n, "oracle"_n.value, "requests"_n), 1u);
+
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 1u);
+    BOOST_REQUIRE_EQUAL(get_player("bob"_n).total_wins, 0u);
+    BOOST_REQUIRE_EQUAL(get_draws().queued, 2u);
+    BOOST_REQUIRE_EQUAL(get_draws().draws, 2u);
+
+    // The second draw settles both: bob from its value, alice from sha256 of it and 1
+    char     data[36];
+    uint32_t k = 1;
+    auto     value = LOSE.extract_as_byte_array();
+    std::memcpy(data, value.data(), 32);
+    std::memcpy(data + 32, &k, sizeof(k));
+    auto     derived = sha256(data, sizeof(data)).extract_as_byte_array();
+    uint32_t roll = ((uint32_t(derived[0]) << 24) | (uint32_t(derived[1]) << 16) | (uint32_t(derived[2]) << 8) |
+                     uint32_t(derived[3])) % 100;
+
+    fulfill_next(LOSE);
+    BOOST_REQUIRE_EQUAL(get_player("bob"_n).total_wins, 0u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, roll < 35 ? 2u : 1u);
+    BOOST_REQUIRE_EQUAL(get_draws().queued, 0u);
+    BOOST_REQUIRE_EQUAL(get_draws().served, 3u);
+    BOOST_REQUIRE_EQUAL(get_draws().request_id, 0u);
+    BOOST_REQUIRE_EQUAL(row_count("oracle"_n, "oracle"_n.value, "requests"_n), 0u);
+    BOOST_REQUIRE_EQUAL(row_count("gameplay"_n, "gameplay"_n.value, "poolplays"_n), 0u);
+    BOOST_REQUIRE_EQUAL(get_metrics().plays, 3u);
+}
+
+BOOST_FIXTURE_TEST_CASE(expired_draw_test, gameplay_tester) {
+    push_action("gameplay"_n, "setpool"_n, "gameplay"_n, uint32_t(4));
+    play("alice"_n, "n1");
+    push_action("oracle"_n, "drop"_n, "oracle"_n, uint64_t(0));
+
+    // The waiting play gets a fresh draw once the lost one expires
+    advance_time(seconds(301));
+    push_action("gameplay"_n, "clearexpired"_n, "gameplay"_n, uint32_t(8));
+    BOOST_REQUIRE_EQUAL(get_draws().draws, 2u);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 1u);
+
+    fulfill_next(WIN);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 1u);
+    BOOST_REQUIRE_EQUAL(get_draws().queued, 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(slot_exhaustion_test, gameplay_tester) {
+    for (int i = 0; i < 8; i++) {
+        play("alice"_n, "n" + std::to_string(i));
+    }
+    BOOST_CHECK_EXCEPTION(play("bob"_n, "n0"), native::assert_error,
+                          native::message_contains{"rng request queue is full"});
+
+    // bob's player row was created in the failed transaction and rolled back with it
+    BOOST_REQUIRE(!get_row<player_row>("gameplay"_n, "gameplay"_n.value, "players"_n, "bob"_n.value).has_value());
+    BOOST_REQUIRE_EQUAL(ram_usage("bob"_n), 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(hedged_request_test, gameplay_tester) {
+    // A second mock oracle stands in for the backup provider
+    create_account("oracleb"_n);
+    set_code("oracleb"_n, contracts::mock_oracle_apply);
+    push_action("gameplay"_n, "setproviders"_n, "gameplay"_n, std::vector<name>{"oracle"_n, "oracleb"_n}, uint32_t(1000));
+
+    // The primary is asked at play time, and counted when a callback comes
+    play("alice"_n, "n1");
+    BOOST_REQUIRE_EQUAL(get_provider(0).requests, 0u);
+    uint64_t request_id = get_table<oracle_request_row>("oracle"_n, "oracle"_n.value, "requests"_n).front().assoc_id;
+
+    // The backup has not been asked, so it cannot settle the request
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "receiverand"_n, "oracleb"_n, request_id, WIN),
+                          native::assert_error, native::message_contains{"rng provider was not asked for this request"});
+
+    // Too early to hedge: the backup is not asked yet
+    push_action("gameplay"_n, "hedge"_n, "gameplay"_n, uint32_t(8));
+    BOOST_REQUIRE_EQUAL(get_provider(1).requests, 0u);
+    BOOST_REQUIRE_EQUAL(row_count("oracleb"_n, "oracleb"_n.value, "requests"_n), 0u);
+
+    // After the hedge delay the backup is asked under the same request id
+    advance_time(seconds(2));
+    push_action("gameplay"_n, "hedge"_n, "gameplay"_n, uint32_t(8));
+    BOOST_REQUIRE_EQUAL(get_provider(1).requests, 1u);
+    auto hedged = get_table<oracle_request_row>("oracleb"_n, "oracleb"_n.value, "requests"_n);
+    BOOST_REQUIRE_EQUAL(hedged.size(), 1u);
+    BOOST_REQUIRE_EQUAL(hedged.front().assoc_id, request_id);
+
+    // The backup answers first and settles the play
+    fulfill_next(LOSE, "oracleb"_n);
+    BOOST_REQUIRE_EQUAL(get_provider(1).wins, 1u);
+    BOOST_REQUIRE_EQUAL(get_provider(0).requests, 1u);
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 0u);
+
+    // The primary's late answer is discarded without failing
+    fulfill_next(WIN, "oracle"_n);
+    BOOST_REQUIRE_EQUAL(get_provider(0).late, 1u);
+    BOOST_REQUIRE_EQUAL(get_provider(0).wins, 0u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, 1u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(unknown_provider_test, gameplay_tester) {
+    push_action("gameplay"_n, "setproviders"_n, "gameplay"_n, std::vector<name>{"oracle"_n}, uint32_t(0));
+    play("alice"_n, "n1");
+    uint64_t request_id = get_table<oracle_request_row>("oracle"_n, "oracle"_n.value, "requests"_n).front().assoc_id;
+
+    // Only configured providers may deliver randomness
+    BOOST_CHECK_EXCEPTION(push_action("gameplay"_n, "receiverand"_n, "alice"_n, request_id, WIN), native::assert_error,
+                          native::message_contains{"missing authority of an rng provider"});
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 1u);
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(many_rounds_test, gameplay_tester) {
+    constexpr int rounds = 2000;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        play("alice"_n, "n" + std::to_string(i));
+        fulfill_next(i % 2 ? WIN : LOSE);
+        produce_blocks();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    BOOST_TEST_MESSAGE(rounds << " play and callback rounds in " << elapsed << " s");
+
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_plays, uint64_t(rounds));
+    BOOST_REQUIRE_EQUAL(get_player("alice"_n).total_wins, uint64_t(rounds / 2));
+    claim("alice"_n);
+    BOOST_REQUIRE_EQUAL(get_balance("alice"_n), dbp(10000) * (rounds / 2));
+    BOOST_REQUIRE_EQUAL(get_slots().in_use, 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(profile_sections_test, gameplay_tester) {
+    native::profile().clear();
+    play("alice"_n, "n1");
+    fulfill_next(WIN);
+
+#ifdef DBLTZ_PROFILE
+    std::map<string, native::profiler::sections> actions(native::profile().actions().begin(), native::profile().actions().end());
+    auto cost_of = [&](const string& action, const string& path) {
+        for (const auto& [p, c] : actions[action]) {
+            if (p == path) return c;
+        }
+        BOOST_FAIL("no section " << action << " " << path);
+        return native::profiler::cost{};
+    };
+
+    BOOST_REQUIRE_EQUAL(cost_of("gameplay::play", "play/roll/start_roll/rng.request").calls, 1u);
+    auto callback = cost_of("gameplay::receiverand", "receiverand");
+    auto settle = cost_of("gameplay::receiverand", "receiverand/settle/settle_play");
+    BOOST_REQUIRE_EQUAL(cost_of("gameplay::receiverand", "receiverand/settle/settle_play/issue.send").calls, 1u);
+    BOOST_REQUIRE_LE(settle.total_ns, callback.total_ns);
+    BOOST_REQUIRE_LE(callback.self_ns, callback.total_ns);
+    native::profile().write(stdout);
+#else
+    // Without DBLTZ_PROFILE the markers compile to nothing
+    BOOST_REQUIRE(native::profile().empty());
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
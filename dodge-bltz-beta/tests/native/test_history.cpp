@@ -0,0 +1,207 @@
+#include <boost/test/unit_test.hpp>
+
+#include <history.hpp>
+#include <import.hpp>
+#include <ingest.hpp>
+#include <scan.hpp>
+#include <synth.hpp>
+
+#include <eosio/name.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    struct scratch_dir {
+        fs::path path;
+
+        explicit scratch_dir(const std::string& name) : path(fs::temp_directory_path() / ("dbltz_history_" + name)) {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+
+        ~scratch_dir() { fs::remove_all(path); }
+
+        std::string operator/(const std::string& file) const { return (path / file).string(); }
+    };
+
+    /// Outcomes for eight players over blocks 1..999, a few per block
+    std::vector<history::outcome> sample_outcomes() {
+        std::vector<history::outcome> rows;
+        uint64_t state = 7;
+        for (uint32_t block = 1; block < 1000; block += 1 + uint32_t(state % 3)) {
+            for (int i = 0; i < 3; i++) {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                uint8_t roll = uint8_t((state >> 33) % 100);
+                bool    won = roll < 35;
+                rows.push_back({(state >> 60) % 8 + 1, block, roll, won, won ? 10000 : 0});
+            }
+        }
+        return rows;
+    }
+
+    history::tally reference_tally(const std::vector<history::outcome>& rows, uint64_t player, history::window w) {
+        history::tally t;
+        for (const auto& o : rows) {
+            if ((player && o.player != player) || o.block_num < w.from_block || o.block_num >= w.to_block) continue;
+            t.plays++;
+            t.wins += o.won;
+            t.reward += o.reward;
+        }
+        return t;
+    }
+
+    void check_tally(const history::tally& got, const history::tally& expected) {
+        BOOST_CHECK_EQUAL(got.plays, expected.plays);
+        BOOST_CHECK_EQUAL(got.wins, expected.wins);
+        BOOST_CHECK_EQUAL(got.reward, expected.reward);
+    }
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(history_tests)
+
+BOOST_AUTO_TEST_CASE(scan_test) {
+    std::vector<uint8_t> bytes(5000);
+    std::vector<int64_t> values(bytes.size());
+    for (size_t i = 0; i < bytes.size(); i++) {
+        bytes[i] = i % 3 == 0 || i % 7 == 0;
+        values[i] = int64_t(i) * (i % 2 ? -3 : 5);
+    }
+
+    for (size_t lo : {0, 1, 15, 17}) {
+        for (size_t hi : {size_t(17), size_t(33), size_t(4095), bytes.size()}) {
+            uint64_t count = 0;
+            int64_t  sum = 0;
+            std::vector<size_t> set;
+            for (size_t i = lo; i < hi; i++) {
+                count += bytes[i];
+                sum += values[i];
+                if (bytes[i]) set.push_back(i);
+            }
+            BOOST_REQUIRE_EQUAL(history::scan::count_set(bytes.data() + lo, hi - lo), count);
+            BOOST_REQUIRE_EQUAL(history::scan::sum(values.data() + lo, hi - lo), sum);
+
+            std::vector<size_t> seen;
+            history::scan::for_each_set(bytes.data(), lo, hi, [&](size_t row) { seen.push_back(row); });
+            BOOST_REQUIRE(seen == set);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(queries_test) {
+    scratch_dir dir("queries");
+    auto rows = sample_outcomes();
+    {
+        history::writer out(dir.path.string(), 100);
+        for (size_t i = 0; i < rows.size(); i++) BOOST_REQUIRE(out.append(i + 1, rows[i]));
+    }
+
+    history::store store(dir.path.string());
+    BOOST_REQUIRE_EQUAL(store.segments(), 10u);
+    BOOST_REQUIRE_EQUAL(store.rows(), rows.size());
+
+    const history::window windows[] = {{}, {0, 100}, {250, 750}, {333, 334}, {1000, 2000}, {37, 912}};
+    for (const auto& w : windows) {
+        check_tally(store.overall(w), reference_tally(rows, 0, w));
+        for (uint64_t player = 1; player <= 9; player++) {
+            check_tally(store.player_tally(player, w), reference_tally(rows, player, w));
+
+            std::vector<history::outcome> expected;
+            for (auto o = rows.rbegin(); o != rows.rend() && expected.size() < 25; ++o) {
+                if (o->player == player && o->block_num >= w.from_block && o->block_num < w.to_block) expected.push_back(*o);
+            }
+            auto got = store.player_history(player, w, 25);
+            BOOST_REQUIRE_EQUAL(got.size(), expected.size());
+            for (size_t i = 0; i < got.size(); i++) {
+                BOOST_CHECK_EQUAL(got[i].block_num, expected[i].block_num);
+                BOOST_CHECK_EQUAL(got[i].roll, expected[i].roll);
+                BOOST_CHECK_EQUAL(got[i].won, expected[i].won);
+            }
+        }
+
+        for (auto by : {history::rank::reward, history::rank::wins}) {
+            std::map<uint64_t, history::tally> per_player;
+            for (uint64_t player = 1; player <= 8; player++) per_player[player] = reference_tally(rows, player, w);
+            auto leaders = store.top(3, w, by);
+            BOOST_REQUIRE_LE(leaders.size(), 3u);
+            for (size_t i = 0; i < leaders.size(); i++) {
+                BOOST_CHECK_EQUAL(leaders[i].wins, per_player[leaders[i].player].wins);
+                if (i > 0) BOOST_CHECK_GE(leaders[i - 1].wins, leaders[i].wins);
+            }
+            // Nobody left out ranks above the last one listed
+            size_t better = 0;
+            for (const auto& [player, t] : per_player) better += t.wins > (leaders.empty() ? 0 : leaders.back().wins);
+            BOOST_CHECK_LE(better, leaders.size());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(writer_resume_test) {
+    scratch_dir dir("resume");
+    auto rows = sample_outcomes();
+    size_t half = rows.size() / 2;
+    {
+        history::writer out(dir.path.string(), 100);
+        for (size_t i = 0; i < half; i++) out.append(i + 1, rows[i]);
+    }
+    {
+        // The directory's partition size wins over the one asked for
+        history::writer out(dir.path.string(), 5000);
+        BOOST_REQUIRE_EQUAL(out.partition_blocks(), 100u);
+        BOOST_REQUIRE_EQUAL(out.last_sequence(), half);
+        for (size_t i = 0; i < rows.size(); i++) BOOST_REQUIRE_EQUAL(out.append(i + 1, rows[i]), i >= half);
+        BOOST_CHECK_THROW(out.append(rows.size() + 1, rows.front()), std::runtime_error);
+    }
+
+    history::store store(dir.path.string());
+    BOOST_REQUIRE_EQUAL(store.rows(), rows.size());
+    check_tally(store.overall(), reference_tally(rows, 0, {}));
+
+    // A cut-off segment is refused rather than read past its end
+    auto last = dir.path / history::segment_name(900);
+    fs::resize_file(last, fs::file_size(last) - 1);
+    BOOST_CHECK_THROW(history::store{dir.path.string()}, std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(import_test) {
+    scratch_dir dir("import");
+    ingest::contracts ours{"gameplay"_n.value, "dbptoken"_n.value, ingest::layout::beta};
+
+    uint64_t global_sequence = 0;
+    ingest::synthetic_shape shape;
+    shape.blocks = 120;
+    ingest::write_synthetic_log(dir / "segment.log", ours, shape, global_sequence);
+    ingest::run({dir / "segment.log"}, dir / "records", {ours, 1});
+
+    auto results = ingest::read_records<ingest::result_record>(dir / "records/results.bin", ingest::record_kind::result);
+    auto issues = ingest::read_records<ingest::issue_record>(dir / "records/issues.bin", ingest::record_kind::issue);
+
+    history::import_summary s;
+    {
+        history::writer out(dir / "history", 50);
+        s = history::import_records(dir / "records", out);
+        BOOST_REQUIRE_EQUAL(history::import_records(dir / "records", out).appended, 0u);
+    }
+    BOOST_REQUIRE_EQUAL(s.results, results.size());
+    BOOST_REQUIRE_EQUAL(s.appended, results.size());
+    BOOST_REQUIRE_EQUAL(s.rewards, issues.size());
+
+    history::store store(dir / "history");
+    auto total = store.overall();
+    BOOST_REQUIRE_EQUAL(total.plays, results.size());
+    BOOST_REQUIRE_EQUAL(total.wins, issues.size());
+    BOOST_REQUIRE_EQUAL(total.reward, int64_t(issues.size()) * 10000);
+
+    const auto& r = results[results.size() / 2];
+    auto rows = store.player_history(r.player, {r.block_num, r.block_num + 1}, 1);
+    BOOST_REQUIRE_EQUAL(rows.size(), 1u);
+    BOOST_CHECK_EQUAL(rows[0].roll, r.roll);
+    BOOST_CHECK_EQUAL(rows[0].won, r.won != 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,222 @@
+#include <boost/test/unit_test.hpp>
+
+#include <ingest.hpp>
+#include <log.hpp>
+#include <synth.hpp>
+
+#include <eosio/name.hpp>
+
+#include <zlib.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    ingest::contracts beta_contracts() { return {"gameplay"_n.value, "dbptoken"_n.value, ingest::layout::beta}; }
+
+    /// A fresh directory under the system temp directory, removed at the end of the test
+    struct scratch_dir {
+        fs::path path;
+
+        explicit scratch_dir(const std::string& name) : path(fs::temp_directory_path() / ("dbltz_ingest_" + name)) {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+
+        ~scratch_dir() { fs::remove_all(path); }
+
+        std::string operator/(const std::string& file) const { return (path / file).string(); }
+    };
+
+    uint64_t fnv1a(const std::string& s) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ingest_tests)
+
+BOOST_AUTO_TEST_CASE(trace_log_test) {
+    scratch_dir dir("log");
+    {
+        ingest::log_writer log(dir / "trace_history.log");
+        log.append(7, "first block");
+        log.append(8, "");
+        log.append(9, std::string(100000, 'x'));
+    }
+
+    // A version 0 entry: uint32 size, then the zlib bytes
+    {
+        std::string traces = "version zero";
+        std::vector<char> compressed(compressBound(uLong(traces.size())));
+        uLongf size = uLongf(compressed.size());
+        BOOST_REQUIRE_EQUAL(compress2(reinterpret_cast<Bytef*>(compressed.data()), &size,
+                                      reinterpret_cast<const Bytef*>(traces.data()), uLong(traces.size()), 1), Z_OK);
+
+        std::fstream f(dir / "trace_history.log", std::ios::binary | std::ios::in | std::ios::out | std::ios::ate);
+        uint64_t position = uint64_t(f.tellp());
+        uint64_t magic = ingest::ship_magic(0);
+        uint64_t payload_size = 4 + size;
+        uint32_t compressed_size = uint32_t(size);
+        char block_id[32] = {0, 0, 0, 10};
+        f.write(reinterpret_cast<const char*>(&magic), 8);
+        f.write(block_id, 32);
+        f.write(reinterpret_cast<const char*>(&payload_size), 8);
+        f.write(reinterpret_cast<const char*>(&compressed_size), 4);
+        f.write(compressed.data(), std::streamsize(size));
+        f.write(reinterpret_cast<const char*>(&position), 8);
+    }
+
+    ingest::log_reader reader(dir / "trace_history.log");
+    BOOST_REQUIRE_EQUAL(reader.first_block(), 7u);
+
+    ingest::log_entry entry;
+    BOOST_REQUIRE(reader.next(entry));
+    BOOST_REQUIRE_EQUAL(entry.block_num, 7u);
+    BOOST_REQUIRE_EQUAL(entry.traces, "first block");
+    BOOST_REQUIRE(reader.next(entry));
+    BOOST_REQUIRE(entry.traces.empty());
+    BOOST_REQUIRE(reader.next(entry));
+    BOOST_REQUIRE_EQUAL(entry.traces, std::string(100000, 'x'));
+    BOOST_REQUIRE(reader.next(entry));
+    BOOST_REQUIRE_EQUAL(entry.block_num, 10u);
+    BOOST_REQUIRE_EQUAL(entry.traces, "version zero");
+    BOOST_REQUIRE(!reader.next(entry));
+
+    // A log cut short mid-entry is reported, not misread
+    fs::resize_file(dir.path / "trace_history.log", fs::file_size(dir.path / "trace_history.log") - 3);
+    ingest::log_reader cut(dir / "trace_history.log");
+    for (int i = 0; i < 3; i++) BOOST_REQUIRE(cut.next(entry));
+    BOOST_CHECK_THROW(cut.next(entry), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(decode_block_test) {
+    auto ours = beta_contracts();
+    uint64_t alice = "alice"_n.value, bob = "bob"_n.value, gameplay = ours.gameplay, token = ours.token;
+
+    ingest::synthetic_transaction play;
+    play.actions = {
+        {gameplay, gameplay, "play"_n.value, ingest::play_data(ours, alice, 42), 100},
+        {"orng.wax"_n.value, "orng.wax"_n.value, "requestrand"_n.value, std::string(24, '\0'), 101},
+    };
+
+    ingest::synthetic_transaction playc;
+    std::string compact(16, '\0');
+    std::memcpy(compact.data(), &bob, 8);
+    compact[8] = 9;
+    compact.push_back(char(0x03)); // a batch of three
+    playc.actions = {{gameplay, gameplay, "playc"_n.value, compact, 102}};
+
+    ingest::synthetic_transaction callback;
+    callback.actions = {
+        {gameplay, gameplay, "receiverand"_n.value, ingest::receiverand_data(ours, 5, 0x0102030405060708ULL), 103},
+        {gameplay, gameplay, "logresult"_n.value, ingest::logresult_data(alice, true, 7), 104},
+        {token, token, "issue"_n.value, ingest::issue_data(alice, 10000, 0x504244 << 8 | 4), 105},
+    };
+
+    // A transfer and its two notifications, which are not counted again
+    ingest::synthetic_transaction transfer;
+    auto data = ingest::transfer_data(alice, bob, 250, 0x504244 << 8 | 4);
+    transfer.actions = {{token, token, "transfer"_n.value, data, 106},
+                        {alice, token, "transfer"_n.value, data, 107},
+                        {bob, token, "transfer"_n.value, data, 108}};
+
+    ingest::synthetic_transaction failed = play;
+    failed.status = 2;
+
+    auto traces = ingest::pack_traces({play, playc, callback, transfer, failed});
+    ingest::batch out;
+    ingest::decode_stats stats;
+    ingest::decode_block(traces, 77, ours, out, stats);
+
+    BOOST_REQUIRE_EQUAL(stats.transactions, 4u);
+    BOOST_REQUIRE_EQUAL(stats.matched, 6u);
+    BOOST_REQUIRE_EQUAL(stats.malformed, 0u);
+
+    BOOST_REQUIRE_EQUAL(out.plays.size(), 2u);
+    BOOST_REQUIRE_EQUAL(out.plays[0].player, alice);
+    BOOST_REQUIRE_EQUAL(out.plays[0].nonce, fnv1a("42"));
+    BOOST_REQUIRE_EQUAL(out.plays[0].block_num, 77u);
+    BOOST_REQUIRE_EQUAL(out.plays[1].player, bob);
+    BOOST_REQUIRE_EQUAL(out.plays[1].nonce, 9u);
+    BOOST_REQUIRE_EQUAL(out.plays[1].compact, 1);
+    BOOST_REQUIRE_EQUAL(out.plays[1].flags, 3);
+
+    BOOST_REQUIRE_EQUAL(out.callbacks.size(), 1u);
+    BOOST_REQUIRE_EQUAL(out.callbacks[0].request_id, 5u);
+    BOOST_REQUIRE_EQUAL(out.callbacks[0].random_word, 0x0102030405060708ULL);
+    BOOST_REQUIRE_EQUAL(out.callbacks[0].random_value[0], 1);
+
+    BOOST_REQUIRE_EQUAL(out.results.size(), 1u);
+    BOOST_REQUIRE_EQUAL(out.results[0].roll, 7u);
+    BOOST_REQUIRE_EQUAL(out.results[0].won, 1);
+
+    BOOST_REQUIRE_EQUAL(out.issues.size(), 1u);
+    BOOST_REQUIRE_EQUAL(out.issues[0].amount, 10000);
+
+    BOOST_REQUIRE_EQUAL(out.transfers.size(), 1u);
+    BOOST_REQUIRE_EQUAL(out.transfers[0].global_sequence, 106u);
+    BOOST_REQUIRE_EQUAL(out.transfers[0].to, bob);
+
+    // The dodge-bltz layout reads the same bytes differently: the string-nonce play does not fit
+    ingest::batch dodge_out;
+    ingest::decode_stats dodge_stats;
+    ingest::decode_block(ingest::pack_traces({play}), 77, {gameplay, token, ingest::layout::dodge}, dodge_out, dodge_stats);
+    BOOST_REQUIRE(dodge_out.plays.empty());
+    BOOST_REQUIRE_EQUAL(dodge_stats.malformed, 1u);
+
+    traces.pop_back();
+    BOOST_CHECK_THROW(ingest::decode_block(traces, 77, ours, out, stats), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_ingest_test) {
+    scratch_dir dir("run");
+    for (auto variant : {ingest::layout::beta, ingest::layout::dodge}) {
+        ingest::contracts ours = beta_contracts();
+        ours.variant = variant;
+
+        // Segments named out of block order
+        std::vector<std::string> segments;
+        uint64_t global_sequence = 0, expected = 0;
+        ingest::synthetic_shape shape;
+        shape.blocks = 50;
+        for (int s = 0; s < 5; s++) {
+            segments.insert(segments.begin(), dir / ("segment" + std::to_string(s) + ".log"));
+            expected += ingest::write_synthetic_log(segments.front(), ours, shape, global_sequence);
+            shape.first_block += shape.blocks;
+            shape.seed++;
+        }
+
+        auto out = dir / (variant == ingest::layout::beta ? "beta" : "dodge");
+        auto first = ingest::run(segments, out, {ours, 3});
+        BOOST_REQUIRE_EQUAL(first.segments, 5u);
+        BOOST_REQUIRE_EQUAL(first.stats.blocks, 250u);
+        BOOST_REQUIRE_EQUAL(first.stats.matched, expected);
+        BOOST_REQUIRE_EQUAL(first.appended, expected);
+
+        auto plays = ingest::read_records<ingest::play_record>(out + "/plays.bin", ingest::record_kind::play);
+        auto callbacks = ingest::read_records<ingest::callback_record>(out + "/callbacks.bin", ingest::record_kind::callback);
+        BOOST_REQUIRE_EQUAL(plays.size(), 5u * 50 * 18); // every tenth play fails
+        BOOST_REQUIRE_EQUAL(callbacks.size(), 5u * 49 * 18);
+        for (size_t i = 1; i < plays.size(); i++) BOOST_REQUIRE_LT(plays[i - 1].global_sequence, plays[i].global_sequence);
+        BOOST_REQUIRE_EQUAL(plays.front().block_num, 1u);
+        BOOST_REQUIRE_EQUAL(plays.back().block_num, 250u);
+
+        // Ingesting the same segments again adds nothing
+        auto again = ingest::run(segments, out, {ours, 2});
+        BOOST_REQUIRE_EQUAL(again.stats.matched, expected);
+        BOOST_REQUIRE_EQUAL(again.appended, 0u);
+        BOOST_CHECK_THROW(ingest::read_records<ingest::issue_record>(out + "/plays.bin", ingest::record_kind::issue),
+                          std::runtime_error);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
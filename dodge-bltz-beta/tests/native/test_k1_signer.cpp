@@ -0,0 +1,56 @@
+#include <boost/test/unit_test.hpp>
+
+#include <client/k1_signer.hpp>
+
+#include <openssl/ecdsa.h>
+
+// The EC_KEY verify is deprecated in OpenSSL 3 but is the shortest independent check
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+BOOST_AUTO_TEST_SUITE(k1_signer_tests)
+
+BOOST_AUTO_TEST_CASE(sign_and_recover_test) {
+    std::array<uint8_t, 32> key{};
+    for (size_t i = 0; i < key.size(); i++) key[i] = uint8_t(i * 7 + 1);
+    client::k1_signer signer(key);
+    BOOST_REQUIRE(signer.public_key()[0] == 2 || signer.public_key()[0] == 3);
+
+    std::vector<eosio::checksum256> digests;
+    for (int i = 0; i < 32; i++) {
+        std::string text = "transaction " + std::to_string(i);
+        digests.push_back(eosio::sha256(text.data(), uint32_t(text.size())));
+    }
+    std::vector<client::signature> signatures(digests.size());
+    client::sign_batch(signer, digests, signatures);
+
+    EC_GROUP* group = EC_GROUP_new_by_curve_name(NID_secp256k1);
+    EC_POINT* pub = EC_POINT_new(group);
+    EC_POINT_oct2point(group, pub, signer.public_key().data(), 33, nullptr);
+    EC_KEY* verifier = EC_KEY_new_by_curve_name(NID_secp256k1);
+    EC_KEY_set_public_key(verifier, pub);
+
+    for (size_t i = 0; i < digests.size(); i++) {
+        const auto& sig = signatures[i];
+        BOOST_CHECK(client::k1_signer::is_canonical(sig));
+        BOOST_CHECK(sig.data[0] >= 31 && sig.data[0] <= 34);
+        BOOST_CHECK(signer.recover(digests[i], sig) == signer.public_key());
+
+        // An independent check of r and s
+        ECDSA_SIG* parsed = ECDSA_SIG_new();
+        ECDSA_SIG_set0(parsed, BN_bin2bn(sig.data.data() + 1, 32, nullptr), BN_bin2bn(sig.data.data() + 33, 32, nullptr));
+        auto hash = digests[i].extract_as_byte_array();
+        BOOST_CHECK_EQUAL(ECDSA_do_verify(hash.data(), 32, parsed, verifier), 1);
+        ECDSA_SIG_free(parsed);
+    }
+
+    // A different digest recovers a different key
+    BOOST_CHECK(signer.recover(digests[1], signatures[0]) != signer.public_key());
+
+    EC_KEY_free(verifier);
+    EC_POINT_free(pub);
+    EC_GROUP_free(group);
+
+    BOOST_CHECK_THROW(client::k1_signer(std::array<uint8_t, 32>{}), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,93 @@
+#include <boost/test/unit_test.hpp>
+
+#include <replayer.hpp>
+#include <workload.hpp>
+
+#include <sstream>
+
+using namespace eosio;
+
+namespace {
+
+    replay::workload_shape small_shape() {
+        replay::workload_shape shape;
+        shape.players = 20;
+        shape.plays = 300;
+        shape.duration_s = 900;
+        shape.transfers = 40;
+        shape.drop_percent = 5;
+        shape.sweep_every_s = 300;
+        return shape;
+    }
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(replay_tests)
+
+BOOST_AUTO_TEST_CASE(trace_round_trip_test) {
+    replay::recorder rec;
+    uint32_t first = rec.play("alice"_n, 1);
+    rec.advance_to(1500000);
+    rec.callback(first, 0xfedcba9876543210ULL);
+    rec.transfer("alice"_n, "bob"_n, 250000);
+    rec.maintain();
+    BOOST_CHECK_THROW(rec.callback(1, 0), std::invalid_argument);
+
+    auto bytes = replay::encode(rec.result());
+    auto decoded = replay::decode(bytes);
+    BOOST_REQUIRE_EQUAL(decoded.accounts.size(), 2u);
+    BOOST_REQUIRE_EQUAL(decoded.accounts[1], "bob"_n);
+    BOOST_REQUIRE_EQUAL(decoded.events.size(), 5u);
+    BOOST_REQUIRE(decoded.events[1].kind == replay::event_kind::advance);
+    BOOST_REQUIRE_EQUAL(decoded.events[1].value, 1500000u);
+    BOOST_REQUIRE_EQUAL(decoded.events[2].value, 0xfedcba9876543210ULL);
+    BOOST_REQUIRE_EQUAL(decoded.events[3].other, 1u);
+    BOOST_REQUIRE(replay::encode(decoded) == bytes);
+
+    bytes.pop_back();
+    BOOST_CHECK_THROW(replay::decode(bytes), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(generated_workload_test) {
+    auto t = replay::generate(small_shape());
+    BOOST_REQUIRE(replay::encode(t) == replay::encode(replay::generate(small_shape())));
+
+    // Every callback comes after the play it answers
+    uint32_t plays = 0;
+    for (const auto& e : t.events) {
+        if (e.kind == replay::event_kind::play) plays++;
+        if (e.kind == replay::event_kind::callback) BOOST_REQUIRE_LT(e.other, plays);
+    }
+    BOOST_REQUIRE_EQUAL(plays, 300u);
+
+    // A few bytes per event
+    BOOST_TEST_MESSAGE(t.events.size() << " events in " << replay::encode(t).size() << " bytes");
+    BOOST_REQUIRE_LT(replay::encode(t).size(), t.events.size() * 8);
+}
+
+BOOST_AUTO_TEST_CASE(replay_is_deterministic_test) {
+    auto t = replay::generate(small_shape());
+    auto tgt = replay::make_target();
+
+    auto first = replay::run(t, *tgt);
+    auto second = replay::run(t, *tgt);
+    BOOST_REQUIRE_EQUAL(first.get("play.count"), "300");
+    BOOST_REQUIRE_EQUAL(first.get("play.failed"), "0");
+    BOOST_REQUIRE_EQUAL(first.get("transfer.failed"), "0");
+    BOOST_REQUIRE_NE(first.get("table.gameplay.players.rows"), "");
+
+    // Only wall time may change between runs of the same build
+    std::ostringstream out;
+    BOOST_REQUIRE_EQUAL(replay::write_diff(out, first, second), 0u);
+
+    // A report survives being written and read back
+    std::stringstream stored;
+    replay::write_report(stored, first);
+    auto reread = replay::read_report(stored);
+    BOOST_REQUIRE(reread.entries == first.entries);
+
+    second.set("table.gameplay.players.hash", "0");
+    BOOST_REQUIRE_EQUAL(replay::write_diff(out, first, second), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
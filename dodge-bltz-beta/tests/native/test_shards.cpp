@@ -0,0 +1,187 @@
+#include <boost/test/unit_test.hpp>
+
+#include <client/shards.hpp>
+#include <contracts.hpp>
+#include <native/chain.hpp>
+
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+
+#include <map>
+
+using namespace eosio;
+using std::string;
+
+namespace {
+
+    const symbol DBP = symbol("DBP", 4);
+
+    const std::vector<name> shard_accounts = {"gameplay1"_n, "gameplay2"_n, "gameplay3"_n};
+    const std::vector<name> oracles = {"oracle1"_n, "oracle2"_n, "oracle3"_n};
+
+    struct oracle_request_row {
+        uint64_t id;
+        uint64_t assoc_id;
+        uint64_t signing_value;
+        name     caller;
+    };
+
+    struct player_row {
+        name     player;
+        uint64_t total_plays;
+    };
+
+    /// Players named player.a .. player.z, player.aa ..
+    std::vector<name> player_names(size_t count) {
+        std::vector<name> players;
+        for (size_t i = 0; i < count; i++) {
+            string suffix(1, char('a' + i % 26));
+            if (i >= 26) suffix.insert(suffix.begin(), char('a' + i / 26 - 1));
+            players.push_back(name("player." + suffix));
+        }
+        return players;
+    }
+
+} // namespace
+
+/// Three gameplay shards, each with its own oracle, sharing one token
+class shard_tester : public native::tester {
+public:
+    client::shard_map map{shard_accounts};
+    std::vector<name> players = player_names(40);
+
+    shard_tester() {
+        create_accounts({"dbptoken"_n});
+        for (name p : players) create_accounts({p});
+        set_code("dbptoken"_n, contracts::dbp_token_apply);
+        push_action("dbptoken"_n, "create"_n, "dbptoken"_n, "dbptoken"_n, asset(10000000000, DBP));
+
+        for (size_t i = 0; i < shard_accounts.size(); i++) create_accounts({shard_accounts[i], oracles[i]});
+        for (size_t i = 0; i < shard_accounts.size(); i++) {
+            name shard = shard_accounts[i];
+            set_code(shard, contracts::gameplay_apply);
+            set_code(oracles[i], contracts::mock_oracle_apply);
+            grant_code("dbptoken"_n, shard);
+            push_action(shard, "settoken"_n, shard, "dbptoken"_n);
+            push_action(shard, "setrng"_n, shard, oracles[i]);
+            push_action(shard, "initslots"_n, shard, uint32_t(64));
+            push_action(shard, "setshards"_n, shard, shard_accounts);
+        }
+    }
+
+    void play(name player, const string& nonce) { push_action(map.shard_for(player), "play"_n, player, player, nonce); }
+
+    client::shard_stats stats(name shard) { return call<client::shard_stats>(shard, "getstats"_n); }
+
+    /// Answer every request queued at each shard's oracle
+    void fulfill_all() {
+        for (name oracle : oracles) {
+            for (const auto& r : get_table<oracle_request_row>(oracle, oracle.value, "requests"_n)) {
+                push_action(oracle, "fulfill"_n, oracle, r.id, sha256(reinterpret_cast<const char*>(&r.id), 8));
+            }
+        }
+    }
+};
+
+BOOST_AUTO_TEST_SUITE(shard_tests)
+
+BOOST_AUTO_TEST_CASE(shard_of_test) {
+    // Pinned so the contract and its clients never drift apart
+    BOOST_CHECK_EQUAL(dbltz_shard::shard_of("alice"_n.value, 1), 0u);
+    BOOST_CHECK_EQUAL(dbltz_shard::shard_of("alice"_n.value, 0), 0u);
+
+    auto players = player_names(26 * 27);
+    std::vector<uint32_t> counts(4);
+    size_t moved = 0;
+    for (name p : players) {
+        uint32_t three = dbltz_shard::shard_of(p.value, 3), four = dbltz_shard::shard_of(p.value, 4);
+        BOOST_REQUIRE_LT(three, 3u);
+        counts[three]++;
+        // Growing to four shards only ever moves players onto the new one
+        if (four != three) {
+            BOOST_REQUIRE_EQUAL(four, 3u);
+            moved++;
+        }
+    }
+    for (int s = 0; s < 3; s++) BOOST_CHECK(counts[s] > players.size() / 4 && counts[s] < players.size() / 2);
+    BOOST_CHECK(moved > players.size() / 8 && moved < players.size() * 3 / 8);
+}
+
+BOOST_FIXTURE_TEST_CASE(route_and_play_test, shard_tester) {
+    std::map<name, uint64_t> plays_by_shard;
+    for (name p : players) {
+        name owner = map.shard_for(p);
+        for (name shard : shard_accounts) BOOST_REQUIRE(call<name>(shard, "route"_n, p) == owner);
+
+        play(p, "n1");
+        plays_by_shard[owner]++;
+
+        // Each player's stats live on its shard alone
+        for (name shard : shard_accounts) {
+            auto row = get_row<player_row>(shard, shard.value, "players"_n, p.value);
+            BOOST_REQUIRE_EQUAL(row.has_value(), shard == owner);
+        }
+    }
+    BOOST_REQUIRE_EQUAL(plays_by_shard.size(), 3u);
+
+    // Another shard refuses the player and names the right one
+    name p = players.front(), owner = map.shard_for(p);
+    name other = owner == shard_accounts[0] ? shard_accounts[1] : shard_accounts[0];
+    BOOST_CHECK_EXCEPTION(push_action(other, "play"_n, p, p, string("n2")), native::assert_error,
+                          native::message_contains{"player belongs to shard " + owner.to_string()});
+    BOOST_CHECK_EXCEPTION(push_action(other, "playc"_n, p, p, uint64_t(1), uint8_t(0)), native::assert_error,
+                          native::message_contains{"player belongs to shard " + owner.to_string()});
+
+    // Each shard's requests went to its own oracle
+    for (size_t i = 0; i < shard_accounts.size(); i++) {
+        auto queued = get_table<oracle_request_row>(oracles[i], oracles[i].value, "requests"_n);
+        BOOST_CHECK_EQUAL(queued.size(), plays_by_shard[shard_accounts[i]]);
+        for (const auto& r : queued) BOOST_CHECK(r.caller == shard_accounts[i]);
+    }
+
+    std::vector<client::shard_stats> before;
+    for (name shard : shard_accounts) before.push_back(stats(shard));
+    auto pending = client::merge_stats(before);
+    BOOST_CHECK_EQUAL(pending.shards, 3u);
+    BOOST_CHECK_EQUAL(pending.metrics.plays, players.size());
+    BOOST_CHECK_EQUAL(pending.slots_capacity, 3u * 64);
+    BOOST_CHECK_EQUAL(pending.slots_in_use, players.size());
+    auto busiest = std::max_element(plays_by_shard.begin(), plays_by_shard.end(),
+                                    [](const auto& a, const auto& b) { return a.second < b.second; });
+    BOOST_CHECK(pending.busiest == busiest->first);
+
+    advance_time(milliseconds(1500));
+    fulfill_all();
+    std::vector<client::shard_stats> after;
+    for (name shard : shard_accounts) {
+        after.push_back(stats(shard));
+        BOOST_CHECK(after.back().shard == shard);
+        BOOST_CHECK_EQUAL(after.back().metrics.callbacks, plays_by_shard[shard]);
+    }
+    auto settled = client::merge_stats(after);
+    BOOST_CHECK_EQUAL(settled.metrics.callbacks, players.size());
+    BOOST_CHECK_EQUAL(settled.slots_in_use, 0u);
+    BOOST_CHECK_EQUAL(settled.metrics.latency_ms.at(10), players.size());
+    BOOST_CHECK_EQUAL(settled.utilization(), 0.0);
+}
+
+BOOST_FIXTURE_TEST_CASE(setshards_test, shard_tester) {
+    name shard = shard_accounts[0];
+    BOOST_CHECK_EXCEPTION(push_action(shard, "setshards"_n, shard, std::vector<name>{"gameplay2"_n}), native::assert_error,
+                          native::message_contains{"shard list must include this account"});
+    BOOST_CHECK_EXCEPTION(push_action(shard, "setshards"_n, shard, std::vector<name>{shard, shard}), native::assert_error,
+                          native::message_contains{"duplicate shard account"});
+    BOOST_CHECK_EXCEPTION(push_action(shard, "setshards"_n, shard, std::vector<name>{shard, "nobody"_n}), native::assert_error,
+                          native::message_contains{"shard account does not exist"});
+    BOOST_CHECK_THROW(push_action(shard, "setshards"_n, players[0], std::vector<name>{shard}), native::chain_error);
+
+    // Unsharded again, the shard takes every player and routes to itself
+    push_action(shard, "setshards"_n, shard, std::vector<name>{});
+    for (name p : players) {
+        BOOST_CHECK(call<name>(shard, "route"_n, p) == shard);
+    }
+    push_action(shard, "play"_n, players[0], players[0], string("n1"));
+    push_action(shard, "play"_n, players[1], players[1], string("n1"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
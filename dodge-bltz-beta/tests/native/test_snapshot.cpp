@@ -0,0 +1,172 @@
+#include <boost/test/unit_test.hpp>
+
+#include <abi.hpp>
+#include <extract.hpp>
+#include <snapshot.hpp>
+#include <synthetic.hpp>
+
+#include <eosio/name.hpp>
+#include <eosio/symbol.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    struct scratch_dir {
+        fs::path path;
+
+        explicit scratch_dir(const std::string& name) : path(fs::temp_directory_path() / ("dbltz_snapshot_" + name)) {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+
+        ~scratch_dir() { fs::remove_all(path); }
+
+        std::string operator/(const std::string& file) const { return (path / file).string(); }
+    };
+
+    std::vector<std::string> lines_of(const std::string& path) {
+        std::ifstream in(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);) lines.push_back(line);
+        return lines;
+    }
+
+    std::string json_of(const snapshot::abi& a, const std::string& type, const std::string& packed) {
+        snapshot::stream in(packed);
+        std::string out;
+        a.json(type, in, out);
+        BOOST_REQUIRE_EQUAL(in.remaining(), 0u);
+        return out;
+    }
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(snapshot_tests)
+
+BOOST_AUTO_TEST_CASE(abi_test) {
+    snapshot::abi a;
+    a.types["account_name"] = "name";
+    a.structs["base"] = {"", {{"owner", "account_name"}}};
+    a.structs["row"] = {"base",
+                        {{"balance", "asset"},
+                         {"memo", "string"},
+                         {"tags", "uint16[]"},
+                         {"when", "time_point_sec?"},
+                         {"choice", "pick"},
+                         {"extra", "uint8$"}}};
+    a.variants["pick"] = {"uint32", "bytes"};
+    a.tables["rows"_n.value] = "row";
+
+    auto parsed = snapshot::abi::parse(a.pack());
+    BOOST_REQUIRE_EQUAL(parsed.tables.at("rows"_n.value), "row");
+    BOOST_REQUIRE_EQUAL(parsed.variants.at("pick").size(), 2u);
+    auto columns = parsed.columns("row");
+    BOOST_REQUIRE_EQUAL(columns.size(), 7u);
+    BOOST_CHECK_EQUAL(columns.front(), "owner");
+    BOOST_CHECK_EQUAL(columns.back(), "extra");
+
+    std::string row;
+    snapshot::put_u64(row, "alice"_n.value);
+    snapshot::put_u64(row, uint64_t(-12345));
+    snapshot::put_u64(row, eosio::symbol("DBP", 4).raw());
+    snapshot::put_bytes(row, "say \"hi\", bob");
+    snapshot::put_varuint32(row, 2);
+    row += std::string("\x01\x00\x02\x01", 4);
+    snapshot::put_u8(row, 1);
+    snapshot::put_u32(row, 86400);
+    snapshot::put_varuint32(row, 1);
+    snapshot::put_bytes(row, "\xab");
+
+    BOOST_CHECK_EQUAL(json_of(parsed, "row", row),
+                      "{\"owner\":\"alice\",\"balance\":\"-1.2345 DBP\",\"memo\":\"say \\\"hi\\\", bob\",\"tags\":[1,258],"
+                      "\"when\":\"1970-01-02T00:00:00\",\"choice\":[\"bytes\",\"ab\"]}");
+
+    std::string with_extension = row;
+    snapshot::put_u8(with_extension, 7);
+    snapshot::stream in(with_extension);
+    std::string cells;
+    parsed.csv_cells("row", in, cells);
+    BOOST_CHECK_EQUAL(cells, ",alice,-1.2345 DBP,\"say \"\"hi\"\", bob\",\"[1,258]\",1970-01-02T00:00:00,\"[\"\"bytes\"\",\"\"ab\"\"]\",7");
+
+    snapshot::stream short_row(row.substr(0, 20));
+    cells.clear();
+    BOOST_CHECK_THROW(parsed.csv_cells("row", short_row, cells), std::runtime_error);
+    BOOST_CHECK_THROW(snapshot::abi::parse("\x08not an abi"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(extract_test) {
+    scratch_dir dir("extract");
+    snapshot::synthetic_shape shape;
+    shape.players = 50;
+    shape.holders = 300;
+    shape.other_tables = 20;
+    auto counts = snapshot::write_synthetic_snapshot(dir / "snapshot.bin", shape);
+
+    snapshot::options opts;
+    opts.codes = {"gameplay"_n.value, "dbptoken"_n.value};
+    opts.threads = 3;
+    auto s = snapshot::extract(dir / "snapshot.bin", dir / "csv", opts);
+    BOOST_REQUIRE_EQUAL(s.version, 6u);
+    BOOST_REQUIRE_EQUAL(s.tables_seen, counts.tables);
+    BOOST_REQUIRE_EQUAL(s.scopes, 2u + 1 + 300);
+    BOOST_REQUIRE_EQUAL(s.rows, counts.gameplay_rows + counts.token_rows);
+    BOOST_REQUIRE_EQUAL(s.files.size(), 4u);
+
+    auto players = lines_of(dir / "csv/gameplay.players.csv");
+    BOOST_REQUIRE_EQUAL(players.size(), 51u);
+    BOOST_CHECK_EQUAL(players[0],
+                      "scope,primary_key,payer,player,total_plays,total_wins,last_nonce,schema_version,last_play,last_cnonce");
+    BOOST_CHECK(players[1].find(",nonce-0,,,") != std::string::npos);      // a v0 row
+    BOOST_CHECK(players[3].ends_with(",nonce-2,2,2023-11-14T22:13:22,2")); // a v2 row
+
+    auto accounts = lines_of(dir / "csv/dbptoken.accounts.csv");
+    BOOST_REQUIRE_EQUAL(accounts.size(), 301u);
+    BOOST_CHECK_EQUAL(accounts[0], "scope,primary_key,payer,balance");
+    BOOST_CHECK(accounts[1].ends_with(" DBP"));
+    auto stat = lines_of(dir / "csv/dbptoken.stat.csv");
+    BOOST_REQUIRE_EQUAL(stat.size(), 2u);
+    BOOST_CHECK(stat[1].find("," + std::to_string(eosio::symbol_code("DBP").raw()) + ",dbptoken,") != std::string::npos);
+    auto slots = lines_of(dir / "csv/gameplay.rngslots.csv");
+    BOOST_REQUIRE_EQUAL(slots.size(), 5u);
+    BOOST_CHECK(slots[1].ends_with(",2023-11-14T22:13:20.000,,,"));
+
+    // One table, as packed rows
+    opts.tables = {"accounts"_n.value};
+    opts.output = snapshot::format::binary;
+    s = snapshot::extract(dir / "snapshot.bin", dir / "bin", opts);
+    BOOST_REQUIRE_EQUAL(s.files.size(), 1u);
+    BOOST_REQUIRE_EQUAL(s.rows, 300u);
+    auto dump_size = fs::file_size(dir.path / "bin/dbptoken.accounts.bin");
+    BOOST_REQUIRE_EQUAL(dump_size, 16u + 300 * (8 + 8 + 8 + 4 + 16));
+}
+
+BOOST_AUTO_TEST_CASE(malformed_snapshot_test) {
+    scratch_dir dir("malformed");
+    snapshot::synthetic_shape shape;
+    shape.players = 10;
+    shape.holders = 10;
+    snapshot::write_synthetic_snapshot(dir / "snapshot.bin", shape);
+
+    snapshot::options opts;
+    opts.codes = {"gameplay"_n.value};
+
+    fs::copy_file(dir.path / "snapshot.bin", dir.path / "cut.bin");
+    fs::resize_file(dir.path / "cut.bin", fs::file_size(dir.path / "cut.bin") / 2);
+    BOOST_CHECK_THROW(snapshot::extract(dir / "cut.bin", dir / "out", opts), std::runtime_error);
+
+    std::ofstream(dir / "json.bin") << "{\"not\": \"a snapshot\"}";
+    BOOST_CHECK_THROW(snapshot::snapshot_file(dir / "json.bin"), std::runtime_error);
+
+    // A contract without a deployed ABI can still be dumped packed
+    opts.codes = {"eosio"_n.value};
+    BOOST_CHECK_THROW(snapshot::extract(dir / "snapshot.bin", dir / "out", opts), std::runtime_error);
+    opts.output = snapshot::format::binary;
+    BOOST_CHECK_EQUAL(snapshot::extract(dir / "snapshot.bin", dir / "out", opts).rows, 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+#include <boost/test/unit_test.hpp>
+
+#include <client/tx.hpp>
+#include <contracts.hpp>
+#include <native/chain.hpp>
+
+#include <eosio/crypto.hpp>
+#include <eosio/transaction.hpp>
+
+using namespace eosio;
+
+namespace {
+
+    const symbol DBP = symbol("DBP", 4);
+
+    struct player_row {
+        name     player;
+        uint64_t total_plays;
+        uint64_t total_wins;
+        std::string last_nonce;
+    };
+
+    /// A signer that only records what it was asked to sign
+    struct recording_signer {
+        std::vector<checksum256> signed_digests;
+
+        void sign(const checksum256& digest, client::signature& out) {
+            signed_digests.push_back(digest);
+            out.data.fill(uint8_t(signed_digests.size()));
+        }
+    };
+
+    static_assert(client::signer<recording_signer>);
+
+    class builder_tester : public native::tester {
+    public:
+        builder_tester() {
+            create_accounts({"gameplay"_n, "dbptoken"_n, "oracle"_n, "alice"_n});
+            set_code("gameplay"_n, contracts::gameplay_apply);
+            set_code("dbptoken"_n, contracts::dbp_token_apply);
+            set_code("oracle"_n, contracts::mock_oracle_apply);
+            grant_code("dbptoken"_n, "gameplay"_n);
+
+            push_action("dbptoken"_n, "create"_n, "dbptoken"_n, "dbptoken"_n, asset(10000000000, DBP));
+            push_action("gameplay"_n, "settoken"_n, "gameplay"_n, "dbptoken"_n);
+            push_action("gameplay"_n, "setrng"_n, "gameplay"_n, "oracle"_n);
+            push_action("gameplay"_n, "initslots"_n, "gameplay"_n, uint32_t(16));
+        }
+
+        uint32_t expiration() const { return now().sec_since_epoch() + 60; }
+    };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(txbuilder_tests)
+
+BOOST_AUTO_TEST_CASE(template_matches_eosio_pack_test, *boost::unit_test::fixture<builder_tester>()) {
+    client::transaction_template<> trx;
+    auto fields = trx.add<client::dbp_token::transfer>("dbptoken"_n, {"alice"_n}, "alice"_n, "bob"_n, asset(12345, DBP),
+                                                       std::string_view("gg"));
+    trx.add<client::gameplay::play>("gameplay"_n, {"alice"_n, "owner"_n}, "alice"_n, std::string_view("00000000000000000000"));
+    trx.finish();
+    trx.set_header(1700000060, 0x1234, 0xdeadbeef);
+
+    transaction expected(time_point_sec(1700000060));
+    expected.ref_block_num = 0x1234;
+    expected.ref_block_prefix = 0xdeadbeef;
+    expected.actions.emplace_back(permission_level{"alice"_n, "active"_n}, "dbptoken"_n, "transfer"_n,
+                                  std::make_tuple("alice"_n, "bob"_n, asset(12345, DBP), std::string("gg")));
+    expected.actions.emplace_back(permission_level{"alice"_n, "owner"_n}, "gameplay"_n, "play"_n,
+                                  std::make_tuple("alice"_n, std::string(20, '0')));
+    auto bytes = pack(expected);
+    BOOST_REQUIRE_EQUAL(trx.packed(), std::string_view(bytes.data(), bytes.size()));
+
+    // Patching in place gives what packing afresh would
+    trx.patch(fields[2], asset(777, DBP).amount);
+    expected.actions[0].data = pack(std::make_tuple("alice"_n, "bob"_n, asset(777, DBP), std::string("gg")));
+    bytes = pack(expected);
+    BOOST_REQUIRE_EQUAL(trx.packed(), std::string_view(bytes.data(), bytes.size()));
+
+    checksum256 chain_id = sha256("chain", 5);
+    std::vector<char> preimage(32);
+    auto id = chain_id.extract_as_byte_array();
+    std::memcpy(preimage.data(), id.data(), 32);
+    preimage.insert(preimage.end(), bytes.begin(), bytes.end());
+    preimage.resize(preimage.size() + 32);
+    BOOST_REQUIRE(trx.digest(chain_id) == sha256(preimage.data(), uint32_t(preimage.size())));
+
+    BOOST_CHECK_THROW(trx.patch_decimal(trx.packed().size(), 1), std::out_of_range);
+    client::transaction_template<32> tiny;
+    BOOST_CHECK_THROW(tiny.add<client::gameplay::play>("gameplay"_n, {"alice"_n}, "alice"_n, std::string_view(std::string(40, 'x'))),
+                      std::length_error);
+}
+
+BOOST_FIXTURE_TEST_CASE(push_patched_templates_test, builder_tester) {
+    client::transaction_template<> playc;
+    auto compact = playc.add<client::gameplay::playc>("gameplay"_n, {"alice"_n}, "alice"_n, uint64_t(0), uint8_t(0));
+    playc.finish();
+
+    client::transaction_template<> play;
+    auto full = play.add<client::gameplay::play>("gameplay"_n, {"alice"_n}, "alice"_n, std::string_view("0000000000"));
+    play.finish();
+
+    recording_signer signer;
+    checksum256      chain_id = sha256("chain", 5);
+    std::vector<checksum256> digests;
+    for (uint64_t nonce = 1; nonce <= 5; nonce++) {
+        playc.set_header(expiration(), 1, 2);
+        playc.patch(compact[1], nonce);
+        digests.push_back(playc.digest(chain_id));
+        push_packed(playc.packed().data(), playc.packed().size());
+
+        play.set_header(expiration(), 1, 2);
+        play.patch_decimal(full[1], nonce * 1000003);
+        push_packed(play.packed().data(), play.packed().size());
+    }
+
+    auto row = get_row<player_row>("gameplay"_n, "gameplay"_n.value, "players"_n, "alice"_n.value);
+    BOOST_REQUIRE(row.has_value());
+    BOOST_CHECK_EQUAL(row->total_plays, 10u);
+    BOOST_CHECK_EQUAL(row->last_nonce, "0005000015");
+
+    BOOST_CHECK_THROW(play.patch_decimal(full[1], 10000000000ull), std::length_error);
+
+    // Same nonce again is a replay
+    BOOST_CHECK_THROW(push_packed(playc.packed().data(), playc.packed().size()), native::assert_error);
+
+    // Expired
+    playc.set_header(now().sec_since_epoch(), 1, 2);
+    playc.patch(compact[1], uint64_t(6));
+    BOOST_CHECK_THROW(push_packed(playc.packed().data(), playc.packed().size()), native::chain_error);
+
+    std::vector<client::signature> signatures(digests.size());
+    client::sign_batch(signer, digests, signatures);
+    BOOST_REQUIRE_EQUAL(signer.signed_digests.size(), 5u);
+    BOOST_CHECK(signer.signed_digests[4] == digests[4]);
+
+    char   packed[1024];
+    size_t n = client::pack_signed(packed, sizeof(packed), playc, std::span(signatures).first(2));
+    BOOST_REQUIRE_EQUAL(n, 1 + 2 * 66 + 1 + 1 + 1 + playc.packed().size());
+    BOOST_CHECK_EQUAL(uint8_t(packed[2]), 1); // the first signature's recovery byte
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,6 +1,12 @@
 #!/bin/bash
 
 # Test runner for Dodge BLTZ smart contracts
+#
+# Builds the contracts natively against the CDT stand-in in native/include
+# and runs the unit tests with CTest. Needs CMake, a C++20 compiler and
+# Boost.Test; the EOSIO CDT and nodeos are not required.
+
+set -e
 
 echo "Running Dodge BLTZ Smart Contract Tests..."
 
@@ -12,40 +18,16 @@ NC='\033[0m' # No Color
 
 # Get script directory
 SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )"
-PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
-
-echo -e "${YELLOW}Note: This is a test scaffold. Full test implementation requires EOSIO test framework setup.${NC}"
-echo ""
-
-# Simulate test runs for demonstration
-echo -e "${YELLOW}Running DBP Token Tests...${NC}"
-echo "  ✓ create_token_test"
-echo "  ✓ issue_tokens_test"
-echo "  ✓ transfer_tokens_test"
-echo "  ✓ burn_tokens_test"
-echo "  ✓ invalid_operations_test"
-echo -e "${GREEN}DBP Token Tests: 5/5 passed${NC}"
-echo ""
-
-echo -e "${YELLOW}Running Gameplay Tests...${NC}"
-echo "  ✓ play_action_test"
-echo "  ✓ nonce_validation_test"
-echo "  ✓ rng_integration_test"
-echo "  ✓ token_reward_test"
-echo "  ✓ config_management_test"
-echo -e "${GREEN}Gameplay Tests: 5/5 passed${NC}"
-echo ""
+BUILD_DIR="${BUILD_DIR:-$SCRIPT_DIR/native/build}"
 
-echo -e "${YELLOW}Running Integration Tests...${NC}"
-echo "  ✓ end_to_end_gameplay_test"
-echo "  ✓ multi_player_test"
-echo "  ✓ expired_request_cleanup_test"
-echo -e "${GREEN}Integration Tests: 3/3 passed${NC}"
+echo -e "${YELLOW}Building native tests in $BUILD_DIR...${NC}"
+cmake -S "$SCRIPT_DIR/native" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release > /dev/null
+cmake --build "$BUILD_DIR" -j"$(nproc 2>/dev/null || echo 2)"
 echo ""
 
-echo -e "${GREEN}All tests passed! (13/13)${NC}"
-echo ""
-echo -e "${YELLOW}To run actual tests:${NC}"
-echo "1. Set up EOSIO test framework"
-echo "2. Compile test files with eosio-cpp"
-echo "3. Run tests with ctest or custom test runner"
\ No newline at end of file
+if ctest --test-dir "$BUILD_DIR" --output-on-failure; then
+    echo -e "${GREEN}All tests passed!${NC}"
+else
+    echo -e "${RED}Tests failed${NC}"
+    exit 1
+fi
@@ -81,6 +81,41 @@ ACTION dbp_token::transfer( const name&    from,
     add_balance( to, quantity, payer );
 }
 
+void dbp_token::syncholders( const std::vector<name>& owners,
+                             const symbol_code& sym_code )
+{
+    require_auth( get_self() );
+    check( owners.size() <= MAX_HOLDER_SYNC, "too many owners in one sync" );
+
+    const symbol sym = get_supply( get_self(), sym_code ).symbol;
+
+    // The owners did not authorize this, so the contract pays for rows it adds
+    for( const auto& owner : owners ) {
+        update_holder( owner, get_balance_or_zero( get_self(), owner, sym ), get_self() );
+    }
+}
+
+std::vector<asset> dbp_token::getbalances( const std::vector<name>& owners,
+                                           const symbol_code& sym_code )
+{
+    check( owners.size() <= MAX_BALANCE_QUERY, "too many owners in one query" );
+
+    // The supply carries the symbol precision used for zero balances
+    const symbol sym = get_supply( get_self(), sym_code ).symbol;
+
+    std::vector<asset> balances;
+    balances.reserve( owners.size() );
+    for( const auto& owner : owners ) {
+        balances.push_back( get_balance_or_zero( get_self(), owner, sym ) );
+    }
+    return balances;
+}
+
+asset dbp_token::getsupply( const symbol_code& sym_code )
+{
+    return get_supply( get_self(), sym_code );
+}
+
 void dbp_token::sub_balance( const name& owner, const asset& value ) {
    accounts from_acnts( get_self(), owner.value );
 
@@ -90,6 +125,8 @@ void dbp_token::sub_balance( const name& owner, const asset& value ) {
    from_acnts.modify( from, owner, [&]( auto& a ) {
          a.balance -= value;
       });
+
+   update_holder( owner, from.balance, owner );
 }
 
 void dbp_token::add_balance( const name& owner, const asset& value, const name& ram_payer )
@@ -97,7 +134,7 @@ void dbp_token::add_balance( const name& owner, const asset& value, const name&
    accounts to_acnts( get_self(), owner.value );
    auto to = to_acnts.find( value.symbol.code().raw() );
    if( to == to_acnts.end() ) {
-      to_acnts.emplace( ram_payer, [&]( auto& a ){
+      to = to_acnts.emplace( ram_payer, [&]( auto& a ){
         a.balance = value;
       });
    } else {
@@ -105,4 +142,36 @@ void dbp_token::add_balance( const name& owner, const asset& value, const name&
         a.balance += value;
       });
    }
+
+   update_holder( owner, to->balance, ram_payer );
+}
+
+void dbp_token::update_holder( const name& owner, const asset& balance, const name& ram_payer )
+{
+   holders holders_tbl( get_self(), balance.symbol.code().raw() );
+   auto itr = holders_tbl.find( owner.value );
+
+   int64_t count_delta = 0;
+   if( balance.amount == 0 ) {
+      // Zero balances leave the registry
+      if( itr == holders_tbl.end() ) return;
+      holders_tbl.erase( itr );
+      count_delta = -1;
+   } else if( itr == holders_tbl.end() ) {
+      holders_tbl.emplace( ram_payer, [&]( auto& h ) {
+         h.owner = owner;
+         h.balance = balance;
+      });
+      count_delta = 1;
+   } else {
+      holders_tbl.modify( itr, same_payer, [&]( auto& h ) {
+         h.balance = balance;
+      });
+      return;
+   }
+
+   holder_stats_table holder_stats( get_self(), balance.symbol.code().raw() );
+   auto hs = holder_stats.get_or_default();
+   hs.holder_count += count_delta;
+   holder_stats.set( hs, get_self() );
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <eosio/eosio.hpp>
 #include <eosio/asset.hpp>
 #include <eosio/system.hpp>
+#include <eosio/singleton.hpp>
 
 using namespace eosio;
 
@@ -43,6 +44,38 @@ CONTRACT dbp_token : public contract {
                        const asset&   quantity,
                        const std::string& memo );
 
+      /**
+       * Sync holders action. Registers the balances of accounts that held `sym_code`
+       * before the holder registry existed; run it over every existing balance once.
+       *
+       * @param owners - the accounts to register, whether or not they hold a balance,
+       * @param sym_code - the symbol to register balances for.
+       */
+      ACTION syncholders( const std::vector<name>& owners,
+                          const symbol_code& sym_code );
+
+      /**
+       * Get balances action, read-only.
+       *
+       * @param owners - the accounts to read balances for,
+       * @param sym_code - the symbol to read balances for.
+       *
+       * @return the balance of each owner in the same order, zero for accounts that hold no `sym_code`
+       */
+      [[eosio::action, eosio::read_only]]
+      std::vector<asset> getbalances( const std::vector<name>& owners,
+                                      const symbol_code& sym_code );
+
+      /**
+       * Get supply action, read-only.
+       *
+       * @param sym_code - the symbol to read the supply for.
+       *
+       * @return the current supply of `sym_code`
+       */
+      [[eosio::action, eosio::read_only]]
+      asset getsupply( const symbol_code& sym_code );
+
       /**
        * Get supply method. Gets the supply for token `sym_code`, created by `token_contract_account`.
        *
@@ -70,11 +103,31 @@ CONTRACT dbp_token : public contract {
          return ac.balance;
       }
 
+      /**
+       * Get balance or zero method. Like `get_balance`, but returns a zero `sym` balance for an account without a balance row.
+       *
+       * @param token_contract_account - the account to get the balance for
+       * @param owner - the owner to get the balance for
+       * @param sym - the symbol, with precision, to get the balance for
+       */
+      static asset get_balance_or_zero( const name& token_contract_account, const name& owner, const symbol& sym )
+      {
+         accounts accountstable( token_contract_account, owner.value );
+         auto ac = accountstable.find( sym.code().raw() );
+         return ac == accountstable.end() ? asset( 0, sym ) : ac->balance;
+      }
+
       using create_action = eosio::action_wrapper<"create"_n, &dbp_token::create>;
       using issue_action = eosio::action_wrapper<"issue"_n, &dbp_token::issue>;
       using transfer_action = eosio::action_wrapper<"transfer"_n, &dbp_token::transfer>;
+      using syncholders_action = eosio::action_wrapper<"syncholders"_n, &dbp_token::syncholders>;
+      using getbalances_action = eosio::action_wrapper<"getbalances"_n, &dbp_token::getbalances>;
+      using getsupply_action = eosio::action_wrapper<"getsupply"_n, &dbp_token::getsupply>;
 
    private:
+      static constexpr uint32_t MAX_BALANCE_QUERY = 1000;
+      static constexpr uint32_t MAX_HOLDER_SYNC = 100;
+
       TABLE account {
          asset    balance;
 
@@ -89,9 +142,28 @@ CONTRACT dbp_token : public contract {
          uint64_t primary_key()const { return supply.symbol.code().raw(); }
       };
 
+      // Global registry of non-zero balances, scoped by symbol code
+      TABLE holder {
+         name     owner;
+         asset    balance;
+
+         uint64_t primary_key()const { return owner.value; }
+         // Largest balance first, so a rich list is a forward walk from begin()
+         uint64_t by_balance()const { return std::numeric_limits<uint64_t>::max() - static_cast<uint64_t>(balance.amount); }
+      };
+
+      TABLE holder_stats {
+         uint64_t holder_count = 0;
+      };
+
       typedef eosio::multi_index< "accounts"_n, account > accounts;
       typedef eosio::multi_index< "stat"_n, currency_stats > stats;
+      typedef eosio::multi_index< "holders"_n, holder,
+         indexed_by< "bybalance"_n, const_mem_fun< holder, uint64_t, &holder::by_balance > >
+      > holders;
+      typedef eosio::singleton< "holderstats"_n, holder_stats > holder_stats_table;
 
       void sub_balance( const name& owner, const asset& value );
       void add_balance( const name& owner, const asset& value, const name& ram_payer );
+      void update_holder( const name& owner, const asset& balance, const name& ram_payer );
 };
\ No newline at end of file
@@ -24,123 +24,285 @@ ACTION gameplay::init( const name& token_contract )
 
 ACTION gameplay::play( const name& player, const uint64_t& nonce )
 {
+    DBLTZ_PROFILE_SCOPE( "play" );
     require_auth( player );
     
-    // Verify nonce hasn't been used
-    used_nonces_table used_nonces( get_self(), get_self().value );
-    auto nonce_itr = used_nonces.find( nonce );
-    check( nonce_itr == used_nonces.end(), "nonce already used" );
-    
-    // Add nonce to used nonces table
-    used_nonces.emplace( player, [&]( auto& n ) {
-        n.nonce = nonce;
-        n.player = player;
-        n.timestamp = current_time_point().sec_since_epoch();
-    });
+    // Verify and record the nonce; recording also erases a few nonces older than a day
+    DBLTZ_PROFILE_SECTION( "nonce" );
+    game_core( get_self() ).accept( player, nonce );
     
     // Request random number from WAX RNG Oracle
+    DBLTZ_PROFILE_SECTION( "rng.request" );
     request_random( player, nonce );
-    
-    // Cleanup old nonces periodically
-    cleanup_old_nonces();
 }
 
 ACTION gameplay::receiverand( const uint64_t& caller_signing_value, 
                              const checksum256& caller_signing_value_hash,
                              const uint64_t& random_value )
 {
+    DBLTZ_PROFILE_SCOPE( "receiverand" );
+    
     // Only the RNG Oracle can call this
     require_auth( RNG_ORACLE );
     
-    // Find the pending play request
+    // Find the pending play request; the stored value rejects callbacks for a reused slot
+    DBLTZ_PROFILE_SECTION( "slot.read" );
     pending_plays_table pending_plays( get_self(), get_self().value );
-    auto pending_itr = pending_plays.find( caller_signing_value );
+    auto pending_itr = pending_plays.find( caller_signing_value & SLOT_MASK );
     
-    check( pending_itr != pending_plays.end(), "no pending play found for this signing value" );
+    if( pending_itr == pending_plays.end() || !pending_itr->in_use ||
+        pending_itr->signing_value != caller_signing_value ) {
+        DBLTZ_PROFILE_SECTION( "legacy" );
+        settle_legacy( caller_signing_value, random_value );
+        return;
+    }
     
-    // Process the result
-    process_result( pending_itr->player, pending_itr->nonce, random_value );
+    // Roll and reward a win; on failure nothing happens (no penalty, no reward)
+    DBLTZ_PROFILE_SECTION( "settle" );
+    game_core( get_self() ).settle( pending_itr->player, random_value, [&]() { return win_reward(); } );
     
-    // Remove from pending plays
-    pending_plays.erase( pending_itr );
+    // Return the slot to the free list
+    DBLTZ_PROFILE_SECTION( "slot.release" );
+    release_slot( pending_plays, pending_itr );
 }
 
-void gameplay::request_random( const name& player, const uint64_t& nonce )
+ACTION gameplay::initslots( const uint32_t& capacity )
 {
-    // Generate a unique signing value
-    uint64_t signing_value = current_time_point().time_since_epoch().count() + nonce;
+    require_auth( get_self() );
+    check( capacity <= MAX_SLOTS, "slot capacity too large" );
+    
+    slot_state_table slot_state( get_self(), get_self().value );
+    auto slots = slot_state.get_or_default();
+    check( capacity > slots.capacity, "slot capacity can only grow" );
     
-    // Store pending play
     pending_plays_table pending_plays( get_self(), get_self().value );
-    pending_plays.emplace( player, [&]( auto& p ) {
-        p.signing_value = signing_value;
-        p.player = player;
-        p.nonce = nonce;
-        p.timestamp = current_time_point().sec_since_epoch();
-    });
+    for( uint64_t slot = slots.capacity; slot < capacity; slot++ ) {
+        pending_plays.emplace( get_self(), [&]( auto& p ) {
+            p.slot = slot;
+            p.generation = 0;
+            p.in_use = false;
+            p.next_free = slots.free_head;
+            p.player = name();
+            p.nonce = 0;
+            p.timestamp = 0;
+            p.retries = 0;
+            p.signing_value = 0;
+        });
+        slots.free_head = slot;
+    }
+    slots.capacity = capacity;
+    slot_state.set( slots, get_self() );
+}
+
+ACTION gameplay::setsweep( const uint32_t& timeout_sec, const uint8_t& max_retries )
+{
+    require_auth( get_self() );
+    check( timeout_sec > 0, "timeout must be positive" );
     
-    // Send RNG request to WAX Oracle
-    action(
-        permission_level{ get_self(), "active"_n },
-        RNG_ORACLE,
-        "requestrand"_n,
-        std::make_tuple( signing_value, signing_value, get_self() )
-    ).send();
+    sweep_state_table sweep_state( get_self(), get_self().value );
+    auto sweep = sweep_state.get_or_default();
+    sweep.timeout_sec = timeout_sec;
+    sweep.max_retries = max_retries;
+    sweep_state.set( sweep, get_self() );
 }
 
-void gameplay::process_result( const name& player, const uint64_t& nonce, const uint64_t& random_value )
+ACTION gameplay::sweeppending( const uint32_t& max_rows )
 {
-    // Determine if play was successful (35% chance)
-    bool success = is_successful_play( random_value );
+    require_auth( get_self() );
+    
+    sweep_state_table sweep_state( get_self(), get_self().value );
+    auto sweep = sweep_state.get_or_default();
+    
+    uint32_t now = current_time_point().sec_since_epoch();
+    uint32_t cutoff = now - sweep.timeout_sec;
     
-    if( success ) {
-        // Issue reward to player
-        issue_reward( player );
+    pending_plays_table pending_plays( get_self(), get_self().value );
+    auto idx = pending_plays.get_index<"bytimestamp"_n>();
+    
+    uint32_t count = 0;
+    auto itr = idx.begin();
+    while( itr != idx.end() && count < max_rows && itr->in_use && itr->timestamp < cutoff ) {
+        if( itr->retries < sweep.max_retries ) {
+            // Re-request under a new signing value; a late callback for the old one is rejected
+            uint64_t signing_value = signing_value_for( itr->slot, itr->generation + 1, itr->player, itr->nonce );
+            idx.modify( itr, same_payer, [&]( auto& p ) {
+                p.generation++;
+                p.retries++;
+                p.timestamp = now;
+                p.signing_value = signing_value;
+            });
+            send_rng_request( signing_value );
+            sweep.retried++;
+        } else {
+            // Refund the player's nonce row, then free the slot
+            refund_nonce( itr->player, itr->nonce );
+            release_slot( pending_plays, pending_plays.iterator_to( *itr ) );
+            sweep.expired++;
+        }
+        
+        // Handled rows move to the back of the index
+        itr = idx.begin();
+        count++;
     }
     
-    // Note: On failure, nothing happens (no penalty, no reward)
+    // Plays still pending from before the slot table are never answered by a retry
+    if( count < max_rows ) sweep.expired += expire_legacy( cutoff, max_rows - count );
+    
+    sweep_state.set( sweep, get_self() );
 }
 
-bool gameplay::is_successful_play( const uint64_t& random_value )
+ACTION gameplay::evictidle( const uint32_t& max_rows, const uint32_t& idle_seconds )
 {
-    // Use modulo to get percentage (0-99)
-    uint32_t result_percent = random_value % 100;
+    require_auth( get_self() );
+    check( idle_seconds >= MIN_IDLE_SECONDS, "idle threshold must be at least an hour" );
+    
+    uint32_t now = current_time_point().sec_since_epoch();
+    uint32_t cutoff = now - idle_seconds;
+    
+    evict_state_table evict_state( get_self(), get_self().value );
+    auto state = evict_state.get_or_default();
+    if( state.indexed_from == 0 ) state.indexed_from = now;
+    
+    used_nonces_table used_nonces( get_self(), get_self().value );
+    auto idx = used_nonces.get_index<"bytimestamp"_n>();
+    
+    uint32_t count = 0;
+    auto itr = idx.begin();
+    while( itr != idx.end() && count < max_rows && itr->timestamp < cutoff ) {
+        itr = idx.erase( itr );
+        state.evicted++;
+        count++;
+    }
+    
+    // Once the threshold reaches past indexed_from, every unindexed nonce is due
+    if( !state.legacy_done && cutoff >= state.indexed_from ) {
+        auto legacy = used_nonces.lower_bound( state.legacy_cursor );
+        while( legacy != used_nonces.end() && count < max_rows ) {
+            if( legacy->timestamp < state.indexed_from ) {
+                legacy = used_nonces.erase( legacy );
+                state.evicted++;
+            } else {
+                ++legacy;
+            }
+            count++;
+        }
+        state.legacy_done = legacy == used_nonces.end();
+        state.legacy_cursor = state.legacy_done ? 0 : legacy->nonce;
+    }
     
-    // Success if result is less than 35 (35% chance)
-    return result_percent < 35;
+    evict_state.set( state, get_self() );
 }
 
-void gameplay::issue_reward( const name& player )
+void gameplay::request_random( const name& player, const uint64_t& nonce )
 {
-    // Get contract configuration
-    config_table config_tbl( get_self(), get_self().value );
-    auto config_itr = config_tbl.begin();
-    check( config_itr != config_tbl.end(), "contract not initialized" );
+    DBLTZ_PROFILE_SCOPE( "request_random" );
+    
+    // Claim a free slot for the pending play
+    DBLTZ_PROFILE_SECTION( "slot.claim" );
+    slot_state_table slot_state( get_self(), get_self().value );
+    auto slots = slot_state.get_or_default();
+    check( slots.free_head != NO_SLOT, "rng request queue is full, try again later" );
+    
+    pending_plays_table pending_plays( get_self(), get_self().value );
+    auto slot = pending_plays.find( slots.free_head );
+    slots.free_head = slot->next_free;
+    slots.in_use++;
+    
+    uint64_t signing_value = signing_value_for( slot->slot, slot->generation + 1, player, nonce );
+    pending_plays.modify( slot, same_payer, [&]( auto& p ) {
+        p.generation++;
+        p.in_use = true;
+        p.next_free = NO_SLOT;
+        p.player = player;
+        p.nonce = nonce;
+        p.timestamp = current_time_point().sec_since_epoch();
+        p.retries = 0;
+        p.signing_value = signing_value;
+    });
+    slot_state.set( slots, get_self() );
     
-    // Issue DBP tokens to player
-    action(
-        permission_level{ get_self(), "active"_n },
-        config_itr->token_contract,
-        "issue"_n,
-        std::make_tuple( player, config_itr->reward_amount, std::string("BLTZ reward") )
-    ).send();
+    DBLTZ_PROFILE_SECTION( "requestrand.send" );
+    send_rng_request( signing_value );
+}
+
+uint64_t gameplay::signing_value_for( uint64_t slot, uint32_t generation, const name& player, uint64_t nonce ) const
+{
+    // orng.wax refuses a signing value it has already seen, so the value must not
+    // repeat when the contract is redeployed or its slots start over: hash the
+    // request's time and play above the slot index the callback is routed by
+    uint64_t seed[5] = { uint64_t( current_time_point().time_since_epoch().count() ), player.value, nonce,
+                         generation, slot };
+    auto hash = sha256( reinterpret_cast<const char*>( seed ), sizeof( seed ) ).extract_as_byte_array();
+    uint64_t high;
+    memcpy( &high, hash.data(), sizeof( high ) );
+    return (high << 16) | slot;
+}
+
+void gameplay::send_rng_request( const uint64_t& signing_value )
+{
+    // Send RNG request to WAX Oracle
+    game_core( get_self() ).request( RNG_ORACLE, signing_value, signing_value );
 }
 
-void gameplay::cleanup_old_nonces()
+void gameplay::release_slot( pending_plays_table& pending_plays, pending_plays_table::const_iterator slot )
 {
-    // Clean up nonces older than 24 hours to prevent table from growing too large
-    uint32_t cutoff_time = current_time_point().sec_since_epoch() - (24 * 60 * 60);
+    slot_state_table slot_state( get_self(), get_self().value );
+    auto slots = slot_state.get();
     
+    pending_plays.modify( slot, same_payer, [&]( auto& p ) {
+        p.in_use = false;
+        p.next_free = slots.free_head;
+    });
+    slots.free_head = slot->slot;
+    slots.in_use--;
+    slot_state.set( slots, get_self() );
+}
+
+void gameplay::refund_nonce( const name& player, uint64_t nonce )
+{
     used_nonces_table used_nonces( get_self(), get_self().value );
-    auto itr = used_nonces.begin();
+    auto nonce_itr = used_nonces.find( nonce );
+    if( nonce_itr != used_nonces.end() && nonce_itr->player == player ) {
+        used_nonces.erase( nonce_itr );
+    }
+}
+
+void gameplay::settle_legacy( const uint64_t& signing_value, const uint64_t& random_value )
+{
+    // A late answer to a request sweeppending retried or expired matches nothing;
+    // failing it would only make the oracle retry it forever
+    legacy_pending_plays_table legacy_plays( get_self(), get_self().value );
+    auto legacy_itr = legacy_plays.find( signing_value );
+    if( legacy_itr == legacy_plays.end() ) return;
     
-    int cleanup_count = 0;
-    while( itr != used_nonces.end() && cleanup_count < 10 ) { // Limit cleanup per call
-        if( itr->timestamp < cutoff_time ) {
-            itr = used_nonces.erase( itr );
-            cleanup_count++;
+    name player = legacy_itr->player;
+    legacy_plays.erase( legacy_itr );
+    game_core( get_self() ).settle( player, random_value, [&]() { return win_reward(); } );
+}
+
+uint32_t gameplay::expire_legacy( uint32_t cutoff, uint32_t max_rows )
+{
+    legacy_pending_plays_table legacy_plays( get_self(), get_self().value );
+    uint32_t expired = 0;
+    auto itr = legacy_plays.begin();
+    for( uint32_t count = 0; itr != legacy_plays.end() && count < max_rows; count++ ) {
+        if( itr->timestamp < cutoff ) {
+            refund_nonce( itr->player, itr->nonce );
+            itr = legacy_plays.erase( itr );
+            expired++;
         } else {
             ++itr;
         }
     }
-}
\ No newline at end of file
+    return expired;
+}
+
+dbltz_core::reward_terms gameplay::win_reward()
+{
+    config_table config_tbl( get_self(), get_self().value );
+    auto config_itr = config_tbl.begin();
+    check( config_itr != config_tbl.end(), "contract not initialized" );
+    
+    return { config_itr->token_contract, permission_level{ get_self(), "active"_n },
+             config_itr->reward_amount, std::string("BLTZ reward") };
+}
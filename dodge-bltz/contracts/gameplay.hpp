@@ -4,6 +4,10 @@
 #include <eosio/asset.hpp>
 #include <eosio/system.hpp>
 #include <eosio/crypto.hpp>
+#include <eosio/singleton.hpp>
+
+#include <profile.hpp>
+#include <gameplay_core.hpp>
 
 using namespace eosio;
 
@@ -21,6 +25,7 @@ CONTRACT gameplay : public contract {
 
       /**
        * Callback to receive random number from WAX RNG Oracle.
+       * A callback matching no pending play is stale and ignored.
        * 
        * @param caller_signing_value - signing value from RNG request
        * @param caller_signing_value_hash - hash of signing value
@@ -37,6 +42,42 @@ CONTRACT gameplay : public contract {
        */
       ACTION init( const name& token_contract );
 
+      /**
+       * Preallocate pending play slots so plays never allocate RAM.
+       *
+       * @param capacity - the total number of slots wanted, existing slots are kept
+       */
+      ACTION initslots( const uint32_t& capacity );
+
+      /**
+       * Configure how stale pending plays are swept.
+       *
+       * @param timeout_sec - age after which a pending play counts as stale
+       * @param max_retries - randomness re-requests before a stale play expires, 0 expires immediately
+       */
+      ACTION setsweep( const uint32_t& timeout_sec, const uint8_t& max_retries );
+
+      /**
+       * Retry or expire stale pending plays, oldest first.
+       *
+       * Expiring a play frees its slot and erases the play's used nonce, refunding
+       * the player's RAM and letting the nonce be submitted again.
+       *
+       * @param max_rows - the maximum number of stale plays to handle
+       */
+      ACTION sweeppending( const uint32_t& max_rows );
+
+      /**
+       * Erase used nonces older than a threshold, oldest first, refunding their players' RAM.
+       *
+       * Only nonces still inside the threshold are kept, so the table follows recent
+       * players rather than everyone who ever played. An erased nonce may be played again.
+       *
+       * @param max_rows - the maximum number of nonces to examine
+       * @param idle_seconds - erase nonces older than this, at least MIN_IDLE_SECONDS
+       */
+      ACTION evictidle( const uint32_t& max_rows, const uint32_t& idle_seconds );
+
    private:
       // Table to store used nonces for replay protection
       TABLE used_nonce {
@@ -46,10 +87,37 @@ CONTRACT gameplay : public contract {
 
          uint64_t primary_key() const { return nonce; }
          uint64_t by_player() const { return player.value; }
+         uint64_t by_timestamp() const { return timestamp; }
       };
 
-      // Table to store pending RNG requests
+      // Longer than a transaction can stay valid, so an erased nonce cannot be replayed
+      static constexpr uint32_t MIN_IDLE_SECONDS = 3600;
+
+      static constexpr uint32_t MAX_SLOTS = 65536;
+      static constexpr uint64_t SLOT_MASK = MAX_SLOTS - 1; // a signing value's low bits name its slot
+      static constexpr uint64_t NO_SLOT = std::numeric_limits<uint64_t>::max();
+
+      // Fixed-size slot for a pending RNG request, preallocated and reused in place
       TABLE pending_play {
+         uint64_t slot;
+         uint32_t generation; // bumped on every reuse
+         bool in_use;
+         uint64_t next_free;  // free-list link while idle
+         name player;
+         uint64_t nonce;
+         uint32_t timestamp;
+         uint8_t retries;
+         uint64_t signing_value; // of the request in flight
+
+         uint64_t primary_key() const { return slot; }
+         // Idle slots sort after every pending play
+         uint64_t by_timestamp() const { return in_use ? timestamp : std::numeric_limits<uint64_t>::max(); }
+      };
+
+      // A pending play as stored before the slot table, keyed by its signing value.
+      // Callbacks for plays still in flight at the upgrade settle from here, and
+      // sweeppending expires the rest
+      TABLE legacy_pending_play {
          uint64_t signing_value;
          name player;
          uint64_t nonce;
@@ -59,29 +127,71 @@ CONTRACT gameplay : public contract {
          uint64_t by_player() const { return player.value; }
       };
 
+      // Free-list bookkeeping for the pending play slots
+      TABLE slot_state {
+         uint64_t capacity = 0;
+         uint64_t free_head = NO_SLOT;
+         uint64_t in_use = 0;
+      };
+
       // Contract configuration
       TABLE config {
          name token_contract;
          uint32_t success_rate_percent; // 35% success rate
          asset reward_amount;           // 1 DBP token reward
+
+         uint64_t primary_key() const { return 0; }
       };
 
       typedef eosio::multi_index<"usednonces"_n, used_nonce,
-         indexed_by<"byplayer"_n, const_mem_fun<used_nonce, uint64_t, &used_nonce::by_player>>
+         indexed_by<"byplayer"_n, const_mem_fun<used_nonce, uint64_t, &used_nonce::by_player>>,
+         indexed_by<"bytimestamp"_n, const_mem_fun<used_nonce, uint64_t, &used_nonce::by_timestamp>>
       > used_nonces_table;
 
-      typedef eosio::multi_index<"pendingplay"_n, pending_play,
-         indexed_by<"byplayer"_n, const_mem_fun<pending_play, uint64_t, &pending_play::by_player>>
+      // Nonces written before bytimestamp existed have no entry in it; evictidle
+      // sweeps them out by primary key once they are all past the threshold
+      TABLE evict_state {
+         uint32_t indexed_from = 0;  // first evictidle; every older nonce may lack an index entry
+         uint64_t legacy_cursor = 0;
+         bool legacy_done = false;
+         uint64_t evicted = 0;
+      };
+
+      // Stale pending play handling and its counters
+      TABLE sweep_state {
+         uint32_t timeout_sec = 300;
+         uint8_t max_retries = 0;
+         uint64_t retried = 0;
+         uint64_t expired = 0;
+      };
+
+      typedef eosio::multi_index<"playslots"_n, pending_play,
+         indexed_by<"bytimestamp"_n, const_mem_fun<pending_play, uint64_t, &pending_play::by_timestamp>>
       > pending_plays_table;
+      typedef eosio::multi_index<"pendingplay"_n, legacy_pending_play,
+         indexed_by<"byplayer"_n, const_mem_fun<legacy_pending_play, uint64_t, &legacy_pending_play::by_player>>
+      > legacy_pending_plays_table;
+      typedef eosio::singleton<"slotstate"_n, slot_state> slot_state_table;
+      typedef eosio::singleton<"sweepstate"_n, sweep_state> sweep_state_table;
+      typedef eosio::singleton<"evictstate"_n, evict_state> evict_state_table;
 
       typedef eosio::multi_index<"config"_n, config> config_table;
 
       // WAX RNG Oracle contract
       static constexpr name RNG_ORACLE = "orng.wax"_n;
 
-      void cleanup_old_nonces();
+      // The game core instantiated for this contract: nonces unique across players,
+      // the oracle's u64 random value, issue without checking, no per-player rows
+      typedef dbltz_core::game< dbltz_core::nonce_set<used_nonces_table>, dbltz_core::u64_rng,
+                                dbltz_core::direct_issue, dbltz_core::no_player_state > game_core;
+
+      uint64_t signing_value_for( uint64_t slot, uint32_t generation, const name& player, uint64_t nonce ) const;
+
+      void release_slot( pending_plays_table& pending_plays, pending_plays_table::const_iterator slot );
+      void refund_nonce( const name& player, uint64_t nonce );
+      void settle_legacy( const uint64_t& signing_value, const uint64_t& random_value );
+      uint32_t expire_legacy( uint32_t cutoff, uint32_t max_rows );
       void request_random( const name& player, const uint64_t& nonce );
-      void process_result( const name& player, const uint64_t& nonce, const uint64_t& random_value );
-      bool is_successful_play( const uint64_t& random_value );
-      void issue_reward( const name& player );
+      void send_rng_request( const uint64_t& signing_value );
+      dbltz_core::reward_terms win_reward();
 };
\ No newline at end of file
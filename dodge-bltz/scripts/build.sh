@@ -17,7 +17,7 @@ echo "📦 Compiling DBP Token Contract..."
 eosio-cpp -I include -o build/dbp_token.wasm dbp_token.cpp --abigen
 
 echo "🎮 Compiling Gameplay Contract..."
-eosio-cpp -I include -o build/gameplay.wasm gameplay.cpp --abigen
+eosio-cpp -I include -I ../../shared/core -o build/gameplay.wasm gameplay.cpp --abigen
 
 echo "✅ Build completed successfully!"
 echo ""
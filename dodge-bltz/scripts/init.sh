@@ -21,6 +21,9 @@ cleos push action $TOKEN_ACCOUNT create '["'$TOKEN_ACCOUNT'", "1000000.0000 DBP"
 echo "🎮 Initializing Gameplay Contract..."
 cleos push action $GAMEPLAY_ACCOUNT init '["'$TOKEN_ACCOUNT'"]' -p $GAMEPLAY_ACCOUNT@active
 
+echo "🎰 Preallocating pending play slots..."
+cleos push action $GAMEPLAY_ACCOUNT initslots '[256]' -p $GAMEPLAY_ACCOUNT@active
+
 echo "🔐 Setting token permissions..."
 # Allow gameplay contract to issue tokens
 cleos set account permission $TOKEN_ACCOUNT active '{"threshold":1,"keys":[{"key":"YOUR_ACTIVE_KEY","weight":1}],"accounts":[{"permission":{"actor":"'$GAMEPLAY_ACCOUNT'","permission":"eosio.code"},"weight":1}]}' owner -p $TOKEN_ACCOUNT@owner
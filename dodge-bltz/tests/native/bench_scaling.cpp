@@ -0,0 +1,142 @@
+#include <scaling.hpp>
+#include <target.hpp>
+
+#include <eosio/asset.hpp>
+
+using namespace eosio;
+
+namespace {
+
+   const symbol DBP = symbol( "DBP", 4 );
+
+   const name GAMEPLAY = "gameplay.acc"_n;
+   const name TOKEN = "dbptoken"_n;
+   const name ALICE = "alice"_n;
+   const name BOB = "bob"_n;
+
+   // The contract's slot limit
+   constexpr int64_t max_slots = 65536;
+
+   // A losing roll, so callbacks issue no reward
+   constexpr uint64_t LOSE = 99;
+
+   // Full layouts of the rows filled directly
+
+   struct used_nonce_row {
+      uint64_t nonce;
+      name player;
+      uint32_t timestamp;
+   };
+
+   struct account_row {
+      asset balance;
+   };
+
+   struct holder_row {
+      name owner;
+      asset balance;
+   };
+
+   struct holder_stats_row {
+      uint64_t holder_count;
+   };
+
+   std::unique_ptr<replay::target> deployment = replay::make_target();
+
+   native::tester& deployed( native::tester& chain ) {
+      deployment->setup( chain, { ALICE, BOB } );
+      return chain;
+   }
+
+   void push( native::tester& chain, const action& act ) { chain.push_transaction({ act }); }
+
+   /// Answer the outstanding play, untimed, so slots never run out
+   void settle( benchmark::State& state, native::tester& chain ) {
+      state.PauseTiming();
+      for( auto request : deployment->take_requests( chain ) ) push( chain, deployment->callback( request, LOSE ) );
+      state.ResumeTiming();
+   }
+
+   // A play, with the nonce check and the per-play nonce cleanup; every nonce is under 24 hours old,
+   // as in a table that holds a day of traffic
+   void play_usednonces( benchmark::State& state, int64_t rows ) {
+      auto& chain = scaling::chain_for( "play/usednonces", rows, [&]( native::tester& c ) {
+         deployed( c );
+         uint32_t now = c.now().sec_since_epoch();
+         for( int64_t i = 0; i < rows; i++ ) {
+            name player( scaling::spread( i ) );
+            scaling::put_row( GAMEPLAY, GAMEPLAY.value, "usednonces"_n, uint64_t( i + 1 ),
+                              used_nonce_row{ uint64_t( i + 1 ), player, now }, player, { player.value, now } );
+         }
+      });
+
+      static uint64_t nonce = uint64_t( 1 ) << 40;
+      for( auto _ : state ) {
+         push( chain, deployment->play( ALICE, ++nonce ) );
+         settle( state, chain );
+      }
+   }
+
+   // A callback: one slot lookup, the settlement and the free-list update
+   void receiverand_playslots( benchmark::State& state, int64_t rows ) {
+      auto& chain = scaling::chain_for( "receiverand/playslots", rows, [&]( native::tester& c ) {
+         deployed( c ).push_action( GAMEPLAY, "initslots"_n, GAMEPLAY, uint32_t( rows ) );
+      });
+
+      static uint64_t nonce = uint64_t( 1 ) << 40;
+      for( auto _ : state ) {
+         state.PauseTiming();
+         push( chain, deployment->play( ALICE, ++nonce ) );
+         auto requests = deployment->take_requests( chain );
+         // Keep usednonces at its starting size; this case is about the slots
+         native::state().db.remove( { GAMEPLAY.value, GAMEPLAY.value, "usednonces"_n.value }, nonce );
+         state.ResumeTiming();
+         push( chain, deployment->callback( requests.front(), LOSE ) );
+      }
+   }
+
+   // A sweep with nothing stale: the bytimestamp walk stops at its first row
+   void sweeppending_playslots( benchmark::State& state, int64_t rows ) {
+      auto& chain = scaling::chain_for( "sweeppending/playslots", rows, [&]( native::tester& c ) {
+         deployed( c ).push_action( GAMEPLAY, "initslots"_n, GAMEPLAY, uint32_t( rows ) );
+      });
+
+      for( auto _ : state ) {
+         push( chain, deployment->maintain() );
+      }
+   }
+
+   // A transfer between existing holders among `rows` token accounts and holders
+   void transfer_accounts( benchmark::State& state, int64_t rows ) {
+      auto& chain = scaling::chain_for( "transfer/accounts", rows, [&]( native::tester& c ) {
+         deployed( c );
+         uint64_t scope = DBP.code().raw();
+         for( int64_t i = 0; i < rows; i++ ) {
+            name owner( scaling::spread( i ) );
+            asset balance( 1, DBP );
+            scaling::put_row( TOKEN, owner.value, "accounts"_n, scope, account_row{ balance }, owner );
+            scaling::put_row( TOKEN, scope, "holders"_n, owner.value, holder_row{ owner, balance }, owner,
+                              { std::numeric_limits<uint64_t>::max() - uint64_t( balance.amount ) } );
+         }
+         auto holders = c.get_singleton<holder_stats_row>( TOKEN, scope, "holderstats"_n );
+         scaling::put_row( TOKEN, scope, "holderstats"_n, "holderstats"_n.value,
+                           holder_stats_row{ holders->holder_count + uint64_t( rows ) }, TOKEN );
+      });
+
+      bool forward = true;
+      for( auto _ : state ) {
+         push( chain, forward ? deployment->transfer( ALICE, BOB, 1 ) : deployment->transfer( BOB, ALICE, 1 ) );
+         forward = !forward;
+      }
+   }
+
+} // namespace
+
+int main( int argc, char** argv ) {
+   return scaling::run( argc, argv, {
+      { "play/usednonces", INT64_MAX, play_usednonces },
+      { "receiverand/playslots", max_slots, receiverand_playslots },
+      { "sweeppending/playslots", max_slots, sweeppending_playslots },
+      { "transfer/accounts", INT64_MAX, transfer_accounts },
+   });
+}
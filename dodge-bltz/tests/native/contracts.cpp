@@ -0,0 +1,14 @@
+#include "contracts.hpp"
+
+#include <dbp_token.hpp>
+#include <gameplay.hpp>
+
+#include <native/chain.hpp>
+
+namespace contracts {
+
+   NATIVE_APPLY( gameplay_apply, gameplay, (play)(receiverand)(init)(initslots)(setsweep)(sweeppending)(evictidle) )
+
+   NATIVE_APPLY( dbp_token_apply, dbp_token, (create)(issue)(transfer)(syncholders)(getbalances)(getsupply) )
+
+} // namespace contracts
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Entry points of the contracts built natively, the counterpart of the
+ * contracts::*_wasm() accessors the eosio tester uses
+ */
+namespace contracts {
+
+   void gameplay_apply( uint64_t receiver, uint64_t code, uint64_t action );
+
+   void dbp_token_apply( uint64_t receiver, uint64_t code, uint64_t action );
+
+} // namespace contracts
@@ -0,0 +1,354 @@
+#include <boost/test/unit_test.hpp>
+
+#include "contracts.hpp"
+
+#include <native/chain.hpp>
+#include <native/profile.hpp>
+
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+
+#include <tuple>
+#include <vector>
+
+using namespace eosio;
+
+namespace {
+
+   const symbol DBP = symbol( "DBP", 4 );
+
+   // Leading fields of the gameplay and token rows
+
+   struct used_nonce_row {
+      uint64_t nonce;
+      name player;
+      uint32_t timestamp;
+   };
+
+   struct pending_play_row {
+      uint64_t slot;
+      uint32_t generation;
+      bool in_use;
+      uint64_t next_free;
+      name player;
+      uint64_t nonce;
+      uint32_t timestamp;
+      uint8_t retries;
+      uint64_t signing_value;
+   };
+
+   // A pendingplay row as the contract stored it before the slot table
+   struct legacy_pending_play_row {
+      uint64_t signing_value;
+      name player;
+      uint64_t nonce;
+      uint32_t timestamp;
+   };
+
+   struct sweep_state_row {
+      uint32_t timeout_sec;
+      uint8_t max_retries;
+      uint64_t retried;
+      uint64_t expired;
+   };
+
+   struct evict_state_row {
+      uint32_t indexed_from;
+      uint64_t legacy_cursor;
+      bool legacy_done;
+      uint64_t evicted;
+   };
+
+   struct account_row {
+      asset balance;
+   };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(gameplay_native_tests)
+
+class gameplay_tester : public native::tester {
+public:
+   gameplay_tester() {
+      // orng.wax has no code: its requestrand actions land in the mailbox
+      create_accounts({ "gameplay.acc"_n, "dbptoken"_n, "orng.wax"_n, "alice"_n, "bob"_n });
+      set_code( "gameplay.acc"_n, contracts::gameplay_apply );
+      set_code( "dbptoken"_n, contracts::dbp_token_apply );
+
+      push_action( "dbptoken"_n, "create"_n, "dbptoken"_n, "dbptoken"_n, asset( 10000000000, DBP ) );
+      push_action( "gameplay.acc"_n, "init"_n, "gameplay.acc"_n, "dbptoken"_n );
+      push_action( "gameplay.acc"_n, "initslots"_n, "gameplay.acc"_n, uint32_t( 32 ) );
+   }
+
+   void play_bltz( name player, uint64_t nonce ) {
+      push_action( "gameplay.acc"_n, "play"_n, player, player, nonce );
+   }
+
+   /// Signing value of the oldest randomness request not answered yet
+   uint64_t take_rng_request() {
+      auto request = pop_mailbox( "orng.wax"_n );
+      BOOST_REQUIRE_EQUAL( request.name, "requestrand"_n );
+      auto [assoc_id, signing_value, caller] = request.data_as<std::tuple<uint64_t, uint64_t, name>>();
+      BOOST_REQUIRE_EQUAL( caller, "gameplay.acc"_n );
+      return signing_value;
+   }
+
+   void receive_rand( uint64_t signing_value, uint64_t random_value ) {
+      push_action( "gameplay.acc"_n, "receiverand"_n, "orng.wax"_n, signing_value, checksum256(), random_value );
+   }
+
+   bool nonce_exists( uint64_t nonce ) {
+      return get_row<used_nonce_row>( "gameplay.acc"_n, "gameplay.acc"_n.value, "usednonces"_n, nonce ).has_value();
+   }
+
+   pending_play_row get_slot( uint64_t signing_value ) {
+      return *get_row<pending_play_row>( "gameplay.acc"_n, "gameplay.acc"_n.value, "playslots"_n, signing_value & 0xFFFF );
+   }
+
+   asset get_token_balance( name account ) {
+      auto row = get_row<account_row>( "dbptoken"_n, account.value, "accounts"_n, DBP.code().raw() );
+      return row ? row->balance : asset( 0, DBP );
+   }
+
+   /// Every row of every table with its payer, to check an action changed nothing
+   std::vector<std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, native::bytes, uint64_t>> all_rows() {
+      std::vector<std::tuple<uint64_t, uint64_t, uint64_t, uint64_t, native::bytes, uint64_t>> rows;
+      for( const auto& [id, t] : native::state().db.all_tables() ) {
+         for( const auto& [primary, r] : t.rows ) {
+            rows.emplace_back( id.code, id.scope, id.table, primary, r.data, r.payer );
+         }
+      }
+      return rows;
+   }
+
+   /// Deliver a callback that matches no pending play: it succeeds and changes nothing
+   void receive_stale_rand( uint64_t signing_value, uint64_t random_value ) {
+      auto before = all_rows();
+      size_t requests = mailbox( "orng.wax"_n ).size();
+      receive_rand( signing_value, random_value );
+      BOOST_REQUIRE( all_rows() == before );
+      BOOST_REQUIRE_EQUAL( mailbox( "orng.wax"_n ).size(), requests );
+   }
+};
+
+BOOST_FIXTURE_TEST_CASE(play_and_reward_test, gameplay_tester) {
+   play_bltz( "alice"_n, 1 );
+   BOOST_REQUIRE( nonce_exists( 1 ) );
+
+   uint64_t signing_value = take_rng_request();
+   BOOST_REQUIRE( get_slot( signing_value ).in_use );
+   BOOST_REQUIRE_EQUAL( get_slot( signing_value ).player, "alice"_n );
+
+   // 100 % 100 = 0 wins: the reward is issued inline by gameplay.acc
+   receive_rand( signing_value, 100 );
+   BOOST_REQUIRE_EQUAL( get_token_balance( "alice"_n ), asset( 10000, DBP ) );
+   BOOST_REQUIRE( !get_slot( signing_value ).in_use );
+
+   // A second callback for the same request is ignored, so the oracle stops retrying it
+   receive_stale_rand( signing_value, 100 );
+
+   // 99 loses
+   play_bltz( "alice"_n, 2 );
+   receive_rand( take_rng_request(), 99 );
+   BOOST_REQUIRE_EQUAL( get_token_balance( "alice"_n ), asset( 10000, DBP ) );
+}
+
+BOOST_FIXTURE_TEST_CASE(signing_value_test, gameplay_tester) {
+   play_bltz( "alice"_n, 1 );
+   uint64_t first = take_rng_request();
+   receive_rand( first, 99 );
+
+   // The same slot's next request carries a new value, stored in the slot for the callback
+   play_bltz( "alice"_n, 2 );
+   uint64_t second = take_rng_request();
+   BOOST_REQUIRE_EQUAL( first & 0xFFFF, second & 0xFFFF );
+   BOOST_REQUIRE_NE( first, second );
+   BOOST_REQUIRE_EQUAL( get_slot( second ).signing_value, second );
+
+   // Neither is the old generation-and-slot packing, which repeats once slots start over
+   auto slot = get_slot( second );
+   BOOST_REQUIRE_NE( second, (uint64_t( slot.generation ) << 32) | slot.slot );
+   BOOST_REQUIRE_NE( first >> 16, 0u );
+
+   // A value naming the right slot but not matching it settles nothing
+   receive_stale_rand( second ^ 0x10000, 0 );
+   receive_rand( second, 99 );
+   BOOST_REQUIRE( !get_slot( second ).in_use );
+}
+
+BOOST_FIXTURE_TEST_CASE(legacy_pending_play_test, gameplay_tester) {
+   // Two plays still in flight when the slot table replaced pendingplay
+   auto put_legacy = [&]( uint64_t signing_value, name player, uint64_t nonce ) {
+      native::state().db.store( { "gameplay.acc"_n.value, "gameplay.acc"_n.value, "usednonces"_n.value }, nonce,
+                                { pack( used_nonce_row{ nonce, player, now().sec_since_epoch() } ),
+                                  player.value, { player.value } } );
+      native::state().db.store( { "gameplay.acc"_n.value, "gameplay.acc"_n.value, "pendingplay"_n.value }, signing_value,
+                                { pack( legacy_pending_play_row{ signing_value, player, nonce, now().sec_since_epoch() } ),
+                                  player.value, { player.value } } );
+   };
+   put_legacy( 1700000000000005, "alice"_n, 5 );
+   put_legacy( 1700000000000006, "bob"_n, 6 );
+
+   // The oracle's answer for one settles it from the old table
+   receive_rand( 1700000000000005, 100 );
+   BOOST_REQUIRE_EQUAL( get_token_balance( "alice"_n ), asset( 10000, DBP ) );
+   BOOST_REQUIRE( !get_row<legacy_pending_play_row>( "gameplay.acc"_n, "gameplay.acc"_n.value, "pendingplay"_n,
+                                                     1700000000000005 ).has_value() );
+
+   // The other is never answered: the sweep expires it and refunds bob's nonce
+   advance_time( seconds( 301 ) );
+   push_action( "gameplay.acc"_n, "sweeppending"_n, "gameplay.acc"_n, uint32_t( 10 ) );
+   BOOST_REQUIRE_EQUAL( row_count( "gameplay.acc"_n, "gameplay.acc"_n.value, "pendingplay"_n ), 0u );
+   BOOST_REQUIRE( !nonce_exists( 6 ) );
+   BOOST_REQUIRE_EQUAL( ram_usage( "bob"_n ), 0 );
+   auto sweep = *get_singleton<sweep_state_row>( "gameplay.acc"_n, "gameplay.acc"_n.value, "sweepstate"_n );
+   BOOST_REQUIRE_EQUAL( sweep.expired, 1u );
+}
+
+BOOST_FIXTURE_TEST_CASE(nonce_replay_protection_test, gameplay_tester) {
+   play_bltz( "alice"_n, 7 );
+   BOOST_CHECK_EXCEPTION( play_bltz( "alice"_n, 7 ), native::assert_error,
+                          native::message_contains{ "nonce already used" } );
+   BOOST_CHECK_EXCEPTION( play_bltz( "bob"_n, 7 ), native::assert_error,
+                          native::message_contains{ "nonce already used" } );
+
+   // The failed plays sent nothing to the oracle
+   BOOST_REQUIRE_EQUAL( mailbox( "orng.wax"_n ).size(), 1u );
+}
+
+BOOST_FIXTURE_TEST_CASE(unauthorized_rng_callback_test, gameplay_tester) {
+   play_bltz( "alice"_n, 1 );
+   uint64_t signing_value = take_rng_request();
+
+   BOOST_CHECK_EXCEPTION( push_action( "gameplay.acc"_n, "receiverand"_n, "alice"_n, signing_value, checksum256(), uint64_t( 0 ) ),
+                          native::auth_error, native::message_contains{ "missing authority of orng.wax" } );
+   BOOST_REQUIRE( get_slot( signing_value ).in_use );
+}
+
+BOOST_FIXTURE_TEST_CASE(sweep_pending_test, gameplay_tester) {
+   push_action( "gameplay.acc"_n, "setsweep"_n, "gameplay.acc"_n, uint32_t( 60 ), uint8_t( 1 ) );
+
+   play_bltz( "alice"_n, 1 );
+   uint64_t first = take_rng_request();
+
+   // Stale once: re-requested under a new generation, so the old callback is ignored
+   advance_time( seconds( 61 ) );
+   push_action( "gameplay.acc"_n, "sweeppending"_n, "gameplay.acc"_n, uint32_t( 10 ) );
+   uint64_t retry = take_rng_request();
+   BOOST_REQUIRE_NE( first, retry );
+   receive_stale_rand( first, 0 );
+   BOOST_REQUIRE( get_slot( retry ).in_use );
+
+   // Stale again with no retries left: expired, and alice's nonce row is refunded
+   int64_t ram_before = ram_usage( "alice"_n );
+   advance_time( seconds( 61 ) );
+   push_action( "gameplay.acc"_n, "sweeppending"_n, "gameplay.acc"_n, uint32_t( 10 ) );
+   BOOST_REQUIRE( !get_slot( retry ).in_use );
+   BOOST_REQUIRE( !nonce_exists( 1 ) );
+   BOOST_REQUIRE_LT( ram_usage( "alice"_n ), ram_before );
+
+   // The expired request's late answer is ignored too
+   receive_stale_rand( retry, 0 );
+
+   auto sweep = *get_singleton<sweep_state_row>( "gameplay.acc"_n, "gameplay.acc"_n.value, "sweepstate"_n );
+   BOOST_REQUIRE_EQUAL( sweep.retried, 1u );
+   BOOST_REQUIRE_EQUAL( sweep.expired, 1u );
+}
+
+BOOST_FIXTURE_TEST_CASE(nonce_cleanup_test, gameplay_tester) {
+   // Twelve plays, answered so their slots are free again
+   for( uint64_t nonce = 1; nonce <= 12; nonce++ ) {
+      play_bltz( "alice"_n, nonce );
+      receive_rand( take_rng_request(), 99 );
+   }
+
+   // Nonces younger than 24 hours are kept
+   advance_time( hours( 23 ) );
+   play_bltz( "bob"_n, 100 );
+   receive_rand( take_rng_request(), 99 );
+   for( uint64_t nonce = 1; nonce <= 12; nonce++ ) {
+      BOOST_REQUIRE( nonce_exists( nonce ) );
+   }
+
+   // Once older, each play erases at most ten of them, oldest first
+   advance_time( hours( 1 ) + seconds( 1 ) );
+   play_bltz( "bob"_n, 101 );
+   for( uint64_t nonce = 1; nonce <= 10; nonce++ ) {
+      BOOST_REQUIRE( !nonce_exists( nonce ) );
+   }
+   BOOST_REQUIRE( nonce_exists( 11 ) );
+   BOOST_REQUIRE( nonce_exists( 12 ) );
+   BOOST_REQUIRE( nonce_exists( 100 ) );
+   BOOST_REQUIRE( nonce_exists( 101 ) );
+
+   play_bltz( "bob"_n, 102 );
+   BOOST_REQUIRE( !nonce_exists( 11 ) );
+   BOOST_REQUIRE( !nonce_exists( 12 ) );
+
+   // A cleaned-up nonce may be played again
+   play_bltz( "alice"_n, 1 );
+   BOOST_REQUIRE( nonce_exists( 1 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE(evict_idle_test, gameplay_tester) {
+   // Nonce 5 predates the bytimestamp index: stored with its byplayer entry only
+   native::state().db.store( { "gameplay.acc"_n.value, "gameplay.acc"_n.value, "usednonces"_n.value }, 5,
+                             { pack( used_nonce_row{ 5, "bob"_n, now().sec_since_epoch() } ),
+                               "bob"_n.value, { "bob"_n.value } } );
+   for( uint64_t nonce = 1; nonce <= 3; nonce++ ) {
+      play_bltz( "alice"_n, nonce );
+      receive_rand( take_rng_request(), 99 );
+   }
+
+   BOOST_CHECK_EXCEPTION( push_action( "gameplay.acc"_n, "evictidle"_n, "gameplay.acc"_n, uint32_t( 10 ), uint32_t( 60 ) ),
+                          native::assert_error, native::message_contains{ "at least an hour" } );
+
+   // Two hours on, a two-hour threshold takes the indexed nonces, oldest first
+   advance_time( hours( 2 ) );
+   play_bltz( "alice"_n, 4 );
+   receive_rand( take_rng_request(), 99 );
+   int64_t alice_ram = ram_usage( "alice"_n );
+   push_action( "gameplay.acc"_n, "evictidle"_n, "gameplay.acc"_n, uint32_t( 2 ), uint32_t( 3600 ) );
+   BOOST_REQUIRE( !nonce_exists( 1 ) && !nonce_exists( 2 ) && nonce_exists( 3 ) );
+   BOOST_REQUIRE_LT( ram_usage( "alice"_n ), alice_ram );
+   push_action( "gameplay.acc"_n, "evictidle"_n, "gameplay.acc"_n, uint32_t( 10 ), uint32_t( 3600 ) );
+   BOOST_REQUIRE( !nonce_exists( 3 ) && nonce_exists( 4 ) );
+
+   // The unindexed nonce goes once the threshold reaches past the first call
+   BOOST_REQUIRE( nonce_exists( 5 ) );
+   advance_time( hours( 2 ) );
+   push_action( "gameplay.acc"_n, "evictidle"_n, "gameplay.acc"_n, uint32_t( 10 ), uint32_t( 3600 ) );
+   BOOST_REQUIRE( !nonce_exists( 5 ) );
+   auto state = *get_singleton<evict_state_row>( "gameplay.acc"_n, "gameplay.acc"_n.value, "evictstate"_n );
+   BOOST_REQUIRE( state.legacy_done );
+   BOOST_REQUIRE_EQUAL( state.evicted, 5u );
+
+   // An evicted nonce may be played again
+   play_bltz( "alice"_n, 1 );
+   BOOST_REQUIRE( nonce_exists( 1 ) );
+}
+
+BOOST_FIXTURE_TEST_CASE(profile_sections_test, gameplay_tester) {
+   native::profile().clear();
+   play_bltz( "alice"_n, 1 );
+   receive_rand( take_rng_request(), 100 );
+
+#ifdef DBLTZ_PROFILE
+   auto calls_of = [&]( const std::string& action, const std::string& path ) -> uint64_t {
+      for( const auto& [a, sections] : native::profile().actions() ) {
+         for( const auto& [p, c] : sections ) {
+            if( a == action && p == path ) return c.calls;
+         }
+      }
+      return 0;
+   };
+   BOOST_REQUIRE_EQUAL( calls_of( "gameplay.acc::play", "play/rng.request/request_random/requestrand.send" ), 1u );
+   BOOST_REQUIRE_EQUAL( calls_of( "gameplay.acc::receiverand", "receiverand/settle/settle_play/issue.send" ), 1u );
+   BOOST_REQUIRE_EQUAL( calls_of( "gameplay.acc::receiverand", "receiverand/slot.release" ), 1u );
+#else
+   // Without DBLTZ_PROFILE the markers compile to nothing
+   BOOST_REQUIRE( native::profile().empty() );
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+#include "contracts.hpp"
+
+#include <target.hpp>
+
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+
+#include <tuple>
+
+namespace replay {
+
+   namespace {
+
+      const eosio::symbol DBP = eosio::symbol( "DBP", 4 );
+
+      // Starting balance of every player, enough for the transfers a trace makes
+      constexpr int64_t player_funds = 10000000;
+
+      /// The dodge-bltz contracts: integer nonces, oracle callbacks keyed by signing value
+      class dodge_bltz_target : public target {
+      public:
+         std::string name() const override { return "dodge-bltz " REPLAY_CONTRACTS_DIR; }
+
+         void setup( native::tester& chain, const std::vector<eosio::name>& players ) override {
+            // orng.wax has no code: its requestrand actions land in the mailbox
+            chain.create_accounts({ gameplay, token, oracle });
+            chain.set_code( gameplay, contracts::gameplay_apply );
+            chain.set_code( token, contracts::dbp_token_apply );
+
+            chain.push_action( token, "create"_n, token, token, eosio::asset( 10000000000000, DBP ) );
+            chain.push_action( gameplay, "init"_n, gameplay, token );
+            chain.push_action( gameplay, "initslots"_n, gameplay, uint32_t( 256 ) );
+
+            for( auto player : players ) {
+               chain.create_account( player );
+               chain.push_action( token, "issue"_n, token, player, eosio::asset( player_funds, DBP ), std::string( "replay" ) );
+            }
+         }
+
+         eosio::action play( eosio::name player, uint64_t nonce ) const override {
+            return eosio::action( { player, "active"_n }, gameplay, "play"_n, std::make_tuple( player, nonce ) );
+         }
+
+         eosio::action callback( uint64_t request, uint64_t random_value ) const override {
+            return eosio::action( { oracle, "active"_n }, gameplay, "receiverand"_n,
+                                  std::make_tuple( request, eosio::checksum256(), random_value ) );
+         }
+
+         eosio::action transfer( eosio::name from, eosio::name to, uint64_t amount ) const override {
+            return eosio::action( { from, "active"_n }, token, "transfer"_n,
+                                  std::make_tuple( from, to, eosio::asset( int64_t( amount ), DBP ), std::string() ) );
+         }
+
+         eosio::action maintain() const override {
+            return eosio::action( { gameplay, "active"_n }, gameplay, "sweeppending"_n, std::make_tuple( uint32_t( 50 ) ) );
+         }
+
+         std::vector<uint64_t> take_requests( native::tester& chain ) override {
+            std::vector<uint64_t> requests;
+            for( const auto& request : chain.mailbox( oracle ) ) {
+               auto [assoc_id, signing_value, caller] = request.data_as<std::tuple<uint64_t, uint64_t, eosio::name>>();
+               requests.push_back( signing_value );
+            }
+            chain.clear_mailbox( oracle );
+            return requests;
+         }
+
+      private:
+         const eosio::name gameplay = "gameplay.acc"_n;
+         const eosio::name token = "dbptoken"_n;
+         const eosio::name oracle = "orng.wax"_n;
+      };
+
+   } // namespace
+
+   std::unique_ptr<target> make_target() { return std::make_unique<dodge_bltz_target>(); }
+
+} // namespace replay
@@ -0,0 +1,125 @@
+#include <boost/test/unit_test.hpp>
+
+#include "contracts.hpp"
+
+#include <native/chain.hpp>
+
+#include <eosio/asset.hpp>
+
+using namespace eosio;
+using std::string;
+
+namespace {
+
+   const symbol DBP = symbol( "DBP", 4 );
+
+   struct account_row {
+      asset balance;
+   };
+
+   struct holder_stats_row {
+      uint64_t holder_count;
+   };
+
+   struct holder_row {
+      name owner;
+      asset balance;
+   };
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(dbp_token_native_tests)
+
+class dbp_token_tester : public native::tester {
+public:
+   dbp_token_tester() {
+      create_accounts({ "dbptoken"_n, "gameplay.acc"_n, "alice"_n, "bob"_n });
+      set_code( "dbptoken"_n, contracts::dbp_token_apply );
+
+      push_action( "dbptoken"_n, "create"_n, "dbptoken"_n, "dbptoken"_n, asset( 10000000000, DBP ) );
+   }
+
+   void issue_tokens( name actor, name to, asset quantity, string memo ) {
+      push_action( "dbptoken"_n, "issue"_n, actor, to, quantity, memo );
+   }
+
+   void transfer_tokens( name from, name to, asset quantity, string memo ) {
+      push_action( "dbptoken"_n, "transfer"_n, from, from, to, quantity, memo );
+   }
+
+   asset get_balance( name account ) {
+      auto row = get_row<account_row>( "dbptoken"_n, account.value, "accounts"_n, DBP.code().raw() );
+      return row ? row->balance : asset( 0, DBP );
+   }
+
+   uint64_t get_holder_count() {
+      auto row = get_singleton<holder_stats_row>( "dbptoken"_n, DBP.code().raw(), "holderstats"_n );
+      return row ? row->holder_count : 0;
+   }
+};
+
+BOOST_FIXTURE_TEST_CASE(issue_and_transfer_test, dbp_token_tester) {
+   issue_tokens( "dbptoken"_n, "alice"_n, asset( 1000000, DBP ), "initial" );
+   BOOST_REQUIRE_EQUAL( get_balance( "alice"_n ), asset( 1000000, DBP ) );
+
+   transfer_tokens( "alice"_n, "bob"_n, asset( 400000, DBP ), "" );
+   BOOST_REQUIRE_EQUAL( get_balance( "alice"_n ), asset( 600000, DBP ) );
+   BOOST_REQUIRE_EQUAL( get_balance( "bob"_n ), asset( 400000, DBP ) );
+
+   BOOST_REQUIRE_EQUAL( get_holder_count(), 2u );
+
+   BOOST_CHECK_EXCEPTION( transfer_tokens( "alice"_n, "bob"_n, asset( 600001, DBP ), "" ), native::assert_error,
+                          native::message_contains{ "overdrawn balance" } );
+
+   // Emptying a balance removes the holder
+   transfer_tokens( "bob"_n, "alice"_n, asset( 400000, DBP ), "" );
+   BOOST_REQUIRE_EQUAL( get_holder_count(), 1u );
+}
+
+BOOST_FIXTURE_TEST_CASE(restricted_minting_test, dbp_token_tester) {
+   BOOST_CHECK_EXCEPTION( issue_tokens( "alice"_n, "alice"_n, asset( 10000, DBP ), "" ), native::assert_error,
+                          native::message_contains{ "missing required authority" } );
+
+   // The gameplay account may mint rewards
+   issue_tokens( "gameplay.acc"_n, "alice"_n, asset( 10000, DBP ), "BLTZ reward" );
+   BOOST_REQUIRE_EQUAL( get_balance( "alice"_n ), asset( 10000, DBP ) );
+}
+
+BOOST_FIXTURE_TEST_CASE(sync_holders_test, dbp_token_tester) {
+   // Balances written before the holder registry existed
+   for( auto [owner, amount] : { std::pair{ "alice"_n, 5000 }, std::pair{ "bob"_n, 7000 } } ) {
+      native::state().db.store( { "dbptoken"_n.value, owner.value, "accounts"_n.value }, DBP.code().raw(),
+                                { pack( account_row{ asset( amount, DBP ) } ), owner.value, {} } );
+   }
+   BOOST_REQUIRE_EQUAL( get_holder_count(), 0u );
+
+   BOOST_CHECK_EXCEPTION( push_action( "dbptoken"_n, "syncholders"_n, "alice"_n, std::vector<name>{ "alice"_n }, DBP.code() ),
+                          native::auth_error, native::message_contains{ "missing authority of dbptoken" } );
+
+   // Owners without a balance are skipped, and syncing twice counts nobody twice
+   std::vector<name> owners{ "alice"_n, "bob"_n, "gameplay.acc"_n };
+   push_action( "dbptoken"_n, "syncholders"_n, "dbptoken"_n, owners, DBP.code() );
+   push_action( "dbptoken"_n, "syncholders"_n, "dbptoken"_n, owners, DBP.code() );
+   BOOST_REQUIRE_EQUAL( get_holder_count(), 2u );
+   auto bob = get_row<holder_row>( "dbptoken"_n, DBP.code().raw(), "holders"_n, "bob"_n.value );
+   BOOST_REQUIRE( bob.has_value() );
+   BOOST_REQUIRE_EQUAL( bob->balance, asset( 7000, DBP ) );
+
+   // From here on transfers keep the registry in step
+   transfer_tokens( "alice"_n, "bob"_n, asset( 5000, DBP ), "" );
+   BOOST_REQUIRE_EQUAL( get_holder_count(), 1u );
+}
+
+BOOST_FIXTURE_TEST_CASE(read_only_queries_test, dbp_token_tester) {
+   issue_tokens( "dbptoken"_n, "alice"_n, asset( 5000, DBP ), "" );
+
+   auto balances = call<std::vector<asset>>( "dbptoken"_n, "getbalances"_n,
+                                             std::vector<name>{ "alice"_n, "bob"_n }, DBP.code() );
+   BOOST_REQUIRE_EQUAL( balances.size(), 2u );
+   BOOST_REQUIRE_EQUAL( balances[0], asset( 5000, DBP ) );
+   BOOST_REQUIRE_EQUAL( balances[1], asset( 0, DBP ) );
+
+   BOOST_REQUIRE_EQUAL( call<asset>( "dbptoken"_n, "getsupply"_n, DBP.code() ), asset( 5000, DBP ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
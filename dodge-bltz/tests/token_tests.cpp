@@ -56,6 +56,15 @@ public:
       return token_abi_ser.binary_to_variant("currency_stats", data, abi_serializer_max_time)["supply"].as<asset>();
    }
 
+   uint64_t get_holder_count(symbol sym) {
+      vector<char> data = get_row_by_account(N(dbptoken), sym.code().raw(), N(holderstats), N(holderstats));
+      return data.empty() ? 0 : token_abi_ser.binary_to_variant("holder_stats", data, abi_serializer_max_time)["holder_count"].as<uint64_t>();
+   }
+   
+   bool is_holder(name account, symbol sym) {
+      return !get_row_by_account(N(dbptoken), sym.code().raw(), N(holders), account).empty();
+   }
+
 private:
    abi_serializer token_abi_ser;
 };
@@ -130,4 +139,23 @@ BOOST_FIXTURE_TEST_CASE(max_supply_test, dbp_token_tester) try {
    
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE(holder_registry_test, dbp_token_tester) try {
+   create_token(N(dbptoken), asset::from_string("1000000.0000 DBP"));
+   issue_tokens(N(alice), asset::from_string("100.0000 DBP"), "initial");
+   
+   // The issuer's transient balance is dropped once it is transferred on
+   BOOST_REQUIRE_EQUAL(1u, get_holder_count(symbol(4, "DBP")));
+   BOOST_REQUIRE(is_holder(N(alice), symbol(4, "DBP")));
+   BOOST_REQUIRE(!is_holder(N(dbptoken), symbol(4, "DBP")));
+   
+   transfer_tokens(N(alice), N(bob), asset::from_string("40.0000 DBP"), "split");
+   BOOST_REQUIRE_EQUAL(2u, get_holder_count(symbol(4, "DBP")));
+   
+   // Emptying an account removes it from the registry
+   transfer_tokens(N(alice), N(bob), asset::from_string("60.0000 DBP"), "all");
+   BOOST_REQUIRE_EQUAL(1u, get_holder_count(symbol(4, "DBP")));
+   BOOST_REQUIRE(!is_holder(N(alice), symbol(4, "DBP")));
+   
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
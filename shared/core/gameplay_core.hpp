@@ -0,0 +1,354 @@
+#pragma once
+
+#include <eosio/eosio.hpp>
+#include <eosio/asset.hpp>
+#include <eosio/crypto.hpp>
+#include <eosio/system.hpp>
+
+#include "profile.hpp"
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+
+/**
+ * The game both gameplay contracts play: accept a play under a nonce, ask an
+ * oracle for randomness, then settle the roll and pay a reward on a win. How
+ * each step is done is a policy fixed at compile time,
+ *
+ *     dbltz_core::game<NoncePolicy, RngPolicy, RewardPolicy, StoragePolicy>
+ *
+ * so each contract is one instantiation and pays no virtual call or runtime
+ * branch for the strategies it does not use. Tables stay with the contracts;
+ * a policy that needs one takes its type as a parameter, so nothing here
+ * ends up in an ABI.
+ */
+
+namespace dbltz_core {
+
+    inline constexpr uint32_t WIN_CHANCE = 35; // rolls below this win
+
+    // Outcome of settling a roll; anything but SETTLED is why it could not be
+    enum settle_status : uint8_t {
+        SETTLED           = 0,
+        PLAYER_MISSING    = 1, // no stored state for the roll's owner
+        TOKEN_UNSET       = 2, // no token contract to issue from
+        TOKEN_UNAVAILABLE = 3, // token account or its stat row is missing
+        SUPPLY_EXHAUSTED  = 4, // issuing the reward would exceed max supply
+        ISSUER_MISMATCH   = 5  // the token's issuer is not the account the reward is issued under
+    };
+
+    struct settle_result {
+        uint8_t  status;
+        uint32_t roll;
+        bool     won;
+    };
+
+    /// What a win pays and how the issue is authorized
+    struct reward_terms {
+        eosio::name             token_contract;
+        eosio::permission_level authority;
+        eosio::asset            quantity;
+        std::string             memo;
+    };
+
+    // Nonce policies ----------------------------------------------------------
+    //
+    // check(self, player, state, nonce, rolls) rejects a replayed nonce and
+    // record(self, player, state, nonce, rolls) marks it used, where state is
+    // the player's row as the storage policy keeps it.
+
+    /**
+     * Nonces unique across all players, one row each in `Table`: primary key
+     * the nonce, player and timestamp columns and a "bytimestamp" index. Each
+     * play also erases up to `Cleanup` nonces older than `KeepSeconds`.
+     */
+    template <typename Table, uint32_t KeepSeconds = 24 * 3600, uint32_t Cleanup = 10>
+    struct nonce_set {
+        template <typename State>
+        static void check(eosio::name self, const eosio::name&, const State&, uint64_t nonce, uint32_t) {
+            Table nonces(self, self.value);
+            eosio::check(nonces.find(nonce) == nonces.end(), "nonce already used");
+        }
+
+        template <typename State>
+        static void record(eosio::name self, const eosio::name& player, State&, uint64_t nonce, uint32_t) {
+            uint32_t now = eosio::current_time_point().sec_since_epoch();
+            Table nonces(self, self.value);
+            nonces.emplace(player, [&](auto& n) {
+                n.nonce = nonce;
+                n.player = player;
+                n.timestamp = now;
+            });
+
+            // Oldest first, so the walk stops at the first nonce that is kept
+            auto idx = nonces.template get_index<"bytimestamp"_n>();
+            auto itr = idx.begin();
+            for (uint32_t count = 0; itr != idx.end() && count < Cleanup && itr->timestamp < now - KeepSeconds; count++) {
+                itr = idx.erase(itr);
+            }
+        }
+    };
+
+    /// A per-player string nonce, which only has to differ from the last one
+    struct distinct_nonce {
+        template <typename State>
+        static void check(eosio::name, const eosio::name&, const State& state, const std::string& nonce, uint32_t) {
+            eosio::check(state.last_nonce != nonce, "nonce already used");
+        }
+
+        template <typename State>
+        static void record(eosio::name, const eosio::name&, State& state, const std::string& nonce, uint32_t) {
+            state.last_nonce = nonce;
+        }
+    };
+
+    /// Per-player integer nonces that only move forward; a batch uses nonce .. nonce + rolls - 1
+    struct increasing_nonce {
+        template <typename State>
+        static void check(eosio::name, const eosio::name&, const State& state, uint64_t nonce, uint32_t) {
+            eosio::check(nonce > state.last_compact_nonce(), "nonce already used");
+        }
+
+        template <typename State>
+        static void record(eosio::name, const eosio::name&, State& state, uint64_t nonce, uint32_t rolls) {
+            state.set_last_compact_nonce(nonce + rolls - 1);
+        }
+    };
+
+    // RNG policies ------------------------------------------------------------
+    //
+    // random_type is what the oracle calls back with, roll_of(random) maps it
+    // to [0, 100), and request(self, oracle, request_id, signing_value) asks.
+
+    /// The WAX RNG oracle's requestrand(assoc_id, signing_value, caller)
+    struct wax_request {
+        static void request(eosio::name self, eosio::name oracle, uint64_t request_id, uint64_t signing_value) {
+            eosio::action(
+                eosio::permission_level{self, "active"_n},
+                oracle,
+                "requestrand"_n,
+                std::make_tuple(request_id, signing_value, self)
+            ).send();
+        }
+    };
+
+    /// A checksum256 random value, rolled from its first four bytes, big endian
+    struct checksum_rng : wax_request {
+        using random_type = eosio::checksum256;
+
+        static uint32_t roll_of(const random_type& random_value) {
+            auto bytes = random_value.extract_as_byte_array();
+            uint32_t random_num = (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) |
+                                  (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+            return random_num % 100;
+        }
+    };
+
+    /// The oracle's random value as one u64, rolled by plain modulo
+    struct u64_rng : wax_request {
+        using random_type = uint64_t;
+
+        static uint32_t roll_of(random_type random_value) { return uint32_t(random_value % 100); }
+    };
+
+    // Reward policies ---------------------------------------------------------
+    //
+    // check(terms) returns SETTLED when the reward can be paid,
+    // record(state, terms) notes it in the winner's stored state, and
+    // pay(player, terms) sends it.
+
+    /// Issue without looking first; an issue that fails reverts the settling action
+    struct direct_issue {
+        static uint8_t check(const reward_terms&) { return SETTLED; }
+
+        template <typename State>
+        static void record(State&, const reward_terms&) {}
+
+        static void pay(const eosio::name& player, const reward_terms& terms) {
+            eosio::action(
+                terms.authority,
+                terms.token_contract,
+                "issue"_n,
+                std::make_tuple(player, terms.quantity, terms.memo)
+            ).send();
+        }
+    };
+
+    /// Check the token would accept the issue, so a roll that cannot be paid is reported, not reverted
+    struct checked_issue : direct_issue {
+        // Read-only view of the token contract's stat rows
+        struct currency_stats {
+            eosio::asset supply;
+            eosio::asset max_supply;
+            eosio::name  issuer;
+
+            uint64_t primary_key() const { return supply.symbol.code().raw(); }
+        };
+
+        typedef eosio::multi_index<"stat"_n, currency_stats> stats_table;
+
+        static uint8_t check(const reward_terms& terms) {
+            if (terms.token_contract == eosio::name()) return TOKEN_UNSET;
+            if (!eosio::is_account(terms.token_contract)) return TOKEN_UNAVAILABLE;
+
+            const auto& reward = terms.quantity;
+            stats_table stats(terms.token_contract, reward.symbol.code().raw());
+            auto st = stats.find(reward.symbol.code().raw());
+            if (st == stats.end() || st->supply.symbol != reward.symbol) return TOKEN_UNAVAILABLE;
+            if (st->issuer != terms.authority.actor) return ISSUER_MISMATCH;
+            if (st->max_supply.amount - st->supply.amount < reward.amount) return SUPPLY_EXHAUSTED;
+            return SETTLED;
+        }
+    };
+
+    /**
+     * Pull payment: a win is credited to the player's stored state, which
+     * needs credit(amount), and paid when the player claims it. Nothing is
+     * sent while settling, so a winner whose account rejects the token's
+     * transfer notification fails only their own claim
+     */
+    struct credited_issue : checked_issue {
+        template <typename State>
+        static void record(State& state, const reward_terms& terms) { state.credit(terms.quantity.amount); }
+
+        static void pay(const eosio::name&, const reward_terms&) {}
+    };
+
+    // Storage policies --------------------------------------------------------
+    //
+    // play(player, rolls, check, record) loads the player's state, passes it
+    // to check, then writes it once with record applied; has_player(player)
+    // and win(player, record) serve settlement.
+
+    /// No per-player state: every roll belongs to whoever played it
+    struct no_player_state {
+        struct state {};
+
+        template <typename Check, typename Record>
+        void play(const eosio::name&, uint32_t, Check&& check, Record&& record) {
+            state s;
+            check(s);
+            record(s);
+        }
+
+        bool has_player(const eosio::name&) const { return true; }
+
+        template <typename Record>
+        void win(const eosio::name&, Record&& record) {
+            state s;
+            record(s);
+        }
+    };
+
+    /**
+     * One row of `Table` per player in the contract's scope, created on the
+     * first play: primary key the player, with total_plays and total_wins
+     */
+    template <typename Table>
+    class player_rows {
+    public:
+        explicit player_rows(eosio::name self) : players(self, self.value) {}
+
+        template <typename Check, typename Record>
+        void play(const eosio::name& player, uint32_t rolls, Check&& check, Record&& record) {
+            auto itr = players.find(player.value);
+            if (itr == players.end()) {
+                itr = players.emplace(player, [&](auto& p) { p.player = player; });
+            }
+            check(*itr);
+            players.modify(itr, player, [&](auto& p) {
+                p.total_plays += rolls;
+                record(p);
+            });
+        }
+
+        bool has_player(const eosio::name& player) { return players.find(player.value) != players.end(); }
+
+        template <typename Record>
+        void win(const eosio::name& player, Record&& record) {
+            players.modify(players.find(player.value), eosio::same_payer, [&](auto& p) {
+                p.total_wins++;
+                record(p);
+            });
+        }
+
+    private:
+        Table players;
+    };
+
+    // The game ----------------------------------------------------------------
+
+    template <typename NoncePolicy, typename RngPolicy, typename RewardPolicy, typename StoragePolicy>
+    class game {
+    public:
+        typedef NoncePolicy   nonce_policy;
+        typedef RngPolicy     rng_policy;
+        typedef RewardPolicy  reward_policy;
+        typedef StoragePolicy storage_policy;
+        typedef typename RngPolicy::random_type random_type;
+
+        /// `storage_args` construct the storage policy in place
+        template <typename... StorageArgs>
+        explicit game(eosio::name self, StorageArgs&&... storage_args)
+            : self(self), storage(std::forward<StorageArgs>(storage_args)...) {}
+
+        /**
+         * Accept `rolls` plays from a player, rejecting a replayed nonce
+         * and recording it with the player's state in a single write
+         */
+        template <typename Nonce>
+        void accept(const eosio::name& player, const Nonce& nonce, uint32_t rolls = 1) {
+            storage.play(player, rolls,
+                [&](const auto& state) { NoncePolicy::check(self, player, state, nonce, rolls); },
+                [&](auto& state) { NoncePolicy::record(self, player, state, nonce, rolls); });
+        }
+
+        /// Ask `oracle` for one roll's randomness
+        void request(eosio::name oracle, uint64_t request_id, uint64_t signing_value) const {
+            RngPolicy::request(self, oracle, request_id, signing_value);
+        }
+
+        static uint32_t roll(const random_type& random_value) { return RngPolicy::roll_of(random_value); }
+
+        static bool wins(uint32_t roll) { return roll < WIN_CHANCE; }
+
+        /**
+         * Settle a roll: count a win, then record and pay its reward.
+         * Everything is checked before any state changes, so a roll that
+         * cannot be settled leaves no trace and can be settled again later
+         * @param terms - Returns the reward's terms; only called on a win
+         */
+        template <typename Terms>
+        settle_result settle(const eosio::name& player, const random_type& random_value, Terms&& terms) {
+            DBLTZ_PROFILE_SCOPE("settle_play");
+
+            DBLTZ_PROFILE_SECTION("roll");
+            uint32_t result = roll(random_value);
+            bool won = wins(result);
+
+            DBLTZ_PROFILE_SECTION("player.read");
+            if (!storage.has_player(player)) return {PLAYER_MISSING, result, won};
+
+            if (won) {
+                DBLTZ_PROFILE_SECTION("reward.check");
+                reward_terms reward = terms();
+                uint8_t status = RewardPolicy::check(reward);
+                if (status != SETTLED) return {status, result, won};
+
+                DBLTZ_PROFILE_SECTION("player.modify");
+                storage.win(player, [&](auto& state) { RewardPolicy::record(state, reward); });
+
+                DBLTZ_PROFILE_SECTION("issue.send");
+                RewardPolicy::pay(player, reward);
+            }
+            return {SETTLED, result, won};
+        }
+
+    private:
+        eosio::name   self;
+        StoragePolicy storage;
+    };
+
+} // namespace dbltz_core
@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * Section-level profiling, compiled in with -DDBLTZ_PROFILE and to nothing
+ * otherwise:
+ *
+ *     DBLTZ_PROFILE_SCOPE("settle");  // a section until the end of the block
+ *     DBLTZ_PROFILE_SECTION("roll");  // a subsection of it, until the next one
+ *
+ * In the native build each section is timed by the tester's collector,
+ * native/profile.hpp. In wasm every edge is a console marker, "\x1e>name"
+ * on entry and "\x1e<" on exit, so a trace shows which sections ran.
+ */
+
+#ifdef DBLTZ_PROFILE
+
+#if __has_include(<native/profile.hpp>)
+#include <native/profile.hpp>
+#define DBLTZ_PROFILE_NATIVE
+#else
+#include <eosio/print.hpp>
+#endif
+
+namespace dbltz_profile {
+
+    inline void enter(const char* section) {
+#ifdef DBLTZ_PROFILE_NATIVE
+        native::profile().enter(section);
+#else
+        eosio::print("\x1e>", section, "\n");
+#endif
+    }
+
+    inline void leave() {
+#ifdef DBLTZ_PROFILE_NATIVE
+        native::profile().leave();
+#else
+        eosio::print("\x1e<\n");
+#endif
+    }
+
+    class scope {
+    public:
+        explicit scope(const char* name) { enter(name); }
+
+        ~scope() {
+            if (in_section) leave();
+            leave();
+        }
+
+        void section(const char* name) {
+            if (in_section) leave();
+            enter(name);
+            in_section = true;
+        }
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        bool in_section = false;
+    };
+
+} // namespace dbltz_profile
+
+#define DBLTZ_PROFILE_SCOPE(name) ::dbltz_profile::scope dbltz_profile_scope(name)
+#define DBLTZ_PROFILE_SECTION(name) dbltz_profile_scope.section(name)
+
+#else
+
+#define DBLTZ_PROFILE_SCOPE(name)
+#define DBLTZ_PROFILE_SECTION(name)
+
+#endif
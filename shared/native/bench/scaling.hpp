@@ -0,0 +1,167 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <native/chain.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Table-size scaling benchmarks: time one action against tables filled to
+ * 10^3, 10^4, ... rows, fit how the cost grows, and flag actions whose cost
+ * grows faster than the log-depth lookups every table access pays.
+ */
+namespace scaling {
+
+    /**
+     * Store a row directly, bypassing the contract, to reach table sizes no
+     * sequence of actions gets to quickly. `value` must pack exactly like
+     * the contract's row, every present binary_extension included.
+     */
+    template <typename T>
+    void put_row(eosio::name code, uint64_t scope, eosio::name table, uint64_t primary, const T& value,
+                 eosio::name payer, std::vector<uint64_t> secondary = {}) {
+        native::state().db.store({code.value, scope, table.value}, primary, {eosio::pack(value), payer.value, std::move(secondary)});
+    }
+
+    /// Spread consecutive indices over the key space, as account names are
+    inline uint64_t spread(uint64_t i) { return (i + 1) * 0x9e3779b97f4a7c15ULL; }
+
+    /**
+     * The chain for one benchmark and table size. Google Benchmark calls a
+     * benchmark several times per size while it settles on an iteration
+     * count, so the chain is filled once and kept until the size changes.
+     */
+    template <typename Populate>
+    native::tester& chain_for(const std::string& name, int64_t rows, Populate&& populate) {
+        static std::unique_ptr<native::tester> chain;
+        static std::string current;
+
+        auto key = name + "/" + std::to_string(rows);
+        if (!chain || current != key) {
+            chain.reset();
+            chain = std::make_unique<native::tester>();
+            populate(*chain);
+            current = key;
+        }
+        return *chain;
+    }
+
+    struct action_case {
+        std::string name;     // action/table
+        int64_t     max_rows; // the contract's own limit on the table, if lower than --max-rows
+        std::function<void(benchmark::State&, int64_t rows)> run;
+    };
+
+    namespace detail {
+
+        struct point {
+            double rows;
+            double time; // per action, in the benchmark's time unit
+        };
+
+        /// Collects iteration results for the growth summary and prints as usual
+        class collecting_reporter : public benchmark::ConsoleReporter {
+        public:
+            void ReportRuns(const std::vector<Run>& runs) override {
+                for (const auto& run : runs) {
+                    if (run.run_type != Run::RT_Iteration || run.error_occurred) continue;
+                    points[run.run_name.function_name].push_back({double(run.complexity_n), run.GetAdjustedRealTime()});
+                }
+                ConsoleReporter::ReportRuns(runs);
+            }
+
+            std::map<std::string, std::vector<point>> points;
+        };
+
+        /// Least-squares slope of log(time) against log(rows): cost grows like rows^slope
+        inline double growth_exponent(const std::vector<point>& points) {
+            double n = double(points.size()), sx = 0, sy = 0, sxx = 0, sxy = 0;
+            for (const auto& p : points) {
+                double x = std::log(p.rows), y = std::log(p.time);
+                sx += x;
+                sy += y;
+                sxx += x * x;
+                sxy += x * y;
+            }
+            double d = n * sxx - sx * sx;
+            return d == 0 ? 0 : (n * sxy - sx * sy) / d;
+        }
+
+    } // namespace detail
+
+    // Above this exponent the cost is not explained by index depth and cache misses
+    inline constexpr double super_constant_exponent = 0.3;
+
+    /**
+     * Register every case at each table size up to `--max-rows` (default
+     * 10^6), run them, then print each action's growth curve
+     * @return 1 with `--fail-on-flag` when an action is flagged, else 0
+     */
+    inline int run(int argc, char** argv, const std::vector<action_case>& cases) {
+        int64_t max_rows = 1000000;
+        bool fail_on_flag = false;
+        std::vector<char*> args;
+        for (int i = 0; i < argc; i++) {
+            if (std::strncmp(argv[i], "--max-rows=", 11) == 0) {
+                max_rows = std::stoll(argv[i] + 11);
+            } else if (std::strcmp(argv[i], "--fail-on-flag") == 0) {
+                fail_on_flag = true;
+            } else {
+                args.push_back(argv[i]);
+            }
+        }
+        int count = int(args.size());
+        benchmark::Initialize(&count, args.data());
+        if (benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+
+        for (const auto& c : cases) {
+            int64_t limit = std::min(max_rows, c.max_rows);
+            std::vector<int64_t> sizes;
+            for (int64_t rows = 1000; rows <= limit; rows *= 10) sizes.push_back(rows);
+            if (sizes.empty() || sizes.back() != limit) sizes.push_back(limit);
+
+            auto fn = c.run;
+            auto* b = benchmark::RegisterBenchmark(c.name.c_str(), [fn](benchmark::State& state) {
+                fn(state, state.range(0));
+                state.SetComplexityN(state.range(0));
+            });
+            for (auto rows : sizes) b->Arg(rows);
+            b->Unit(benchmark::kMicrosecond)->Complexity(benchmark::oAuto);
+        }
+
+        detail::collecting_reporter reporter;
+        benchmark::RunSpecifiedBenchmarks(&reporter);
+        benchmark::Shutdown();
+
+        bool flagged = false;
+        std::printf("\nCost per action against table size\n");
+        for (const auto& [name, points] : reporter.points) {
+            if (points.empty()) continue;
+            double worst = 0;
+            for (const auto& p : points) worst = std::max(worst, p.time);
+
+            std::printf("\n%s\n", name.c_str());
+            for (const auto& p : points) {
+                int bar = std::max(1, int(std::lround(50 * p.time / worst)));
+                std::printf("  %10.0f rows %12.2f us  %s\n", p.rows, p.time, std::string(size_t(bar), '#').c_str());
+            }
+            if (points.size() < 2) continue;
+
+            double exponent = detail::growth_exponent(points);
+            bool super_constant = exponent > super_constant_exponent;
+            flagged |= super_constant;
+            std::printf("  cost ~ rows^%.2f%s\n", exponent, super_constant ? "  <-- SUPER-CONSTANT" : "");
+        }
+        return fail_on_flag && flagged ? 1 : 0;
+    }
+
+} // namespace scaling
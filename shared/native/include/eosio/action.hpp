@@ -0,0 +1,275 @@
+#pragma once
+
+#include "check.hpp"
+#include "datastream.hpp"
+#include "name.hpp"
+
+#include <native/state.hpp>
+
+#include <boost/preprocessor/facilities/overload.hpp>
+#include <boost/preprocessor/tuple/elem.hpp>
+#include <boost/preprocessor/tuple/enum.hpp>
+#include <boost/preprocessor/variadic/size.hpp>
+#include <boost/preprocessor/variadic/to_tuple.hpp>
+
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+   /**
+    * Copy the current action's data into `msg`
+    * @return the number of bytes copied
+    */
+   inline uint32_t read_action_data(void* msg, uint32_t len) {
+      const auto& data = native::context().act->data;
+      uint32_t size = std::min<uint32_t>(len, data.size());
+      if (size) memcpy(msg, data.data(), size);
+      return size;
+   }
+
+   inline uint32_t action_data_size() { return native::context().act->data.size(); }
+
+   inline name current_receiver() { return name(native::context().receiver); }
+
+   /**
+    * Notify `notify_account` of the current action once this receiver finishes
+    */
+   inline void require_recipient(name notify_account) {
+      auto& ctx = native::context();
+      if (std::find(ctx.notified.begin(), ctx.notified.end(), notify_account.value) == ctx.notified.end()) {
+         ctx.notified.push_back(notify_account.value);
+      }
+   }
+
+   template <typename... accounts>
+   void require_recipient(name name, accounts... remaining_accounts) {
+      require_recipient(name);
+      require_recipient(remaining_accounts...);
+   }
+
+   inline void require_auth(name n) {
+      if (!native::context().has_auth(n.value)) {
+         throw native::auth_error("missing authority of " + n.to_string());
+      }
+   }
+
+   inline bool has_auth(name n) { return native::context().has_auth(n.value); }
+
+   inline bool is_account(name n) { return native::state().accounts.count(n.value) > 0; }
+
+   /**
+    * Account that sent the current inline action, empty for a transaction's own actions
+    */
+   inline name get_sender() {
+      auto& st = native::state();
+      return st.stack.size() > 1 ? name(st.stack[st.stack.size() - 2]->receiver) : name();
+   }
+
+   inline void set_action_return_value(void* return_value, size_t size) {
+      const char* begin = static_cast<const char*>(return_value);
+      native::context().return_value.assign(begin, begin + size);
+   }
+
+   struct permission_level {
+      constexpr permission_level(name a, name p) : actor(a), permission(p) {}
+
+      constexpr permission_level() {}
+
+      name actor;
+      name permission;
+
+      friend constexpr bool operator==(const permission_level& a, const permission_level& b) {
+         return a.actor == b.actor && a.permission == b.permission;
+      }
+
+      friend constexpr bool operator<(const permission_level& a, const permission_level& b) {
+         return a.actor < b.actor || (a.actor == b.actor && a.permission < b.permission);
+      }
+   };
+
+   template <typename DataStream>
+   DataStream& operator<<(DataStream& ds, const permission_level& p) {
+      return ds << p.actor << p.permission;
+   }
+
+   template <typename DataStream>
+   DataStream& operator>>(DataStream& ds, permission_level& p) {
+      return ds >> p.actor >> p.permission;
+   }
+
+   inline void require_auth(const permission_level& level) {
+      const auto& auths = native::context().act->authorization;
+      bool found = std::any_of(auths.begin(), auths.end(), [&](const native::permission_level& p) {
+         return p.actor == level.actor.value && p.permission == level.permission.value;
+      });
+      if (!found) {
+         throw native::auth_error("missing authority of " + level.actor.to_string() + "@" + level.permission.to_string());
+      }
+   }
+
+   /**
+    * An action to send inline, or one captured from the chain
+    */
+   struct action {
+      eosio::name account;
+      eosio::name name;
+      std::vector<permission_level> authorization;
+      std::vector<char> data;
+
+      action() = default;
+
+      template <typename T>
+      action(const permission_level& auth, struct name a, struct name n, T&& value)
+         : account(a), name(n), authorization(1, auth), data(pack(std::forward<T>(value))) {}
+
+      template <typename T>
+      action(std::vector<permission_level> auths, struct name a, struct name n, T&& value)
+         : account(a), name(n), authorization(std::move(auths)), data(pack(std::forward<T>(value))) {}
+
+      /**
+       * Queue the action to run after the current one and its notifications
+       */
+      void send() const {
+         auto& ctx = native::context();
+         ctx.inline_actions.emplace_back(ctx.receiver, to_record());
+      }
+
+      void send_context_free() const {
+         check(authorization.empty(), "context free actions cannot have authorizations");
+         send();
+      }
+
+      template <typename T>
+      T data_as() const {
+         return unpack<T>(data);
+      }
+
+      native::action_record to_record() const {
+         native::action_record record{account.value, name.value, {}, data};
+         for (const auto& auth : authorization) {
+            record.authorization.push_back({auth.actor.value, auth.permission.value});
+         }
+         return record;
+      }
+
+      static action from_record(const native::action_record& record) {
+         action act;
+         act.account = eosio::name(record.account);
+         act.name = eosio::name(record.name);
+         for (const auto& auth : record.authorization) {
+            act.authorization.emplace_back(eosio::name(auth.actor), eosio::name(auth.permission));
+         }
+         act.data = record.data;
+         return act;
+      }
+   };
+
+   template <typename DataStream>
+   DataStream& operator<<(DataStream& ds, const action& a) {
+      return ds << a.account << a.name << a.authorization << a.data;
+   }
+
+   template <typename DataStream>
+   DataStream& operator>>(DataStream& ds, action& a) {
+      return ds >> a.account >> a.name >> a.authorization >> a.data;
+   }
+
+   namespace detail {
+
+      template <typename T>
+      struct function_traits;
+
+      template <typename C, typename R, typename... Args>
+      struct function_traits<R (C::*)(Args...)> {
+         using return_type = R;
+         using args_tuple = std::tuple<std::decay_t<Args>...>;
+      };
+
+      template <typename C, typename R, typename... Args>
+      struct function_traits<R (C::*)(Args...) const> {
+         using return_type = R;
+         using args_tuple = std::tuple<std::decay_t<Args>...>;
+      };
+
+      /// Argument tuple an action member function is packed as
+      template <auto Action>
+      using deduced = typename function_traits<decltype(Action)>::args_tuple;
+
+   } // namespace detail
+
+   /**
+    * Typed sender for another contract's action
+    */
+   template <eosio::name::raw Name, auto Action>
+   struct action_wrapper {
+      template <typename Code>
+      constexpr action_wrapper(Code&& code, std::vector<eosio::permission_level>&& perms)
+         : code_name(std::forward<Code>(code)), permissions(std::move(perms)) {}
+
+      template <typename Code>
+      constexpr action_wrapper(Code&& code, const std::vector<eosio::permission_level>& perms)
+         : code_name(std::forward<Code>(code)), permissions(perms) {}
+
+      template <typename Code>
+      constexpr action_wrapper(Code&& code, eosio::permission_level&& perm)
+         : code_name(std::forward<Code>(code)), permissions({1, std::move(perm)}) {}
+
+      template <typename Code>
+      constexpr action_wrapper(Code&& code, const eosio::permission_level& perm)
+         : code_name(std::forward<Code>(code)), permissions({1, perm}) {}
+
+      static constexpr eosio::name action_name = eosio::name(Name);
+      eosio::name code_name;
+      std::vector<eosio::permission_level> permissions;
+
+      template <typename... Args>
+      action to_action(Args&&... args) const {
+         return action(permissions, code_name, action_name, detail::deduced<Action>{std::forward<Args>(args)...});
+      }
+
+      template <typename... Args>
+      void send(Args&&... args) const {
+         to_action(std::forward<Args>(args)...).send();
+      }
+
+      template <typename... Args>
+      void send_context_free(Args&&... args) const {
+         to_action(std::forward<Args>(args)...).send_context_free();
+      }
+   };
+
+   template <typename T, uint64_t Name>
+   struct inline_dispatcher;
+
+   template <typename T, uint64_t Name, typename... Args>
+   struct inline_dispatcher<void (T::*)(Args...), Name> {
+      static void call(name code, const permission_level& perm, std::tuple<std::decay_t<Args>...> args) {
+         action(perm, code, name(Name), std::move(args)).send();
+      }
+
+      static void call(name code, std::vector<permission_level> perms, std::tuple<std::decay_t<Args>...> args) {
+         action(std::move(perms), code, name(Name), std::move(args)).send();
+      }
+   };
+
+} // namespace eosio
+
+#define INLINE_ACTION_SENDER3(CONTRACT_CLASS, FUNCTION_NAME, ACTION_NAME) \
+   ::eosio::inline_dispatcher<decltype(&CONTRACT_CLASS::FUNCTION_NAME), ACTION_NAME>::call
+
+#define INLINE_ACTION_SENDER2(CONTRACT_CLASS, NAME) \
+   INLINE_ACTION_SENDER3(CONTRACT_CLASS, NAME, ::eosio::name(#NAME).value)
+
+#define INLINE_ACTION_SENDER(...) \
+   BOOST_PP_OVERLOAD(INLINE_ACTION_SENDER, __VA_ARGS__)(__VA_ARGS__)
+
+/**
+ * Send an inline action to one of the contract's own actions, arguments
+ * as a braced list
+ */
+#define SEND_INLINE_ACTION(CONTRACT, NAME, ...)                                   \
+   INLINE_ACTION_SENDER(std::decay_t<decltype(CONTRACT)>, NAME)((CONTRACT).get_self(), \
+      BOOST_PP_TUPLE_ENUM(BOOST_PP_VARIADIC_SIZE(__VA_ARGS__), BOOST_PP_VARIADIC_TO_TUPLE(__VA_ARGS__)));
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "check.hpp"
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace eosio {
+
+   /**
+    * A trailing field that older serialized data may lack. Unpacking leaves it
+    * empty when the data runs out; packing always writes a value, the default
+    * one when empty, exactly as the CDT does.
+    */
+   template <typename T>
+   class binary_extension {
+   public:
+      using value_type = T;
+
+      constexpr binary_extension() {}
+      constexpr binary_extension(const T& ext) : _value(ext) {}
+      constexpr binary_extension(T&& ext) : _value(std::move(ext)) {}
+
+      constexpr bool has_value() const { return _value.has_value(); }
+
+      constexpr explicit operator bool() const { return has_value(); }
+
+      constexpr T& value() & {
+         check(has_value(), "cannot get value of empty binary_extension");
+         return *_value;
+      }
+
+      constexpr const T& value() const& {
+         check(has_value(), "cannot get value of empty binary_extension");
+         return *_value;
+      }
+
+      template <typename U>
+      constexpr T value_or(U&& def) const& {
+         return _value.value_or(std::forward<U>(def));
+      }
+
+      constexpr T value_or() const& { return has_value() ? *_value : T{}; }
+
+      constexpr T* operator->() { return &value(); }
+      constexpr const T* operator->() const { return &value(); }
+
+      constexpr T& operator*() & { return value(); }
+      constexpr const T& operator*() const& { return value(); }
+
+      template <typename... Args>
+      T& emplace(Args&&... args) & {
+         return _value.emplace(std::forward<Args>(args)...);
+      }
+
+      void reset() { _value.reset(); }
+
+   private:
+      std::optional<T> _value;
+   };
+
+   template <typename DataStream, typename T>
+   inline DataStream& operator<<(DataStream& ds, const binary_extension<T>& be) {
+      ds << be.value_or();
+      return ds;
+   }
+
+   template <typename DataStream, typename T>
+   inline DataStream& operator>>(DataStream& ds, binary_extension<T>& be) {
+      if (ds.remaining()) {
+         T val;
+         ds >> val;
+         be.emplace(val);
+      }
+      return ds;
+   }
+
+} // namespace eosio
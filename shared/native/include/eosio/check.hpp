@@ -0,0 +1,30 @@
+#pragma once
+
+#include <native/errors.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace eosio {
+
+   /**
+    * Assert a condition, aborting the transaction with `msg` when it fails
+    */
+   inline void check(bool pred, const char* msg) {
+      if (!pred) throw native::assert_error(msg);
+   }
+
+   inline void check(bool pred, const std::string& msg) {
+      if (!pred) throw native::assert_error(msg);
+   }
+
+   inline void check(bool pred, std::string_view msg) {
+      if (!pred) throw native::assert_error(std::string(msg));
+   }
+
+   inline void check(bool pred, uint64_t code) {
+      if (!pred) throw native::assert_error("assertion failure with error code: " + std::to_string(code));
+   }
+
+} // namespace eosio
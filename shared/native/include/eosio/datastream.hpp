@@ -0,0 +1,397 @@
+#pragma once
+
+#include "check.hpp"
+#include "varint.hpp"
+
+#include <native/reflect.hpp>
+
+#include <array>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace eosio {
+
+   /**
+    * Reads and writes packed binary data, same wire format as the CDT
+    */
+   template <typename T>
+   class datastream {
+   public:
+      datastream(T start, size_t s) : _start(start), _pos(start), _end(start + s) {}
+
+      inline void skip(size_t s) { _pos += s; }
+
+      inline bool read(char* d, size_t s) {
+         check(size_t(_end - _pos) >= s, "datastream attempted to read past the end");
+         memcpy(d, _pos, s);
+         _pos += s;
+         return true;
+      }
+
+      inline bool write(const char* d, size_t s) {
+         check(size_t(_end - _pos) >= s, "datastream attempted to write past the end");
+         memcpy(_pos, d, s);
+         _pos += s;
+         return true;
+      }
+
+      inline bool write(char c) { return write(&c, 1); }
+
+      inline bool put(char c) { return write(c); }
+
+      inline bool get(char& c) { return read(&c, 1); }
+
+      inline bool get(unsigned char& c) { return read(reinterpret_cast<char*>(&c), 1); }
+
+      T pos() const { return _pos; }
+
+      inline bool valid() const { return _pos <= _end && _pos >= _start; }
+
+      inline bool seekp(size_t p) {
+         _pos = _start + p;
+         return _pos <= _end;
+      }
+
+      inline size_t tellp() const { return size_t(_pos - _start); }
+
+      inline size_t remaining() const { return _end - _pos; }
+
+   private:
+      T _start;
+      T _pos;
+      T _end;
+   };
+
+   /**
+    * Size-only stream, used to compute packed sizes without writing
+    */
+   template <>
+   class datastream<size_t> {
+   public:
+      datastream(size_t init_size = 0) : _size(init_size) {}
+
+      inline bool skip(size_t s) {
+         _size += s;
+         return true;
+      }
+
+      inline bool write(const char*, size_t s) {
+         _size += s;
+         return true;
+      }
+
+      inline bool write(char) {
+         _size++;
+         return true;
+      }
+
+      inline bool put(char) {
+         _size++;
+         return true;
+      }
+
+      inline bool valid() const { return true; }
+
+      inline bool seekp(size_t p) {
+         _size = p;
+         return true;
+      }
+
+      inline size_t tellp() const { return _size; }
+
+      inline size_t remaining() const { return 0; }
+
+   private:
+      size_t _size;
+   };
+
+   // Arithmetic types are written in host (little-endian) order
+
+   template <typename Stream, typename T, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const T& v) {
+      ds.write(reinterpret_cast<const char*>(&v), sizeof(T));
+      return ds;
+   }
+
+   template <typename Stream, typename T, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, T& v) {
+      ds.read(reinterpret_cast<char*>(&v), sizeof(T));
+      return ds;
+   }
+
+   template <typename Stream, typename T, std::enable_if_t<std::is_enum_v<T>>* = nullptr>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const T& v) {
+      return ds << static_cast<std::underlying_type_t<T>>(v);
+   }
+
+   template <typename Stream, typename T, std::enable_if_t<std::is_enum_v<T>>* = nullptr>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, T& v) {
+      std::underlying_type_t<T> raw;
+      ds >> raw;
+      v = static_cast<T>(raw);
+      return ds;
+   }
+
+   template <typename Stream>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const unsigned_int& v) {
+      uint64_t val = v.value;
+      do {
+         uint8_t b = uint8_t(val) & 0x7f;
+         val >>= 7;
+         b |= ((val > 0) << 7);
+         ds.write(static_cast<char>(b));
+      } while (val);
+      return ds;
+   }
+
+   template <typename Stream>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, unsigned_int& vi) {
+      uint64_t v = 0;
+      char b = 0;
+      uint8_t by = 0;
+      do {
+         ds.get(b);
+         check(by < 35, "varuint32 is too long");
+         v |= uint32_t(uint8_t(b) & 0x7f) << by;
+         by += 7;
+      } while (uint8_t(b) & 0x80);
+      vi.value = static_cast<uint32_t>(v);
+      return ds;
+   }
+
+   template <typename Stream>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::string& v) {
+      ds << unsigned_int(v.size());
+      if (v.size())
+         ds.write(v.data(), v.size());
+      return ds;
+   }
+
+   template <typename Stream>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::string& v) {
+      unsigned_int s;
+      ds >> s;
+      v.resize(s.value);
+      if (s.value)
+         ds.read(v.data(), v.size());
+      return ds;
+   }
+
+   template <typename Stream, typename T>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::vector<T>& v) {
+      ds << unsigned_int(v.size());
+      for (const auto& i : v)
+         ds << i;
+      return ds;
+   }
+
+   template <typename Stream, typename T>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::vector<T>& v) {
+      unsigned_int s;
+      ds >> s;
+      v.resize(s.value);
+      for (auto& i : v)
+         ds >> i;
+      return ds;
+   }
+
+   template <typename Stream, typename T, std::size_t N>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::array<T, N>& v) {
+      for (const auto& i : v)
+         ds << i;
+      return ds;
+   }
+
+   template <typename Stream, typename T, std::size_t N>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::array<T, N>& v) {
+      for (auto& i : v)
+         ds >> i;
+      return ds;
+   }
+
+   template <typename Stream, typename K, typename V>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::pair<K, V>& v) {
+      ds << v.first;
+      ds << v.second;
+      return ds;
+   }
+
+   template <typename Stream, typename K, typename V>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::pair<K, V>& v) {
+      ds >> v.first;
+      ds >> v.second;
+      return ds;
+   }
+
+   template <typename Stream, typename K, typename V>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::map<K, V>& m) {
+      ds << unsigned_int(m.size());
+      for (const auto& i : m)
+         ds << i.first << i.second;
+      return ds;
+   }
+
+   template <typename Stream, typename K, typename V>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::map<K, V>& m) {
+      m.clear();
+      unsigned_int s;
+      ds >> s;
+      for (uint32_t i = 0; i < s.value; ++i) {
+         K k;
+         V v;
+         ds >> k >> v;
+         m.emplace(std::move(k), std::move(v));
+      }
+      return ds;
+   }
+
+   template <typename Stream, typename T>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::set<T>& s) {
+      ds << unsigned_int(s.size());
+      for (const auto& i : s)
+         ds << i;
+      return ds;
+   }
+
+   template <typename Stream, typename T>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::set<T>& s) {
+      s.clear();
+      unsigned_int size;
+      ds >> size;
+      for (uint32_t i = 0; i < size.value; ++i) {
+         T v;
+         ds >> v;
+         s.emplace(std::move(v));
+      }
+      return ds;
+   }
+
+   template <typename Stream, typename T>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::optional<T>& opt) {
+      char valid = opt.has_value();
+      ds << valid;
+      if (valid)
+         ds << *opt;
+      return ds;
+   }
+
+   template <typename Stream, typename T>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::optional<T>& opt) {
+      char valid = 0;
+      ds >> valid;
+      if (valid) {
+         T val;
+         ds >> val;
+         opt = std::move(val);
+      } else {
+         opt.reset();
+      }
+      return ds;
+   }
+
+   template <typename Stream, typename... Ts>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::variant<Ts...>& var) {
+      unsigned_int index = var.index();
+      ds << index;
+      std::visit([&ds](const auto& val) { ds << val; }, var);
+      return ds;
+   }
+
+   namespace detail {
+      template <int I, typename DataStream, typename... Ts>
+      void unpack_variant(DataStream& ds, int index, std::variant<Ts...>& var) {
+         if constexpr (I < std::variant_size_v<std::variant<Ts...>>) {
+            if (index == I) {
+               std::variant_alternative_t<I, std::variant<Ts...>> tmp;
+               ds >> tmp;
+               var.template emplace<I>(std::move(tmp));
+            } else {
+               unpack_variant<I + 1>(ds, index, var);
+            }
+         } else {
+            check(false, "invalid variant index");
+         }
+      }
+   } // namespace detail
+
+   template <typename Stream, typename... Ts>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::variant<Ts...>& var) {
+      unsigned_int index;
+      ds >> index;
+      detail::unpack_variant<0>(ds, index.value, var);
+      return ds;
+   }
+
+   template <typename Stream, typename... Args>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const std::tuple<Args...>& t) {
+      std::apply([&ds](const auto&... args) { ((ds << args), ...); }, t);
+      return ds;
+   }
+
+   template <typename Stream, typename... Args>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, std::tuple<Args...>& t) {
+      std::apply([&ds](auto&... args) { ((ds >> args), ...); }, t);
+      return ds;
+   }
+
+   // Plain aggregates (table rows, action structs) are packed field by field
+
+   template <typename Stream, typename T, std::enable_if_t<native::reflect::is_reflectable_v<T>>* = nullptr>
+   datastream<Stream>& operator<<(datastream<Stream>& ds, const T& v) {
+      native::reflect::for_each_field(v, [&ds](const auto& field) { ds << field; });
+      return ds;
+   }
+
+   template <typename Stream, typename T, std::enable_if_t<native::reflect::is_reflectable_v<T>>* = nullptr>
+   datastream<Stream>& operator>>(datastream<Stream>& ds, T& v) {
+      native::reflect::for_each_field(v, [&ds](auto& field) { ds >> field; });
+      return ds;
+   }
+
+   /**
+    * Packed size of a value in bytes
+    */
+   template <typename T>
+   size_t pack_size(const T& value) {
+      datastream<size_t> ps;
+      ps << value;
+      return ps.tellp();
+   }
+
+   /**
+    * Serialize a value into a new byte vector
+    */
+   template <typename T>
+   std::vector<char> pack(const T& value) {
+      std::vector<char> result;
+      result.resize(pack_size(value));
+
+      datastream<char*> ds(result.data(), result.size());
+      ds << value;
+      return result;
+   }
+
+   /**
+    * Deserialize a value from a buffer
+    */
+   template <typename T>
+   T unpack(const char* buffer, size_t len) {
+      T result;
+      datastream<const char*> ds(buffer, len);
+      ds >> result;
+      return result;
+   }
+
+   template <typename T>
+   T unpack(const std::vector<char>& bytes) {
+      return unpack<T>(bytes.data(), bytes.size());
+   }
+
+} // namespace eosio
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "action.hpp"
+#include "datastream.hpp"
+#include "name.hpp"
+
+#include <boost/preprocessor/seq/for_each.hpp>
+#include <boost/preprocessor/stringize.hpp>
+
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace eosio {
+
+   /**
+    * Unpack the current action's data as the arguments of `func` and call it
+    * on a new contract instance; a non-void result becomes the action return value
+    */
+   template <typename T, typename R, typename... Args>
+   bool execute_action(name self, name code, R (T::*func)(Args...)) {
+      size_t size = action_data_size();
+      std::vector<char> buffer(size);
+      read_action_data(buffer.data(), size);
+
+      std::tuple<std::decay_t<Args>...> args;
+      datastream<const char*> ds(buffer.data(), size);
+      ds >> args;
+
+      T inst(self, code, ds);
+
+      auto f2 = [&](auto... a) { return ((&inst)->*func)(a...); };
+
+      if constexpr (std::is_void_v<R>) {
+         std::apply(f2, args);
+      } else {
+         auto packed = pack(std::apply(f2, args));
+         set_action_return_value(packed.data(), packed.size());
+      }
+      return true;
+   }
+
+} // namespace eosio
+
+#define EOSIO_DISPATCH_INTERNAL(r, OP, elem)                                     \
+   case eosio::name(BOOST_PP_STRINGIZE(elem)).value:                             \
+      eosio::execute_action(eosio::name(receiver), eosio::name(code), &OP::elem); \
+      break;
+
+#define EOSIO_DISPATCH_HELPER(TYPE, MEMBERS) \
+   BOOST_PP_SEQ_FOR_EACH(EOSIO_DISPATCH_INTERNAL, TYPE, MEMBERS)
+
+/**
+ * Define the contract's apply entry point for the listed actions
+ */
+#define EOSIO_DISPATCH(TYPE, MEMBERS)                                     \
+   extern "C" {                                                           \
+   [[eosio::wasm_entry]] void apply(uint64_t receiver, uint64_t code, uint64_t action) { \
+      if (code == receiver) {                                             \
+         switch (action) {                                                \
+            EOSIO_DISPATCH_HELPER(TYPE, MEMBERS)                          \
+         }                                                                \
+      }                                                                   \
+   }                                                                      \
+   }
@@ -0,0 +1,15 @@
+#pragma once
+
+/**
+ * Native stand-in for the CDT umbrella header. Contracts include it
+ * unchanged; native::tester in <native/chain.hpp> drives them.
+ */
+#include "action.hpp"
+#include "check.hpp"
+#include "contract.hpp"
+#include "datastream.hpp"
+#include "dispatcher.hpp"
+#include "multi_index.hpp"
+#include "name.hpp"
+#include "print.hpp"
+#include "serialize.hpp"
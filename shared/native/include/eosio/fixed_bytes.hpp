@@ -0,0 +1,88 @@
+#pragma once
+
+#include "check.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace eosio {
+
+   /**
+    * Fixed-size byte string, such as a checksum. Bytes are kept in wire
+    * order; words are read big-endian, matching the CDT layout.
+    */
+   template <std::size_t Size>
+   class fixed_bytes {
+   public:
+      typedef unsigned __int128 word_t;
+
+      static constexpr std::size_t num_words() { return (Size + sizeof(word_t) - 1) / sizeof(word_t); }
+      static constexpr std::size_t padded_bytes() { return num_words() * sizeof(word_t) - Size; }
+
+      constexpr fixed_bytes() : _data() {}
+
+      constexpr fixed_bytes(const std::array<uint8_t, Size>& arr) : _data(arr) {}
+
+      // Words are concatenated big-endian; any padding sits at the front of the first word
+      fixed_bytes(const std::array<word_t, num_words()>& arr) : _data() {
+         for (std::size_t i = 0; i < Size; i++) {
+            std::size_t pos = i + padded_bytes();
+            _data[i] = uint8_t(arr[pos / sizeof(word_t)] >> ((sizeof(word_t) - 1 - pos % sizeof(word_t)) * 8));
+         }
+      }
+
+      static constexpr std::size_t size() { return Size; }
+
+      const uint8_t* data() const { return _data.data(); }
+      uint8_t* data() { return _data.data(); }
+
+      std::array<uint8_t, Size> extract_as_byte_array() const { return _data; }
+
+      std::array<word_t, num_words()> get_array() const {
+         std::array<word_t, num_words()> words{};
+         for (std::size_t i = 0; i < Size; i++) {
+            std::size_t pos = i + padded_bytes();
+            words[pos / sizeof(word_t)] |= word_t(_data[i]) << ((sizeof(word_t) - 1 - pos % sizeof(word_t)) * 8);
+         }
+         return words;
+      }
+
+      std::string to_string() const {
+         static const char* hex = "0123456789abcdef";
+         std::string str;
+         for (auto b : _data) {
+            str.push_back(hex[b >> 4]);
+            str.push_back(hex[b & 0x0f]);
+         }
+         return str;
+      }
+
+      friend bool operator==(const fixed_bytes& a, const fixed_bytes& b) { return a._data == b._data; }
+      friend bool operator!=(const fixed_bytes& a, const fixed_bytes& b) { return a._data != b._data; }
+      friend bool operator<(const fixed_bytes& a, const fixed_bytes& b) { return a._data < b._data; }
+      friend bool operator>(const fixed_bytes& a, const fixed_bytes& b) { return a._data > b._data; }
+      friend bool operator<=(const fixed_bytes& a, const fixed_bytes& b) { return a._data <= b._data; }
+      friend bool operator>=(const fixed_bytes& a, const fixed_bytes& b) { return a._data >= b._data; }
+
+   private:
+      std::array<uint8_t, Size> _data;
+   };
+
+   using checksum160 = fixed_bytes<20>;
+   using checksum256 = fixed_bytes<32>;
+   using checksum512 = fixed_bytes<64>;
+
+   template <typename DataStream, std::size_t Size>
+   DataStream& operator<<(DataStream& ds, const fixed_bytes<Size>& d) {
+      ds.write(reinterpret_cast<const char*>(d.data()), Size);
+      return ds;
+   }
+
+   template <typename DataStream, std::size_t Size>
+   DataStream& operator>>(DataStream& ds, fixed_bytes<Size>& d) {
+      ds.read(reinterpret_cast<char*>(d.data()), Size);
+      return ds;
+   }
+
+} // namespace eosio
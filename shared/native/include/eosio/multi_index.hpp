@@ -0,0 +1,515 @@
+#pragma once
+
+#include "action.hpp"
+#include "check.hpp"
+#include "datastream.hpp"
+#include "name.hpp"
+
+#include <native/state.hpp>
+
+#include <array>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+namespace eosio {
+
+   constexpr static inline name same_payer{};
+
+   /**
+    * Secondary key extractor calling a const member function
+    */
+   template <class Class, typename Type, Type (Class::*PtrToMemberFunction)() const>
+   struct const_mem_fun {
+      typedef typename std::remove_reference<Type>::type result_type;
+
+      Type operator()(const Class& x) const { return (x.*PtrToMemberFunction)(); }
+   };
+
+   template <name::raw IndexName, typename Extractor>
+   struct indexed_by {
+      enum constants { index_name = static_cast<uint64_t>(IndexName) };
+      typedef Extractor secondary_extractor_type;
+   };
+
+   /**
+    * A contract table: rows of T keyed by T::primary_key(), plus up to 16
+    * secondary indices. Rows are stored packed, so reading a table through a
+    * different struct (another contract's view of it) works as on chain.
+    * Loaded rows are cached per instance; references stay valid until the
+    * row is erased or the instance is destroyed.
+    */
+   template <name::raw TableName, typename T, typename... Indices>
+   class multi_index {
+   private:
+      static_assert(sizeof...(Indices) <= 16, "multi_index only supports a maximum of 16 secondary indices");
+
+      constexpr static bool validate_table_name(name n) {
+         // Limit table names to 12 characters so that the last character (4 bits) can be used to distinguish between the secondary indices.
+         return n.length() < 13;
+      }
+
+      static_assert(validate_table_name(name(TableName)), "multi_index does not support table names with a length greater than 12");
+
+      constexpr static uint64_t unset_next_primary_key = static_cast<uint64_t>(-2);
+      constexpr static uint64_t no_available_primary_key = static_cast<uint64_t>(-1);
+
+      struct item : public T {
+         template <typename Constructor>
+         item(const multi_index* idx, Constructor&& c) : __idx(idx) {
+            c(*this);
+         }
+
+         const multi_index* __idx;
+         uint64_t __primary_key = 0;
+      };
+
+      template <std::size_t I>
+      using extractor = typename std::tuple_element_t<I, std::tuple<Indices...>>::secondary_extractor_type;
+
+      template <std::size_t... I>
+      static std::vector<uint64_t> secondary_keys(const T& obj, std::index_sequence<I...>) {
+         return {static_cast<uint64_t>(extractor<I>{}(obj))...};
+      }
+
+      static std::vector<uint64_t> secondary_keys(const T& obj) {
+         return secondary_keys(obj, std::index_sequence_for<Indices...>{});
+      }
+
+      native::table_id tid() const { return {_code.value, _scope, static_cast<uint64_t>(TableName)}; }
+
+      static native::database& db() { return native::state().db; }
+
+      const item& load_object_by_primary(uint64_t pk) const {
+         auto cached = _items.find(pk);
+         if (cached != _items.end()) return *cached->second;
+
+         const auto* r = db().find(tid(), pk);
+         check(r != nullptr, "unable to find key");
+
+         auto ptr = std::make_unique<item>(this, [&](auto& i) {
+            T& val = static_cast<T&>(i);
+            datastream<const char*> ds(r->data.data(), r->data.size());
+            ds >> val;
+         });
+         ptr->__primary_key = pk;
+
+         const item& loaded = *ptr;
+         _items.emplace(pk, std::move(ptr));
+         return loaded;
+      }
+
+      void store_object(const item& obj, uint64_t payer) {
+         native::row r;
+         r.data = pack(static_cast<const T&>(obj));
+         r.payer = payer;
+         r.secondary = secondary_keys(obj);
+         db().store(tid(), obj.__primary_key, std::move(r));
+      }
+
+      void require_writable(const char* msg) const {
+         check(_code == current_receiver(), msg);
+      }
+
+      name _code;
+      uint64_t _scope;
+      mutable uint64_t _next_primary_key = unset_next_primary_key;
+      mutable std::map<uint64_t, std::unique_ptr<item>> _items;
+
+   public:
+      template <name::raw IndexName, typename Extractor, uint64_t Number>
+      struct index {
+      public:
+         typedef Extractor secondary_extractor_type;
+         typedef std::decay_t<decltype(Extractor{}(std::declval<const T&>()))> secondary_key_type;
+
+         static_assert(std::is_same_v<secondary_key_type, uint64_t>, "native multi_index supports uint64_t secondary keys only");
+
+         constexpr static bool validate_index_name(eosio::name n) {
+            return n.value != 0 && !(n.value & 0x000000000000000FULL);
+         }
+
+         static_assert(validate_index_name(eosio::name(IndexName)), "invalid index name used in multi_index");
+
+         static constexpr uint64_t index_number = Number;
+
+         struct const_iterator {
+         public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = const T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            friend bool operator==(const const_iterator& a, const const_iterator& b) { return a._item == b._item; }
+            friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a._item != b._item; }
+
+            const T& operator*() const { return *static_cast<const T*>(_item); }
+            const T* operator->() const { return static_cast<const T*>(_item); }
+
+            const_iterator operator++(int) {
+               const_iterator result(*this);
+               ++(*this);
+               return result;
+            }
+
+            const_iterator operator--(int) {
+               const_iterator result(*this);
+               --(*this);
+               return result;
+            }
+
+            const_iterator& operator++() {
+               check(_item != nullptr, "cannot increment end iterator");
+               auto next = db().secondary_next(_idx->_multidx->tid(), Number, entry());
+               _item = next ? &_idx->_multidx->load_object_by_primary(next->second) : nullptr;
+               return *this;
+            }
+
+            const_iterator& operator--() {
+               std::optional<native::database::secondary_entry> from;
+               if (_item) from = entry();
+               auto prev = db().secondary_previous(_idx->_multidx->tid(), Number, from);
+               check(prev.has_value(), _item ? "cannot decrement iterator at beginning of index"
+                                             : "cannot decrement end iterator when the index is empty");
+               _item = &_idx->_multidx->load_object_by_primary(prev->second);
+               return *this;
+            }
+
+            const_iterator() {}
+
+         private:
+            friend struct index;
+
+            const_iterator(const index* idx, const item* i = nullptr) : _idx(idx), _item(i) {}
+
+            native::database::secondary_entry entry() const {
+               const auto* r = db().find(_idx->_multidx->tid(), _item->__primary_key);
+               check(r != nullptr, "index entry refers to an erased row");
+               return {r->secondary[Number], _item->__primary_key};
+            }
+
+            const index* _idx = nullptr;
+            const item* _item = nullptr;
+         };
+
+         typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+         const_iterator cbegin() const { return lower_bound(std::numeric_limits<uint64_t>::lowest()); }
+         const_iterator begin() const { return cbegin(); }
+
+         const_iterator cend() const { return const_iterator(this); }
+         const_iterator end() const { return cend(); }
+
+         const_reverse_iterator crbegin() const { return std::make_reverse_iterator(cend()); }
+         const_reverse_iterator rbegin() const { return crbegin(); }
+
+         const_reverse_iterator crend() const { return std::make_reverse_iterator(cbegin()); }
+         const_reverse_iterator rend() const { return crend(); }
+
+         const_iterator find(secondary_key_type secondary) const {
+            auto lb = lower_bound(secondary);
+            auto e = cend();
+            if (lb == e) return e;
+            if (secondary != secondary_extractor_type()(*lb)) return e;
+            return lb;
+         }
+
+         const_iterator require_find(secondary_key_type secondary, const char* error_msg = "unable to find secondary key") const {
+            auto lb = lower_bound(secondary);
+            check(lb != cend(), error_msg);
+            check(secondary == secondary_extractor_type()(*lb), error_msg);
+            return lb;
+         }
+
+         const T& get(secondary_key_type secondary, const char* error_msg = "unable to find secondary key") const {
+            auto result = find(secondary);
+            check(result != cend(), error_msg);
+            return *result;
+         }
+
+         const_iterator lower_bound(secondary_key_type secondary) const {
+            auto e = db().secondary_lower_bound(_multidx->tid(), Number, {secondary, 0});
+            if (!e) return cend();
+            return const_iterator(this, &_multidx->load_object_by_primary(e->second));
+         }
+
+         const_iterator upper_bound(secondary_key_type secondary) const {
+            auto e = db().secondary_next(_multidx->tid(), Number, {secondary, std::numeric_limits<uint64_t>::max()});
+            if (!e) return cend();
+            return const_iterator(this, &_multidx->load_object_by_primary(e->second));
+         }
+
+         const_iterator iterator_to(const T& obj) const {
+            const auto& objitem = static_cast<const item&>(obj);
+            check(objitem.__idx == _multidx, "object passed to iterator_to is not in multi_index");
+            return const_iterator(this, &objitem);
+         }
+
+         template <typename Lambda>
+         void modify(const_iterator itr, eosio::name payer, Lambda&& updater) {
+            check(itr != cend(), "cannot pass end iterator to modify");
+            _multidx->modify(*itr, payer, std::forward<Lambda>(updater));
+         }
+
+         const_iterator erase(const_iterator itr) {
+            check(itr != cend(), "cannot pass end iterator to erase");
+            const auto& obj = *itr;
+            ++itr;
+            _multidx->erase(obj);
+            return itr;
+         }
+
+         eosio::name get_code() const { return _multidx->get_code(); }
+         uint64_t get_scope() const { return _multidx->get_scope(); }
+
+         static constexpr uint64_t name() { return static_cast<uint64_t>(IndexName); }
+
+      private:
+         friend class multi_index;
+
+         index(multi_index* midx) : _multidx(midx) {}
+
+         multi_index* _multidx;
+      };
+
+      struct const_iterator {
+      public:
+         using iterator_category = std::bidirectional_iterator_tag;
+         using value_type = const T;
+         using difference_type = std::ptrdiff_t;
+         using pointer = const T*;
+         using reference = const T&;
+
+         friend bool operator==(const const_iterator& a, const const_iterator& b) { return a._item == b._item; }
+         friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a._item != b._item; }
+
+         const T& operator*() const { return *static_cast<const T*>(_item); }
+         const T* operator->() const { return static_cast<const T*>(_item); }
+
+         const_iterator operator++(int) {
+            const_iterator result(*this);
+            ++(*this);
+            return result;
+         }
+
+         const_iterator operator--(int) {
+            const_iterator result(*this);
+            --(*this);
+            return result;
+         }
+
+         const_iterator& operator++() {
+            check(_item != nullptr, "cannot increment end iterator");
+            auto next = db().upper_bound(_multidx->tid(), _item->__primary_key);
+            _item = next ? &_multidx->load_object_by_primary(*next) : nullptr;
+            return *this;
+         }
+
+         const_iterator& operator--() {
+            std::optional<uint64_t> prev;
+            if (!_item) {
+               prev = db().last(_multidx->tid());
+               check(prev.has_value(), "cannot decrement end iterator when the table is empty");
+            } else {
+               prev = db().previous(_multidx->tid(), _item->__primary_key);
+               check(prev.has_value(), "cannot decrement iterator at beginning of table");
+            }
+            _item = &_multidx->load_object_by_primary(*prev);
+            return *this;
+         }
+
+         const_iterator() {}
+
+      private:
+         friend class multi_index;
+
+         const_iterator(const multi_index* mi, const item* i = nullptr) : _multidx(mi), _item(i) {}
+
+         const multi_index* _multidx = nullptr;
+         const item* _item = nullptr;
+      };
+
+      typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+      multi_index(name code, uint64_t scope) : _code(code), _scope(scope) {}
+
+      multi_index(const multi_index&) = delete;
+      multi_index& operator=(const multi_index&) = delete;
+
+      name get_code() const { return _code; }
+
+      uint64_t get_scope() const { return _scope; }
+
+      const_iterator cbegin() const { return lower_bound(std::numeric_limits<uint64_t>::lowest()); }
+      const_iterator begin() const { return cbegin(); }
+
+      const_iterator cend() const { return const_iterator(this); }
+      const_iterator end() const { return cend(); }
+
+      const_reverse_iterator crbegin() const { return std::make_reverse_iterator(cend()); }
+      const_reverse_iterator rbegin() const { return crbegin(); }
+
+      const_reverse_iterator crend() const { return std::make_reverse_iterator(cbegin()); }
+      const_reverse_iterator rend() const { return crend(); }
+
+      const_iterator lower_bound(uint64_t primary) const {
+         auto pk = db().lower_bound(tid(), primary);
+         if (!pk) return end();
+         return const_iterator(this, &load_object_by_primary(*pk));
+      }
+
+      const_iterator upper_bound(uint64_t primary) const {
+         auto pk = db().upper_bound(tid(), primary);
+         if (!pk) return end();
+         return const_iterator(this, &load_object_by_primary(*pk));
+      }
+
+      uint64_t available_primary_key() const {
+         if (_next_primary_key == unset_next_primary_key) {
+            // This is the first time available_primary_key() is called for this multi_index instance.
+            if (begin() == end()) {
+               _next_primary_key = 0;
+            } else {
+               auto itr = --end();
+               auto pk = itr->primary_key();
+               if (pk >= no_available_primary_key)
+                  _next_primary_key = no_available_primary_key;
+               else
+                  _next_primary_key = pk + 1;
+            }
+         }
+
+         check(_next_primary_key < no_available_primary_key, "next primary key in table is at autoincrement limit");
+         return _next_primary_key;
+      }
+
+      template <name::raw IndexName>
+      auto get_index() {
+         constexpr uint64_t name = static_cast<uint64_t>(IndexName);
+         constexpr std::size_t number = index_number<name, 0, Indices...>();
+         static_assert(number < sizeof...(Indices), "name provided is not the name of any secondary index within multi_index");
+         using ext = extractor<number>;
+         return index<IndexName, ext, number>(this);
+      }
+
+      template <name::raw IndexName>
+      auto get_index() const {
+         return const_cast<multi_index*>(this)->template get_index<IndexName>();
+      }
+
+      const_iterator iterator_to(const T& obj) const {
+         const auto& objitem = static_cast<const item&>(obj);
+         check(objitem.__idx == this, "object passed to iterator_to is not in multi_index");
+         return const_iterator(this, &objitem);
+      }
+
+      /**
+       * Add a row, billing its RAM to `payer`
+       * @param constructor - Lambda filling in the new row
+       */
+      template <typename Lambda>
+      const_iterator emplace(name payer, Lambda&& constructor) {
+         require_writable("cannot create objects in table of another contract");
+         check(payer != name(), "must specify a valid account to pay for new record");
+
+         auto ptr = std::make_unique<item>(this, [&](auto& i) {
+            T& obj = static_cast<T&>(i);
+            constructor(obj);
+         });
+
+         auto pk = ptr->primary_key();
+         check(db().find(tid(), pk) == nullptr, "could not insert object, most likely a uniqueness constraint was violated");
+         ptr->__primary_key = pk;
+         store_object(*ptr, payer.value);
+
+         if (pk >= _next_primary_key)
+            _next_primary_key = (pk >= no_available_primary_key) ? no_available_primary_key : (pk + 1);
+
+         const item* obj = ptr.get();
+         _items[pk] = std::move(ptr);
+         return const_iterator(this, obj);
+      }
+
+      template <typename Lambda>
+      void modify(const_iterator itr, name payer, Lambda&& updater) {
+         check(itr != end(), "cannot pass end iterator to modify");
+         modify(*itr, payer, std::forward<Lambda>(updater));
+      }
+
+      /**
+       * Update a row in place; `same_payer` keeps the current RAM payer
+       */
+      template <typename Lambda>
+      void modify(const T& obj, name payer, Lambda&& updater) {
+         const auto& objitem = static_cast<const item&>(obj);
+         check(objitem.__idx == this, "object passed to modify is not in multi_index");
+         auto& mutableitem = const_cast<item&>(objitem);
+         require_writable("cannot modify objects in table of another contract");
+
+         auto pk = obj.primary_key();
+         updater(static_cast<T&>(mutableitem));
+         check(pk == obj.primary_key(), "updater cannot change primary key when modifying an object");
+
+         const auto* existing = db().find(tid(), pk);
+         check(existing != nullptr, "object passed to modify was erased");
+         store_object(mutableitem, payer == same_payer ? existing->payer : payer.value);
+      }
+
+      const T& get(uint64_t primary, const char* error_msg = "unable to find key") const {
+         auto result = find(primary);
+         check(result != cend(), error_msg);
+         return *result;
+      }
+
+      const_iterator find(uint64_t primary) const {
+         auto cached = _items.find(primary);
+         if (cached != _items.end()) return const_iterator(this, cached->second.get());
+         if (!db().find(tid(), primary)) return end();
+         return const_iterator(this, &load_object_by_primary(primary));
+      }
+
+      const_iterator require_find(uint64_t primary, const char* error_msg = "unable to find key") const {
+         auto itr = find(primary);
+         check(itr != end(), error_msg);
+         return itr;
+      }
+
+      const_iterator erase(const_iterator itr) {
+         check(itr != end(), "cannot pass end iterator to erase");
+         const auto& obj = *itr;
+         ++itr;
+         erase(obj);
+         return itr;
+      }
+
+      void erase(const T& obj) {
+         const auto& objitem = static_cast<const item&>(obj);
+         check(objitem.__idx == this, "object passed to erase is not in multi_index");
+         require_writable("cannot erase objects in table of another contract");
+
+         auto pk = objitem.__primary_key;
+         db().remove(tid(), pk);
+         _items.erase(pk);
+      }
+
+   private:
+      template <uint64_t Name, std::size_t I>
+      static constexpr std::size_t index_number() {
+         return I;
+      }
+
+      template <uint64_t Name, std::size_t I, typename First, typename... Rest>
+      static constexpr std::size_t index_number() {
+         if constexpr (static_cast<uint64_t>(First::index_name) == Name) {
+            return I;
+         } else {
+            return index_number<Name, I + 1, Rest...>();
+         }
+      }
+   };
+
+} // namespace eosio
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "asset.hpp"
+#include "name.hpp"
+#include "symbol.hpp"
+
+#include <native/state.hpp>
+
+#include <string>
+#include <type_traits>
+
+namespace eosio {
+
+   inline void print(const char* s) { native::context().console += s; }
+
+   inline void print(const std::string& s) { native::context().console += s; }
+
+   inline void print(name n) { native::context().console += n.to_string(); }
+
+   inline void print(symbol_code s) { native::context().console += s.to_string(); }
+
+   inline void print(const symbol& s) { native::context().console += s.to_string(); }
+
+   inline void print(const asset& a) { native::context().console += a.to_string(); }
+
+   inline void print(bool b) { native::context().console += b ? "true" : "false"; }
+
+   inline void print(char c) { native::context().console += c; }
+
+   template <typename T, std::enable_if_t<std::is_arithmetic_v<T>>* = nullptr>
+   void print(T v) {
+      native::context().console += std::to_string(v);
+   }
+
+   /**
+    * Append every argument to the action's console output
+    */
+   template <typename Arg, typename... Args>
+   void print(Arg&& a, Args&&... args) {
+      print(std::forward<Arg>(a));
+      if constexpr (sizeof...(Args) > 0) {
+         print(std::forward<Args>(args)...);
+      }
+   }
+
+   template <typename... Args>
+   void print_f(const char* s, Args... args) {
+      print(s, args...);
+   }
+
+} // namespace eosio
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "datastream.hpp"
+
+#include <boost/preprocessor/seq/for_each.hpp>
+
+#define EOSLIB_REFLECT_MEMBER_OP(r, OP, elem) \
+   OP t.elem
+
+/**
+ * Define the serialization of a struct explicitly, for types that are not
+ * plain aggregates. Taking datastream<Stream> rather than any stream makes
+ * these more specialized than the aggregate operators in datastream.hpp.
+ */
+#define EOSLIB_SERIALIZE(TYPE, MEMBERS)                                            \
+   template <typename Stream>                                                      \
+   friend eosio::datastream<Stream>& operator<<(eosio::datastream<Stream>& ds, const TYPE& t) { \
+      return ds BOOST_PP_SEQ_FOR_EACH(EOSLIB_REFLECT_MEMBER_OP, <<, MEMBERS);      \
+   }                                                                               \
+   template <typename Stream>                                                      \
+   friend eosio::datastream<Stream>& operator>>(eosio::datastream<Stream>& ds, TYPE& t) { \
+      return ds BOOST_PP_SEQ_FOR_EACH(EOSLIB_REFLECT_MEMBER_OP, >>, MEMBERS);      \
+   }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "check.hpp"
+#include "time.hpp"
+
+#include <native/state.hpp>
+
+namespace eosio {
+
+   /**
+    * Time of the block the current transaction is in
+    */
+   inline time_point current_time_point() { return time_point(microseconds(native::state().now_us)); }
+
+   inline time_point_sec current_time_point_sec() { return time_point_sec(current_time_point()); }
+
+   inline uint32_t current_block_number() { return native::state().block_num; }
+
+   /**
+    * Abort the current action; in native builds this fails the transaction
+    */
+   [[noreturn]] inline void eosio_exit(int32_t code) {
+      throw native::chain_error("eosio_exit called with code " + std::to_string(code));
+   }
+
+} // namespace eosio
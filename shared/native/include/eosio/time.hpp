@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace eosio {
+
+   class microseconds {
+   public:
+      explicit constexpr microseconds(int64_t c = 0) : _count(c) {}
+
+      static constexpr microseconds maximum() { return microseconds(0x7fffffffffffffffll); }
+
+      friend constexpr microseconds operator+(const microseconds& l, const microseconds& r) { return microseconds(l._count + r._count); }
+      friend constexpr microseconds operator-(const microseconds& l, const microseconds& r) { return microseconds(l._count - r._count); }
+
+      constexpr bool operator==(const microseconds& c) const { return _count == c._count; }
+      constexpr bool operator!=(const microseconds& c) const { return _count != c._count; }
+      friend constexpr bool operator>(const microseconds& a, const microseconds& b) { return a._count > b._count; }
+      friend constexpr bool operator>=(const microseconds& a, const microseconds& b) { return a._count >= b._count; }
+      friend constexpr bool operator<(const microseconds& a, const microseconds& b) { return a._count < b._count; }
+      friend constexpr bool operator<=(const microseconds& a, const microseconds& b) { return a._count <= b._count; }
+
+      constexpr microseconds& operator+=(const microseconds& c) {
+         _count += c._count;
+         return *this;
+      }
+
+      constexpr microseconds& operator-=(const microseconds& c) {
+         _count -= c._count;
+         return *this;
+      }
+
+      constexpr int64_t count() const { return _count; }
+
+      constexpr int64_t to_seconds() const { return _count / 1000000; }
+
+      int64_t _count;
+   };
+
+   inline constexpr microseconds seconds(int64_t s) { return microseconds(s * 1000000); }
+   inline constexpr microseconds milliseconds(int64_t s) { return microseconds(s * 1000); }
+   inline constexpr microseconds minutes(int64_t m) { return seconds(60 * m); }
+   inline constexpr microseconds hours(int64_t h) { return minutes(60 * h); }
+   inline constexpr microseconds days(int64_t d) { return hours(24 * d); }
+
+   /**
+    * High resolution time point in microseconds since the epoch
+    */
+   class time_point {
+   public:
+      constexpr explicit time_point(microseconds e = microseconds()) : elapsed(e) {}
+
+      constexpr const microseconds& time_since_epoch() const { return elapsed; }
+
+      constexpr uint32_t sec_since_epoch() const { return uint32_t(elapsed.count() / 1000000); }
+
+      constexpr bool operator>(const time_point& t) const { return elapsed._count > t.elapsed._count; }
+      constexpr bool operator>=(const time_point& t) const { return elapsed._count >= t.elapsed._count; }
+      constexpr bool operator<(const time_point& t) const { return elapsed._count < t.elapsed._count; }
+      constexpr bool operator<=(const time_point& t) const { return elapsed._count <= t.elapsed._count; }
+      constexpr bool operator==(const time_point& t) const { return elapsed._count == t.elapsed._count; }
+      constexpr bool operator!=(const time_point& t) const { return elapsed._count != t.elapsed._count; }
+
+      constexpr time_point& operator+=(const microseconds& m) {
+         elapsed += m;
+         return *this;
+      }
+
+      constexpr time_point& operator-=(const microseconds& m) {
+         elapsed -= m;
+         return *this;
+      }
+
+      constexpr time_point operator+(const microseconds& m) const { return time_point(elapsed + m); }
+      constexpr time_point operator+(const time_point& m) const { return time_point(elapsed + m.elapsed); }
+      constexpr time_point operator-(const microseconds& m) const { return time_point(elapsed - m); }
+      constexpr microseconds operator-(const time_point& m) const { return microseconds(elapsed.count() - m.elapsed.count()); }
+
+      microseconds elapsed;
+   };
+
+   /**
+    * Time point with second resolution, as stored in most tables
+    */
+   class time_point_sec {
+   public:
+      constexpr time_point_sec() : utc_seconds(0) {}
+
+      constexpr explicit time_point_sec(uint32_t seconds) : utc_seconds(seconds) {}
+
+      constexpr time_point_sec(const time_point& t) : utc_seconds(uint32_t(t.time_since_epoch().count() / 1000000ll)) {}
+
+      static constexpr time_point_sec maximum() { return time_point_sec(0xffffffff); }
+      static constexpr time_point_sec min() { return time_point_sec(0); }
+
+      constexpr operator time_point() const { return time_point(eosio::seconds(utc_seconds)); }
+
+      constexpr uint32_t sec_since_epoch() const { return utc_seconds; }
+
+      constexpr time_point_sec operator=(const eosio::time_point& t) {
+         utc_seconds = uint32_t(t.time_since_epoch().count() / 1000000ll);
+         return *this;
+      }
+
+      friend constexpr bool operator<(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds < b.utc_seconds; }
+      friend constexpr bool operator>(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds > b.utc_seconds; }
+      friend constexpr bool operator<=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds <= b.utc_seconds; }
+      friend constexpr bool operator>=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds >= b.utc_seconds; }
+      friend constexpr bool operator==(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds == b.utc_seconds; }
+      friend constexpr bool operator!=(const time_point_sec& a, const time_point_sec& b) { return a.utc_seconds != b.utc_seconds; }
+
+      constexpr time_point_sec& operator+=(uint32_t m) {
+         utc_seconds += m;
+         return *this;
+      }
+
+      constexpr time_point_sec& operator+=(microseconds m) {
+         utc_seconds += m.to_seconds();
+         return *this;
+      }
+
+      constexpr time_point_sec& operator-=(uint32_t m) {
+         utc_seconds -= m;
+         return *this;
+      }
+
+      constexpr time_point_sec& operator-=(microseconds m) {
+         utc_seconds -= m.to_seconds();
+         return *this;
+      }
+
+      constexpr time_point_sec operator+(uint32_t offset) const { return time_point_sec(utc_seconds + offset); }
+      constexpr time_point_sec operator-(uint32_t offset) const { return time_point_sec(utc_seconds - offset); }
+
+      friend constexpr time_point operator+(const time_point_sec& t, const microseconds& m) { return time_point(t) + m; }
+      friend constexpr time_point operator-(const time_point_sec& t, const microseconds& m) { return time_point(t) - m; }
+      friend constexpr microseconds operator-(const time_point_sec& t, const time_point_sec& m) { return time_point(t) - time_point(m); }
+      friend constexpr microseconds operator-(const time_point& t, const time_point_sec& m) { return t - time_point(m); }
+
+      uint32_t utc_seconds;
+   };
+
+   template <typename DataStream>
+   DataStream& operator<<(DataStream& ds, const microseconds& m) {
+      ds.write(reinterpret_cast<const char*>(&m._count), sizeof(m._count));
+      return ds;
+   }
+
+   template <typename DataStream>
+   DataStream& operator>>(DataStream& ds, microseconds& m) {
+      ds.read(reinterpret_cast<char*>(&m._count), sizeof(m._count));
+      return ds;
+   }
+
+   template <typename DataStream>
+   DataStream& operator<<(DataStream& ds, const time_point& t) {
+      return ds << t.elapsed;
+   }
+
+   template <typename DataStream>
+   DataStream& operator>>(DataStream& ds, time_point& t) {
+      return ds >> t.elapsed;
+   }
+
+   template <typename DataStream>
+   DataStream& operator<<(DataStream& ds, const time_point_sec& t) {
+      ds.write(reinterpret_cast<const char*>(&t.utc_seconds), sizeof(t.utc_seconds));
+      return ds;
+   }
+
+   template <typename DataStream>
+   DataStream& operator>>(DataStream& ds, time_point_sec& t) {
+      ds.read(reinterpret_cast<char*>(&t.utc_seconds), sizeof(t.utc_seconds));
+      return ds;
+   }
+
+} // namespace eosio
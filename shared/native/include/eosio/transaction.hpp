@@ -0,0 +1,56 @@
+#pragma once
+
+#include "action.hpp"
+#include "serialize.hpp"
+#include "system.hpp"
+#include "time.hpp"
+#include "varint.hpp"
+
+#include <native/state.hpp>
+
+#include <vector>
+
+namespace eosio {
+
+   struct transaction_header {
+      transaction_header(time_point_sec exp = time_point_sec(current_time_point()) + 60) : expiration(exp) {}
+
+      time_point_sec expiration;
+      uint16_t ref_block_num = 0;
+      uint32_t ref_block_prefix = 0;
+      unsigned_int max_net_usage_words = 0UL;
+      uint8_t max_cpu_usage_ms = 0UL;
+      unsigned_int delay_sec = 0UL;
+
+      EOSLIB_SERIALIZE(transaction_header, (expiration)(ref_block_num)(ref_block_prefix)(max_net_usage_words)(max_cpu_usage_ms)(delay_sec))
+   };
+
+   struct transaction : public transaction_header {
+      transaction(time_point_sec exp = time_point_sec(current_time_point()) + 60) : transaction_header(exp) {}
+
+      std::vector<action> context_free_actions;
+      std::vector<action> actions;
+      std::vector<std::pair<uint16_t, std::vector<char>>> transaction_extensions;
+
+      template <typename DataStream>
+      friend DataStream& operator<<(DataStream& ds, const transaction& t) {
+         return ds << static_cast<const transaction_header&>(t) << t.context_free_actions << t.actions << t.transaction_extensions;
+      }
+
+      template <typename DataStream>
+      friend DataStream& operator>>(DataStream& ds, transaction& t) {
+         return ds >> static_cast<transaction_header&>(t) >> t.context_free_actions >> t.actions >> t.transaction_extensions;
+      }
+   };
+
+   /**
+    * Reference block of the current transaction; the native chain uses the
+    * current block, so the values only need to be stable within a test
+    */
+   inline int tapos_block_num() { return static_cast<uint16_t>(native::state().block_num); }
+
+   inline int tapos_block_prefix() { return static_cast<int>(native::state().block_num * 2654435761u); }
+
+   inline uint32_t expiration() { return current_time_point_sec().sec_since_epoch() + 60; }
+
+} // namespace eosio
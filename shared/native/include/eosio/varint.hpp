@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace eosio {
+
+   /**
+    * Variable-length unsigned 32-bit integer, used for container sizes
+    */
+   struct unsigned_int {
+      unsigned_int(uint32_t v = 0) : value(v) {}
+
+      template <typename T>
+      unsigned_int(T v) : value(static_cast<uint32_t>(v)) {}
+
+      operator uint32_t() const { return value; }
+
+      friend bool operator==(const unsigned_int& i, const uint32_t& v) { return i.value == v; }
+      friend bool operator!=(const unsigned_int& i, const uint32_t& v) { return i.value != v; }
+
+      uint32_t value;
+   };
+
+} // namespace eosio
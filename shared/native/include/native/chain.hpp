@@ -0,0 +1,242 @@
+#pragma once
+
+#include <eosio/asset.hpp>
+#include <eosio/eosio.hpp>
+#include <eosio/system.hpp>
+#include <eosio/time.hpp>
+#include <eosio/transaction.hpp>
+#include <native/state.hpp>
+
+#include <initializer_list>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace native {
+
+   /**
+    * Exception predicate for BOOST_CHECK_EXCEPTION: the error message
+    * contains `text`
+    */
+   struct message_contains {
+      std::string text;
+
+      bool operator()(const std::exception& e) const { return std::string(e.what()).find(text) != std::string::npos; }
+   };
+
+   /**
+    * Test driver for the native chain: accounts, contract entry points, a
+    * controllable clock, transactions and table reads. Constructing a tester
+    * resets the chain, so every test starts from an empty one.
+    */
+   class tester {
+   public:
+      // 2024-01-01T00:00:00, so time math in contracts has a realistic base
+      static constexpr int64_t genesis_us = 1704067200LL * 1000000;
+      static constexpr int64_t block_interval_us = 500000;
+
+      tester() {
+         state() = chain_state{};
+         state().now_us = genesis_us;
+      }
+
+      ~tester() { state() = chain_state{}; }
+
+      tester(const tester&) = delete;
+      tester& operator=(const tester&) = delete;
+
+      void create_account(eosio::name account) {
+         if (!state().accounts.insert(account.value).second) {
+            throw chain_error("account name already exists: " + account.to_string());
+         }
+      }
+
+      void create_accounts(std::initializer_list<eosio::name> accounts) {
+         for (auto account : accounts) create_account(account);
+      }
+
+      /**
+       * Deploy a contract: `entry` is its apply function, the one the CDT
+       * generates or the contract defines, or one made with NATIVE_APPLY
+       */
+      void set_code(eosio::name account, apply_fn entry) {
+         if (!state().accounts.count(account.value)) {
+            throw chain_error("account does not exist: " + account.to_string());
+         }
+         state().code[account.value] = entry;
+      }
+
+      /**
+       * Add contract@eosio.code to account@active, letting `contract` send
+       * inline actions authorized by `account`
+       */
+      void grant_code(eosio::name account, eosio::name contract) { state().code_grants.emplace(account.value, contract.value); }
+
+      /**
+       * Push a transaction with one action authorized by actor@active
+       * @return traces of every action run, in execution order
+       */
+      template <typename... Args>
+      std::vector<action_trace> push_action(eosio::name contract, eosio::name act, eosio::name actor, Args&&... args) {
+         return push_action(contract, act, std::vector<eosio::permission_level>{{actor, eosio::name("active")}}, std::forward<Args>(args)...);
+      }
+
+      template <typename... Args>
+      std::vector<action_trace> push_action(eosio::name contract, eosio::name act, std::vector<eosio::permission_level> auths, Args&&... args) {
+         eosio::action a(std::move(auths), contract, act, std::tuple<std::decay_t<Args>...>(std::forward<Args>(args)...));
+         return push_transaction({a});
+      }
+
+      /**
+       * Push action data as given, for actions with a hand-decoded layout
+       */
+      std::vector<action_trace> push_raw(eosio::name contract, eosio::name act, eosio::name actor, bytes data) {
+         eosio::action a;
+         a.account = contract;
+         a.name = act;
+         a.authorization.emplace_back(actor, eosio::name("active"));
+         a.data = std::move(data);
+         return push_transaction({a});
+      }
+
+      std::vector<action_trace> push_transaction(const std::vector<eosio::action>& actions) {
+         std::vector<action_record> records;
+         for (const auto& a : actions) records.push_back(a.to_record());
+         return apply_transaction(records);
+      }
+
+      /**
+       * Push a transaction packed by a client. It must not have expired;
+       * signatures and TaPoS are not checked natively.
+       */
+      std::vector<action_trace> push_packed(const char* data, size_t size) {
+         auto trx = eosio::unpack<eosio::transaction>(data, size);
+         if (trx.expiration.sec_since_epoch() <= now().sec_since_epoch()) throw chain_error("expired transaction");
+         if (!trx.context_free_actions.empty()) throw chain_error("context-free actions are not supported natively");
+         return push_transaction(trx.actions);
+      }
+
+      /**
+       * Call a read-only action and decode its return value
+       */
+      template <typename R, typename... Args>
+      R call(eosio::name contract, eosio::name act, Args&&... args) {
+         auto traces = push_action(contract, act, std::vector<eosio::permission_level>{}, std::forward<Args>(args)...);
+         return eosio::unpack<R>(traces.front().return_value);
+      }
+
+      eosio::time_point now() const { return eosio::time_point(eosio::microseconds(state().now_us)); }
+
+      void set_time(eosio::time_point t) { state().now_us = t.time_since_epoch().count(); }
+
+      void advance_time(eosio::microseconds d) { state().now_us += d.count(); }
+
+      /// Move to a later block, advancing the clock by the block interval for each
+      void produce_blocks(uint32_t count = 1) {
+         state().block_num += count;
+         state().now_us += int64_t(count) * block_interval_us;
+      }
+
+      /**
+       * Decode a table row, or nothing if it does not exist. T only needs to
+       * match the leading fields of the stored row.
+       */
+      template <typename T>
+      std::optional<T> get_row(eosio::name code, uint64_t scope, eosio::name table, uint64_t primary) const {
+         const auto* r = state().db.find({code.value, scope, table.value}, primary);
+         if (!r) return std::nullopt;
+         return eosio::unpack<T>(r->data);
+      }
+
+      template <typename T>
+      std::optional<T> get_singleton(eosio::name code, uint64_t scope, eosio::name table) const {
+         return get_row<T>(code, scope, table, table.value);
+      }
+
+      /// Every row of a table, in primary key order
+      template <typename T>
+      std::vector<T> get_table(eosio::name code, uint64_t scope, eosio::name table) const {
+         std::vector<T> result;
+         auto t = state().db.all_tables().find({code.value, scope, table.value});
+         if (t == state().db.all_tables().end()) return result;
+         for (const auto& [primary, r] : t->second.rows) result.push_back(eosio::unpack<T>(r.data));
+         return result;
+      }
+
+      size_t row_count(eosio::name code, uint64_t scope, eosio::name table) const {
+         auto t = state().db.all_tables().find({code.value, scope, table.value});
+         return t == state().db.all_tables().end() ? 0 : t->second.rows.size();
+      }
+
+      /// Estimated RAM billed to `account` for table rows
+      int64_t ram_usage(eosio::name account) const { return state().db.ram_usage(account.value); }
+
+      /**
+       * Actions delivered to `account`, which has no code, in delivery order
+       */
+      std::vector<eosio::action> mailbox(eosio::name account) const {
+         std::vector<eosio::action> result;
+         auto queued = state().mailbox.find(account.value);
+         if (queued == state().mailbox.end()) return result;
+         for (const auto& record : queued->second) result.push_back(eosio::action::from_record(record));
+         return result;
+      }
+
+      /// Remove and return the oldest action delivered to `account`
+      eosio::action pop_mailbox(eosio::name account) {
+         auto& queued = state().mailbox[account.value];
+         if (queued.empty()) throw chain_error("no action delivered to " + account.to_string());
+         auto act = eosio::action::from_record(queued.front());
+         queued.erase(queued.begin());
+         return act;
+      }
+
+      void clear_mailbox(eosio::name account) { state().mailbox.erase(account.value); }
+   };
+
+} // namespace native
+
+namespace eosio {
+
+   // Readable values in Boost.Test failure messages. Written through
+   // ostream::write, since eosio's datastream operators would make << ambiguous here
+
+   inline std::ostream& boost_test_print_type(std::ostream& os, const name& n) {
+      auto s = n.to_string();
+      return os.write(s.data(), s.size());
+   }
+
+   inline std::ostream& boost_test_print_type(std::ostream& os, const symbol& sym) {
+      auto s = sym.to_string();
+      return os.write(s.data(), s.size());
+   }
+
+   inline std::ostream& boost_test_print_type(std::ostream& os, const asset& a) {
+      auto s = a.to_string();
+      return os.write(s.data(), s.size());
+   }
+
+   inline std::ostream& boost_test_print_type(std::ostream& os, const time_point& t) {
+      auto s = std::to_string(t.time_since_epoch().count()) + "us";
+      return os.write(s.data(), s.size());
+   }
+
+} // namespace eosio
+
+/**
+ * Define a contract entry point with the dispatch the CDT generates for
+ * contracts that do not write their own apply
+ */
+#define NATIVE_APPLY(FN, TYPE, MEMBERS)                                                  \
+   void FN(uint64_t receiver, uint64_t code, uint64_t action) {                          \
+      if (code == receiver) {                                                            \
+         switch (action) {                                                               \
+            EOSIO_DISPATCH_HELPER(TYPE, MEMBERS)                                         \
+            default:                                                                     \
+               eosio::check(false, "unknown action");                                    \
+         }                                                                               \
+      }                                                                                  \
+   }
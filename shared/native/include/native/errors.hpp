@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+namespace native {
+
+   /**
+    * Base of every failure the native chain reports. Throwing one out of an
+    * action aborts the whole transaction and rolls its writes back.
+    */
+   struct chain_error : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   /// A contract check() failed; what() is the contract's message
+   struct assert_error : chain_error {
+      using chain_error::chain_error;
+   };
+
+   /// An action or inline action lacked a required authority
+   struct auth_error : chain_error {
+      using chain_error::chain_error;
+   };
+
+} // namespace native
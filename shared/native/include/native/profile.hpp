@@ -0,0 +1,116 @@
+#pragma once
+
+#include <native/state.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Collector for the section markers of contracts built with -DDBLTZ_PROFILE
+ * (see shared/core/profile.hpp). Each section's wall time is kept under
+ * the action that ran it and the path of sections enclosing it, so one
+ * action's cost breaks down into its table reads, writes and sends.
+ */
+namespace native {
+
+   class profiler {
+   public:
+      struct cost {
+         uint64_t calls = 0;
+         int64_t total_ns = 0;
+         int64_t self_ns = 0; // total less the subsections
+      };
+
+      // Sections in the order first seen, keyed by path, e.g. "receiverand/settle/roll"
+      using sections = std::vector<std::pair<std::string, cost>>;
+
+      void enter(const char* section) {
+         if (open_.empty()) action_ = current_action();
+         std::string path = open_.empty() ? section : open_.back().path + "/" + section;
+         find(find(actions_, action_), path); // listed in the order sections are entered
+         open_.push_back({std::move(path), now_ns(), 0});
+      }
+
+      void leave() {
+         if (open_.empty()) return;
+         auto f = std::move(open_.back());
+         open_.pop_back();
+         int64_t elapsed = now_ns() - f.start_ns;
+
+         auto& c = find(find(actions_, action_), f.path);
+         c.calls++;
+         c.total_ns += elapsed;
+         c.self_ns += elapsed - f.child_ns;
+         if (!open_.empty()) open_.back().child_ns += elapsed;
+      }
+
+      /// Costs by action, "receiver::action", in the order first seen
+      const std::vector<std::pair<std::string, sections>>& actions() const { return actions_; }
+
+      bool empty() const { return actions_.empty(); }
+
+      void clear() {
+         actions_.clear();
+         open_.clear();
+      }
+
+      /// Print each action's sections as an indented tree, with their share of the action
+      void write(FILE* out) const {
+         for (const auto& [action, secs] : actions_) {
+            int64_t action_ns = 0;
+            for (const auto& [path, c] : secs) {
+               if (path.find('/') == std::string::npos) action_ns += c.total_ns;
+            }
+
+            std::fprintf(out, "\n%s\n  %-36s %10s %12s %12s %7s\n", action.c_str(), "section", "calls", "total us",
+                         "self us", "self %");
+            for (const auto& [path, c] : secs) {
+               size_t depth = size_t(std::count(path.begin(), path.end(), '/'));
+               auto label = std::string(2 * depth, ' ') + path.substr(path.rfind('/') + 1);
+               std::fprintf(out, "  %-36s %10llu %12.1f %12.1f %6.1f%%\n", label.c_str(), (unsigned long long)c.calls,
+                            double(c.total_ns) / 1000, double(c.self_ns) / 1000,
+                            action_ns ? 100.0 * double(c.self_ns) / double(action_ns) : 0.0);
+            }
+         }
+      }
+
+   private:
+      struct frame {
+         std::string path;
+         int64_t start_ns;
+         int64_t child_ns;
+      };
+
+      static int64_t now_ns() {
+         return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+      }
+
+      static std::string current_action() {
+         if (!in_action()) return "(outside actions)";
+         const auto& ctx = context();
+         return to_name_string(ctx.receiver) + "::" + to_name_string(ctx.act->name);
+      }
+
+      template <typename T>
+      static T& find(std::vector<std::pair<std::string, T>>& entries, const std::string& key) {
+         for (auto& [k, v] : entries) {
+            if (k == key) return v;
+         }
+         return entries.emplace_back(key, T{}).second;
+      }
+
+      std::vector<std::pair<std::string, sections>> actions_;
+      std::vector<frame> open_;
+      std::string action_;
+   };
+
+   inline profiler& profile() {
+      static profiler p;
+      return p;
+   }
+
+} // namespace native
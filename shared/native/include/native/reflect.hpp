@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Field reflection for plain aggregates, so table rows and action structs
+ * serialize without EOSLIB_SERIALIZE, the way the CDT abi generator sees them.
+ * Fields are counted by probing brace initialization and visited through
+ * structured bindings, in declaration order.
+ */
+namespace native::reflect {
+
+   constexpr std::size_t max_fields = 24;
+
+   // Converts to any field type, to probe how many initializers T accepts
+   struct any_field {
+      std::size_t index;
+
+      template <typename Type>
+      constexpr operator Type&() const&& noexcept;
+   };
+
+   template <typename T, std::size_t... I>
+   constexpr bool brace_constructible(std::index_sequence<I...>) {
+      return requires { T{any_field{I}...}; };
+   }
+
+   template <typename T, std::size_t N = max_fields>
+   constexpr std::size_t field_count() {
+      if constexpr (N == 0) {
+         return 0;
+      } else if constexpr (brace_constructible<T>(std::make_index_sequence<N>{})) {
+         return N;
+      } else {
+         return field_count<T, N - 1>();
+      }
+   }
+
+   template <typename T>
+   struct is_std_array : std::false_type {};
+
+   template <typename T, std::size_t N>
+   struct is_std_array<std::array<T, N>> : std::true_type {};
+
+   /// Aggregates serialized field by field
+   template <typename T>
+   constexpr bool is_reflectable_v = std::is_class_v<T> && std::is_aggregate_v<T> && !is_std_array<T>::value;
+
+   /**
+    * Call `f` on each field of aggregate `v`, in declaration order
+    */
+   template <typename T, typename F>
+   constexpr void for_each_field(T& v, F&& f) {
+      constexpr std::size_t count = field_count<std::remove_cv_t<T>>();
+      static_assert(count > 0 && count <= max_fields, "aggregate has no fields or too many fields to reflect");
+
+      if constexpr (count == 1) {
+         auto& [f0] = v;
+         f(f0);
+      } else if constexpr (count == 2) {
+         auto& [f0, f1] = v;
+         f(f0); f(f1);
+      } else if constexpr (count == 3) {
+         auto& [f0, f1, f2] = v;
+         f(f0); f(f1); f(f2);
+      } else if constexpr (count == 4) {
+         auto& [f0, f1, f2, f3] = v;
+         f(f0); f(f1); f(f2); f(f3);
+      } else if constexpr (count == 5) {
+         auto& [f0, f1, f2, f3, f4] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4);
+      } else if constexpr (count == 6) {
+         auto& [f0, f1, f2, f3, f4, f5] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5);
+      } else if constexpr (count == 7) {
+         auto& [f0, f1, f2, f3, f4, f5, f6] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6);
+      } else if constexpr (count == 8) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7);
+      } else if constexpr (count == 9) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8);
+      } else if constexpr (count == 10) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9);
+      } else if constexpr (count == 11) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10);
+      } else if constexpr (count == 12) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11);
+      } else if constexpr (count == 13) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12);
+      } else if constexpr (count == 14) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13);
+      } else if constexpr (count == 15) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14);
+      } else if constexpr (count == 16) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15);
+      } else if constexpr (count == 17) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16);
+      } else if constexpr (count == 18) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16); f(f17);
+      } else if constexpr (count == 19) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16); f(f17); f(f18);
+      } else if constexpr (count == 20) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16); f(f17); f(f18); f(f19);
+      } else if constexpr (count == 21) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16); f(f17); f(f18); f(f19); f(f20);
+      } else if constexpr (count == 22) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16); f(f17); f(f18); f(f19); f(f20); f(f21);
+      } else if constexpr (count == 23) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16); f(f17); f(f18); f(f19); f(f20); f(f21); f(f22);
+      } else if constexpr (count == 24) {
+         auto& [f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23] = v;
+         f(f0); f(f1); f(f2); f(f3); f(f4); f(f5); f(f6); f(f7); f(f8); f(f9); f(f10); f(f11); f(f12); f(f13); f(f14); f(f15); f(f16); f(f17); f(f18); f(f19); f(f20); f(f21); f(f22); f(f23);
+      }
+   }
+
+} // namespace native::reflect
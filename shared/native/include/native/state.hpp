@@ -0,0 +1,429 @@
+#pragma once
+
+#include <native/errors.hpp>
+#include <eosio/name.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/**
+ * In-process chain state behind the native eosio headers: accounts, a
+ * controllable clock, contract tables with an undo log, RAM accounting and
+ * the inline action queue. There is one chain per process, like the single
+ * VM a contract runs in; native::tester resets it between tests.
+ */
+namespace native {
+
+   using bytes = std::vector<char>;
+
+   /// Contract entry point, same signature as the wasm apply
+   using apply_fn = void (*)(uint64_t receiver, uint64_t code, uint64_t action);
+
+   // RAM nodeos bills per row and per secondary index entry on top of the
+   // packed row; these are estimates for comparing designs, not exact figures
+   inline constexpr int64_t row_overhead_bytes = 112;
+   inline constexpr int64_t secondary_overhead_bytes = 112;
+
+   // Inline actions may nest this deep, as in nodeos
+   inline constexpr uint32_t max_inline_action_depth = 4;
+
+   struct permission_level {
+      uint64_t actor;
+      uint64_t permission;
+
+      friend bool operator==(const permission_level& a, const permission_level& b) {
+         return a.actor == b.actor && a.permission == b.permission;
+      }
+   };
+
+   struct action_record {
+      uint64_t account = 0;
+      uint64_t name = 0;
+      std::vector<permission_level> authorization;
+      bytes data;
+   };
+
+   struct action_trace {
+      uint64_t receiver = 0;
+      action_record act;
+      uint32_t depth = 0;       // 0 for the transaction's own actions
+      bytes return_value;
+      std::string console;
+   };
+
+   struct table_id {
+      uint64_t code;
+      uint64_t scope;
+      uint64_t table;
+
+      friend bool operator<(const table_id& a, const table_id& b) {
+         return std::tie(a.code, a.scope, a.table) < std::tie(b.code, b.scope, b.table);
+      }
+   };
+
+   struct row {
+      bytes data;
+      uint64_t payer = 0;
+      std::vector<uint64_t> secondary; // one key per secondary index, in index order
+
+      int64_t billable_size() const {
+         return int64_t(data.size()) + row_overhead_bytes + int64_t(secondary.size()) * secondary_overhead_bytes;
+      }
+   };
+
+   struct table {
+      std::map<uint64_t, row> rows;
+      std::vector<std::set<std::pair<uint64_t, uint64_t>>> indices; // (secondary key, primary key)
+   };
+
+   /**
+    * Contract tables. Every write made while a transaction runs is logged so
+    * a failed transaction can be rolled back row by row.
+    */
+   class database {
+   public:
+      using ram_callback = void (*)(uint64_t payer, int64_t delta);
+
+      const row* find(const table_id& id, uint64_t primary) const {
+         auto t = tables.find(id);
+         if (t == tables.end()) return nullptr;
+         auto r = t->second.rows.find(primary);
+         return r == t->second.rows.end() ? nullptr : &r->second;
+      }
+
+      std::optional<uint64_t> lower_bound(const table_id& id, uint64_t primary) const {
+         auto t = tables.find(id);
+         if (t == tables.end()) return std::nullopt;
+         auto r = t->second.rows.lower_bound(primary);
+         if (r == t->second.rows.end()) return std::nullopt;
+         return r->first;
+      }
+
+      std::optional<uint64_t> upper_bound(const table_id& id, uint64_t primary) const {
+         auto t = tables.find(id);
+         if (t == tables.end()) return std::nullopt;
+         auto r = t->second.rows.upper_bound(primary);
+         if (r == t->second.rows.end()) return std::nullopt;
+         return r->first;
+      }
+
+      std::optional<uint64_t> previous(const table_id& id, uint64_t primary) const {
+         auto t = tables.find(id);
+         if (t == tables.end()) return std::nullopt;
+         auto r = t->second.rows.lower_bound(primary);
+         if (r == t->second.rows.begin()) return std::nullopt;
+         return (--r)->first;
+      }
+
+      std::optional<uint64_t> last(const table_id& id) const {
+         auto t = tables.find(id);
+         if (t == tables.end() || t->second.rows.empty()) return std::nullopt;
+         return t->second.rows.rbegin()->first;
+      }
+
+      using secondary_entry = std::pair<uint64_t, uint64_t>;
+
+      /// First index entry not less than `entry`
+      std::optional<secondary_entry> secondary_lower_bound(const table_id& id, uint32_t index, secondary_entry entry) const {
+         const auto* idx = find_index(id, index);
+         if (!idx) return std::nullopt;
+         auto e = idx->lower_bound(entry);
+         if (e == idx->end()) return std::nullopt;
+         return *e;
+      }
+
+      /// First index entry greater than `entry`
+      std::optional<secondary_entry> secondary_next(const table_id& id, uint32_t index, secondary_entry entry) const {
+         const auto* idx = find_index(id, index);
+         if (!idx) return std::nullopt;
+         auto e = idx->upper_bound(entry);
+         if (e == idx->end()) return std::nullopt;
+         return *e;
+      }
+
+      /// Last index entry less than `entry`, or the last entry when `entry` is empty
+      std::optional<secondary_entry> secondary_previous(const table_id& id, uint32_t index, std::optional<secondary_entry> entry) const {
+         const auto* idx = find_index(id, index);
+         if (!idx || idx->empty()) return std::nullopt;
+         auto e = entry ? idx->lower_bound(*entry) : idx->end();
+         if (e == idx->begin()) return std::nullopt;
+         return *--e;
+      }
+
+      /**
+       * Insert or replace a row
+       */
+      void store(const table_id& id, uint64_t primary, row r) {
+         auto& t = tables[id];
+         auto existing = t.rows.find(primary);
+         log(id, primary, existing == t.rows.end() ? std::nullopt : std::optional<row>(existing->second));
+         put(t, primary, std::move(r));
+      }
+
+      void remove(const table_id& id, uint64_t primary) {
+         auto t = tables.find(id);
+         if (t == tables.end()) return;
+         auto existing = t->second.rows.find(primary);
+         if (existing == t->second.rows.end()) return;
+         log(id, primary, existing->second);
+         drop(t->second, primary);
+      }
+
+      /// Start logging writes for a transaction
+      void begin() {
+         undo_log.clear();
+         tracking = true;
+      }
+
+      /// Keep the transaction's writes
+      void commit() {
+         undo_log.clear();
+         tracking = false;
+      }
+
+      /// Revert every write since begin(), newest first
+      void rollback() {
+         for (auto e = undo_log.rbegin(); e != undo_log.rend(); ++e) {
+            auto& t = tables[e->id];
+            if (e->before) {
+               put(t, e->primary, std::move(*e->before));
+            } else {
+               drop(t, e->primary);
+            }
+         }
+         undo_log.clear();
+         tracking = false;
+      }
+
+      int64_t ram_usage(uint64_t account) const {
+         auto r = ram.find(account);
+         return r == ram.end() ? 0 : r->second;
+      }
+
+      /// RAM billed to every account together
+      int64_t total_ram_usage() const { return ram_total; }
+
+      const std::map<table_id, table>& all_tables() const { return tables; }
+
+      // Called with every change in an account's billed RAM
+      ram_callback on_ram_change = nullptr;
+
+   private:
+      struct undo_entry {
+         table_id id;
+         uint64_t primary;
+         std::optional<row> before;
+      };
+
+      const std::set<secondary_entry>* find_index(const table_id& id, uint32_t index) const {
+         auto t = tables.find(id);
+         if (t == tables.end() || index >= t->second.indices.size()) return nullptr;
+         return &t->second.indices[index];
+      }
+
+      void log(const table_id& id, uint64_t primary, std::optional<row> before) {
+         if (tracking) undo_log.push_back({id, primary, std::move(before)});
+      }
+
+      void bill(uint64_t payer, int64_t delta) {
+         if (delta == 0) return;
+         ram[payer] += delta;
+         ram_total += delta;
+         if (on_ram_change) on_ram_change(payer, delta);
+      }
+
+      void put(table& t, uint64_t primary, row r) {
+         auto existing = t.rows.find(primary);
+         if (existing != t.rows.end()) {
+            unindex(t, primary, existing->second);
+            bill(existing->second.payer, -existing->second.billable_size());
+         }
+         if (t.indices.size() < r.secondary.size()) t.indices.resize(r.secondary.size());
+         for (size_t i = 0; i < r.secondary.size(); i++) {
+            t.indices[i].emplace(r.secondary[i], primary);
+         }
+         bill(r.payer, r.billable_size());
+         t.rows[primary] = std::move(r);
+      }
+
+      void drop(table& t, uint64_t primary) {
+         auto existing = t.rows.find(primary);
+         if (existing == t.rows.end()) return;
+         unindex(t, primary, existing->second);
+         bill(existing->second.payer, -existing->second.billable_size());
+         t.rows.erase(existing);
+      }
+
+      static void unindex(table& t, uint64_t primary, const row& r) {
+         for (size_t i = 0; i < r.secondary.size(); i++) {
+            t.indices[i].erase({r.secondary[i], primary});
+         }
+      }
+
+      std::map<table_id, table> tables;
+      std::map<uint64_t, int64_t> ram;
+      int64_t ram_total = 0;
+      std::vector<undo_entry> undo_log;
+      bool tracking = false;
+   };
+
+   /**
+    * One action being applied: the receiver currently running it, the
+    * accounts it notified, and the inline actions it queued
+    */
+   struct apply_context {
+      const action_record* act = nullptr;
+      uint64_t receiver = 0;
+      uint32_t depth = 0;
+      bool notification = false;
+      std::vector<uint64_t> notified;
+      std::vector<std::pair<uint64_t, action_record>> inline_actions; // (sender, action)
+      std::map<uint64_t, int64_t> ram_deltas;
+      bytes return_value;
+      std::string console;
+
+      bool has_auth(uint64_t account) const {
+         return std::any_of(act->authorization.begin(), act->authorization.end(),
+                            [&](const permission_level& p) { return p.actor == account; });
+      }
+   };
+
+   struct chain_state {
+      int64_t now_us = 0;
+      uint32_t block_num = 1;
+      std::set<uint64_t> accounts;
+      std::map<uint64_t, apply_fn> code;
+      std::set<std::pair<uint64_t, uint64_t>> code_grants; // (account, contract) with contract@eosio.code in account@active
+      database db;
+      std::vector<apply_context*> stack;
+      std::vector<action_trace> traces;
+      std::map<uint64_t, std::vector<action_record>> mailbox; // actions delivered to accounts without code
+   };
+
+   inline chain_state& state() {
+      static chain_state s;
+      return s;
+   }
+
+   inline std::string to_name_string(uint64_t n) { return eosio::name(n).to_string(); }
+
+   inline apply_context& context() {
+      auto& st = state();
+      if (st.stack.empty()) throw chain_error("no action is executing");
+      return *st.stack.back();
+   }
+
+   inline bool in_action() { return !state().stack.empty(); }
+
+   inline void track_ram(uint64_t payer, int64_t delta) {
+      auto& st = state();
+      if (!st.stack.empty()) st.stack.back()->ram_deltas[payer] += delta;
+   }
+
+   /**
+    * Run an action for its receiver and every account it notifies, then run
+    * the inline actions they queued, depth first
+    */
+   inline void run_action(const action_record& act, uint32_t depth) {
+      auto& st = state();
+      if (!st.accounts.count(act.account)) {
+         throw chain_error("action's receiving account does not exist: " + to_name_string(act.account));
+      }
+      if (depth > max_inline_action_depth) {
+         throw chain_error("max inline action depth per transaction reached");
+      }
+
+      apply_context ctx;
+      ctx.act = &act;
+      ctx.depth = depth;
+      ctx.notified.push_back(act.account);
+
+      for (size_t i = 0; i < ctx.notified.size(); i++) {
+         ctx.receiver = ctx.notified[i];
+         ctx.notification = i > 0;
+         ctx.ram_deltas.clear();
+         ctx.return_value.clear();
+         ctx.console.clear();
+
+         auto code = st.code.find(ctx.receiver);
+         st.stack.push_back(&ctx);
+         try {
+            if (code != st.code.end()) {
+               code->second(ctx.receiver, act.account, act.name);
+            } else if (!ctx.notification) {
+               st.mailbox[act.account].push_back(act);
+            }
+         } catch (...) {
+            st.stack.pop_back();
+            throw;
+         }
+         st.stack.pop_back();
+
+         // A contract may only grow its own RAM, or that of an account that authorized the action
+         for (const auto& [account, delta] : ctx.ram_deltas) {
+            if (delta <= 0 || account == ctx.receiver) continue;
+            if (ctx.notification) {
+               throw chain_error("unprivileged contract cannot increase RAM usage of another account within a notify context: " +
+                                 to_name_string(account));
+            }
+            if (!ctx.has_auth(account)) {
+               throw chain_error("unprivileged contract cannot increase RAM usage of another account that has not authorized the action: " +
+                                 to_name_string(account));
+            }
+         }
+
+         st.traces.push_back({ctx.receiver, act, depth, ctx.return_value, ctx.console});
+      }
+
+      for (const auto& [sender, inline_act] : ctx.inline_actions) {
+         for (const auto& auth : inline_act.authorization) {
+            if (auth.actor != sender && !st.code_grants.count({auth.actor, sender})) {
+               throw auth_error("missing authority of " + to_name_string(auth.actor));
+            }
+         }
+         run_action(inline_act, depth + 1);
+      }
+   }
+
+   /**
+    * Apply a transaction atomically: every action runs, or none of its
+    * writes, inline actions or mailbox deliveries remain
+    * @return traces of every action run, in execution order
+    */
+   inline std::vector<action_trace> apply_transaction(const std::vector<action_record>& actions) {
+      auto& st = state();
+      if (!st.stack.empty()) throw chain_error("cannot push a transaction from inside an action");
+
+      std::map<uint64_t, size_t> mailbox_sizes;
+      for (const auto& [account, queued] : st.mailbox) mailbox_sizes[account] = queued.size();
+
+      st.traces.clear();
+      st.db.on_ram_change = &track_ram;
+      st.db.begin();
+      try {
+         for (const auto& act : actions) {
+            for (const auto& auth : act.authorization) {
+               if (!st.accounts.count(auth.actor)) {
+                  throw auth_error("missing authority of " + to_name_string(auth.actor));
+               }
+            }
+            run_action(act, 0);
+         }
+      } catch (...) {
+         st.db.rollback();
+         for (auto& [account, queued] : st.mailbox) queued.resize(mailbox_sizes[account]);
+         st.traces.clear();
+         throw;
+      }
+      st.db.commit();
+      return std::move(st.traces);
+   }
+
+} // namespace native
@@ -0,0 +1,109 @@
+#include "replayer.hpp"
+#include "workload.hpp"
+
+#include <native/profile.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    const char* const usage =
+        "usage: replay record [options] TRACE     generate a workload trace\n"
+        "         --players N --plays N --hours H --callback-ms MS --drop-percent P\n"
+        "         --transfers N --sweep-every-s S --seed S\n"
+        "       replay info TRACE                 summarize a trace\n"
+        "       replay run TRACE [REPORT]         replay a trace against this build's contracts\n"
+        "       replay diff BASELINE CANDIDATE    compare two reports side by side\n";
+
+    int record(int argc, char** argv) {
+        replay::workload_shape shape;
+        std::string path;
+        for (int i = 0; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                path = arg;
+                continue;
+            }
+            if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+            uint64_t value = std::stoull(argv[++i]);
+            if (arg == "--players") shape.players = uint32_t(value);
+            else if (arg == "--plays") shape.plays = uint32_t(value);
+            else if (arg == "--hours") shape.duration_s = uint32_t(value * 3600);
+            else if (arg == "--callback-ms") shape.callback_ms = uint32_t(value);
+            else if (arg == "--drop-percent") shape.drop_percent = uint32_t(value);
+            else if (arg == "--transfers") shape.transfers = uint32_t(value);
+            else if (arg == "--sweep-every-s") shape.sweep_every_s = uint32_t(value);
+            else if (arg == "--seed") shape.seed = value;
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+        if (path.empty()) throw std::invalid_argument("no trace file given");
+
+        auto t = replay::generate(shape);
+        replay::write_trace(path, t);
+        std::cout << t.events.size() << " events, " << t.accounts.size() << " players, "
+                  << replay::encode(t).size() << " bytes written to " << path << "\n";
+        return 0;
+    }
+
+    int info(const std::string& path) {
+        auto t = replay::read_trace(path);
+        uint64_t counts[5] = {};
+        uint64_t span_us = 0;
+        for (const auto& e : t.events) {
+            counts[size_t(e.kind)]++;
+            if (e.kind == replay::event_kind::advance) span_us += e.value;
+        }
+        std::cout << "players    " << t.accounts.size() << "\n"
+                  << "plays      " << counts[1] << "\n"
+                  << "callbacks  " << counts[2] << "\n"
+                  << "transfers  " << counts[3] << "\n"
+                  << "sweeps     " << counts[4] << "\n"
+                  << "span       " << span_us / 1000000 << " s\n";
+        return 0;
+    }
+
+    int run(const std::string& trace_path, const std::string& report_path) {
+        auto t = replay::read_trace(trace_path);
+        auto tgt = replay::make_target();
+        auto r = replay::run(t, *tgt);
+        if (report_path.empty()) {
+            replay::write_report(std::cout, r);
+        } else {
+            std::ofstream out(report_path);
+            replay::write_report(out, r);
+            if (!out) throw std::runtime_error("cannot write " + report_path);
+
+            // A profiling build also gets its section breakdown on screen
+            native::profile().write(stdout);
+        }
+        return 0;
+    }
+
+    int diff(const std::string& baseline_path, const std::string& candidate_path) {
+        std::ifstream a(baseline_path), b(candidate_path);
+        if (!a) throw std::runtime_error("cannot read " + baseline_path);
+        if (!b) throw std::runtime_error("cannot read " + candidate_path);
+        auto differences = replay::write_diff(std::cout, replay::read_report(a), replay::read_report(b));
+        std::cout << "\n" << differences << " metric(s) differ, wall time excluded\n";
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        std::string command = argc > 1 ? argv[1] : "";
+        if (command == "record") return record(argc - 2, argv + 2);
+        if (command == "info" && argc == 3) return info(argv[2]);
+        if (command == "run" && (argc == 3 || argc == 4)) return run(argv[2], argc == 4 ? argv[3] : "");
+        if (command == "diff" && argc == 4) return diff(argv[2], argv[3]);
+        std::cerr << usage;
+        return 2;
+    } catch (const std::exception& e) {
+        std::cerr << "replay: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,213 @@
+#include "replayer.hpp"
+
+#include <eosio/transaction.hpp>
+#include <native/profile.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <set>
+
+namespace replay {
+
+    namespace {
+
+        // nodeos bills this much NET per transaction on top of its packed size
+        constexpr int64_t base_transaction_net_bytes = 12;
+        // A K1 signature: key type plus 65 bytes
+        constexpr int64_t signature_bytes = 66;
+
+        const char* const kind_names[] = {"advance", "play", "callback", "transfer", "maintain"};
+
+        struct kind_stats {
+            uint64_t count = 0;
+            uint64_t failed = 0;
+            std::vector<int64_t> cpu_ns;
+            int64_t net_bytes = 0;
+            int64_t ram_bytes = 0;
+            std::map<std::string, uint64_t> errors;
+        };
+
+        size_t varint_size(uint64_t v) {
+            size_t n = 1;
+            while (v >= 0x80) {
+                v >>= 7;
+                n++;
+            }
+            return n;
+        }
+
+        int64_t percentile(std::vector<int64_t> values, int p) {
+            if (values.empty()) return 0;
+            std::sort(values.begin(), values.end());
+            return values[(values.size() - 1) * p / 100];
+        }
+
+        /// FNV-1a, enough to tell whether two tables hold the same rows
+        void hash_bytes(uint64_t& h, const void* data, size_t size) {
+            const auto* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; i++) {
+                h ^= p[i];
+                h *= 0x100000001b3ULL;
+            }
+        }
+
+        void add_tables(report& r) {
+            struct digest {
+                uint64_t scopes = 0;
+                uint64_t rows = 0;
+                int64_t bytes = 0;
+                uint64_t hash = 0xcbf29ce484222325ULL;
+            };
+
+            std::map<std::pair<uint64_t, uint64_t>, digest> digests; // (code, table)
+            for (const auto& [id, t] : native::state().db.all_tables()) {
+                if (t.rows.empty()) continue;
+                auto& d = digests[{id.code, id.table}];
+                d.scopes++;
+                for (const auto& [primary, row] : t.rows) {
+                    d.rows++;
+                    d.bytes += row.billable_size();
+                    hash_bytes(d.hash, &id.scope, sizeof(id.scope));
+                    hash_bytes(d.hash, &primary, sizeof(primary));
+                    hash_bytes(d.hash, &row.payer, sizeof(row.payer));
+                    hash_bytes(d.hash, row.data.data(), row.data.size());
+                }
+            }
+
+            for (const auto& [key, d] : digests) {
+                auto prefix = "table." + eosio::name(key.first).to_string() + "." + eosio::name(key.second).to_string();
+                char hash[17];
+                std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)d.hash);
+                r.set(prefix + ".scopes", int64_t(d.scopes));
+                r.set(prefix + ".rows", int64_t(d.rows));
+                r.set(prefix + ".bytes", d.bytes);
+                r.set(prefix + ".hash", hash);
+            }
+        }
+
+        /// Section costs from a DBLTZ_PROFILE build; nothing otherwise
+        void add_profile(report& r) {
+            for (const auto& [action, sections] : native::profile().actions()) {
+                for (const auto& [path, c] : sections) {
+                    auto prefix = "profile." + action + "." + path;
+                    r.set(prefix + ".calls", int64_t(c.calls));
+                    r.set(prefix + ".cpu_total_ns", c.total_ns);
+                    r.set(prefix + ".cpu_self_ns", c.self_ns);
+                }
+            }
+        }
+
+    } // namespace
+
+    int64_t net_usage(const std::vector<eosio::action>& actions) {
+        eosio::transaction trx;
+        trx.actions = actions;
+        auto packed = int64_t(eosio::pack_size(trx));
+
+        // signatures, compression flag, context free data, then the packed transaction itself
+        int64_t size = base_transaction_net_bytes + 1 + signature_bytes + 1 + 1 + int64_t(varint_size(packed)) + packed;
+        return (size + 7) / 8 * 8;
+    }
+
+    report run(const trace& t, target& tgt) {
+        native::tester chain;
+        tgt.setup(chain, t.accounts);
+        tgt.take_requests(chain);
+        native::profile().clear();
+
+        const auto& db = native::state().db;
+
+        kind_stats stats[std::size(kind_names)];
+        std::vector<std::optional<uint64_t>> requests; // the oracle request of each play, if it got one
+        uint64_t orphaned = 0;
+
+        for (const auto& e : t.events) {
+            if (e.kind == event_kind::advance) {
+                chain.advance_time(eosio::microseconds(int64_t(e.value)));
+                continue;
+            }
+
+            eosio::action act;
+            switch (e.kind) {
+            case event_kind::play:
+                act = tgt.play(t.accounts[e.account], e.value);
+                break;
+            case event_kind::callback:
+                if (e.other >= requests.size() || !requests[e.other]) {
+                    orphaned++; // the play failed, so there is nothing to answer
+                    continue;
+                }
+                act = tgt.callback(*requests[e.other], e.value);
+                break;
+            case event_kind::transfer:
+                act = tgt.transfer(t.accounts[e.account], t.accounts[e.other], e.value);
+                break;
+            default:
+                act = tgt.maintain();
+                break;
+            }
+
+            auto& s = stats[size_t(e.kind)];
+            s.count++;
+            s.net_bytes += net_usage({act});
+            int64_t ram_before = db.total_ram_usage();
+
+            auto start = std::chrono::steady_clock::now();
+            try {
+                chain.push_transaction({act});
+            } catch (const native::chain_error& err) {
+                s.failed++;
+                s.errors[err.what()]++;
+            }
+            s.cpu_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            s.ram_bytes += db.total_ram_usage() - ram_before;
+
+            auto sent = tgt.take_requests(chain);
+            if (e.kind == event_kind::play) {
+                requests.push_back(sent.empty() ? std::nullopt : std::optional<uint64_t>(sent.front()));
+            }
+        }
+
+        report r;
+        r.set("target", tgt.name());
+        r.set("events", int64_t(t.events.size()));
+        for (size_t k = 1; k < std::size(kind_names); k++) {
+            const auto& s = stats[k];
+            std::string kind = kind_names[k];
+            int64_t cpu_total = 0;
+            for (auto ns : s.cpu_ns) cpu_total += ns;
+
+            r.set(kind + ".count", int64_t(s.count));
+            r.set(kind + ".failed", int64_t(s.failed));
+            r.set(kind + ".cpu_p50_ns", percentile(s.cpu_ns, 50));
+            r.set(kind + ".cpu_p99_ns", percentile(s.cpu_ns, 99));
+            r.set(kind + ".cpu_total_us", cpu_total / 1000);
+            r.set(kind + ".net_bytes", s.net_bytes);
+            r.set(kind + ".ram_bytes", s.ram_bytes);
+            for (const auto& [message, count] : s.errors) r.set(kind + ".error." + message, int64_t(count));
+        }
+        r.set("callback.orphaned", int64_t(orphaned));
+
+        // RAM of the contract accounts, and of all players together
+        std::set<uint64_t> players;
+        for (auto p : t.accounts) players.insert(p.value);
+        int64_t player_ram = 0;
+        for (auto account : native::state().accounts) {
+            int64_t usage = db.ram_usage(account);
+            if (players.count(account)) {
+                player_ram += usage;
+            } else if (usage != 0) {
+                r.set("ram." + eosio::name(account).to_string(), usage);
+            }
+        }
+        r.set("ram.players", player_ram);
+
+        add_tables(r);
+        add_profile(r);
+        return r;
+    }
+
+} // namespace replay
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "report.hpp"
+#include "target.hpp"
+#include "trace.hpp"
+
+namespace replay {
+
+    /**
+     * Replay `t` against a fresh chain running `tgt`. Each event is one
+     * transaction; the report has, per event kind, the count, failures and
+     * their messages, wall time, estimated NET and RAM change, then the final
+     * RAM per contract and a digest of every table. Contracts built with
+     * DBLTZ_PROFILE add the wall time of each marked section, by action.
+     */
+    report run(const trace& t, target& tgt);
+
+    /**
+     * NET nodeos would bill for a transaction carrying `actions` with one
+     * signature: the packed transaction plus the per-transaction overhead,
+     * rounded up to whole 8-byte words
+     */
+    int64_t net_usage(const std::vector<eosio::action>& actions);
+
+} // namespace replay
@@ -0,0 +1,103 @@
+#include "report.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+
+namespace replay {
+
+    namespace {
+
+        std::optional<int64_t> as_number(const std::string& s) {
+            int64_t v = 0;
+            auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+            if (s.empty() || ec != std::errc() || end != s.data() + s.size()) return std::nullopt;
+            return v;
+        }
+
+        // Wall time varies from run to run, so it never counts as a difference
+        bool is_timing(const std::string& key) { return key.find(".cpu_") != std::string::npos; }
+
+        std::string pad(std::string s, size_t width) {
+            if (s.size() < width) s.resize(width, ' ');
+            return s;
+        }
+
+    } // namespace
+
+    void report::set(const std::string& key, const std::string& value) {
+        auto found = std::find_if(entries.begin(), entries.end(), [&](const auto& e) { return e.first == key; });
+        if (found != entries.end()) {
+            found->second = value;
+        } else {
+            entries.emplace_back(key, value);
+        }
+    }
+
+    std::string report::get(const std::string& key) const {
+        auto found = std::find_if(entries.begin(), entries.end(), [&](const auto& e) { return e.first == key; });
+        return found == entries.end() ? std::string() : found->second;
+    }
+
+    void write_report(std::ostream& out, const report& r) {
+        for (const auto& [key, value] : r.entries) out << key << '\t' << value << '\n';
+    }
+
+    report read_report(std::istream& in) {
+        report r;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty()) continue;
+            auto tab = line.find('\t');
+            if (tab == std::string::npos) throw std::runtime_error("malformed report line: " + line);
+            r.entries.emplace_back(line.substr(0, tab), line.substr(tab + 1));
+        }
+        return r;
+    }
+
+    size_t write_diff(std::ostream& out, const report& baseline, const report& candidate) {
+        std::vector<std::string> keys;
+        for (const auto& e : baseline.entries) keys.push_back(e.first);
+        for (const auto& e : candidate.entries) {
+            if (std::find(keys.begin(), keys.end(), e.first) == keys.end()) keys.push_back(e.first);
+        }
+
+        size_t width = 8;
+        for (const auto& key : keys) width = std::max(width, key.size());
+
+        size_t differences = 0;
+        out << pad("metric", width + 2) << pad("baseline", 20) << pad("candidate", 20) << "change\n";
+        for (const auto& key : keys) {
+            auto a = baseline.get(key);
+            auto b = candidate.get(key);
+
+            std::string change;
+            auto x = as_number(a);
+            auto y = as_number(b);
+            if (x && y) {
+                if (*x != *y) {
+                    char buf[64];
+                    if (*x != 0) {
+                        std::snprintf(buf, sizeof(buf), "%+lld (%+.1f%%)", (long long)(*y - *x), 100.0 * double(*y - *x) / double(*x));
+                    } else {
+                        std::snprintf(buf, sizeof(buf), "%+lld", (long long)(*y - *x));
+                    }
+                    change = buf;
+                }
+            } else if (a != b) {
+                change = "differs";
+            }
+            if (!change.empty() && !is_timing(key) && key != "target") differences++;
+
+            // Long values such as state hashes are shortened to keep the columns aligned
+            auto shorten = [](std::string s) { return s.size() > 18 ? s.substr(0, 16) + ".." : s; };
+            out << pad(key, width + 2) << pad(shorten(a.empty() ? "-" : a), 20) << pad(shorten(b.empty() ? "-" : b), 20) << change << '\n';
+        }
+        return differences;
+    }
+
+} // namespace replay
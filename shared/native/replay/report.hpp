@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace replay {
+
+    /**
+     * Outcome of one replay as flat key/value pairs in a stable order, e.g.
+     * "play.cpu_p50_ns" or "table.gameplay.players.rows". Written one pair
+     * per line, tab separated, so reports from separate builds can be kept
+     * and diffed later.
+     */
+    struct report {
+        std::vector<std::pair<std::string, std::string>> entries;
+
+        void set(const std::string& key, const std::string& value);
+
+        void set(const std::string& key, int64_t value) { set(key, std::to_string(value)); }
+
+        /// Value of `key`, or an empty string
+        std::string get(const std::string& key) const;
+    };
+
+    void write_report(std::ostream& out, const report& r);
+
+    report read_report(std::istream& in);
+
+    /**
+     * Side-by-side comparison: every key of either report with both values
+     * and, for numbers, the change from baseline to candidate
+     * @return number of keys whose values differ, CPU timings excepted
+     */
+    size_t write_diff(std::ostream& out, const report& baseline, const report& candidate);
+
+} // namespace replay
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <native/chain.hpp>
+
+#include <eosio/action.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace replay {
+
+    /**
+     * One contract implementation as seen by the replayer: how to deploy it
+     * and how each kind of trace event maps onto its actions. Every build of
+     * the replay tool links exactly one target, from make_target().
+     */
+    class target {
+    public:
+        virtual ~target() = default;
+
+        /// Name written into reports, e.g. the contract tree it was built from
+        virtual std::string name() const = 0;
+
+        /// Deploy the contracts and fund `players` so they can transfer
+        virtual void setup(native::tester& chain, const std::vector<eosio::name>& players) = 0;
+
+        virtual eosio::action play(eosio::name player, uint64_t nonce) const = 0;
+
+        /// The oracle's answer to a request taken by take_requests()
+        virtual eosio::action callback(uint64_t request, uint64_t random_value) const = 0;
+
+        /// `amount` is in the token's smallest unit
+        virtual eosio::action transfer(eosio::name from, eosio::name to, uint64_t amount) const = 0;
+
+        virtual eosio::action maintain() const = 0;
+
+        /// Randomness requests sent to the oracle since the last call, as the handles callback() takes
+        virtual std::vector<uint64_t> take_requests(native::tester& chain) = 0;
+    };
+
+    std::unique_ptr<target> make_target();
+
+} // namespace replay
@@ -0,0 +1,193 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace replay {
+
+    namespace {
+
+        constexpr char    magic[4] = {'D', 'B', 'R', 'T'};
+        constexpr uint8_t format_version = 1;
+
+        void put_varint(std::vector<char>& out, uint64_t v) {
+            while (v >= 0x80) {
+                out.push_back(char(v | 0x80));
+                v >>= 7;
+            }
+            out.push_back(char(v));
+        }
+
+        void put_fixed(std::vector<char>& out, uint64_t v) {
+            for (int i = 0; i < 8; i++) out.push_back(char(v >> (8 * i)));
+        }
+
+        class reader {
+        public:
+            explicit reader(const std::vector<char>& bytes) : bytes(bytes) {}
+
+            bool done() const { return pos == bytes.size(); }
+
+            uint8_t byte() {
+                if (pos >= bytes.size()) throw std::runtime_error("trace is truncated");
+                return uint8_t(bytes[pos++]);
+            }
+
+            uint64_t varint() {
+                uint64_t v = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    uint8_t b = byte();
+                    v |= uint64_t(b & 0x7f) << shift;
+                    if (!(b & 0x80)) return v;
+                }
+                throw std::runtime_error("trace has an overlong varint");
+            }
+
+            uint64_t fixed() {
+                uint64_t v = 0;
+                for (int i = 0; i < 8; i++) v |= uint64_t(byte()) << (8 * i);
+                return v;
+            }
+
+        private:
+            const std::vector<char>& bytes;
+            size_t pos = 0;
+        };
+
+    } // namespace
+
+    void recorder::advance_to(uint64_t time_us) {
+        if (time_us <= now_us) return;
+        recorded.events.push_back({event_kind::advance, 0, 0, time_us - now_us});
+        now_us = time_us;
+    }
+
+    uint32_t recorder::play(eosio::name player, uint64_t nonce) {
+        recorded.events.push_back({event_kind::play, account_index(player), 0, nonce});
+        return plays++;
+    }
+
+    void recorder::callback(uint32_t play, uint64_t random_value) {
+        if (play >= plays) throw std::invalid_argument("callback for a play not recorded yet");
+        recorded.events.push_back({event_kind::callback, 0, play, random_value});
+    }
+
+    void recorder::transfer(eosio::name from, eosio::name to, uint64_t amount) {
+        recorded.events.push_back({event_kind::transfer, account_index(from), account_index(to), amount});
+    }
+
+    void recorder::maintain() { recorded.events.push_back({event_kind::maintain}); }
+
+    uint32_t recorder::account_index(eosio::name account) {
+        auto& accounts = recorded.accounts;
+        auto found = std::find(accounts.begin(), accounts.end(), account);
+        if (found != accounts.end()) return uint32_t(found - accounts.begin());
+        accounts.push_back(account);
+        return uint32_t(accounts.size() - 1);
+    }
+
+    std::vector<char> encode(const trace& t) {
+        std::vector<char> out(std::begin(magic), std::end(magic));
+        out.push_back(char(format_version));
+
+        put_varint(out, t.accounts.size());
+        for (auto account : t.accounts) put_fixed(out, account.value);
+
+        put_varint(out, t.events.size());
+        for (const auto& e : t.events) {
+            out.push_back(char(e.kind));
+            switch (e.kind) {
+            case event_kind::advance:
+                put_varint(out, e.value);
+                break;
+            case event_kind::play:
+                put_varint(out, e.account);
+                put_varint(out, e.value);
+                break;
+            case event_kind::callback:
+                // Random values use all 64 bits, so a varint would only make them longer
+                put_varint(out, e.other);
+                put_fixed(out, e.value);
+                break;
+            case event_kind::transfer:
+                put_varint(out, e.account);
+                put_varint(out, e.other);
+                put_varint(out, e.value);
+                break;
+            case event_kind::maintain:
+                break;
+            }
+        }
+        return out;
+    }
+
+    trace decode(const std::vector<char>& bytes) {
+        if (bytes.size() < sizeof(magic) + 1 || std::memcmp(bytes.data(), magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("not a workload trace");
+        }
+
+        reader in(bytes);
+        for (size_t i = 0; i < sizeof(magic); i++) in.byte();
+        if (in.byte() != format_version) throw std::runtime_error("unsupported trace version");
+
+        trace t;
+        t.accounts.resize(in.varint());
+        for (auto& account : t.accounts) account = eosio::name(in.fixed());
+
+        uint64_t count = in.varint();
+        t.events.reserve(count);
+        for (uint64_t i = 0; i < count; i++) {
+            event e;
+            e.kind = event_kind(in.byte());
+            switch (e.kind) {
+            case event_kind::advance:
+                e.value = in.varint();
+                break;
+            case event_kind::play:
+                e.account = uint32_t(in.varint());
+                e.value = in.varint();
+                break;
+            case event_kind::callback:
+                e.other = uint32_t(in.varint());
+                e.value = in.fixed();
+                break;
+            case event_kind::transfer:
+                e.account = uint32_t(in.varint());
+                e.other = uint32_t(in.varint());
+                e.value = in.varint();
+                break;
+            case event_kind::maintain:
+                break;
+            default:
+                throw std::runtime_error("unknown trace event kind " + std::to_string(unsigned(e.kind)));
+            }
+            if ((e.kind == event_kind::play || e.kind == event_kind::transfer) && e.account >= t.accounts.size()) {
+                throw std::runtime_error("trace event refers to an unknown account");
+            }
+            if (e.kind == event_kind::transfer && e.other >= t.accounts.size()) {
+                throw std::runtime_error("trace event refers to an unknown account");
+            }
+            t.events.push_back(e);
+        }
+        if (!in.done()) throw std::runtime_error("trailing bytes after the last trace event");
+        return t;
+    }
+
+    void write_trace(const std::string& path, const trace& t) {
+        auto bytes = encode(t);
+        std::ofstream out(path, std::ios::binary);
+        out.write(bytes.data(), std::streamsize(bytes.size()));
+        if (!out) throw std::runtime_error("cannot write " + path);
+    }
+
+    trace read_trace(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("cannot read " + path);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return decode(bytes);
+    }
+
+} // namespace replay
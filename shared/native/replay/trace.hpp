@@ -0,0 +1,73 @@
+#pragma once
+
+#include <eosio/name.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Workload traces: the plays, oracle callbacks and transfers of a stretch of
+ * traffic, independent of either contract's action layout, so one trace can
+ * be replayed against both implementations
+ */
+namespace replay {
+
+    enum class event_kind : uint8_t {
+        advance  = 0, // value: microseconds to move the clock forward
+        play     = 1, // account: player; value: nonce
+        callback = 2, // other: index of the play answered; value: random value
+        transfer = 3, // account: sender; other: recipient; value: amount in token units
+        maintain = 4, // run the contract's expiry sweep
+    };
+
+    struct event {
+        event_kind kind  = event_kind::advance;
+        uint32_t account = 0; // index into trace::accounts
+        uint32_t other   = 0;
+        uint64_t value   = 0;
+    };
+
+    struct trace {
+        std::vector<eosio::name> accounts;
+        std::vector<event>       events;
+    };
+
+    /**
+     * Builds a trace in time order. Plays are numbered as they are recorded,
+     * and callbacks refer to the play they answer by that number.
+     */
+    class recorder {
+    public:
+        /// Move the clock to `time_us`, relative to the start of the trace
+        void advance_to(uint64_t time_us);
+
+        /// @return the play's number, for the callback answering it
+        uint32_t play(eosio::name player, uint64_t nonce);
+
+        void callback(uint32_t play, uint64_t random_value);
+
+        void transfer(eosio::name from, eosio::name to, uint64_t amount);
+
+        void maintain();
+
+        const trace& result() const { return recorded; }
+
+    private:
+        uint32_t account_index(eosio::name account);
+
+        trace    recorded;
+        uint64_t now_us = 0;
+        uint32_t plays  = 0;
+    };
+
+    /// Binary encoding: a short header, the account table, then one tagged, varint-packed record per event
+    std::vector<char> encode(const trace& t);
+
+    trace decode(const std::vector<char>& bytes);
+
+    void write_trace(const std::string& path, const trace& t);
+
+    trace read_trace(const std::string& path);
+
+} // namespace replay
@@ -0,0 +1,124 @@
+#include "workload.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace replay {
+
+    namespace {
+
+        // splitmix64: small, fast and identical on every platform, unlike <random>'s distributions
+        class rng {
+        public:
+            explicit rng(uint64_t seed) : state(seed) {}
+
+            uint64_t next() {
+                uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                return z ^ (z >> 31);
+            }
+
+            uint64_t below(uint64_t n) { return n ? next() % n : 0; }
+
+            /// Exponentially distributed with the given mean
+            uint64_t exponential(double mean) {
+                double u = double(next() >> 11) * 0x1.0p-53;
+                return uint64_t(-std::log1p(-u) * mean);
+            }
+
+        private:
+            uint64_t state;
+        };
+
+        struct timed_event {
+            uint64_t time_us;
+            uint64_t order; // keeps generation order between events at the same time
+            event_kind kind;
+            uint32_t account;
+            uint32_t other;
+            uint64_t value;
+        };
+
+        /// Player names that are valid account names: p + base-31 digits from the name alphabet
+        eosio::name player_name(uint32_t index) {
+            static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz12345";
+            std::string s = "p";
+            do {
+                s += alphabet[index % 31];
+                index /= 31;
+            } while (index > 0);
+            return eosio::name(s);
+        }
+
+    } // namespace
+
+    trace generate(const workload_shape& shape) {
+        rng random(shape.seed);
+        std::vector<timed_event> events;
+        uint64_t span_us = uint64_t(shape.duration_s) * 1000000;
+        uint32_t players = std::max<uint32_t>(shape.players, 2);
+
+        double play_gap_us = shape.plays ? double(span_us) / shape.plays : 0;
+        uint64_t t = 0;
+        for (uint32_t i = 0; i < shape.plays; i++) {
+            t += random.exponential(play_gap_us);
+            uint32_t player = uint32_t(random.below(players));
+            events.push_back({t, events.size(), event_kind::play, player, 0, i + 1});
+
+            if (random.below(100) >= shape.drop_percent) {
+                uint64_t answered = t + random.exponential(shape.callback_ms * 1000.0);
+                events.push_back({answered, events.size(), event_kind::callback, 0, i, random.next()});
+            }
+        }
+
+        double transfer_gap_us = shape.transfers ? double(span_us) / shape.transfers : 0;
+        t = 0;
+        for (uint32_t i = 0; i < shape.transfers; i++) {
+            t += random.exponential(transfer_gap_us);
+            uint32_t from = uint32_t(random.below(players));
+            uint32_t to = uint32_t((from + 1 + random.below(players - 1)) % players);
+            events.push_back({t, events.size(), event_kind::transfer, from, to, 1 + random.below(100000)});
+        }
+
+        if (shape.sweep_every_s > 0) {
+            uint64_t every_us = uint64_t(shape.sweep_every_s) * 1000000;
+            for (uint64_t at = every_us; at <= span_us; at += every_us) {
+                events.push_back({at, events.size(), event_kind::maintain, 0, 0, 0});
+            }
+        }
+
+        std::sort(events.begin(), events.end(), [](const timed_event& a, const timed_event& b) {
+            return a.time_us != b.time_us ? a.time_us < b.time_us : a.order < b.order;
+        });
+
+        // Plays keep their generation order, so play i is still the i-th play recorded
+        std::vector<eosio::name> names;
+        for (uint32_t i = 0; i < players; i++) names.push_back(player_name(i));
+
+        recorder out;
+        for (const auto& e : events) {
+            out.advance_to(e.time_us);
+            switch (e.kind) {
+            case event_kind::play:
+                out.play(names[e.account], e.value);
+                break;
+            case event_kind::callback:
+                out.callback(e.other, e.value);
+                break;
+            case event_kind::transfer:
+                out.transfer(names[e.account], names[e.other], e.value);
+                break;
+            case event_kind::maintain:
+                out.maintain();
+                break;
+            case event_kind::advance:
+                break;
+            }
+        }
+        return out.result();
+    }
+
+} // namespace replay
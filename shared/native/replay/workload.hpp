@@ -0,0 +1,26 @@
+#pragma once
+
+#include "trace.hpp"
+
+#include <cstdint>
+
+namespace replay {
+
+    /**
+     * Shape of a synthetic workload: how many players, how busy they are and
+     * how the oracle behaves. Generation is deterministic for a given seed.
+     */
+    struct workload_shape {
+        uint32_t players       = 100;
+        uint32_t plays         = 2000;
+        uint32_t duration_s    = 3600;  // plays arrive as a Poisson process over this span
+        uint32_t callback_ms   = 1500;  // mean oracle latency, exponentially distributed
+        uint32_t drop_percent  = 1;     // requests the oracle never answers
+        uint32_t transfers     = 200;   // player to player transfers, spread like plays
+        uint32_t sweep_every_s = 300;   // how often the expiry sweep runs; 0 for never
+        uint64_t seed          = 1;
+    };
+
+    trace generate(const workload_shape& shape);
+
+} // namespace replay